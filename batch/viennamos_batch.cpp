@@ -0,0 +1,757 @@
+/* =============================================================================
+   Copyright (c) 2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMOS - The Vienna MOS Simulator
+                             -----------------
+
+   license:    see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennamos_batch.cpp
+    @brief Headless runner for ViennaMini states saved by ViennaMOS.
+
+    A state file, as written by 'Save State' of the ViennaMini module, holds the mesh file,
+    the solver settings and the segment setup of a simulation. viennamos-batch loads the
+    state and the mesh, runs the simulation the same way the ViennaMini worker of the GUI
+    does and writes the potential and the carrier concentrations to a VTK file. Neither Qt
+    nor VTK is needed, so batch runs start within milliseconds, also on compute nodes.
+
+    Usage: viennamos-batch [options] STATE.ini [STATE.ini ...]
+      --mesh FILE               use this mesh instead of the one of the state
+      --output PREFIX           result file prefix, '_<n>' is appended for several
+                                states                                (<state name>_result)
+      --materials FILE          material database                     (the one of the GUI)
+      --threads N               number of OpenMP threads per run
+      --log                     write the simulator output to <prefix>.log instead of
+                                the console
+      --no-mesh-cache           always parse the mesh file, neither read nor write the
+                                binary cache <mesh>.vgcache next to it
+      --checkpoint N            write the state of the simulation to <prefix>.checkpoint
+                                every N nonlinear iterations
+      --resume                  continue from <prefix>.checkpoint if it exists, e.g.
+                                after a crashed or killed run
+      --initial-guess FILE      start from the result FILE (.pvd or .vtu) of a previous run
+                                on another mesh of the device, e.g. a coarser one, instead
+                                of the doping based initial guesses
+      --refine TOL              refine the cells whose variation of the potential or of the
+                                log carrier densities exceeds TOL thermal voltages and
+                                simulate again, starting from the previous solution; not
+                                with --initial-guess, --resume or --checkpoint
+      --refine-levels N         at most N refinements                           (5)
+      --probe FROM:TO:N         sample the solution at N points on the line from FROM to
+                                TO, given as 'x,y' or 'x,y,z' in the units of the mesh
+                                file, and write them to <prefix>_probe.csv
+      --probe P0:P1:P2:N:M      sample the solution on a grid of N x M points on the
+                                parallelogram at P0 spanned towards P1 and P2 instead
+
+    The exit code is non-zero if a state could not be run or a simulation did not converge.
+*/
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "viennamini/simulator.hpp"
+#include "viennamini/device_setup.hpp"
+#include "viennamini/result_accessor.hpp"
+#include "viennamini/solution_transfer.hpp"
+#include "viennamini/adaptive_simulator.hpp"
+
+#include "viennagrid/io/netgen_reader.hpp"
+#include "viennagrid/io/mesh_cache.hpp"
+#include "viennagrid/io/vtk_reader.hpp"
+#include "viennagrid/algorithm/scale.hpp"
+#include "viennagrid/algorithm/norm.hpp"
+#include "viennagrid/algorithm/spatial_index.hpp"
+
+#include "viennamaterials/library.hpp"
+#include "viennamaterials/kernels/pugixml.hpp"
+
+#include "viennafvm/timer.hpp"
+#include "viennautils/log.hpp"
+
+#ifndef VIENNAMOS_BATCH_MATERIALS
+  #define VIENNAMOS_BATCH_MATERIALS "materials.xml"
+#endif
+
+namespace batch {
+
+// ----------------------------------------------------------------------------
+//
+// State files
+//
+// ----------------------------------------------------------------------------
+
+/** @brief Reads the INI files written by QSettings. Sub-groups are part of the key,
+    e.g., 'segment0\\name' in the group 'device'. Keys outside of a group are stored
+    in the group '%General', as QSettings does. */
+class ini_file
+{
+public:
+  bool load(std::string const& filename)
+  {
+    std::ifstream stream(filename.c_str());
+    if(!stream) return false;
+
+    std::string group = "%General";
+    std::string line;
+    while(std::getline(stream, line))
+    {
+      line = trim(line);
+      if(line.empty() || line[0] == ';' || line[0] == '#') continue;
+
+      if(line[0] == '[' && line[line.size()-1] == ']')
+      {
+        group = line.substr(1, line.size()-2);
+        continue;
+      }
+
+      std::string::size_type assign = line.find('=');
+      if(assign == std::string::npos) continue;
+      values_[group][trim(line.substr(0, assign))] = unquote(trim(line.substr(assign+1)));
+    }
+    return true;
+  }
+
+  bool has(std::string const& group, std::string const& key) const
+  {
+    Groups::const_iterator g = values_.find(group);
+    return (g != values_.end()) && (g->second.find(key) != g->second.end());
+  }
+
+  std::string value(std::string const& group, std::string const& key, std::string const& fallback = "") const
+  {
+    Groups::const_iterator g = values_.find(group);
+    if(g == values_.end()) return fallback;
+    Values::const_iterator v = g->second.find(key);
+    return (v == g->second.end()) ? fallback : v->second;
+  }
+
+  double number(std::string const& group, std::string const& key, double fallback = 0.0) const
+  {
+    return has(group, key) ? std::atof(value(group, key).c_str()) : fallback;
+  }
+
+  bool flag(std::string const& group, std::string const& key, bool fallback = false) const
+  {
+    return has(group, key) ? (value(group, key) == "true") : fallback;
+  }
+
+private:
+  typedef std::map<std::string, std::string>  Values;
+  typedef std::map<std::string, Values>       Groups;
+
+  static std::string trim(std::string const& text)
+  {
+    std::string::size_type begin = text.find_first_not_of(" \t\r\n");
+    if(begin == std::string::npos) return "";
+    std::string::size_type end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+  }
+
+  // QSettings quotes strings with special characters and escapes backslashes
+  static std::string unquote(std::string const& text)
+  {
+    std::string result;
+    std::size_t begin = 0, end = text.size();
+    if(text.size() >= 2 && text[0] == '"' && text[text.size()-1] == '"') { begin = 1; end = text.size()-1; }
+    for(std::size_t i = begin; i < end; i++)
+    {
+      if(text[i] == '\\' && i+1 < end) i++;
+      result += text[i];
+    }
+    return result;
+  }
+
+  Groups values_;
+};
+
+/** @brief The content of a ViennaMini state, see ViennaMiniForm::saveState() */
+struct state
+{
+  state() : scaling(1.0), dim(2) {}
+
+  std::string                             meshfile;
+  double                                  scaling;
+  int                                     dim;
+  viennamini::config                      config;
+  std::vector<viennamini::segment_setup>  segments;
+};
+
+/** @brief Relative mesh paths are resolved against the working directory, as the GUI does,
+    and against the directory of the state file */
+std::string resolve_mesh(std::string const& meshfile, std::string const& statefile)
+{
+  if(std::ifstream(meshfile.c_str())) return meshfile;
+  if(!meshfile.empty() && meshfile[0] == '/') return meshfile;
+
+  std::string::size_type slash = statefile.find_last_of('/');
+  if(slash == std::string::npos) return meshfile;
+
+  std::string candidate = statefile.substr(0, slash+1) + meshfile;
+  if(std::ifstream(candidate.c_str())) return candidate;
+
+  // the example states store the path relative to the build directory of the GUI, try its name only
+  std::string::size_type name = meshfile.find_last_of('/');
+  if(name != std::string::npos)
+  {
+    candidate = statefile.substr(0, slash+1) + meshfile.substr(name+1);
+    if(std::ifstream(candidate.c_str())) return candidate;
+  }
+  return meshfile;
+}
+
+bool read_state(std::string const& filename, state& s, std::string& error)
+{
+  ini_file ini;
+  if(!ini.load(filename))
+  {
+    error = "cannot open the state file";
+    return false;
+  }
+
+  // states written by newer versions keep the general settings in a group of their own
+  std::string general = ini.has("general", "meshfile") ? "general" : "%General";
+  if(!ini.has(general, "meshfile"))
+  {
+    error = "the state does not contain a mesh file";
+    return false;
+  }
+
+  s.meshfile = resolve_mesh(ini.value(general, "meshfile"), filename);
+  s.scaling  = ini.number(general, "meshscaling", 1.0);
+  s.dim      = (ini.number(general, "meshtype", 0) == 1) ? 3 : 2; // the index of the mesh type combobox
+
+  // the entries missing in older state files keep the defaults of the config
+  viennamini::config& config = s.config;
+  config.temperature()          = ini.number(general, "temperature",         config.temperature());
+  config.linear_iterations()    = static_cast<std::size_t>(ini.number(general, "linsolve_iter", config.linear_iterations()));
+  config.linear_breaktol()      = ini.number(general, "linsolve_tol",        config.linear_breaktol());
+  config.nonlinear_iterations() = static_cast<std::size_t>(ini.number(general, "nonlinsolve_iter", config.nonlinear_iterations()));
+  config.nonlinear_breaktol()   = ini.number(general, "nonlinsolve_tol",     config.nonlinear_breaktol());
+  config.damping()              = ini.number(general, "nonlinsolve_damping", config.damping());
+  config.adaptive_damping()     = ini.flag  (general, "nonlinsolve_adaptive_damping", config.adaptive_damping());
+  config.bias_ramping()         = ini.flag  (general, "nonlinsolve_bias_ramping",     config.bias_ramping());
+  config.bias_step()            = ini.number(general, "nonlinsolve_bias_step",        config.bias_step());
+
+  int segments = static_cast<int>(ini.number("device", "segmentsize", 0));
+  for(int si = 0; si < segments; si++)
+  {
+    std::stringstream prefix;
+    prefix << "segment" << si << "\\";
+    std::string p = prefix.str();
+
+    viennamini::segment_setup seg;
+    seg.id               = static_cast<std::size_t>(ini.number("device", p+"id"));
+    seg.name             = ini.value ("device", p+"name");
+    seg.material         = ini.value ("device", p+"material");
+    seg.is_contact       = ini.flag  ("device", p+"iscontact");
+    seg.contact          = ini.number("device", p+"contact");
+    seg.workfunction     = ini.number("device", p+"workfunction");
+    seg.is_oxide         = ini.flag  ("device", p+"isoxide");
+    seg.is_semiconductor = ini.flag  ("device", p+"issemiconductor");
+    seg.donors           = ini.number("device", p+"donors");
+    seg.acceptors        = ini.number("device", p+"acceptors");
+    s.segments.push_back(seg);
+  }
+  if(s.segments.empty())
+  {
+    error = "the state does not contain any segments";
+    return false;
+  }
+  return true;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Probing
+//
+// ----------------------------------------------------------------------------
+
+/** @brief A line or a plane through the device, on which the solution is sampled */
+struct probe_geometry
+{
+  probe_geometry() : dim(0), plane(false)
+  {
+    for(int i = 0; i < 3; i++)
+      for(int d = 0; d < 3; d++) points[i][d] = 0.0;
+    samples[0] = samples[1] = 0;
+  }
+
+  bool enabled() const { return samples[0] > 0; }
+
+  int           dim;
+  bool          plane;          // the parallelogram at points[0] spanned towards points[1] and points[2],
+                                // otherwise the line from points[0] to points[1]
+  double        points[3][3];
+  std::size_t   samples[2];     // towards points[1] and towards points[2]
+};
+
+/** @brief Parses the line 'x0,y0[,z0]:x1,y1[,z1]:n' or the plane 'x0,y0[,z0]:x1,y1[,z1]:x2,y2[,z2]:n:m' */
+bool parse_probe(std::string const& text, probe_geometry& probe)
+{
+  std::vector<std::string> parts;
+  std::string::size_type begin = 0, colon;
+  while((colon = text.find(':', begin)) != std::string::npos)
+  {
+    parts.push_back(text.substr(begin, colon - begin));
+    begin = colon+1;
+  }
+  parts.push_back(text.substr(begin));
+  if(parts.size() != 3 && parts.size() != 5) return false;
+
+  probe.plane = (parts.size() == 5);
+  int point_count = probe.plane ? 3 : 2;
+  for(int i = 0; i < point_count; i++)
+  {
+    std::replace(parts[i].begin(), parts[i].end(), ',', ' ');
+    std::istringstream stream(parts[i]);
+    int dim = 0;
+    while(dim < 3 && stream >> probe.points[i][dim]) dim++;
+    if(dim < 2 || !(stream >> std::ws).eof()) return false;
+    if(i > 0 && dim != probe.dim) return false;
+    probe.dim = dim;
+  }
+
+  for(int i = 0; i + point_count < static_cast<int>(parts.size()); i++)
+  {
+    int samples = std::atoi(parts[i + point_count].c_str());
+    if(samples < 2) return false;
+    probe.samples[i] = static_cast<std::size_t>(samples);
+  }
+  return true;
+}
+
+/** @brief Writes the potential and the carrier concentrations at the samples of the probe line
+    or plane into a CSV file, the fields of samples outside of the device are empty. The cells
+    are found by a single traversal of each line through a bounding volume hierarchy of the mesh */
+template<typename MeshT, typename SimulatorT>
+void write_probe(MeshT const& mesh, viennamini::StorageType& storage, SimulatorT& simulator,
+                 probe_geometry const& probe, double scaling, std::string const& filename)
+{
+  typedef typename viennagrid::result_of::point<MeshT>::type                              PointType;
+  typedef typename viennagrid::result_of::cell<MeshT>::type                               CellType;
+  typedef typename viennagrid::result_of::const_cell_range<MeshT>::type                   CellRangeType;
+  typedef typename SimulatorT::VectorType                                                 VectorType;
+  typedef viennamini::result_accessor<CellType, viennamini::StorageType, VectorType>     AccessorType;
+
+  if(probe.dim != viennagrid::result_of::static_size<PointType>::value)
+    throw std::runtime_error("the probe does not match the dimension of the mesh");
+
+  PointType points[3];
+  for(int i = 0; i < 3; i++)
+    for(std::size_t d = 0; d < points[i].size(); d++)
+      points[i][d] = probe.points[i][d] * scaling;
+
+  viennagrid::spatial_index<MeshT> index(mesh);
+  std::vector<int> cells;
+  if(probe.plane)
+    index.sample_plane(points[0], points[1], points[2], probe.samples[0], probe.samples[1], cells);
+  else
+    index.sample_line(points[0], points[1], probe.samples[0], cells);
+
+  CellRangeType mesh_cells(mesh);
+  AccessorType  potential(storage, simulator.result(), simulator.quantity_potential().id());
+  AccessorType  electrons(storage, simulator.result(), simulator.quantity_electron_density().id());
+  AccessorType  holes    (storage, simulator.result(), simulator.quantity_hole_density().id());
+
+  std::ofstream stream(filename.c_str());
+  if(!stream)
+    throw std::runtime_error("cannot write " + filename);
+
+  char const* axes[3] = { "x", "y", "z" };
+  stream << (probe.plane ? "u,v" : "distance");
+  for(int d = 0; d < probe.dim; d++) stream << "," << axes[d];
+  stream << ",cell,potential,electrons,holes" << std::endl;
+
+  stream.precision(10);
+  double length[2] = { viennagrid::norm(points[1] - points[0]) / scaling, viennagrid::norm(points[2] - points[0]) / scaling };
+  for(std::size_t k = 0; k < cells.size(); k++)
+  {
+    // the samples of a plane are stored row by row
+    double t = double(k % probe.samples[0]) / double(probe.samples[0] - 1);
+    double u = probe.plane ? double(k / probe.samples[0]) / double(probe.samples[1] - 1) : 0.0;
+    stream << t * length[0];
+    if(probe.plane) stream << "," << u * length[1];
+    for(int d = 0; d < probe.dim; d++)
+      stream << "," << probe.points[0][d] + t * (probe.points[1][d] - probe.points[0][d])
+                                          + u * (probe.points[2][d] - probe.points[0][d]);
+
+    if(cells[k] < 0)
+    {
+      stream << ",-1,,," << std::endl;
+      continue;
+    }
+    CellType const& cell = mesh_cells[cells[k]];
+    stream << "," << cells[k] << "," << potential(cell) << "," << electrons(cell) << "," << holes(cell) << std::endl;
+  }
+}
+
+// ----------------------------------------------------------------------------
+//
+// Simulation
+//
+// ----------------------------------------------------------------------------
+
+//! writes the log output of a run into a file
+class file_sink : public viennautils::log::sink
+{
+public:
+  explicit file_sink(std::string const& filename) : stream_(filename.c_str()) {}
+  void write(const char* data, std::size_t size) { stream_.write(data, static_cast<std::streamsize>(size)); }
+
+private:
+  std::ofstream stream_;
+};
+
+struct run_info
+{
+  run_info() : cells(0), nonlinear_iterations(0), converged(false), load(0), simulate(0), write(0) {}
+
+  std::size_t   cells;
+  std::size_t   nonlinear_iterations;
+  bool          converged;
+  double        load;       // [s]
+  double        simulate;   // [s]
+  double        write;      // [s]
+};
+
+/** @brief Reads the potential and the carrier densities of a result written by write_result(),
+    'ids' are the ids of the quantities, which are part of the names of the data arrays */
+template<typename MeshT, typename SegmentationT>
+viennamini::solution_transfer<MeshT>* read_previous_result(std::string const& filename, std::size_t const* ids)
+{
+  typedef typename viennagrid::result_of::cell<MeshT>::type                     CellType;
+  typedef typename viennagrid::result_of::const_cell_range<MeshT>::type         CellRangeType;
+  typedef typename viennagrid::result_of::iterator<CellRangeType>::type         CellIteratorType;
+
+  MeshT         mesh;
+  SegmentationT segmentation(mesh);
+  std::vector<double> data[3];
+
+  viennagrid::io::vtk_reader<MeshT> reader;
+  for(int i = 0; i < 3; i++)
+  {
+    std::stringstream name;
+    name << "fvm_result" << ids[i];
+    viennagrid::io::add_scalar_data_on_cells(reader, viennagrid::make_accessor<CellType>(data[i]), name.str());
+  }
+  reader(mesh, segmentation, filename);
+
+  std::auto_ptr< viennamini::solution_transfer<MeshT> > transfer(new viennamini::solution_transfer<MeshT>(mesh));
+  CellRangeType cells(mesh);
+  for(int i = 0; i < 3; i++)
+  {
+    std::vector<double> values;
+    values.reserve(cells.size());
+    for(CellIteratorType cit = cells.begin(); cit != cells.end(); ++cit)
+    {
+      std::size_t id = static_cast<std::size_t>((*cit).id().get());
+      if(id >= data[i].size())
+        throw std::runtime_error(filename + " does not contain the solution of a ViennaMini simulation");
+      values.push_back(data[i][id]);
+    }
+    // all cells hold values, the densities are undefined where they are zero, i.e. in oxides and contacts
+    transfer->add_quantity(ids[i], values, std::vector<bool>(values.size(), true), i > 0);
+  }
+  return transfer.release();
+}
+
+/** @brief Sets up the device from the state, see viennamini::setup_device(), which the ViennaMini worker uses as well */
+struct device_setup
+{
+  explicit device_setup(state& s) : s(s) {}
+
+  template<typename DeviceT>
+  void operator()(DeviceT& device) const
+  {
+    viennamini::setup_device(device, s.config, s.segments);
+  }
+
+  state& s;
+};
+
+/** @brief Collects the convergence of a finished simulation and writes its results */
+template<typename MeshT, typename SimulatorT>
+void finish(run_info& info, SimulatorT& simulator, MeshT const& mesh, viennamini::StorageType& storage,
+            state const& s, std::string const& output, probe_geometry const& probe)
+{
+  viennafvm::Timer timer;
+
+  for(std::size_t i = 0; i < simulator.bias_steps().size(); i++)
+    info.nonlinear_iterations += simulator.bias_steps()[i].nonlinear_iterations;
+  info.converged = !simulator.bias_steps().empty() && simulator.bias_steps().back().converged;
+
+  timer.start();
+  simulator.write_result(output);
+  if(probe.enabled())
+    write_probe(mesh, storage, simulator, probe, s.scaling, output + "_probe.csv");
+  info.write = timer.get();
+}
+
+template<typename MeshT, typename SegmentationT, typename DeviceT, typename SimulatorT>
+run_info run(state& s, viennamini::MatLibPugixmlType& matlib, std::string const& output, bool mesh_cache, bool resume,
+             std::string const& initial_guess, bool refine, probe_geometry const& probe)
+{
+  run_info info;
+  viennafvm::Timer timer;
+
+  timer.start();
+  MeshT                   mesh;
+  SegmentationT           segmentation(mesh);
+  viennamini::StorageType storage;
+
+  if(mesh_cache)
+  {
+    viennagrid::io::cached_reader<viennagrid::io::netgen_reader> reader;
+    reader(mesh, segmentation, s.meshfile);
+  }
+  else
+  {
+    viennagrid::io::netgen_reader reader;
+    reader(mesh, segmentation, s.meshfile);
+  }
+  viennagrid::scale(mesh, s.scaling);
+  info.cells = viennagrid::cells(mesh).size();
+  info.load  = timer.get();
+
+  if(refine)
+  {
+    // each level is a simulation of its own, the iterations of all levels are reported
+    timer.start();
+    viennamini::adaptive_simulator<DeviceT, viennamini::MatLibPugixmlType> adaptive(mesh, segmentation, matlib, s.config);
+    adaptive(device_setup(s));    // an unresolved error indicator is logged, the convergence is the one of the last level
+    info.simulate  = timer.get();
+    info.cells     = viennagrid::cells(adaptive.mesh()).size();
+    for(std::size_t i = 0; i+1 < adaptive.levels().size(); i++)
+      info.nonlinear_iterations += adaptive.levels()[i].nonlinear_iterations;
+
+    finish(info, adaptive.simulator(), adaptive.mesh(), adaptive.device().storage(), s, output, probe);
+    return info;
+  }
+
+  timer.start();
+  DeviceT device(mesh, segmentation, storage);
+  device_setup setup(s);
+  setup(device);
+
+  SimulatorT simulator(device, matlib, s.config);
+
+  std::auto_ptr< viennamini::solution_transfer<MeshT> > previous;
+  if(!initial_guess.empty())
+  {
+    std::size_t ids[3] = { simulator.quantity_potential().id(), simulator.quantity_electron_density().id(),
+                           simulator.quantity_hole_density().id() };
+    previous.reset(read_previous_result<MeshT, SegmentationT>(initial_guess, ids));
+    simulator.use_initial_guess(previous.get());
+  }
+
+  std::string checkpoint = s.config.checkpoint_file().empty() ? output + ".checkpoint" : s.config.checkpoint_file();
+  if(resume && std::ifstream(checkpoint.c_str()))
+  {
+    if(!simulator.resume_from_checkpoint(checkpoint))
+      throw std::runtime_error("cannot resume from " + checkpoint);
+  }
+  else
+    simulator();
+  info.simulate = timer.get();
+
+  finish(info, simulator, mesh, storage, s, output, probe);
+  return info;
+}
+
+run_info simulate(state& s, viennamini::MatLibPugixmlType& matlib, std::string const& output, bool mesh_cache, bool resume,
+                  std::string const& initial_guess, bool refine, probe_geometry const& probe)
+{
+  if(s.dim == 2)
+    return run<viennamini::MeshTriangular2DType, viennamini::SegmentationTriangular2DType,
+               viennamini::DeviceTriangular2DType, viennamini::SimulatorTriangular2DType>(s, matlib, output, mesh_cache, resume, initial_guess, refine, probe);
+  else
+    return run<viennamini::MeshTetrahedral3DType, viennamini::SegmentationTetrahedral3DType,
+               viennamini::DeviceTetrahedral3DType, viennamini::SimulatorTetrahedral3DType>(s, matlib, output, mesh_cache, resume, initial_guess, refine, probe);
+}
+
+// ----------------------------------------------------------------------------
+//
+// Command line
+//
+// ----------------------------------------------------------------------------
+
+struct options
+{
+  options() : materials(VIENNAMOS_BATCH_MATERIALS), threads(0), log(false), mesh_cache(true), checkpoint(0), resume(false),
+              refine(0), refine_levels(-1) {}
+
+  std::vector<std::string>  states;
+  std::string               mesh;
+  std::string               output;
+  std::string               materials;
+  int                       threads;
+  bool                      log;
+  bool                      mesh_cache;
+  int                       checkpoint;
+  bool                      resume;
+  std::string               initial_guess;
+  double                    refine;
+  int                       refine_levels;
+  probe_geometry            probe;
+};
+
+void usage()
+{
+  std::cerr << "usage: viennamos-batch [--mesh FILE] [--output PREFIX] [--materials FILE]" << std::endl
+            << "                       [--threads N] [--log] [--no-mesh-cache] [--checkpoint N] [--resume]" << std::endl
+            << "                       [--initial-guess FILE] [--refine TOL] [--refine-levels N]" << std::endl
+            << "                       [--probe FROM:TO:N|P0:P1:P2:N:M]" << std::endl
+            << "                       STATE.ini [STATE.ini ...]" << std::endl;
+}
+
+bool parse(int argc, char** argv, options& opt)
+{
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    bool has_value = (i+1 < argc);
+
+    if(arg == "--log")                         opt.log       = true;
+    else if(arg == "--no-mesh-cache")          opt.mesh_cache = false;
+    else if(arg == "--resume")                 opt.resume    = true;
+    else if(arg == "--mesh"      && has_value) opt.mesh      = argv[++i];
+    else if(arg == "--output"    && has_value) opt.output    = argv[++i];
+    else if(arg == "--materials" && has_value) opt.materials = argv[++i];
+    else if(arg == "--threads"   && has_value) opt.threads   = std::atoi(argv[++i]);
+    else if(arg == "--checkpoint" && has_value) opt.checkpoint = std::atoi(argv[++i]);
+    else if(arg == "--initial-guess" && has_value) opt.initial_guess = argv[++i];
+    else if(arg == "--refine"    && has_value) opt.refine    = std::atof(argv[++i]);
+    else if(arg == "--refine-levels" && has_value) opt.refine_levels = std::atoi(argv[++i]);
+    else if(arg == "--probe"     && has_value) { if(!parse_probe(argv[++i], opt.probe)) return false; }
+    else if(arg.size() > 1 && arg[0] == '-')   return false;
+    else                                       opt.states.push_back(arg);
+  }
+
+  // the levels of a refinement are simulations of their own on new meshes, which start from the
+  // solution of the previous level and are neither checkpointed nor resumed
+  if(opt.refine > 0 && (!opt.initial_guess.empty() || opt.resume || opt.checkpoint > 0))
+  {
+    std::cerr << "--refine cannot be combined with --initial-guess, --resume or --checkpoint" << std::endl;
+    return false;
+  }
+  return !opt.states.empty();
+}
+
+/** @brief The result prefix of a state: the given prefix, or the name of the state file */
+std::string output_prefix(options const& opt, std::size_t index)
+{
+  std::stringstream prefix;
+  if(!opt.output.empty())
+  {
+    prefix << opt.output;
+    if(opt.states.size() > 1) prefix << "_" << index;
+    return prefix.str();
+  }
+
+  std::string name = opt.states[index];
+  std::string::size_type slash = name.find_last_of('/');
+  if(slash != std::string::npos) name = name.substr(slash+1);
+  std::string::size_type dot = name.find_last_of('.');
+  if(dot != std::string::npos) name = name.substr(0, dot);
+  return name + "_result";
+}
+
+} // end namespace batch
+
+int main(int argc, char** argv)
+{
+  batch::options opt;
+  if(!batch::parse(argc, argv, opt))
+  {
+    batch::usage();
+    return EXIT_FAILURE;
+  }
+
+#ifdef _OPENMP
+  if(opt.threads > 0) omp_set_num_threads(opt.threads);
+#else
+  if(opt.threads > 1) std::cerr << "viennamos-batch: built without OpenMP, --threads is ignored" << std::endl;
+#endif
+
+  // the material database is parsed once for all states
+  viennamini::MatLibPugixmlType matlib;
+  try
+  {
+    matlib.load(opt.materials);
+  }
+  catch(...)
+  {
+    std::cerr << "viennamos-batch: cannot load the material database " << opt.materials << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  bool success = true;
+  for(std::size_t si = 0; si < opt.states.size(); si++)
+  {
+    std::string const& statefile = opt.states[si];
+    std::string        output    = batch::output_prefix(opt, si);
+
+    batch::state s;
+    std::string  error;
+    if(!batch::read_state(statefile, s, error))
+    {
+      std::cerr << "viennamos-batch: " << statefile << ": " << error << std::endl;
+      success = false;
+      continue;
+    }
+    if(!opt.mesh.empty()) s.meshfile = opt.mesh;
+    if(opt.refine > 0)
+    {
+      s.config.refinement_tolerance() = opt.refine;
+      if(opt.refine_levels >= 0) s.config.refinement_levels() = opt.refine_levels;
+    }
+    if(opt.checkpoint > 0)
+    {
+      s.config.checkpoint_file()     = output + ".checkpoint";
+      s.config.checkpoint_interval() = opt.checkpoint;
+    }
+
+    batch::run_info info;
+    try
+    {
+      if(opt.log)
+      {
+        batch::file_sink logfile(output + ".log");
+        viennautils::log::scoped_sink redirect(logfile);
+        info = batch::simulate(s, matlib, output, opt.mesh_cache, opt.resume, opt.initial_guess, opt.refine > 0, opt.probe);
+      }
+      else
+        info = batch::simulate(s, matlib, output, opt.mesh_cache, opt.resume, opt.initial_guess, opt.refine > 0, opt.probe);
+    }
+    catch(std::exception& e)
+    {
+      std::cerr << "viennamos-batch: " << statefile << ": " << e.what() << std::endl;
+      success = false;
+      continue;
+    }
+
+    std::cout << std::fixed << std::setprecision(3)
+              << statefile << ": " << s.dim << "D  cells " << info.cells
+              << "  nonlinear its " << info.nonlinear_iterations << (info.converged ? "" : "  (not converged)")
+              << "  load " << info.load << "  simulate " << info.simulate << "  write " << info.write << " [s]"
+              << "  -> " << output << std::endl;
+    success = success && info.converged;
+  }
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,369 @@
+/* =============================================================================
+   Copyright (c) 2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMOS - The Vienna MOS Simulator
+                             -----------------
+
+   license:    see file LICENSE in the base directory
+============================================================================= */
+
+/** @file mesh_construction_bench.cpp
+    @brief Compares the construction of tetrahedral meshes with the boundary elements stored
+           in hidden key maps (the default config) and in hashed key maps.
+
+    A structured box of n x n x n cubes is split into six tetrahedra per cube. The cells are
+    created one by one, which deduplicates the triangles and lines of each cell against the
+    ones created so far. The runtimes are reported along with the number of triangles and
+    lines, which are checked against the closed-form counts of the box.
+
+    With --segments S, the cells of the hashed mesh are then split into S slabs along the
+    z-axis and added to a segmentation. The time and the memory for building the segmentation
+    are reported, as well as the time for iterating the triangles of all segments and testing
+    their segment membership.
+
+    With --compact, a mesh of the default config is built and an immutable compact snapshot
+    (viennagrid::compact_mesh) is taken of it. The memory of both is reported, as well as the
+    time for a pass over the volumes of all cells and the lengths of all edges on either one.
+
+    Usage: mesh_construction_bench [options]
+      --cells N[,N...]    approximate number of tetrahedra per mesh   (1000000)
+      --repeat R          number of timed runs per config             (1)
+      --segments S        number of segments, 0 skips the segmentation (0)
+      --compact           compare traversals of the mesh and of its compact snapshot
+      --no-reference      skip the default config, e.g., for very large meshes
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/mesh/element_creation.hpp"
+#include "viennagrid/mesh/segmentation.hpp"
+#include "viennagrid/mesh/compact_mesh.hpp"
+#include "viennagrid/algorithm/volume.hpp"
+
+#include "viennafvm/timer.hpp"
+
+namespace mesh_construction_bench {
+
+struct counts
+{
+  counts() : cells(0), triangles(0), lines(0) {}
+
+  std::size_t cells;
+  std::size_t triangles;
+  std::size_t lines;
+};
+
+//! the number of triangles and lines of the box, each cube being split into six tetrahedra
+inline counts expected(std::size_t n)
+{
+  counts c;
+  c.cells     = 6 * n * n * n;
+  c.triangles = 12 * n * n * n + 6 * n * n;
+  c.lines     = 3 * n * (n + 1) * (n + 1) + 3 * n * n * (n + 1) + n * n * n;
+  return c;
+}
+
+//! builds the box into the mesh, the tetrahedra of a cube share its main diagonal
+template <typename MeshType>
+void build(MeshType& mesh, std::size_t n, bool reserve)
+{
+  typedef typename viennagrid::result_of::point<MeshType>::type          PointType;
+  typedef typename viennagrid::result_of::vertex_handle<MeshType>::type  VertexHandleType;
+
+  std::size_t const m = n + 1;
+  std::vector<VertexHandleType> vertices(m * m * m);
+  for(std::size_t k = 0; k < m; k++)
+    for(std::size_t j = 0; j < m; j++)
+      for(std::size_t i = 0; i < m; i++)
+        vertices[(k * m + j) * m + i] = viennagrid::make_vertex(mesh, PointType(double(i), double(j), double(k)));
+
+  if(reserve)
+    viennagrid::reserve_boundary_elements(mesh, 6 * n * n * n);
+
+  // the three axis orders of the paths along the cube edges from corner 0 to corner 7
+  std::size_t const axes[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+  std::size_t const stride[3]  = { 1, m, m * m };
+
+  for(std::size_t k = 0; k < n; k++)
+    for(std::size_t j = 0; j < n; j++)
+      for(std::size_t i = 0; i < n; i++)
+      {
+        std::size_t const origin = (k * m + j) * m + i;
+        for(std::size_t t = 0; t < 6; t++)
+        {
+          std::size_t v1 = origin + stride[axes[t][0]];
+          std::size_t v2 = v1 + stride[axes[t][1]];
+          std::size_t v3 = v2 + stride[axes[t][2]];
+          viennagrid::make_tetrahedron(mesh, vertices[origin], vertices[v1], vertices[v2], vertices[v3]);
+        }
+      }
+}
+
+//! builds the box 'repeat' times into fresh meshes, returns the fastest run
+template <typename MeshType>
+double run(std::size_t n, bool reserve, int repeat, counts& c)
+{
+  double best = 0.0;
+  for(int r = 0; r < repeat; r++)
+  {
+    MeshType mesh;
+    viennafvm::Timer timer;
+    timer.start();
+    build(mesh, n, reserve);
+    double elapsed = timer.get();
+    if(r == 0 || elapsed < best) best = elapsed;
+
+    c.cells     = viennagrid::cells(mesh).size();
+    c.triangles = viennagrid::elements<viennagrid::triangle_tag>(mesh).size();
+    c.lines     = viennagrid::elements<viennagrid::line_tag>(mesh).size();
+  }
+  return best;
+}
+
+//! the resident memory of the process in MB, zero if it cannot be determined
+inline double resident_mb()
+{
+  std::ifstream statm("/proc/self/statm");
+  double pages_total = 0.0, pages_resident = 0.0;
+  if(!(statm >> pages_total >> pages_resident)) return 0.0;
+  return pages_resident * 4096.0 / (1024.0 * 1024.0);
+}
+
+//! builds a segmentation of 'segments' slabs on the box, reports its build time and memory and the time of a pass over the triangles of all segments
+inline void run_segmentation(std::size_t n, std::size_t segments)
+{
+  typedef viennagrid::tetrahedral_3d_hashed_mesh                                    MeshType;
+  typedef viennagrid::tetrahedral_3d_hashed_segmentation                            SegmentationType;
+  typedef viennagrid::result_of::segment_handle<SegmentationType>::type             SegmentHandleType;
+  typedef viennagrid::result_of::cell_range<MeshType>::type                         CellRange;
+  typedef viennagrid::result_of::iterator<CellRange>::type                          CellIterator;
+  typedef viennagrid::result_of::const_triangle_range<SegmentHandleType>::type      TriangleRange;
+  typedef viennagrid::result_of::iterator<TriangleRange>::type                      TriangleIterator;
+
+  double memory_before = resident_mb();
+  MeshType mesh;
+  build(mesh, n, true);
+  double mesh_memory = resident_mb() - memory_before;
+
+  memory_before = resident_mb();
+  SegmentationType segmentation(mesh);
+  viennafvm::Timer timer;
+  timer.start();
+  CellRange cells(mesh);
+  std::size_t index = 0;
+  for(CellIterator cit = cells.begin(); cit != cells.end(); ++cit, ++index)
+    viennagrid::add(segmentation.get_make_segment(static_cast<int>(index * segments / cells.size())), *cit);
+  double build_time = timer.get();
+  double memory = resident_mb() - memory_before;
+
+  timer.start();
+  std::size_t members = 0, triangles = 0;
+  for(SegmentationType::iterator sit = segmentation.begin(); sit != segmentation.end(); ++sit)
+  {
+    TriangleRange segment_triangles(*sit);
+    for(TriangleIterator tit = segment_triangles.begin(); tit != segment_triangles.end(); ++tit)
+    {
+      ++triangles;
+      if(viennagrid::is_in_segment(*sit, *tit)) ++members;
+    }
+  }
+  double pass_time = timer.get();
+
+  std::cout << "segments " << std::setw(4) << segmentation.size()
+            << "  triangles in segments " << std::setw(9) << triangles
+            << std::fixed << std::setprecision(3)
+            << "  build " << build_time << " s  " << std::setprecision(0) << memory << " MB (mesh " << mesh_memory << " MB)"
+            << std::setprecision(3) << "  triangle pass " << pass_time << " s" << std::endl;
+  if(members != triangles)
+    std::cerr << "segment membership differs from the segment views" << std::endl;
+}
+
+//! sums up the cell volumes and the edge lengths of the mesh
+template <typename MeshType>
+double traverse(MeshType const& mesh)
+{
+  typedef typename viennagrid::result_of::const_cell_range<MeshType>::type  CellRange;
+  typedef typename viennagrid::result_of::iterator<CellRange>::type          CellIterator;
+  typedef typename viennagrid::result_of::const_line_range<MeshType>::type  EdgeRange;
+  typedef typename viennagrid::result_of::iterator<EdgeRange>::type          EdgeIterator;
+
+  double sum = 0.0;
+  CellRange cells(mesh);
+  for(CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+    sum += viennagrid::volume(*cit);
+
+  EdgeRange edges(mesh);
+  for(EdgeIterator eit = edges.begin(); eit != edges.end(); ++eit)
+    sum += viennagrid::spanned_volume(viennagrid::point(viennagrid::vertices(*eit)[0]), viennagrid::point(viennagrid::vertices(*eit)[1]));
+  return sum;
+}
+
+//! sums up the cell volumes and the edge lengths of the compact snapshot
+template <typename MeshType>
+double traverse(viennagrid::compact_mesh<MeshType> const& compact)
+{
+  typedef typename viennagrid::compact_mesh<MeshType>::index_type IndexType;
+
+  double sum = 0.0;
+  IndexType const cell_count = static_cast<IndexType>(compact.cell_count());
+  for(IndexType c = 0; c < cell_count; c++)
+    sum += viennagrid::volume(compact, c);
+
+  IndexType const edge_count = static_cast<IndexType>(compact.edge_count());
+  for(IndexType e = 0; e < edge_count; e++)
+  {
+    IndexType const* vertices = compact.edge_vertices(e);
+    sum += viennagrid::spanned_volume(compact.point(vertices[0]), compact.point(vertices[1]));
+  }
+  return sum;
+}
+
+//! compares the memory and a traversal of a mesh of the default config with its compact snapshot
+inline bool run_compact(std::size_t n)
+{
+  typedef viennagrid::tetrahedral_3d_mesh            MeshType;
+  typedef viennagrid::compact_mesh<MeshType>         CompactMeshType;
+
+  double memory_before = resident_mb();
+  MeshType mesh;
+  build(mesh, n, false);
+  double mesh_memory = resident_mb() - memory_before;
+
+  viennafvm::Timer timer;
+  timer.start();
+  CompactMeshType compact(mesh);
+  double snapshot_time = timer.get();
+  double compact_memory = compact.memory_size() / (1024.0 * 1024.0);
+
+  timer.start();
+  double mesh_sum = traverse(mesh);
+  double mesh_time = timer.get();
+
+  timer.start();
+  double compact_sum = traverse(compact);
+  double compact_time = timer.get();
+
+  std::cout << std::fixed << std::setprecision(0)
+            << "mesh " << mesh_memory << " MB  compact " << compact_memory << " MB"
+            << std::setprecision(3) << "  snapshot " << snapshot_time << " s"
+            << "  traversal mesh " << mesh_time << " s  compact " << compact_time << " s" << std::endl;
+
+  if(std::abs(mesh_sum - compact_sum) > 1e-9 * std::abs(mesh_sum))
+  {
+    std::cerr << "traversal of the compact snapshot differs from the mesh" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+inline bool operator==(counts const& a, counts const& b)
+{
+  return a.cells == b.cells && a.triangles == b.triangles && a.lines == b.lines;
+}
+
+struct options
+{
+  options() : repeat(1), segments(0), compact(false), reference(true) {}
+
+  std::vector<std::size_t>  cells;
+  int                       repeat;
+  std::size_t               segments;
+  bool                      compact;
+  bool                      reference;
+};
+
+inline void usage()
+{
+  std::cout << "Usage: mesh_construction_bench [options]" << std::endl
+            << "  --cells N[,N...]    approximate number of tetrahedra per mesh   (1000000)" << std::endl
+            << "  --repeat R          number of timed runs per config             (1)" << std::endl
+            << "  --segments S        number of segments, 0 skips the segmentation (0)" << std::endl
+            << "  --compact           compare traversals of the mesh and of its compact snapshot" << std::endl
+            << "  --no-reference      skip the default config" << std::endl;
+}
+
+inline bool parse(int argc, char* argv[], options& opt)
+{
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg == "--help" || arg == "-h") return false;
+    else if(arg == "--cells" && i+1 < argc)
+    {
+      std::stringstream list(argv[++i]);
+      std::string item;
+      while(std::getline(list, item, ','))
+        if(!item.empty()) opt.cells.push_back(std::strtoul(item.c_str(), NULL, 10));
+    }
+    else if(arg == "--repeat" && i+1 < argc)  opt.repeat = std::max(1, std::atoi(argv[++i]));
+    else if(arg == "--segments" && i+1 < argc) opt.segments = std::strtoul(argv[++i], NULL, 10);
+    else if(arg == "--compact")               opt.compact = true;
+    else if(arg == "--no-reference")          opt.reference = false;
+    else
+    {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return false;
+    }
+  }
+  if(opt.cells.empty()) opt.cells.push_back(1000000);
+  return true;
+}
+
+} // mesh_construction_bench
+
+int main(int argc, char* argv[])
+{
+  using namespace mesh_construction_bench;
+
+  options opt;
+  if(!parse(argc, argv, opt))
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  bool failed = false;
+  for(std::size_t ci = 0; ci < opt.cells.size(); ci++)
+  {
+    std::size_t n = std::max<std::size_t>(1, static_cast<std::size_t>(std::floor(std::pow(opt.cells[ci] / 6.0, 1.0 / 3.0) + 0.5)));
+    counts const reference = expected(n);
+
+    counts hashed, reserved, tree;
+    double hashed_time   = run<viennagrid::tetrahedral_3d_hashed_mesh>(n, false, opt.repeat, hashed);
+    double reserved_time = run<viennagrid::tetrahedral_3d_hashed_mesh>(n, true,  opt.repeat, reserved);
+    double tree_time     = opt.reference ? run<viennagrid::tetrahedral_3d_mesh>(n, false, opt.repeat, tree) : 0.0;
+
+    std::cout << "cells " << std::setw(9) << reference.cells
+              << "  triangles " << std::setw(9) << hashed.triangles
+              << "  lines " << std::setw(9) << hashed.lines
+              << std::fixed << std::setprecision(3)
+              << "  hashed " << hashed_time << " s  reserved " << reserved_time << " s";
+    if(opt.reference)
+      std::cout << "  map " << tree_time << " s  speedup " << std::setprecision(1) << tree_time / reserved_time;
+    std::cout << std::endl;
+
+    if(!(hashed == reference) || !(reserved == reference) || (opt.reference && !(tree == reference)))
+    {
+      std::cerr << "element counts differ from the expected " << reference.triangles << " triangles, "
+                << reference.lines << " lines" << std::endl;
+      failed = true;
+    }
+
+    if(opt.segments > 0)
+      run_segmentation(n, opt.segments);
+
+    if(opt.compact && !run_compact(n))
+      failed = true;
+  }
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
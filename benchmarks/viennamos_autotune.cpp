@@ -0,0 +1,294 @@
+/* =============================================================================
+   Copyright (c) 2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMOS - The Vienna MOS Simulator
+                             -----------------
+
+   license:    see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennamos_autotune.cpp
+    @brief Replays captured linear systems with all solver/preconditioner combinations
+           and writes the fastest combination of each problem class.
+
+    The systems are captured by setting viennamini::config::capture_prefix(), e.g., via
+    'viennamos_bench --capture DIR/nin'. The captured files are named
+    '<prefix>_<dimension>d_pde<quantity>_<number>.mtx', the problem class is given by the
+    dimension and the quantity. Per class, the combination with the lowest total solve time,
+    which solves all systems of the class, is recommended. The recommendation is picked up
+    by viennamini::config::load_solver_recommendation(), or automatically by setting the
+    environment variable VIENNAMINI_SOLVER_RECOMMENDATION to the written file.
+
+    Usage: viennamos_autotune [options] system.mtx [system.mtx ...]
+      --output FILE       recommendation file                         (solver_recommendation.xml)
+      --tolerance T       relative break tolerance of the solvers     (1e-14)
+      --iterations N      maximum number of solver iterations         (1000)
+      --repeat R          number of timed solves per combination      (1)
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <limits>
+#include <cctype>
+
+#include "boost/numeric/ublas/matrix_sparse.hpp"
+#include "boost/numeric/ublas/vector.hpp"
+#include "boost/numeric/ublas/operation_sparse.hpp"
+
+#include "viennafvm/forwards.h"
+#include "viennafvm/linear_solvers/viennacl.hpp"
+#include "viennafvm/io/system_capture.hpp"
+#include "viennafvm/timer.hpp"
+
+namespace autotune {
+
+typedef double                                                NumericType;
+typedef boost::numeric::ublas::compressed_matrix<NumericType> MatrixType;
+typedef boost::numeric::ublas::vector<NumericType>            VectorType;
+typedef viennafvm::linsolv::viennacl                          LinearSolverType;
+
+//! a problem class: dimension and quantity of the captured systems
+typedef std::pair<int, std::size_t>   ProblemClassType;
+//! a combination of solver and preconditioner id
+typedef std::pair<long, long>         CombinationType;
+
+struct options
+{
+  options() : output("solver_recommendation.xml"), tolerance(1.0e-14), iterations(1000), repeat(1) {}
+
+  std::string               output;
+  double                    tolerance;
+  std::size_t               iterations;
+  std::size_t               repeat;
+  std::vector<std::string>  files;
+};
+
+//! accumulated performance of a combination on all systems of a problem class
+struct performance
+{
+  performance() : time(0), iterations(0), systems(0), failures(0) {}
+
+  double        time;         // [s]
+  std::size_t   iterations;
+  std::size_t   systems;
+  std::size_t   failures;
+};
+
+typedef std::map<CombinationType, performance>        PerformancesType;
+typedef std::map<ProblemClassType, PerformancesType>  ResultsType;
+
+/** @brief Extracts the problem class from a capture file name '..._<dim>d_pde<index>_<number>.mtx' */
+bool problem_class(std::string const& filename, ProblemClassType& pc)
+{
+  std::string::size_type pos = filename.rfind("d_pde");
+  if(pos == std::string::npos || pos == 0)
+    return false;
+
+  std::string::size_type begin = pos;
+  while(begin > 0 && std::isdigit(static_cast<unsigned char>(filename[begin-1])))
+    begin--;
+  if(begin == pos)
+    return false;
+
+  pc.first  = std::atoi(filename.substr(begin, pos - begin).c_str());
+  pc.second = std::strtoul(filename.c_str() + pos + 5, NULL, 10);
+  return true;
+}
+
+/** @brief Solves the system with the given combination, returns the wall clock time or a negative value on failure */
+double replay(MatrixType const& A, VectorType const& b, CombinationType const& combination,
+              options const& opt, std::size_t& iterations)
+{
+  double best = -1.0;
+  for(std::size_t r = 0; r < opt.repeat; r++)
+  {
+    // the solver normalizes the rows of the system in place
+    MatrixType system_matrix(A);
+    VectorType load_vector(b);
+    VectorType x;
+
+    LinearSolverType solver;
+    solver.solver()           = combination.first;
+    solver.preconditioner()   = combination.second;
+    solver.break_tolerance()  = opt.tolerance;
+    solver.max_iterations()   = opt.iterations;
+
+    viennafvm::Timer timer;
+    timer.start();
+    solver(system_matrix, load_vector, x);
+    double time = timer.get();
+
+    // check the residual of the normalized system, the estimate of the Krylov solver is not reliable
+    // if the method does not suit the system, e.g., CG for non-symmetric matrices
+    VectorType residual = boost::numeric::ublas::prod(system_matrix, x) - load_vector;
+    double rhs_norm      = boost::numeric::ublas::norm_2(load_vector);
+    double residual_norm = boost::numeric::ublas::norm_2(residual) / (rhs_norm > 0 ? rhs_norm : 1.0);
+
+    if(x.size() != b.size() || solver.last_iterations() >= opt.iterations
+       || !(residual_norm <= std::max(1.0e-8, 1.0e3 * opt.tolerance)))
+      return -1.0;
+
+    iterations = solver.last_iterations();
+    if(best < 0 || time < best)
+      best = time;
+  }
+  return best;
+}
+
+bool write_recommendation(std::string const& filename, ResultsType const& results)
+{
+  std::ofstream stream(filename.c_str());
+  if(!stream)
+    return false;
+
+  stream << "<?xml version=\"1.0\"?>" << std::endl;
+  stream << "<solver_recommendation>" << std::endl;
+  for(ResultsType::const_iterator riter = results.begin(); riter != results.end(); riter++)
+  {
+    CombinationType best;
+    double          best_time = -1.0;
+    for(PerformancesType::const_iterator piter = riter->second.begin(); piter != riter->second.end(); piter++)
+    {
+      if(piter->second.failures == 0 && (best_time < 0 || piter->second.time < best_time))
+      {
+        best      = piter->first;
+        best_time = piter->second.time;
+      }
+    }
+    if(best_time < 0)
+      continue;
+
+    stream << "  <problem>" << std::endl
+           << "    <dimension>"       << riter->first.first  << "</dimension>" << std::endl
+           << "    <pde>"             << riter->first.second << "</pde>" << std::endl
+           << "    <solver>"          << LinearSolverType::solver_name(best.first) << "</solver>" << std::endl
+           << "    <preconditioner>"  << LinearSolverType::preconditioner_name(best.second) << "</preconditioner>" << std::endl
+           << "    <time>"            << best_time << "</time>" << std::endl
+           << "  </problem>" << std::endl;
+  }
+  stream << "</solver_recommendation>" << std::endl;
+  return stream.good();
+}
+
+void write_summary(std::ostream& stream, ResultsType const& results)
+{
+  for(ResultsType::const_iterator riter = results.begin(); riter != results.end(); riter++)
+  {
+    stream << std::endl << "* " << riter->first.first << "D, quantity " << riter->first.second << std::endl;
+    stream << std::left << std::setw(12) << "  solver" << std::setw(14) << "preconditioner" << std::right
+           << std::setw(10) << "systems" << std::setw(12) << "iterations" << std::setw(14) << "time [s]" << std::endl;
+
+    for(PerformancesType::const_iterator piter = riter->second.begin(); piter != riter->second.end(); piter++)
+    {
+      performance const& perf = piter->second;
+      stream << std::left << "  " << std::setw(10) << LinearSolverType::solver_name(piter->first.first)
+             << std::setw(14) << LinearSolverType::preconditioner_name(piter->first.second) << std::right
+             << std::setw(10) << perf.systems;
+      if(perf.failures > 0)
+        stream << std::setw(26) << "failed" << std::endl;
+      else
+        stream << std::setw(12) << perf.iterations << std::setw(14) << std::fixed << std::setprecision(6) << perf.time << std::endl;
+    }
+  }
+}
+
+bool parse(int argc, char** argv, options& opt)
+{
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    bool has_value = (i+1 < argc);
+
+    if(arg == "--output" && has_value)          opt.output     = argv[++i];
+    else if(arg == "--tolerance" && has_value)  opt.tolerance  = std::atof(argv[++i]);
+    else if(arg == "--iterations" && has_value) opt.iterations = std::strtoul(argv[++i], NULL, 10);
+    else if(arg == "--repeat" && has_value)     opt.repeat     = std::strtoul(argv[++i], NULL, 10);
+    else if(arg.compare(0, 2, "--") == 0)       return false;
+    else                                        opt.files.push_back(arg);
+  }
+  return !opt.files.empty() && opt.repeat > 0 && opt.iterations > 0;
+}
+
+} // end namespace autotune
+
+int main(int argc, char** argv)
+{
+  autotune::options opt;
+  if(!autotune::parse(argc, argv, opt))
+  {
+    std::cerr << "usage: viennamos_autotune [--output FILE] [--tolerance T] [--iterations N] [--repeat R] system.mtx [system.mtx ...]" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  const long solvers[] = { autotune::LinearSolverType::solver_ids::cg,
+                           autotune::LinearSolverType::solver_ids::bicgstab,
+                           autotune::LinearSolverType::solver_ids::gmres };
+  const long preconditioners[] = { autotune::LinearSolverType::preconditioner_ids::none,
+                                   autotune::LinearSolverType::preconditioner_ids::ilu0,
+                                   autotune::LinearSolverType::preconditioner_ids::ilut,
+                                   autotune::LinearSolverType::preconditioner_ids::block_ilu,
+                                   autotune::LinearSolverType::preconditioner_ids::jacobi,
+                                   autotune::LinearSolverType::preconditioner_ids::row_scaling };
+
+  autotune::ResultsType results;
+  for(std::size_t fi = 0; fi < opt.files.size(); fi++)
+  {
+    autotune::ProblemClassType problem;
+    if(!autotune::problem_class(opt.files[fi], problem))
+    {
+      std::cerr << "viennamos_autotune: skipping " << opt.files[fi] << ", not a captured system" << std::endl;
+      continue;
+    }
+
+    autotune::MatrixType A;
+    autotune::VectorType b;
+    if(!viennafvm::io::read_system(A, b, opt.files[fi]))
+    {
+      std::cerr << "viennamos_autotune: cannot read " << opt.files[fi] << std::endl;
+      continue;
+    }
+    std::cout << "replaying " << opt.files[fi] << " (" << A.size1() << " unknowns, " << A.nnz() << " nonzeros)" << std::endl;
+
+    for(std::size_t si = 0; si < sizeof(solvers)/sizeof(solvers[0]); si++)
+      for(std::size_t pi = 0; pi < sizeof(preconditioners)/sizeof(preconditioners[0]); pi++)
+      {
+        autotune::CombinationType combination(solvers[si], preconditioners[pi]);
+        autotune::performance& perf = results[problem][combination];
+
+        std::size_t iterations = 0;
+        double time = autotune::replay(A, b, combination, opt, iterations);
+
+        perf.systems++;
+        if(time < 0)
+          perf.failures++;
+        else
+        {
+          perf.time       += time;
+          perf.iterations += iterations;
+        }
+      }
+  }
+
+  if(results.empty())
+  {
+    std::cerr << "viennamos_autotune: no captured systems could be replayed" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  autotune::write_summary(std::cout, results);
+
+  if(!autotune::write_recommendation(opt.output, results))
+  {
+    std::cerr << "viennamos_autotune: cannot write " << opt.output << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << std::endl << "recommendation written to " << opt.output << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,658 @@
+/* =============================================================================
+   Copyright (c) 2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMOS - The Vienna MOS Simulator
+                             -----------------
+
+   license:    see file LICENSE in the base directory
+============================================================================= */
+
+/** @file viennamos_bench.cpp
+    @brief End-to-end benchmark of the simulation pipeline on procedurally generated devices.
+
+    Structured 2D triangular and 3D tetrahedral nin diodes and MOSFETs of the requested
+    size are generated in memory and simulated with ViennaMini. The time spent in each
+    stage of the pipeline is taken from the scoped profiler and written to the console
+    and, optionally, to a CSV file (rows are appended, hence results of several commits
+    can be collected in one file) and to a JSON file.
+
+    Usage: viennamos_bench [options]
+      --device nin|mosfet       device type                           (nin)
+      --dim 2|3                 spatial dimension                     (2)
+      --cells N[,N,...]         approximate number of cells per run   (10000)
+      --repeat R                number of runs per size               (1)
+      --bias V                  drain/right contact potential [V]     (0.5)
+      --gate V                  gate contact potential [V]            (0.2)
+      --bias-step V             ramp the contact potentials in steps of V
+      --adaptive-damping        enable the line search of the nonlinear solver
+      --capture PREFIX          capture the assembled systems for viennamos_autotune
+      --jit DIR                 compile the integrands, caching the kernels in DIR
+      --materials FILE          material database
+      --csv FILE                append the results to a CSV file
+      --json FILE               write the results to a JSON file
+      --tag TAG                 label stored with each result, e.g., the commit
+      --write                   also write the simulation results to VTK files, the doping
+                                and the initial guess are always written by the simulator
+      --verbose                 do not silence the simulator output
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "viennamini/simulator.hpp"
+#include "viennamini/result_accessor.hpp"
+
+#include "viennagrid/algorithm/quantity_transfer_plan.hpp"
+
+#include "viennamaterials/library.hpp"
+#include "viennamaterials/kernels/pugixml.hpp"
+
+#include "viennautils/average.hpp"
+#include "viennautils/profiler.hpp"
+
+#ifndef VIENNAUTILS_WITH_PROFILER
+  #error "viennamos_bench requires the scoped profiler, define VIENNAUTILS_WITH_PROFILER"
+#endif
+
+#ifndef VIENNAMOS_BENCH_MATERIALS
+  #define VIENNAMOS_BENCH_MATERIALS "materials.xml"
+#endif
+
+namespace bench {
+
+// ----------------------------------------------------------------------------
+//
+// Options and results
+//
+// ----------------------------------------------------------------------------
+
+struct options
+{
+  options() : device("nin"), dim(2), repeat(1), bias(0.5), gate(0.2), bias_step(0), adaptive_damping(false),
+              materials(VIENNAMOS_BENCH_MATERIALS), write(false), verbose(false) {}
+
+  std::string               device;
+  int                       dim;
+  std::vector<std::size_t>  cells;
+  std::size_t               repeat;
+  double                    bias;
+  double                    gate;
+  double                    bias_step;
+  bool                      adaptive_damping;
+  std::string               materials;
+  std::string               capture;
+  std::string               jit;
+  std::string               csv;
+  std::string               json;
+  std::string               tag;
+  bool                      write;
+  bool                      verbose;
+};
+
+//! timings of a single run, all times in seconds
+struct result
+{
+  result() : dim(0), run(0), cells(0), vertices(0), unknowns(0), nonlinear_iterations(0),
+             linear_iterations(0), converged(false), load(0), setup(0), assembly(0),
+             preconditioner(0), solve(0), vertex_transfer(0), write(0), total(0) {}
+
+  std::string   device;
+  int           dim;
+  std::size_t   run;
+  std::size_t   cells;
+  std::size_t   vertices;
+  std::size_t   unknowns;
+  std::size_t   nonlinear_iterations;
+  std::size_t   linear_iterations;
+  bool          converged;
+
+  double        load;             // mesh generation
+  double        setup;            // interface detection, quantity setup and initial guess
+  double        assembly;         // system and residual assembly
+  double        preconditioner;   // preconditioner setup
+  double        solve;            // Krylov solver, row normalization and update
+  double        vertex_transfer;  // cell to vertex transfer of the results
+  double        write;            // VTK output of the doping, the initial guess and the results
+  double        total;
+};
+
+//! discards everything written to it, used to silence the simulator
+class null_buffer : public std::streambuf
+{
+protected:
+  int overflow(int c) { return c; }
+};
+
+//! counts the Krylov iterations of all linear solves
+class linear_counter : public viennafvm::solver_observer
+{
+public:
+  linear_counter() : iterations(0) {}
+  void on_linear_solve(viennafvm::linear_solve_record const& record) { iterations += record.iterations; }
+
+  std::size_t iterations;
+};
+
+//! stores the transferred vertex values in a plain array indexed by the vertex id
+struct vertex_array_setter
+{
+  vertex_array_setter(std::vector<double>& values) : values_(values) {}
+
+  template <typename VertexT, typename ValueT>
+  void operator()(VertexT const & vertex, ValueT value) const
+  {
+    values_[static_cast<std::size_t>(vertex.id().get())] = value;
+  }
+
+  std::vector<double>& values_;
+};
+
+inline double seconds(std::string const& scope)
+{
+  return viennautils::profiler::statistics(scope).total * 1.0e-6;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Device layouts
+//
+// ----------------------------------------------------------------------------
+
+// segment indices of the nin diode
+const std::size_t nin_left_contact  = 1;
+const std::size_t nin_left_n        = 2;
+const std::size_t nin_intrinsic     = 3;
+const std::size_t nin_right_n       = 4;
+const std::size_t nin_right_contact = 5;
+
+// segment indices of the MOSFET
+const std::size_t mos_gate_contact   = 1;
+const std::size_t mos_source_contact = 2;
+const std::size_t mos_oxide          = 3;
+const std::size_t mos_drain_contact  = 4;
+const std::size_t mos_source         = 5;
+const std::size_t mos_drain          = 6;
+const std::size_t mos_body           = 7;
+const std::size_t mos_body_contact   = 8;
+
+/** @brief Maps a cell to its segment. The cell is given by its column/row index and its
+    centroid relative to the device extent. Contacts are one cell layer thick, so that
+    they stay attached to the device at every resolution. */
+std::size_t nin_segment(std::size_t i, std::size_t nx, double x)
+{
+  if(i == 0)      return nin_left_contact;
+  if(i == nx-1)   return nin_right_contact;
+  if(x < 0.3)     return nin_left_n;
+  if(x > 0.7)     return nin_right_n;
+  return nin_intrinsic;
+}
+
+std::size_t mosfet_segment(std::size_t j, std::size_t ny, double x, double y)
+{
+  if(j == 0)                                  return mos_body_contact;
+  if(j == ny-1)
+  {
+    if(x < 0.25)                              return mos_source_contact;
+    if(x > 0.75)                              return mos_drain_contact;
+  }
+  if(y > 0.8)
+  {
+    if((x > 0.4) && (x < 0.6) && (y > 0.9))   return mos_gate_contact;
+    if((x > 0.3) && (x < 0.7))                return mos_oxide;
+  }
+  if(y > 0.6)
+  {
+    if(x < 0.3)                               return mos_source;
+    if(x > 0.7)                               return mos_drain;
+  }
+  return mos_body;
+}
+
+/** @brief Physical extent of the devices [m], the MOSFET is extruded in z */
+void device_extent(std::string const& device, double& lx, double& ly, double& lz)
+{
+  if(device == "mosfet") { lx = 100.0e-9; ly = 50.0e-9; lz = 50.0e-9; }
+  else                   { lx = 150.0e-9; ly = 50.0e-9; lz = 50.0e-9; }
+}
+
+/** @brief Number of intervals per axis, such that the mesh has approximately the requested number of cells */
+void resolution(options const& opt, std::size_t cells, std::size_t& nx, std::size_t& ny, std::size_t& nz)
+{
+  double lx, ly, lz;
+  device_extent(opt.device, lx, ly, lz);
+
+  // the layouts need a few cells per region, they do not vary along z
+  const double min_x = (opt.device == "mosfet") ? 20.0 : 10.0;
+  const double min_y = (opt.device == "mosfet") ? 20.0 : 2.0;
+  const double min_z = 2.0;
+
+  double h;
+  if(opt.dim == 2) h = std::sqrt(2.0 * lx * ly / static_cast<double>(cells));
+  else             h = std::pow(6.0 * lx * ly * lz / static_cast<double>(cells), 1.0/3.0);
+
+  nx = static_cast<std::size_t>(std::max(min_x, std::floor(lx / h + 0.5)));
+  ny = static_cast<std::size_t>(std::max(min_y, std::floor(ly / h + 0.5)));
+  nz = (opt.dim == 2) ? 1 : static_cast<std::size_t>(std::max(min_z, std::floor(lz / h + 0.5)));
+}
+
+// ----------------------------------------------------------------------------
+//
+// Mesh generation
+//
+// ----------------------------------------------------------------------------
+
+/** @brief Generates a structured triangular mesh, each quad is split into two triangles */
+template<typename MeshT, typename SegmentationT>
+void generate(options const& opt, std::size_t cells, MeshT& mesh, SegmentationT& segmentation, viennagrid::triangle_tag)
+{
+  typedef typename viennagrid::result_of::point<MeshT>::type          PointType;
+  typedef typename viennagrid::result_of::vertex<MeshT>::type         VertexType;
+  typedef typename viennagrid::result_of::vertex_handle<MeshT>::type  VertexHandleType;
+  typedef typename viennagrid::result_of::cell<MeshT>::type           CellType;
+
+  std::size_t nx, ny, nz;
+  resolution(opt, cells, nx, ny, nz);
+  double lx, ly, lz;
+  device_extent(opt.device, lx, ly, lz);
+
+  std::vector<VertexHandleType> handles((nx+1)*(ny+1));
+  for(std::size_t j = 0; j <= ny; j++)
+    for(std::size_t i = 0; i <= nx; i++)
+    {
+      std::size_t index = j*(nx+1) + i;
+      handles[index] = viennagrid::make_vertex_with_id(mesh, typename VertexType::id_type(index),
+                                                       PointType(lx * i / nx, ly * j / ny));
+    }
+
+  std::size_t cell_id = 0;
+  viennagrid::static_array<VertexHandleType, 3> tri;
+  for(std::size_t j = 0; j < ny; j++)
+    for(std::size_t i = 0; i < nx; i++)
+    {
+      double x = (i + 0.5) / nx;
+      double y = (j + 0.5) / ny;
+      std::size_t si = (opt.device == "mosfet") ? mosfet_segment(j, ny, x, y) : nin_segment(i, nx, x);
+
+      VertexHandleType v00 = handles[ j   *(nx+1) + i  ];
+      VertexHandleType v10 = handles[ j   *(nx+1) + i+1];
+      VertexHandleType v01 = handles[(j+1)*(nx+1) + i  ];
+      VertexHandleType v11 = handles[(j+1)*(nx+1) + i+1];
+
+      tri[0] = v00; tri[1] = v10; tri[2] = v11;
+      viennagrid::make_element_with_id<CellType>(segmentation[si], tri.begin(), tri.end(), typename CellType::id_type(cell_id++));
+      tri[0] = v00; tri[1] = v11; tri[2] = v01;
+      viennagrid::make_element_with_id<CellType>(segmentation[si], tri.begin(), tri.end(), typename CellType::id_type(cell_id++));
+    }
+}
+
+/** @brief Generates a structured tetrahedral mesh, each hexahedron is split into six
+    tetrahedra sharing the main diagonal, which yields a conforming mesh */
+template<typename MeshT, typename SegmentationT>
+void generate(options const& opt, std::size_t cells, MeshT& mesh, SegmentationT& segmentation, viennagrid::tetrahedron_tag)
+{
+  typedef typename viennagrid::result_of::point<MeshT>::type          PointType;
+  typedef typename viennagrid::result_of::vertex<MeshT>::type         VertexType;
+  typedef typename viennagrid::result_of::vertex_handle<MeshT>::type  VertexHandleType;
+  typedef typename viennagrid::result_of::cell<MeshT>::type           CellType;
+
+  // corner indices (bit 0: x, bit 1: y, bit 2: z) of the six tetrahedra
+  static const std::size_t kuhn[6][4] = { {0,1,3,7}, {0,1,5,7}, {0,2,3,7}, {0,2,6,7}, {0,4,5,7}, {0,4,6,7} };
+
+  std::size_t nx, ny, nz;
+  resolution(opt, cells, nx, ny, nz);
+  double lx, ly, lz;
+  device_extent(opt.device, lx, ly, lz);
+
+  std::vector<VertexHandleType> handles((nx+1)*(ny+1)*(nz+1));
+  for(std::size_t k = 0; k <= nz; k++)
+    for(std::size_t j = 0; j <= ny; j++)
+      for(std::size_t i = 0; i <= nx; i++)
+      {
+        std::size_t index = (k*(ny+1) + j)*(nx+1) + i;
+        handles[index] = viennagrid::make_vertex_with_id(mesh, typename VertexType::id_type(index),
+                                                         PointType(lx * i / nx, ly * j / ny, lz * k / nz));
+      }
+
+  std::size_t cell_id = 0;
+  VertexHandleType corners[8];
+  viennagrid::static_array<VertexHandleType, 4> tet;
+  for(std::size_t k = 0; k < nz; k++)
+    for(std::size_t j = 0; j < ny; j++)
+      for(std::size_t i = 0; i < nx; i++)
+      {
+        double x = (i + 0.5) / nx;
+        double y = (j + 0.5) / ny;
+        std::size_t si = (opt.device == "mosfet") ? mosfet_segment(j, ny, x, y) : nin_segment(i, nx, x);
+
+        for(std::size_t c = 0; c < 8; c++)
+          corners[c] = handles[((k + ((c>>2)&1))*(ny+1) + j + ((c>>1)&1))*(nx+1) + i + (c&1)];
+
+        for(std::size_t t = 0; t < 6; t++)
+        {
+          for(std::size_t c = 0; c < 4; c++)
+            tet[c] = corners[kuhn[t][c]];
+          viennagrid::make_element_with_id<CellType>(segmentation[si], tet.begin(), tet.end(), typename CellType::id_type(cell_id++));
+        }
+      }
+}
+
+template<typename DeviceT>
+void prepare(options const& opt, DeviceT& device, viennamini::config& config)
+{
+  if(opt.device == "mosfet")
+  {
+    device.assign_name(mos_gate_contact, "gate_contact");     device.assign_material(mos_gate_contact, "Cu");     device.assign_contact(mos_gate_contact);
+    device.assign_name(mos_source_contact, "source_contact"); device.assign_material(mos_source_contact, "Cu");   device.assign_contact(mos_source_contact);
+    device.assign_name(mos_drain_contact, "drain_contact");   device.assign_material(mos_drain_contact, "Cu");    device.assign_contact(mos_drain_contact);
+    device.assign_name(mos_body_contact, "body_contact");     device.assign_material(mos_body_contact, "Cu");     device.assign_contact(mos_body_contact);
+    device.assign_name(mos_oxide, "oxide");                   device.assign_material(mos_oxide, "HfO2");          device.assign_oxide(mos_oxide);
+    device.assign_name(mos_source, "source");                 device.assign_material(mos_source, "Si");           device.assign_semiconductor(mos_source, 1.E24, 1.E8);
+    device.assign_name(mos_drain, "drain");                   device.assign_material(mos_drain, "Si");            device.assign_semiconductor(mos_drain, 1.E24, 1.E8);
+    device.assign_name(mos_body, "body");                     device.assign_material(mos_body, "Si");             device.assign_semiconductor(mos_body, 1.E12, 1.E20);
+
+    config.assign_contact(mos_gate_contact,   opt.gate, 0.4);
+    config.assign_contact(mos_body_contact,   0.0,      0.0);
+    config.assign_contact(mos_source_contact, 0.0,      0.0);
+    config.assign_contact(mos_drain_contact,  opt.bias, 0.0);
+  }
+  else
+  {
+    device.assign_name(nin_left_contact, "left_contact");     device.assign_material(nin_left_contact, "Cu");     device.assign_contact(nin_left_contact);
+    device.assign_name(nin_right_contact, "right_contact");   device.assign_material(nin_right_contact, "Cu");    device.assign_contact(nin_right_contact);
+    device.assign_name(nin_left_n, "left_n");                 device.assign_material(nin_left_n, "Si");           device.assign_semiconductor(nin_left_n, 1.E24, 1.E8);
+    device.assign_name(nin_intrinsic, "intrinsic");           device.assign_material(nin_intrinsic, "Si");        device.assign_semiconductor(nin_intrinsic, 1.E21, 1.E11);
+    device.assign_name(nin_right_n, "right_n");               device.assign_material(nin_right_n, "Si");          device.assign_semiconductor(nin_right_n, 1.E24, 1.E8);
+
+    config.assign_contact(nin_left_contact,  0.0,      0.0);
+    config.assign_contact(nin_right_contact, opt.bias, 0.0);
+  }
+
+  config.temperature()                        = 300;
+  config.damping()                            = 1.0;
+  config.linear_breaktol()                    = 1.0E-13;
+  config.linear_iterations()                  = 700;
+  config.nonlinear_iterations()               = 100;
+  config.nonlinear_breaktol()                 = 1.0E-3;
+  config.initial_guess_smoothing_iterations() = 4;
+  config.adaptive_damping()                   = opt.adaptive_damping;
+  config.capture_prefix()                     = opt.capture;
+  if(!opt.jit.empty())
+    config.jit_cache()                        = opt.jit;
+  if(opt.bias_step > 0)
+  {
+    config.bias_ramping() = true;
+    config.bias_step()    = opt.bias_step;
+  }
+}
+
+// ----------------------------------------------------------------------------
+//
+// A single benchmark run
+//
+// ----------------------------------------------------------------------------
+
+template<typename MeshT, typename SegmentationT, typename DeviceT, typename SimulatorT>
+result run(options const& opt, std::size_t cells, std::size_t run_index, viennamini::MatLibPugixmlType& matlib)
+{
+  typedef typename viennagrid::result_of::cell_tag<MeshT>::type                 CellTag;
+  typedef typename viennagrid::result_of::cell<MeshT>::type                     CellType;
+  typedef typename viennagrid::result_of::vertex<MeshT>::type                   VertexType;
+  typedef typename SimulatorT::VectorType                                       ResultVector;
+  typedef viennamini::result_accessor<CellType, viennamini::StorageType, ResultVector>  ResultAccessor;
+
+  viennautils::profiler::clear();
+
+  result res;
+  res.device = opt.device;
+  res.dim    = opt.dim;
+  res.run    = run_index;
+
+  linear_counter counter;
+  {
+    VIENNAUTILS_PROFILE_SCOPE("bench::total");
+
+    MeshT                   mesh;
+    SegmentationT           segmentation(mesh);
+    viennamini::StorageType storage;
+
+    VIENNAUTILS_PROFILE_SCOPE_NAMED(generate_scope, "bench::generate");
+    generate(opt, cells, mesh, segmentation, CellTag());
+    VIENNAUTILS_PROFILE_STOP(generate_scope);
+
+    res.cells    = viennagrid::cells(mesh).size();
+    res.vertices = viennagrid::vertices(mesh).size();
+
+    DeviceT            device(mesh, segmentation, storage);
+    viennamini::config config;
+    prepare(opt, device, config);
+
+    SimulatorT sim(device, matlib, config);
+    sim.set_observer(&counter);
+    sim();
+
+    res.unknowns = sim.result().size();
+    for(std::size_t i = 0; i < sim.bias_steps().size(); i++)
+      res.nonlinear_iterations += sim.bias_steps()[i].nonlinear_iterations;
+    res.converged = !sim.bias_steps().empty() && sim.bias_steps().back().converged;
+
+    {
+      VIENNAUTILS_PROFILE_SCOPE("bench::vertex_transfer");
+
+      std::vector<double> values(res.vertices);
+      vertex_array_setter setter(values);
+      std::size_t const quantities[3] = { sim.quantity_potential().id(),
+                                          sim.quantity_electron_density().id(),
+                                          sim.quantity_hole_density().id() };
+
+      // the plan is set up once, the three quantities are transferred in one pass
+      viennagrid::quantity_transfer_plan<MeshT, CellType, VertexType> plan(mesh, viennagrid::arithmetic_transfer_weighting_tag());
+      std::vector<double> cell_values, vertex_values;
+      for(std::size_t q = 0; q < 3; q++)
+        plan.gather(ResultAccessor(device.storage(), sim.result(), quantities[q]), cell_values, q);
+      plan.apply(cell_values, vertex_values, 3);
+      for(std::size_t q = 0; q < 3; q++)
+        plan.scatter(vertex_values, setter, q);
+    }
+
+    if(opt.write)
+    {
+      std::stringstream filename;
+      filename << "bench_" << opt.device << opt.dim << "d_" << res.cells;
+      sim.write_result(filename.str());
+    }
+  }
+
+  res.linear_iterations = counter.iterations;
+  res.load              = seconds("bench::generate");
+  res.setup             = seconds("viennamini::detect_interfaces") + seconds("viennamini::prepare");
+  res.assembly          = seconds("viennafvm::assembly") + seconds("viennafvm::residual_assembly");
+  res.preconditioner    = seconds("viennafvm::preconditioner_setup");
+  res.solve             = seconds("viennafvm::krylov_solve") + seconds("viennafvm::row_normalization")
+                        + seconds("viennafvm::update");
+  res.vertex_transfer   = seconds("bench::vertex_transfer");
+  res.write             = seconds("viennamini::write_device_doping") + seconds("viennamini::write_device_initial_guesses")
+                        + seconds("viennamini::write_result");
+  res.total             = seconds("bench::total");
+  return res;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Output
+//
+// ----------------------------------------------------------------------------
+
+void write_console(std::ostream& stream, result const& r)
+{
+  stream << std::fixed << std::setprecision(4)
+         << r.device << " " << r.dim << "D  cells " << r.cells << "  vertices " << r.vertices
+         << "  unknowns " << r.unknowns << "  nonlinear its " << r.nonlinear_iterations
+         << "  linear its " << r.linear_iterations << (r.converged ? "" : "  (not converged)") << std::endl
+         << "  load " << r.load << "  setup " << r.setup << "  assembly " << r.assembly
+         << "  preconditioner " << r.preconditioner << "  solve " << r.solve
+         << "  vertex transfer " << r.vertex_transfer << "  write " << r.write
+         << "  total " << r.total << " [s]" << std::endl;
+}
+
+void write_csv(std::string const& filename, std::string const& tag, std::vector<result> const& results)
+{
+  bool empty = true;
+  {
+    std::ifstream probe(filename.c_str());
+    empty = !probe || (probe.peek() == std::ifstream::traits_type::eof());
+  }
+
+  std::ofstream stream(filename.c_str(), std::ios::app);
+  if(!stream)
+  {
+    std::cerr << "viennamos_bench: cannot open " << filename << std::endl;
+    return;
+  }
+
+  if(empty)
+    stream << "tag,device,dim,run,cells,vertices,unknowns,nonlinear_iterations,linear_iterations,converged,"
+           << "load,setup,assembly,preconditioner,solve,vertex_transfer,write,total" << std::endl;
+
+  stream << std::setprecision(6) << std::fixed;
+  for(std::size_t i = 0; i < results.size(); i++)
+  {
+    result const& r = results[i];
+    stream << tag << "," << r.device << "," << r.dim << "," << r.run << "," << r.cells << "," << r.vertices << ","
+           << r.unknowns << "," << r.nonlinear_iterations << "," << r.linear_iterations << "," << (r.converged ? 1 : 0) << ","
+           << r.load << "," << r.setup << "," << r.assembly << "," << r.preconditioner << "," << r.solve << ","
+           << r.vertex_transfer << "," << r.write << "," << r.total << std::endl;
+  }
+}
+
+void write_json(std::string const& filename, std::string const& tag, std::vector<result> const& results)
+{
+  std::ofstream stream(filename.c_str());
+  if(!stream)
+  {
+    std::cerr << "viennamos_bench: cannot open " << filename << std::endl;
+    return;
+  }
+
+  stream << std::setprecision(6) << std::fixed;
+  stream << "{\n  \"tag\": \"" << tag << "\",\n  \"results\": [";
+  for(std::size_t i = 0; i < results.size(); i++)
+  {
+    result const& r = results[i];
+    stream << (i ? "," : "") << "\n    {\"device\": \"" << r.device << "\", \"dim\": " << r.dim << ", \"run\": " << r.run
+           << ", \"cells\": " << r.cells << ", \"vertices\": " << r.vertices << ", \"unknowns\": " << r.unknowns
+           << ", \"nonlinear_iterations\": " << r.nonlinear_iterations << ", \"linear_iterations\": " << r.linear_iterations
+           << ", \"converged\": " << (r.converged ? "true" : "false")
+           << ",\n     \"times\": {\"load\": " << r.load << ", \"setup\": " << r.setup << ", \"assembly\": " << r.assembly
+           << ", \"preconditioner\": " << r.preconditioner << ", \"solve\": " << r.solve
+           << ", \"vertex_transfer\": " << r.vertex_transfer << ", \"write\": " << r.write << ", \"total\": " << r.total << "}}";
+  }
+  stream << "\n  ]\n}" << std::endl;
+}
+
+// ----------------------------------------------------------------------------
+//
+// Command line
+//
+// ----------------------------------------------------------------------------
+
+void usage()
+{
+  std::cerr << "usage: viennamos_bench [--device nin|mosfet] [--dim 2|3] [--cells N[,N,...]] [--repeat R]" << std::endl
+            << "                       [--bias V] [--gate V] [--bias-step V] [--adaptive-damping]" << std::endl
+            << "                       [--capture PREFIX] [--jit DIR] [--materials FILE] [--csv FILE] [--json FILE]" << std::endl
+            << "                       [--tag TAG] [--write] [--verbose]" << std::endl;
+}
+
+bool parse(int argc, char** argv, options& opt)
+{
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    bool has_value = (i+1 < argc);
+
+    if(arg == "--write")                       opt.write            = true;
+    else if(arg == "--verbose")                opt.verbose          = true;
+    else if(arg == "--adaptive-damping")       opt.adaptive_damping = true;
+    else if(arg == "--bias-step" && has_value) opt.bias_step = std::atof(argv[++i]);
+    else if(arg == "--device"    && has_value) opt.device    = argv[++i];
+    else if(arg == "--dim"       && has_value) opt.dim       = std::atoi(argv[++i]);
+    else if(arg == "--repeat"    && has_value) opt.repeat    = std::strtoul(argv[++i], NULL, 10);
+    else if(arg == "--bias"      && has_value) opt.bias      = std::atof(argv[++i]);
+    else if(arg == "--gate"      && has_value) opt.gate      = std::atof(argv[++i]);
+    else if(arg == "--materials" && has_value) opt.materials = argv[++i];
+    else if(arg == "--capture"   && has_value) opt.capture   = argv[++i];
+    else if(arg == "--jit"       && has_value) opt.jit       = argv[++i];
+    else if(arg == "--csv"       && has_value) opt.csv       = argv[++i];
+    else if(arg == "--json"      && has_value) opt.json      = argv[++i];
+    else if(arg == "--tag"       && has_value) opt.tag       = argv[++i];
+    else if(arg == "--cells"     && has_value)
+    {
+      std::stringstream list(argv[++i]);
+      std::string item;
+      while(std::getline(list, item, ','))
+        opt.cells.push_back(std::strtoul(item.c_str(), NULL, 10));
+    }
+    else return false;
+  }
+
+  if(opt.cells.empty()) opt.cells.push_back(10000);
+  return ((opt.device == "nin") || (opt.device == "mosfet")) && ((opt.dim == 2) || (opt.dim == 3)) && (opt.repeat > 0);
+}
+
+} // end namespace bench
+
+int main(int argc, char** argv)
+{
+  bench::options opt;
+  if(!bench::parse(argc, argv, opt))
+  {
+    bench::usage();
+    return EXIT_FAILURE;
+  }
+
+  viennamini::MatLibPugixmlType matlib;
+  try
+  {
+    matlib.load(opt.materials);
+  }
+  catch(...)
+  {
+    std::cerr << "viennamos_bench: cannot load the material database " << opt.materials << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<bench::result> results;
+  for(std::size_t ci = 0; ci < opt.cells.size(); ci++)
+  {
+    for(std::size_t r = 0; r < opt.repeat; r++)
+    {
+      bench::null_buffer null;
+      std::streambuf* cout_buffer = std::cout.rdbuf();
+      if(!opt.verbose) std::cout.rdbuf(&null);
+
+      bench::result res;
+      if(opt.dim == 2)
+        res = bench::run<viennamini::MeshTriangular2DType, viennamini::SegmentationTriangular2DType,
+                         viennamini::DeviceTriangular2DType, viennamini::SimulatorTriangular2DType>(opt, opt.cells[ci], r, matlib);
+      else
+        res = bench::run<viennamini::MeshTetrahedral3DType, viennamini::SegmentationTetrahedral3DType,
+                         viennamini::DeviceTetrahedral3DType, viennamini::SimulatorTetrahedral3DType>(opt, opt.cells[ci], r, matlib);
+
+      std::cout.rdbuf(cout_buffer);
+      bench::write_console(std::cout, res);
+      results.push_back(res);
+    }
+  }
+
+  if(!opt.csv.empty())  bench::write_csv(opt.csv, opt.tag, results);
+  if(!opt.json.empty()) bench::write_json(opt.json, opt.tag, results);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,235 @@
+/* =============================================================================
+   Copyright (c) 2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMOS - The Vienna MOS Simulator
+                             -----------------
+
+   license:    see file LICENSE in the base directory
+============================================================================= */
+
+/** @file voronoi_bench.cpp
+    @brief Compares the array-based computation of the Voronoi information of tetrahedral
+           meshes with the reference implementation, which collects the data in maps keyed by handles.
+
+    Both implementations are run on each mesh, the runtimes and the largest deviation of the
+    box volumes and interface areas are reported. By default, the 3D meshes of the ViennaGrid
+    tutorials are used. Larger meshes are obtained by uniform refinement, every level
+    multiplies the number of cells by eight.
+
+    Usage: voronoi_bench [options] [mesh.mesh ...]
+      --refine N          refine each mesh uniformly N times          (0)
+      --repeat R          number of timed runs per implementation     (1)
+      --no-reference      skip the reference implementation, e.g., for very large meshes
+*/
+
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/io/netgen_reader.hpp"
+#include "viennagrid/algorithm/voronoi.hpp"
+#include "viennagrid/algorithm/refine.hpp"
+#include "viennagrid/accessor.hpp"
+
+#include "viennafvm/timer.hpp"
+
+#ifndef VIENNAMOS_VORONOI_MESHES
+  #define VIENNAMOS_VORONOI_MESHES "external/ViennaGrid/examples/data"
+#endif
+
+namespace voronoi_bench {
+
+typedef viennagrid::tetrahedral_3d_mesh                                 MeshType;
+typedef viennagrid::tetrahedral_3d_segmentation                         SegmentationType;
+typedef viennagrid::result_of::vertex<MeshType>::type                   VertexType;
+typedef viennagrid::result_of::line<MeshType>::type                     EdgeType;
+typedef viennagrid::result_of::cell<MeshType>::type                     CellType;
+typedef viennagrid::result_of::const_cell_handle<MeshType>::type        ConstCellHandleType;
+typedef viennagrid::result_of::voronoi_cell_contribution<ConstCellHandleType>::type  ContributionType;
+
+//! the Voronoi quantities of a mesh, stored in the containers of the ViennaGrid tests
+struct voronoi_info
+{
+  std::deque<double>            interface_areas;
+  std::deque<ContributionType>  interface_contributions;
+  std::deque<double>            vertex_box_volumes;
+  std::deque<ContributionType>  vertex_box_volume_contributions;
+  std::deque<double>            edge_box_volumes;
+  std::deque<ContributionType>  edge_box_volume_contributions;
+};
+
+struct array_tag {};
+struct reference_tag {};
+
+inline void compute(MeshType const& mesh, voronoi_info& info, array_tag)
+{
+  viennagrid::apply_voronoi<CellType>(mesh,
+                                      viennagrid::make_field<EdgeType>(info.interface_areas),
+                                      viennagrid::make_field<EdgeType>(info.interface_contributions),
+                                      viennagrid::make_field<VertexType>(info.vertex_box_volumes),
+                                      viennagrid::make_field<VertexType>(info.vertex_box_volume_contributions),
+                                      viennagrid::make_field<EdgeType>(info.edge_box_volumes),
+                                      viennagrid::make_field<EdgeType>(info.edge_box_volume_contributions));
+}
+
+inline void compute(MeshType const& mesh, voronoi_info& info, reference_tag)
+{
+  viennagrid::detail::write_voronoi_info_reference<viennagrid::tetrahedron_tag>(mesh,
+                                      viennagrid::make_field<EdgeType>(info.interface_areas),
+                                      viennagrid::make_field<EdgeType>(info.interface_contributions),
+                                      viennagrid::make_field<VertexType>(info.vertex_box_volumes),
+                                      viennagrid::make_field<VertexType>(info.vertex_box_volume_contributions),
+                                      viennagrid::make_field<EdgeType>(info.edge_box_volumes),
+                                      viennagrid::make_field<EdgeType>(info.edge_box_volume_contributions),
+                                      viennagrid::tetrahedron_tag());
+}
+
+//! runs an implementation 'repeat' times on fresh containers, returns the fastest run
+template <typename ImplementationTag>
+double run(MeshType const& mesh, voronoi_info& info, int repeat, ImplementationTag tag)
+{
+  double best = 0.0;
+  for(int r = 0; r < repeat; r++)
+  {
+    info = voronoi_info();
+    viennafvm::Timer timer;
+    timer.start();
+    compute(mesh, info, tag);
+    double elapsed = timer.get();
+    if(r == 0 || elapsed < best) best = elapsed;
+  }
+  return best;
+}
+
+//! the largest deviation of two value containers, relative to the largest value
+inline double deviation(std::deque<double> const& a, std::deque<double> const& b)
+{
+  if(a.size() != b.size()) return 1.0;
+  double diff = 0.0, scale = 0.0;
+  for(std::size_t i = 0; i < a.size(); i++)
+  {
+    diff  = std::max(diff,  std::fabs(a[i] - b[i]));
+    scale = std::max(scale, std::fabs(b[i]));
+  }
+  return scale > 0.0 ? diff / scale : diff;
+}
+
+//! the largest deviation of the summed cell contributions, the order of the contributions may differ
+inline double deviation(std::deque<ContributionType> const& a, std::deque<ContributionType> const& b)
+{
+  std::deque<double> sum_a(a.size(), 0.0), sum_b(b.size(), 0.0);
+  for(std::size_t i = 0; i < a.size(); i++)
+    for(std::size_t j = 0; j < a[i].size(); j++) sum_a[i] += a[i][j].second;
+  for(std::size_t i = 0; i < b.size(); i++)
+    for(std::size_t j = 0; j < b[i].size(); j++) sum_b[i] += b[i][j].second;
+  return deviation(sum_a, sum_b);
+}
+
+struct options
+{
+  options() : refine(0), repeat(1), reference(true) {}
+
+  int                       refine;
+  int                       repeat;
+  bool                      reference;
+  std::vector<std::string>  meshes;
+};
+
+inline void usage()
+{
+  std::cout << "Usage: voronoi_bench [options] [mesh.mesh ...]" << std::endl
+            << "  --refine N          refine each mesh uniformly N times          (0)" << std::endl
+            << "  --repeat R          number of timed runs per implementation     (1)" << std::endl
+            << "  --no-reference      skip the reference implementation" << std::endl;
+}
+
+inline bool parse(int argc, char* argv[], options& opt)
+{
+  for(int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if(arg == "--help" || arg == "-h") return false;
+    else if(arg == "--refine" && i+1 < argc)  opt.refine = std::atoi(argv[++i]);
+    else if(arg == "--repeat" && i+1 < argc)  opt.repeat = std::max(1, std::atoi(argv[++i]));
+    else if(arg == "--no-reference")          opt.reference = false;
+    else if(!arg.empty() && arg[0] == '-')
+    {
+      std::cerr << "Unknown option: " << arg << std::endl;
+      return false;
+    }
+    else opt.meshes.push_back(arg);
+  }
+  if(opt.meshes.empty())
+  {
+    std::string const meshes[] = { "cube48", "cube384", "cube3072", "twocubes", "sshape3d", "interconnect3d" };
+    for(std::size_t i = 0; i < sizeof(meshes)/sizeof(meshes[0]); i++)
+      opt.meshes.push_back(std::string(VIENNAMOS_VORONOI_MESHES) + "/" + meshes[i] + ".mesh");
+  }
+  return true;
+}
+
+} // voronoi_bench
+
+int main(int argc, char* argv[])
+{
+  using namespace voronoi_bench;
+
+  options opt;
+  if(!parse(argc, argv, opt))
+  {
+    usage();
+    return EXIT_FAILURE;
+  }
+
+  bool failed = false;
+  for(std::size_t mi = 0; mi < opt.meshes.size(); mi++)
+  {
+    MeshType mesh;
+    try
+    {
+      SegmentationType segmentation(mesh);
+      viennagrid::io::netgen_reader reader;
+      reader(mesh, segmentation, opt.meshes[mi]);
+    }
+    catch(std::exception const& e)
+    {
+      std::cerr << opt.meshes[mi] << ": " << e.what() << std::endl;
+      failed = true;
+      continue;
+    }
+
+    for(int level = 0; level < opt.refine; level++)
+    {
+      MeshType refined;
+      viennagrid::cell_refine_uniformly(mesh, refined);
+      mesh = refined;
+    }
+
+    voronoi_info array_info, reference_info;
+    double array_time     = run(mesh, array_info, opt.repeat, array_tag());
+    double reference_time = opt.reference ? run(mesh, reference_info, opt.repeat, reference_tag()) : 0.0;
+
+    std::cout << std::setw(16) << std::left << opt.meshes[mi].substr(opt.meshes[mi].find_last_of("/\\") + 1) << std::right
+              << "  cells " << std::setw(9) << viennagrid::cells(mesh).size()
+              << std::fixed << std::setprecision(4) << "  array " << array_time << " s";
+    if(opt.reference)
+    {
+      double dev = std::max(std::max(deviation(array_info.vertex_box_volumes, reference_info.vertex_box_volumes),
+                                     deviation(array_info.interface_areas,    reference_info.interface_areas)),
+                            std::max(deviation(array_info.vertex_box_volume_contributions, reference_info.vertex_box_volume_contributions),
+                                     deviation(array_info.interface_contributions,         reference_info.interface_contributions)));
+      std::cout << "  reference " << reference_time << " s  speedup " << std::setprecision(1) << reference_time / array_time
+                << std::scientific << std::setprecision(1) << "  deviation " << dev;
+      if(dev > 1.0e-10) failed = true;
+    }
+    std::cout << std::endl;
+  }
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
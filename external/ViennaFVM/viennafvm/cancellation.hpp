@@ -0,0 +1,63 @@
+#ifndef VIENNAFVM_CANCELLATION_HPP
+#define VIENNAFVM_CANCELLATION_HPP
+
+/* =======================================================================
+   Copyright (c) 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+           ViennaFVM - The Vienna Finite Volume Method Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+#include <exception>
+
+namespace viennafvm
+{
+
+  /** @brief A flag, by which another thread asks the solvers to stop.
+   *
+   *  The solvers only check the flag between their steps, i.e., between the assembly, the preconditioner
+   *  setup, the Krylov iterations and the nonlinear iterations. Hence a request takes effect with a short
+   *  delay, but the data of the simulation is always in a consistent state. The flag is only ever set,
+   *  so a volatile flag suffices; the requesting thread does not need to synchronize with the solver.
+   */
+  class cancellation_token
+  {
+  public:
+    cancellation_token() : requested_(false) {}
+
+    /** @brief Asks the solvers to stop, may be called from any thread */
+    void request() { requested_ = true; }
+
+    bool requested() const { return requested_; }
+
+    /** @brief Makes the token reusable for another run, must not be called while a solver is running */
+    void reset() { requested_ = false; }
+
+  private:
+    volatile bool requested_;
+  };
+
+  /** @brief Thrown by the linear solvers if the run has been cancelled within a solve */
+  class cancelled_exception : public std::exception
+  {
+  public:
+    virtual const char* what() const throw() { return "ViennaFVM: the solve has been cancelled"; }
+  };
+
+  /** @brief Throws a cancelled_exception if a cancellation has been requested, a NULL token never cancels */
+  inline void check_cancellation(cancellation_token const * token)
+  {
+    if (token && token->requested())
+      throw cancelled_exception();
+  }
+
+}
+
+#endif // VIENNAFVM_CANCELLATION_HPP
@@ -28,6 +28,7 @@
 #include "viennamath/expression.hpp"
 #include "viennamath/manipulation/substitute.hpp"
 #include "viennafvm/ncell_quantity.hpp"
+#include "viennafvm/log.hpp"
 
 namespace viennafvm {
 
@@ -48,7 +49,7 @@ namespace viennafvm {
           if (   !viennamath::callback_if_castable< viennamath::rt_unary_expr<InterfaceType> >::apply(e, *this)
               && !viennamath::callback_if_castable< viennamath::rt_binary_expr<InterfaceType> >::apply(e, *this))
           {
-            std::cout << "Integrand extraction stalled at e=" << e->deep_str() << std::endl;
+            viennafvm::log::out() << "Integrand extraction stalled at e=" << e->deep_str() << std::endl;
             throw "Cannot derive weak form!";
           }
 
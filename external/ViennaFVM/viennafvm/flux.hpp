@@ -29,6 +29,8 @@
 #include "viennamath/expression.hpp"
 #include "viennamath/manipulation/substitute.hpp"
 #include "viennafvm/ncell_quantity.hpp"
+#include "viennafvm/jit.hpp"
+#include "viennafvm/log.hpp"
 #include "viennamath/manipulation/diff.hpp"
 #include "viennamath/manipulation/eval.hpp"
 
@@ -152,7 +154,7 @@ namespace viennafvm
           }
           else
           {
-            std::cout << "Gradient scanner encountered unexpected expression: " << bin << std::endl;
+            viennafvm::log::out() << "Gradient scanner encountered unexpected expression: " << bin << std::endl;
             throw "Gradient scanning failed";
           }
         }
@@ -212,7 +214,7 @@ namespace viennafvm
           }
           else
           {
-            std::cout << "Gradient extraction encountered unexpected expression: " << bin << std::endl;
+            viennafvm::log::out() << "Gradient extraction encountered unexpected expression: " << bin << std::endl;
             throw "Gradient extraction failed";
           }
         }
@@ -330,7 +332,7 @@ namespace viennafvm
           }
           else
           {
-            std::cout << "Gradient extraction encountered unexpected expression: " << bin << std::endl;
+            viennafvm::log::out() << "Gradient extraction encountered unexpected expression: " << bin << std::endl;
             throw "Gradient extraction failed";
           }
         }
@@ -446,7 +448,7 @@ namespace viennafvm
           }
           else
           {
-            std::cout << "Function symbol prefactor extraction encountered unexpected expression: " << bin << std::endl;
+            viennafvm::log::out() << "Function symbol prefactor extraction encountered unexpected expression: " << bin << std::endl;
             throw "Function symbol prefactor extraction failed";
           }
         }
@@ -501,7 +503,7 @@ namespace viennafvm
         }
         else
         {
-          std::cout << "Gradient NOT found in flux expression: " << integrand << std::endl;
+          viennafvm::log::out() << "Gradient NOT found in flux expression: " << integrand << std::endl;
           throw "No gradient in flux!";
         }
 
@@ -517,12 +519,12 @@ namespace viennafvm
         arg_extractor(integrand.get());
         viennamath::rt_expr<InterfaceType> gradient_argument = arg_extractor.get();
 #ifdef VIENNAFVM_DEBUG
-        std::cout << " - Gradient argument: " << gradient_argument << std::endl;
+        viennafvm::log::out() << " - Gradient argument: " << gradient_argument << std::endl;
 #endif
         grad_prefactor_extractor(integrand.get());
         viennamath::rt_expr<InterfaceType> gradient_prefactor  = grad_prefactor_extractor.get();
 #ifdef VIENNAFVM_DEBUG
-        std::cout << " - Gradient prefactor: " << gradient_prefactor << std::endl;
+        viennafvm::log::out() << " - Gradient prefactor: " << gradient_prefactor << std::endl;
 #endif
         // Instantiate residual accessor for nonlinear terms:
         viennafvm::ncell_quantity<CellType, InterfaceType> current_iterate;
@@ -540,7 +542,7 @@ namespace viennafvm
         if (gradient_scanner.found() && fsymbol_scanner.found()) //advection-diffusion
         {
 #ifdef VIENNAFVM_DEBUG
-          std::cout << " - Detected type of equation: Advection-Diffusion" << std::endl;
+          viennafvm::log::out() << " - Detected type of equation: Advection-Diffusion" << std::endl;
 #endif
           has_advection_ = true;
 
@@ -550,7 +552,7 @@ namespace viennafvm
           fs_prefactor_extractor(integrand.get());
           viennamath::rt_expr<InterfaceType> fs_prefactor  = fs_prefactor_extractor.get();
 #ifdef VIENNAFVM_DEBUG
-          std::cout << " - Prefactor of " << u << ": " << fs_prefactor << std::endl;
+          viennafvm::log::out() << " - Prefactor of " << u << ": " << fs_prefactor << std::endl;
 #endif
 
           //
@@ -563,13 +565,13 @@ namespace viennafvm
           B_ = fs_prefactor;
 
 #ifdef VIENNAFVM_DEBUG
-          std::cout << " - Expression for stabilization term B/A (without distance d): " << B_ / A_ << std::endl;
+          viennafvm::log::out() << " - Expression for stabilization term B/A (without distance d): " << B_ / A_ << std::endl;
 #endif
         }
         else //pure diffusion
         {
 #ifdef VIENNAFVM_DEBUG
-          std::cout << " - Detected type of equation: Purely Diffusive" << std::endl;
+          viennafvm::log::out() << " - Detected type of equation: Purely Diffusive" << std::endl;
 #endif
 
           // replace grad() by 1/distance in expression, where 1/distance is a cell quantity
@@ -593,8 +595,8 @@ namespace viennafvm
           integrand_prefactor_ = replaced_gradient_prefactor;
 
 #ifdef VIENNAFVM_DEBUG
-          std::cout << " - Expression for in-flux:  " << in_integrand_ << std::endl;
-          std::cout << " - Expression for out-flux: " << out_integrand_ << std::endl;
+          viennafvm::log::out() << " - Expression for in-flux:  " << in_integrand_ << std::endl;
+          viennafvm::log::out() << " - Expression for out-flux: " << out_integrand_ << std::endl;
 #endif
         }
 
@@ -619,12 +621,7 @@ namespace viennafvm
           double val_A = viennamath::eval(A_, p);
           double val_B = viennamath::eval(B_, p);
           double d     = facet_distance_accessor(facet); //viennadata::access<viennafvm::facet_distance_key, double>()(facet);
-          double exponent = val_B / (val_A / d);
-
-          if ( std::abs(exponent) > 0.01) // Actual tolerance is not critical - this is for stabilization purposes only
-            return val_B / (std::exp(exponent) - 1);
-          else
-            return val_A / d;  // Note: Can be obtained from tailor expansion of the equation above
+          return advective_in(val_A, val_B, d);
         }
 
         // pure diffusion:
@@ -637,7 +634,7 @@ namespace viennafvm
         integrand_prefactor_.get()->recursive_traversal(cell_updater_outer);
         double eps_outer = viennamath::eval(integrand_prefactor_, p);
 
-        return viennamath::eval(in_integrand_, p) * 2.0 * eps_inner * eps_outer / (eps_inner + eps_outer);
+        return diffusive(viennamath::eval(in_integrand_, p), eps_inner, eps_outer);
 
       }
 
@@ -660,12 +657,7 @@ namespace viennafvm
           double val_A = viennamath::eval(A_, p);
           double val_B = viennamath::eval(B_, p);
           double d     = facet_distance_accessor(facet); //viennadata::access<viennafvm::facet_distance_key, double>()(facet);
-          double exponent = val_B / (val_A / d);
-
-          if ( std::abs(exponent) > 0.01) // Actual tolerance is not critical - this is for stabilization purposes only
-            return val_B / (1.0 - std::exp(-exponent));
-          else
-            return val_A / d;  // Note: Can be obtained from tailor expansion of the equation above
+          return advective_out(val_A, val_B, d);
         }
 
         // pure diffusion:
@@ -678,11 +670,97 @@ namespace viennafvm
         integrand_prefactor_.get()->recursive_traversal(cell_updater_outer);
         double eps_outer = viennamath::eval(integrand_prefactor_, p);
 
-        return viennamath::eval(out_integrand_, p) * 2.0 * eps_inner * eps_outer / (eps_inner + eps_outer);
+        return diffusive(viennamath::eval(out_integrand_, p), eps_inner, eps_outer);
+      }
+
+      //
+      // Compiled evaluation: the fluxes of all facets are gathered first and then evaluated at once
+      //
+
+      /** @brief Compiles the flux expressions, returns false if the interpreted in() and out() have to be used */
+      bool compile(jit_compiler & jit)
+      {
+        if (has_advection_)
+          return jit_A_.compile(jit, A_) && jit_B_.compile(jit, B_);
+
+        // in_integrand_ and out_integrand_ are the same expression
+        return jit_integrand_.compile(jit, in_integrand_) && jit_prefactor_.compile(jit, integrand_prefactor_);
+      }
+
+      /** @brief Reads the quantities of the flux from 'inner_cell' to 'outer_cell' across 'facet', must be called at the same point as in() and out() */
+      void gather(CellType const & inner_cell, FacetType const & facet, CellType const & outer_cell)
+      {
+        if (has_advection_)
+        {
+          jit_A_.push_back(inner_cell, &facet);
+          jit_B_.push_back(inner_cell, &facet);
+        }
+        else
+        {
+          jit_integrand_.push_back(inner_cell, &facet);
+          jit_prefactor_.push_back(inner_cell, &facet);
+          jit_prefactor_.push_back(outer_cell, &facet);
+        }
+      }
+
+      /** @brief Evaluates the compiled expressions for all gathered fluxes */
+      void evaluate()
+      {
+        if (has_advection_)
+        {
+          jit_A_.evaluate();
+          jit_B_.evaluate();
+        }
+        else
+        {
+          jit_integrand_.evaluate();
+          jit_prefactor_.evaluate();
+        }
+      }
+
+      /** @brief The same as in() for the i-th gathered flux, where 'd' is the distance of the cells */
+      double in(std::size_t i, double d) const
+      {
+        if (has_advection_)
+          return advective_in(jit_A_[i], jit_B_[i], d);
+        return diffusive(jit_integrand_[i], jit_prefactor_[2*i], jit_prefactor_[2*i+1]);
+      }
+
+      /** @brief The same as out() for the i-th gathered flux, where 'd' is the distance of the cells */
+      double out(std::size_t i, double d) const
+      {
+        if (has_advection_)
+          return advective_out(jit_A_[i], jit_B_[i], d);
+        return diffusive(jit_integrand_[i], jit_prefactor_[2*i], jit_prefactor_[2*i+1]);
       }
 
     private:
 
+      static double advective_in(double val_A, double val_B, double d)
+      {
+        double exponent = val_B / (val_A / d);
+
+        if ( std::abs(exponent) > 0.01) // Actual tolerance is not critical - this is for stabilization purposes only
+          return val_B / (std::exp(exponent) - 1);
+        else
+          return val_A / d;  // Note: Can be obtained from tailor expansion of the equation above
+      }
+
+      static double advective_out(double val_A, double val_B, double d)
+      {
+        double exponent = val_B / (val_A / d);
+
+        if ( std::abs(exponent) > 0.01) // Actual tolerance is not critical - this is for stabilization purposes only
+          return val_B / (1.0 - std::exp(-exponent));
+        else
+          return val_A / d;  // Note: Can be obtained from tailor expansion of the equation above
+      }
+
+      static double diffusive(double integrand, double eps_inner, double eps_outer)
+      {
+        return integrand * 2.0 * eps_inner * eps_outer / (eps_inner + eps_outer);
+      }
+
       StorageType & storage;
       
       bool has_advection_;
@@ -695,6 +773,12 @@ namespace viennafvm
       // diffusion-advection:
       viennamath::rt_expr<InterfaceType> A_;
       viennamath::rt_expr<InterfaceType> B_;
+
+      // compiled expressions, the prefactor is gathered for the inner and the outer cell of each flux:
+      jit_expression<CellType, FacetType, InterfaceType> jit_integrand_;
+      jit_expression<CellType, FacetType, InterfaceType> jit_prefactor_;
+      jit_expression<CellType, FacetType, InterfaceType> jit_A_;
+      jit_expression<CellType, FacetType, InterfaceType> jit_B_;
   };
 
 
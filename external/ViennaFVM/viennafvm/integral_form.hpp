@@ -20,6 +20,7 @@
 #include "viennamath/manipulation/substitute.hpp"
 
 #include "viennafvm/forwards.h"
+#include "viennafvm/log.hpp"
 
 /** @file   integral_form.hpp
     @brief  Derives an integral form of a PDE given in strong form.
@@ -104,7 +105,7 @@ namespace viennafvm
               && !viennamath::callback_if_castable< viennamath::rt_binary_expr<InterfaceType> >::apply(e, *this)
               && !viennamath::callback_if_castable< viennamath::rt_function_symbol<InterfaceType> >::apply(e, *this))
           {
-            std::cout << "Weak form derivation stalled at e=" << e->deep_str() << std::endl;
+            viennafvm::log::out() << "Weak form derivation stalled at e=" << e->deep_str() << std::endl;
             throw "Cannot derive weak form!";
           }
 
@@ -199,7 +200,7 @@ namespace viennafvm
   {
     if (is_integral_form(strong_formulation))
     {
-      std::cout << "ViennaFVM: make_weak_form(): Nothing to do, problem already in integral form!" << std::endl;
+      viennafvm::log::out() << "ViennaFVM: make_weak_form(): Nothing to do, problem already in integral form!" << std::endl;
       return strong_formulation;
     }
 
@@ -0,0 +1,139 @@
+#ifndef VIENNAFVM_IO_SYSTEM_CAPTURE_HPP
+#define VIENNAFVM_IO_SYSTEM_CAPTURE_HPP
+
+/* =======================================================================
+   Copyright (c) 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+           ViennaFVM - The Vienna Finite Volume Method Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+/** @file system_capture.hpp
+    @brief Writes and reads assembled linear systems in the MatrixMarket format.
+
+    The matrix is stored as '<name>.mtx' in the coordinate format, the right hand side
+    as '<name>_rhs.mtx' in the array format. The values are written with full precision,
+    hence a replayed system is identical to the captured one. The files can also be read
+    by viennacl::io::read_matrix_market_file() and other MatrixMarket readers.
+*/
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <limits>
+#include <iomanip>
+
+#include "boost/numeric/ublas/matrix_sparse.hpp"
+#include "boost/numeric/ublas/vector.hpp"
+
+namespace viennafvm
+{
+  namespace io
+  {
+
+    /** @brief Returns the file name of the right hand side belonging to the matrix file 'matrix_file' */
+    inline std::string rhs_filename(std::string const & matrix_file)
+    {
+      std::string::size_type pos = matrix_file.rfind(".mtx");
+      if (pos == std::string::npos)
+        return matrix_file + "_rhs.mtx";
+      return matrix_file.substr(0, pos) + "_rhs.mtx";
+    }
+
+    /** @brief Writes the system matrix to '<name>.mtx' and the right hand side to '<name>_rhs.mtx'. Returns false on I/O errors. */
+    template <typename NumericT>
+    bool write_system(boost::numeric::ublas::compressed_matrix<NumericT> const & A,
+                      boost::numeric::ublas::vector<NumericT> const & b,
+                      std::string const & name)
+    {
+      typedef typename boost::numeric::ublas::compressed_matrix<NumericT>::const_iterator1    Iterator1;
+      typedef typename boost::numeric::ublas::compressed_matrix<NumericT>::const_iterator2    Iterator2;
+
+      std::ofstream matrix_stream((name + ".mtx").c_str());
+      std::ofstream rhs_stream((name + "_rhs.mtx").c_str());
+      if (!matrix_stream || !rhs_stream)
+        return false;
+
+      matrix_stream << std::setprecision(std::numeric_limits<NumericT>::digits10 + 2);
+      rhs_stream    << std::setprecision(std::numeric_limits<NumericT>::digits10 + 2);
+
+      matrix_stream << "%%MatrixMarket matrix coordinate real general" << std::endl;
+      matrix_stream << A.size1() << " " << A.size2() << " " << A.nnz() << std::endl;
+      for (Iterator1 row_it = A.begin1(); row_it != A.end1(); ++row_it)
+        for (Iterator2 col_it = row_it.begin(); col_it != row_it.end(); ++col_it)
+          matrix_stream << col_it.index1() + 1 << " " << col_it.index2() + 1 << " " << *col_it << "\n";
+
+      rhs_stream << "%%MatrixMarket matrix array real general" << std::endl;
+      rhs_stream << b.size() << " 1" << std::endl;
+      for (std::size_t i = 0; i < b.size(); ++i)
+        rhs_stream << b(i) << "\n";
+
+      return matrix_stream.good() && rhs_stream.good();
+    }
+
+    namespace detail
+    {
+      /** @brief Skips the MatrixMarket banner and comments, returns the size line */
+      inline bool read_header(std::ifstream & stream, std::string & size_line)
+      {
+        while (std::getline(stream, size_line))
+        {
+          if (!size_line.empty() && size_line[0] != '%')
+            return true;
+        }
+        return false;
+      }
+    }
+
+    /** @brief Reads a system written by write_system(). 'matrix_file' is the name of the matrix file, i.e., '<name>.mtx'.
+               The entries of the matrix have to be sorted by rows. Returns false if the files cannot be read. */
+    template <typename NumericT>
+    bool read_system(boost::numeric::ublas::compressed_matrix<NumericT> & A,
+                     boost::numeric::ublas::vector<NumericT> & b,
+                     std::string const & matrix_file)
+    {
+      std::ifstream matrix_stream(matrix_file.c_str());
+      std::ifstream rhs_stream(rhs_filename(matrix_file).c_str());
+      if (!matrix_stream || !rhs_stream)
+        return false;
+
+      std::string line;
+      std::size_t rows = 0, cols = 0, nnz = 0;
+      if (!detail::read_header(matrix_stream, line))
+        return false;
+      std::istringstream(line) >> rows >> cols >> nnz;
+
+      A = boost::numeric::ublas::compressed_matrix<NumericT>(rows, cols, nnz);
+      for (std::size_t k = 0; k < nnz; ++k)
+      {
+        std::size_t i, j;
+        NumericT value;
+        if (!(matrix_stream >> i >> j >> value) || i < 1 || j < 1 || i > rows || j > cols)
+          return false;
+        A.push_back(i - 1, j - 1, value);
+      }
+
+      std::size_t size = 0, columns = 0;
+      if (!detail::read_header(rhs_stream, line))
+        return false;
+      std::istringstream(line) >> size >> columns;
+
+      b.resize(size, false);
+      for (std::size_t i = 0; i < size; ++i)
+        if (!(rhs_stream >> b(i)))
+          return false;
+
+      return true;
+    }
+
+  }
+}
+
+#endif
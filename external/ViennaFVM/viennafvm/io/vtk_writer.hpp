@@ -19,6 +19,7 @@
 #include <iostream>
 
 #include "viennafvm/forwards.h"
+#include "viennafvm/log.hpp"
 
 // ViennaGrid includes:
 #include "viennagrid/io/vtk_writer.hpp"
@@ -56,7 +57,7 @@ namespace viennafvm
       typedef viennafvm::boundary_key         BoundaryKeyType;
 
     #ifdef VIENNAFVM_VERBOSE
-      std::cout << "* write_solution_to_VTK_file(): Writing result on mesh for later export" << std::endl;
+      viennafvm::log::out() << "* write_solution_to_VTK_file(): Writing result on mesh for later export" << std::endl;
     #endif
       viennagrid::io::vtk_writer<DomainType> my_vtk_writer;
 
@@ -105,7 +106,7 @@ namespace viennafvm
       }
 
     #ifdef VIENNAFVM_VERBOSE
-      std::cout << "* write_solution_to_VTK_file(): Writing data to '"
+      viennafvm::log::out() << "* write_solution_to_VTK_file(): Writing data to '"
                 << filename
                 << "' (can be viewed with e.g. Paraview)" << std::endl;
     #endif
@@ -0,0 +1,440 @@
+#ifndef VIENNAFVM_JIT_HPP
+#define VIENNAFVM_JIT_HPP
+
+/* =======================================================================
+   Copyright (c) 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+           ViennaFVM - The Vienna Finite Volume Method Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #define VIENNAFVM_JIT_AVAILABLE
+  #include <dlfcn.h>
+  #include <unistd.h>
+  #include <sys/stat.h>
+  #include <sys/types.h>
+#endif
+
+#include "viennafvm/forwards.h"
+#include "viennafvm/ncell_quantity.hpp"
+#include "viennafvm/log.hpp"
+
+#include "viennamath/expression.hpp"
+
+/** @file  jit.hpp
+    @brief Compiles the prepared integrands of the assembler to native code by means of the system compiler.
+*/
+
+namespace viennafvm
+{
+
+  /** @brief Compiles kernels, which evaluate an expression for a batch of elements, to shared libraries and loads them.
+   *
+   *  The shared libraries are cached on disk, the file name is a hash of the source code, the compiler and the flags.
+   *  Hence repeated runs of the same model load the kernels without invoking the compiler. The compiler is taken
+   *  from the environment variable VIENNAFVM_JIT_CXX (default: c++), the cache directory from VIENNAFVM_JIT_CACHE
+   *  (default: viennafvm-jit-<uid> in TMPDIR). If a kernel cannot be built, kernel() returns NULL and the assembler keeps
+   *  interpreting the expressions. Only POSIX systems are supported, elsewhere kernel() always returns NULL.
+   *
+   *  As the cached libraries are loaded into the process, the cache directory is created with mode 0700, and a directory
+   *  or library which is not owned by the user, is writable by the group or by others, or is a symbolic link is refused.
+   *
+   *  The kernels are loaded for the lifetime of the compiler object, which must not be used by several threads at once.
+   */
+  class jit_compiler
+  {
+    public:
+      /** @brief A kernel evaluates result[i] = f(q[0][i], q[1][i], ...) for 0 <= i < n */
+      typedef void (*kernel_type)(long n, double const * const * q, double * result);
+
+      jit_compiler() : compilations_(0), loads_(0)
+      {
+        const char * cxx = std::getenv("VIENNAFVM_JIT_CXX");
+        compiler_ = (cxx && *cxx) ? cxx : "c++";
+
+        // no fused multiply-adds, so that the kernels yield the same values as the interpreted expressions
+        flags_ = "-O3 -ffp-contract=off -fPIC -shared";
+
+        const char * cache = std::getenv("VIENNAFVM_JIT_CACHE");
+        if (cache && *cache)
+          cache_directory_ = cache;
+        else
+        {
+          const char * tmp = std::getenv("TMPDIR");
+          std::stringstream dir;
+          dir << ((tmp && *tmp) ? tmp : "/tmp") << "/viennafvm-jit";
+#ifdef VIENNAFVM_JIT_AVAILABLE
+          dir << "-" << geteuid();
+#endif
+          cache_directory_ = dir.str();
+        }
+      }
+
+      ~jit_compiler()
+      {
+#ifdef VIENNAFVM_JIT_AVAILABLE
+        for (std::size_t i = 0; i < handles_.size(); ++i)
+          dlclose(handles_[i]);
+#endif
+      }
+
+      std::string const & compiler() const { return compiler_; }
+      void compiler(std::string const & command) { compiler_ = command; }
+
+      /** @brief The flags passed to the compiler, these have to produce a shared library */
+      std::string const & flags() const { return flags_; }
+      void flags(std::string const & f) { flags_ = f; }
+
+      std::string const & cache_directory() const { return cache_directory_; }
+      void cache_directory(std::string const & dir) { cache_directory_ = dir; }
+
+      /** @brief Returns the number of kernels built by the compiler, and the number of kernels loaded from the cache directory */
+      std::size_t compilations() const { return compilations_; }
+      std::size_t loads() const { return loads_; }
+
+      /** @brief Returns the kernel 'viennafvm_jit_kernel' defined in 'source', NULL if it cannot be built */
+      kernel_type kernel(std::string const & source)
+      {
+        std::string name = hash(compiler_ + "\n" + flags_ + "\n" + source);
+
+        std::map<std::string, kernel_type>::const_iterator it = kernels_.find(name);
+        if (it != kernels_.end())
+          return it->second;
+
+        kernel_type k = build(name, source);
+        kernels_[name] = k;    // a failed build is not retried
+        return k;
+      }
+
+    private:
+      jit_compiler(jit_compiler const &);
+      jit_compiler & operator=(jit_compiler const &);
+
+      /** @brief FNV-1a hash as a hex string */
+      static std::string hash(std::string const & text)
+      {
+        unsigned long long h = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < text.size(); ++i)
+        {
+          h ^= static_cast<unsigned char>(text[i]);
+          h *= 1099511628211ULL;
+        }
+        std::stringstream ss;
+        ss << std::hex << std::setw(16) << std::setfill('0') << h;
+        return ss.str();
+      }
+
+#ifdef VIENNAFVM_JIT_AVAILABLE
+      static bool make_directory(std::string const & dir)
+      {
+        for (std::size_t pos = dir.find('/', 1); ; pos = dir.find('/', pos + 1))
+        {
+          std::string prefix = dir.substr(0, pos);
+          if (mkdir(prefix.c_str(), 0700) != 0)
+          {
+            struct stat info;
+            if (stat(prefix.c_str(), &info) != 0 || !S_ISDIR(info.st_mode))
+              return false;
+          }
+          if (pos == std::string::npos)
+            return true;
+        }
+      }
+
+      /** @brief A file or directory may be trusted if it is owned by the user and only writable by the user */
+      static bool owned_and_private(std::string const & path, bool directory)
+      {
+        struct stat info;
+        if (lstat(path.c_str(), &info) != 0)
+          return false;
+        if (directory ? !S_ISDIR(info.st_mode) : !S_ISREG(info.st_mode))
+          return false;
+        return info.st_uid == geteuid() && (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+      }
+
+      kernel_type build(std::string const & name, std::string const & source)
+      {
+        std::string base    = cache_directory_ + "/kernel_" + name;
+        std::string library = base + ".so";
+
+        if (!make_directory(cache_directory_))
+        {
+          viennafvm::log::err() << "ViennaFVM: cannot create the kernel cache directory " << cache_directory_ << std::endl;
+          return NULL;
+        }
+        if (!owned_and_private(cache_directory_, true))
+        {
+          viennafvm::log::err() << "ViennaFVM: the kernel cache directory " << cache_directory_
+                                << " is not a directory which only the user owns and can write to, not using it" << std::endl;
+          return NULL;
+        }
+
+        struct stat info;
+        if (lstat(library.c_str(), &info) == 0)
+        {
+          if (!owned_and_private(library, false))
+          {
+            viennafvm::log::err() << "ViennaFVM: " << library << " is not a file which only the user owns and can write to, not loading it" << std::endl;
+            return NULL;
+          }
+
+          kernel_type k = load(library);
+          if (k)
+          {
+            ++loads_;
+            return k;
+          }
+        }
+
+        // other processes or compiler objects may build the same kernel, hence the files are renamed into place
+        std::stringstream unique;
+        unique << base << "." << getpid() << "." << static_cast<void const *>(this);
+        std::string source_file = unique.str() + ".cpp";
+        std::string temporary   = unique.str() + ".so";
+        std::string log_file    = unique.str() + ".log";
+        {
+          std::ofstream file(source_file.c_str());
+          file << source;
+          if (!file)
+          {
+            viennafvm::log::err() << "ViennaFVM: cannot write " << source_file << std::endl;
+            return NULL;
+          }
+        }
+
+        std::string command = compiler_ + " " + flags_ + " -o \"" + temporary + "\" \"" + source_file + "\" > \"" + log_file + "\" 2>&1";
+        int status = std::system(command.c_str());
+        std::remove(source_file.c_str());
+        if (status != 0 || chmod(temporary.c_str(), 0700) != 0 || std::rename(temporary.c_str(), library.c_str()) != 0)
+        {
+          std::remove(temporary.c_str());
+          viennafvm::log::err() << "ViennaFVM: compiling a kernel failed, see " << log_file << std::endl;
+          return NULL;
+        }
+        std::remove(log_file.c_str());
+        ++compilations_;
+
+        return load(library);
+      }
+
+      kernel_type load(std::string const & library)
+      {
+        void * handle = dlopen(library.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle)
+        {
+          viennafvm::log::err() << "ViennaFVM: cannot load " << library << ": " << dlerror() << std::endl;
+          return NULL;
+        }
+
+        // C++03 does not allow casting an object pointer to a function pointer, hence the pointer is copied
+        void * symbol = dlsym(handle, "viennafvm_jit_kernel");
+        if (!symbol)
+        {
+          dlclose(handle);
+          return NULL;
+        }
+        handles_.push_back(handle);
+
+        kernel_type k;
+        *reinterpret_cast<void **>(&k) = symbol;
+        return k;
+      }
+#else
+      kernel_type build(std::string const &, std::string const &) { return NULL; }
+#endif
+
+      std::string compiler_;
+      std::string flags_;
+      std::string cache_directory_;
+
+      std::map<std::string, kernel_type> kernels_;
+      std::vector<void *>                handles_;
+      std::size_t                        compilations_;
+      std::size_t                        loads_;
+  };
+
+
+
+  /** @brief A prepared expression of the assembler, which is evaluated by a compiled kernel for a batch of elements.
+   *
+   *  The leaves of the expression, i.e. the cell and facet quantities, become the arguments of the kernel. For each
+   *  element, push_back() reads the values of the leaves, evaluate() then runs the kernel on all elements at once.
+   *  Expressions which contain other leaves than cell quantities, facet quantities and constants are not compiled.
+   *  The expression must not be modified or destroyed as long as the object is used.
+   */
+  template <typename CellType, typename FacetType, typename InterfaceType>
+  class jit_expression
+  {
+      typedef viennafvm::ncell_quantity<CellType,  InterfaceType>    CellQuantityType;
+      typedef viennafvm::ncell_quantity<FacetType, InterfaceType>    FacetQuantityType;
+
+      /** @brief A leaf of the expression, either a cell or a facet quantity */
+      struct leaf
+      {
+        leaf(CellQuantityType const * c, FacetQuantityType const * f) : cell_quantity(c), facet_quantity(f) {}
+
+        CellQuantityType  const * cell_quantity;
+        FacetQuantityType const * facet_quantity;
+      };
+
+    public:
+      jit_expression() : kernel_(NULL), size_(0) {}
+
+      /** @brief Compiles the expression, returns false if the expression is not supported or cannot be compiled.
+       *
+       *  If 'facet_quantities' is false, facet quantities are not accepted, as is the case for volume integrands.
+       */
+      bool compile(jit_compiler & jit, viennamath::rt_expr<InterfaceType> const & e, bool facet_quantities = true)
+      {
+        leaves_.clear();
+        kernel_ = NULL;
+
+        std::stringstream code;
+        code << std::setprecision(17);
+        if (!emit(e.get(), code, facet_quantities))
+          return false;
+
+        std::stringstream source;
+        source << "// generated by ViennaFVM" << std::endl
+               << "#include <cmath>" << std::endl
+               << "extern \"C\" void viennafvm_jit_kernel(long n, double const * const * q, double * __restrict__ result)" << std::endl
+               << "{" << std::endl;
+        for (std::size_t k = 0; k < leaves_.size(); ++k)
+          source << "  double const * __restrict__ q" << k << " = q[" << k << "];" << std::endl;
+        source << "  for (long i = 0; i < n; ++i)" << std::endl
+               << "    result[i] = " << code.str() << ";" << std::endl
+               << "}" << std::endl;
+
+        kernel_ = jit.kernel(source.str());
+        values_.assign(leaves_.size(), std::vector<double>());
+        size_ = 0;
+        return kernel_ != NULL;
+      }
+
+      bool compiled() const { return kernel_ != NULL; }
+
+      /** @brief Appends the values of the leaves for the given cell and facet. The facet may be NULL if there are no facet quantities */
+      void push_back(CellType const & cell, FacetType const * facet)
+      {
+        for (std::size_t k = 0; k < leaves_.size(); ++k)
+        {
+          if (leaves_[k].cell_quantity)
+            values_[k].push_back(leaves_[k].cell_quantity->wrapper().eval(cell, 0.0));
+          else
+            values_[k].push_back(leaves_[k].facet_quantity->wrapper().eval(*facet, 0.0));
+        }
+        ++size_;
+      }
+
+      /** @brief Evaluates the expression for all elements passed to push_back() since the last call to clear() */
+      void evaluate()
+      {
+        std::vector<double const *> arguments(values_.size());
+        for (std::size_t k = 0; k < values_.size(); ++k)
+          arguments[k] = values_[k].empty() ? NULL : &values_[k][0];
+
+        result_.resize(size_);
+        if (size_ > 0)
+          kernel_(static_cast<long>(size_), arguments.empty() ? NULL : &arguments[0], &result_[0]);
+      }
+
+      void clear()
+      {
+        for (std::size_t k = 0; k < values_.size(); ++k)
+          values_[k].clear();
+        size_ = 0;
+      }
+
+      std::size_t size() const { return size_; }
+
+      /** @brief The value of the expression for the i-th element, available after evaluate() */
+      double operator[](std::size_t i) const { return result_[i]; }
+
+    private:
+
+      /** @brief Writes the expression as C++ code to 'code', the k-th leaf becomes the kernel argument qk[i] */
+      bool emit(InterfaceType const * e, std::ostream & code, bool facet_quantities)
+      {
+        if (e->is_constant())
+        {
+          code << "(" << e->unwrap() << ")";
+          return true;
+        }
+
+        if (CellQuantityType const * cq = dynamic_cast<CellQuantityType const *>(e))
+        {
+          code << "q" << leaves_.size() << "[i]";
+          leaves_.push_back(leaf(cq, NULL));
+          return true;
+        }
+
+        if (FacetQuantityType const * fq = dynamic_cast<FacetQuantityType const *>(e))
+        {
+          if (!facet_quantities)
+            return false;
+          code << "q" << leaves_.size() << "[i]";
+          leaves_.push_back(leaf(NULL, fq));
+          return true;
+        }
+
+        if (viennamath::rt_binary_expr<InterfaceType> const * be = dynamic_cast<viennamath::rt_binary_expr<InterfaceType> const *>(e))
+        {
+          std::string op = be->op()->str();
+          if (op != "+" && op != "-" && op != "*" && op != "/")
+            return false;
+          code << "(";
+          if (!emit(be->lhs(), code, facet_quantities))
+            return false;
+          code << " " << op << " ";
+          if (!emit(be->rhs(), code, facet_quantities))
+            return false;
+          code << ")";
+          return true;
+        }
+
+        if (viennamath::rt_unary_expr<InterfaceType> const * ue = dynamic_cast<viennamath::rt_unary_expr<InterfaceType> const *>(e))
+        {
+          std::string op = ue->op()->str();
+          if (op == "id")
+            code << "(";
+          else if (op == "exp" || op == "sin" || op == "cos" || op == "tan" || op == "fabs" || op == "sqrt" || op == "log" || op == "log10")
+            code << "std::" << op << "(";
+          else
+            return false;   // grad, div, partial derivatives and integrals are not evaluated by the assembler
+          if (!emit(ue->lhs(), code, facet_quantities))
+            return false;
+          code << ")";
+          return true;
+        }
+
+        // variables and function symbols do not occur in prepared integrands
+        return false;
+      }
+
+      std::vector<leaf>                       leaves_;
+      jit_compiler::kernel_type               kernel_;
+      std::vector< std::vector<double> >      values_;
+      std::vector<double>                     result_;
+      std::size_t                             size_;
+  };
+
+}
+
+#endif // VIENNAFVM_JIT_HPP
@@ -25,7 +25,9 @@
 #include "viennafvm/mapping.hpp"
 #include "viennafvm/util.hpp"
 #include "viennafvm/flux.hpp"
+#include "viennafvm/jit.hpp"
 #include "viennafvm/ncell_quantity.hpp"
+#include "viennafvm/log.hpp"
 
 #include "viennagrid/forwards.hpp"
 #include "viennagrid/algorithm/voronoi.hpp"
@@ -60,6 +62,18 @@ namespace viennafvm
   {
     public:
 
+      /** @brief If a JIT compiler is passed, the integrands are evaluated by compiled kernels wherever possible. The compiler is not owned.
+       *  If 'prepared' is true, prepare() has been called for the mesh and the storage, and the assembly does not repeat it.
+       */
+      explicit linear_assembler(jit_compiler * jit = NULL, bool prepared = false) : jit_(jit), prepared_(prepared) {}
+
+      /** @brief Computes the effective facet areas and the distances of the cell centers, which only depend on the mesh */
+      template <typename SegmentT, typename StorageType>
+      void prepare(SegmentT const & segment, StorageType & storage)
+      {
+        setup(segment, storage);
+      }
+
       /** @brief  Assembles the full PDE system into the same matrix */
       template <typename LinPdeSysT,
                 typename SegmentT,
@@ -90,10 +104,10 @@ namespace viennafvm
         for (std::size_t pde_index = 0; pde_index < pde_system.size(); ++pde_index)
         {
 #ifdef VIENNAFVM_DEBUG
-          std::cout << std::endl;
-          std::cout << "//" << std::endl;
-          std::cout << "//   Equation " << pde_index << std::endl;
-          std::cout << "//" << std::endl;
+          viennafvm::log::out() << std::endl;
+          viennafvm::log::out() << "//" << std::endl;
+          viennafvm::log::out() << "//   Equation " << pde_index << std::endl;
+          viennafvm::log::out() << "//" << std::endl;
 #endif
           assemble(pde_system, pde_index,
                    segment, storage,
@@ -133,10 +147,10 @@ namespace viennafvm
 
 
 #ifdef VIENNAFVM_DEBUG
-        std::cout << std::endl;
-        std::cout << "//" << std::endl;
-        std::cout << "//   Equation " << pde_index << std::endl;
-        std::cout << "//" << std::endl;
+        viennafvm::log::out() << std::endl;
+        viennafvm::log::out() << "//" << std::endl;
+        viennafvm::log::out() << "//   Equation " << pde_index << std::endl;
+        viennafvm::log::out() << "//" << std::endl;
 #endif
         assemble(pde_system, pde_index,
                  segment, storage,
@@ -186,13 +200,13 @@ namespace viennafvm
 
 
 #ifdef VIENNAFVM_DEBUG
-        std::cout << " - Strong form: " << pde << std::endl;
+        viennafvm::log::out() << " - Strong form: " << pde << std::endl;
 #endif
 
         equ_type integral_form = viennafvm::make_integral_form( pde );
 
 #ifdef VIENNAFVM_DEBUG
-        std::cout << " - Integral form: " << integral_form << std::endl;
+        viennafvm::log::out() << " - Integral form: " << integral_form << std::endl;
 #endif
 
         //
@@ -206,10 +220,10 @@ namespace viennafvm
         expr_type  stabilization_integrand = prepare_for_evaluation<CellType>(storage, pde_options.damping_term(), u);
 
 #ifdef VIENNAFVM_DEBUG
-        std::cout << " - Surface integrand for matrix: " << partial_omega_integrand << std::endl;
-        std::cout << " - Volume integrand for matrix:  " <<  matrix_omega_integrand << std::endl;
-        std::cout << " - Stabilization for matrix:     " << stabilization_integrand << std::endl;
-        std::cout << " - Volume integrand for rhs:     " <<     rhs_omega_integrand << std::endl;
+        viennafvm::log::out() << " - Surface integrand for matrix: " << partial_omega_integrand << std::endl;
+        viennafvm::log::out() << " - Volume integrand for matrix:  " <<  matrix_omega_integrand << std::endl;
+        viennafvm::log::out() << " - Stabilization for matrix:     " << stabilization_integrand << std::endl;
+        viennafvm::log::out() << " - Volume integrand for rhs:     " <<     rhs_omega_integrand << std::endl;
 #endif
 
         viennafvm::flux_handler<StorageType, CellType, FacetType, interface_type>  flux(storage, partial_omega_integrand, u);
@@ -221,7 +235,8 @@ namespace viennafvm
         //
         // Preprocess domain
         //
-        setup(segment, storage);
+        if (!prepared_)
+          setup(segment, storage);
 
 
         typename viennadata::result_of::accessor<StorageType, viennafvm::mapping_key, long, CellType>::type cell_mapping_accessor =
@@ -236,6 +251,24 @@ namespace viennafvm
         typename viennadata::result_of::accessor<StorageType, viennafvm::current_iterate_key, double, CellType>::type current_iterate_accessor =
             viennadata::make_accessor(storage, viennafvm::current_iterate_key(u.id()));
 
+        if (jit_)
+        {
+          jit_expression<CellType, FacetType, interface_type> jit_matrix, jit_stabilization, jit_rhs;
+          if (flux.compile(*jit_)
+              && jit_matrix.compile(*jit_, substituted_matrix_omega_integrand, false)
+              && jit_stabilization.compile(*jit_, stabilization_integrand, false)
+              && jit_rhs.compile(*jit_, rhs_omega_integrand, false))
+          {
+            assemble_compiled(pde_system, segment, storage, u,
+                              flux, jit_matrix, jit_stabilization, jit_rhs,
+                              system_matrix, load_vector);
+            return;
+          }
+#ifdef VIENNAFVM_DEBUG
+          viennafvm::log::out() << " - Integrands cannot be compiled, interpreting them" << std::endl;
+#endif
+        }
+
         //
         // Actual assembly:
         //
@@ -324,8 +357,225 @@ namespace viennafvm
 
       } // assemble
 
+      /** @brief The same as the interpreted assembly in assemble(), but the integrands are evaluated by compiled kernels.
+       *
+       *  The quantities of the fluxes and the cells are gathered in a first pass, then all integrands are evaluated at
+       *  once and finally the contributions are written in the same order as in assemble().
+       */
+      template <typename PDESystemType, typename SegmentT, typename StorageType,
+                typename FluxHandlerType, typename JITExpressionType,
+                typename MatrixT, typename VectorT>
+      void assemble_compiled(PDESystemType const & pde_system,
+                             SegmentT      const & segment,
+                             StorageType         & storage,
+                             viennamath::function_symbol const & u,
+                             FluxHandlerType     & flux,
+                             JITExpressionType   & jit_matrix,
+                             JITExpressionType   & jit_stabilization,
+                             JITExpressionType   & jit_rhs,
+                             MatrixT             & system_matrix,
+                             VectorT             & load_vector)
+      {
+        typedef typename viennagrid::result_of::cell_tag<SegmentT>::type CellTag;
+        typedef typename viennagrid::result_of::facet_tag<CellTag>::type FacetTag;
+
+        typedef typename viennagrid::result_of::element<SegmentT, FacetTag>::type                FacetType;
+        typedef typename viennagrid::result_of::element<SegmentT, CellTag  >::type                CellType;
+
+        typedef typename viennagrid::result_of::const_element_range<SegmentT, CellTag>::type    CellContainer;
+        typedef typename viennagrid::result_of::iterator<CellContainer>::type                      CellIterator;
+
+        typedef typename viennagrid::result_of::const_element_range<CellType, FacetTag>::type  FacetOnCellContainer;
+        typedef typename viennagrid::result_of::iterator<FacetOnCellContainer>::type               FacetOnCellIterator;
+
+        typename viennadata::result_of::accessor<StorageType, viennafvm::mapping_key, long, CellType>::type cell_mapping_accessor =
+            viennadata::make_accessor(storage, viennafvm::mapping_key(u.id()));
+
+        typename viennadata::result_of::accessor<StorageType, viennafvm::facet_area_key, double, FacetType>::type facet_area_accessor =
+            viennadata::make_accessor(storage, viennafvm::facet_area_key());
+
+        typename viennadata::result_of::accessor<StorageType, viennafvm::boundary_key, double, CellType>::type boundary_accessor =
+            viennadata::make_accessor(storage, viennafvm::boundary_key(u.id()));
+
+        typename viennadata::result_of::accessor<StorageType, viennafvm::current_iterate_key, double, CellType>::type current_iterate_accessor =
+            viennadata::make_accessor(storage, viennafvm::current_iterate_key(u.id()));
+
+        typename viennadata::result_of::accessor<StorageType, facet_distance_key, double, FacetType>::type facet_distance_accessor =
+            viennadata::make_accessor(storage, facet_distance_key());
+
+        // the assembled cells and, per cell, the range of its fluxes:
+        std::vector<CellType const *>  rows;
+        std::vector<std::size_t>       flux_offsets(1, 0);
+        std::vector<FacetType const *> flux_facets;
+        std::vector<CellType const *>  flux_outer_cells;
+
+        //
+        // Gather the quantities, the gradients on the facets are set up for each flux as in the interpreted assembly
+        //
+        CellContainer cells(segment);
+        for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        {
+          if (cell_mapping_accessor(*cit) < 0)
+            continue;
+
+          FacetOnCellContainer facets_on_cell(*cit);
+          for (FacetOnCellIterator focit  = facets_on_cell.begin();
+                                   focit != facets_on_cell.end();
+                                 ++focit)
+          {
+            CellType const * other_cell = util::other_cell_of_facet(*focit, *cit, segment);
+
+            if (other_cell)
+            {
+              long col_index = cell_mapping_accessor(*other_cell);
+
+              for (std::size_t i=0; i<pde_system.size(); ++i)
+                compute_gradients_for_cell(*cit, *focit, *other_cell,
+                                           viennadata::make_accessor<current_iterate_key, double, CellType>(storage, current_iterate_key(pde_system.unknown(i)[0].id())),
+                                           viennadata::make_accessor<current_iterate_key, double, FacetType>(storage, current_iterate_key(pde_system.unknown(i)[0].id())),
+                                           facet_distance_accessor);
+
+              if (col_index == viennafvm::DIRICHLET_BOUNDARY || col_index >= 0)
+              {
+                flux.gather(*cit, *focit, *other_cell);
+                flux_facets.push_back(&(*focit));
+                flux_outer_cells.push_back(other_cell);
+              }
+            }
+          }
+
+          jit_matrix.push_back(*cit, NULL);
+          jit_stabilization.push_back(*cit, NULL);
+          jit_rhs.push_back(*cit, NULL);
+
+          rows.push_back(&(*cit));
+          flux_offsets.push_back(flux_facets.size());
+        }
+
+        flux.evaluate();
+        jit_matrix.evaluate();
+        jit_stabilization.evaluate();
+        jit_rhs.evaluate();
+
+        //
+        // Write the contributions
+        //
+        for (std::size_t r = 0; r < rows.size(); ++r)
+        {
+          CellType const & cell = *rows[r];
+          long row_index = cell_mapping_accessor(cell);
+
+          for (std::size_t k = flux_offsets[r]; k < flux_offsets[r+1]; ++k)
+          {
+            FacetType const & facet      = *flux_facets[k];
+            CellType  const & other_cell = *flux_outer_cells[k];
+
+            long   col_index            = cell_mapping_accessor(other_cell);
+            double effective_facet_area = facet_area_accessor(facet);
+            double d                    = facet_distance_accessor(facet);
+            double flux_in              = flux.in(k, d);
+            double flux_out             = flux.out(k, d);
+
+            if (col_index == viennafvm::DIRICHLET_BOUNDARY)
+            {
+              double boundary_value = boundary_accessor(other_cell);
+              double current_value  = current_iterate_accessor(cell);
+
+              load_vector(row_index)              -= flux_out * effective_facet_area * (boundary_value - current_value);
+              system_matrix(row_index, row_index) -= flux_in * effective_facet_area;
+
+              load_vector(row_index) -= flux_out * effective_facet_area * current_value;
+              load_vector(row_index) += flux_in * effective_facet_area * current_iterate_accessor(cell);
+            }
+            else
+            {
+              system_matrix(row_index, col_index) += flux_out * effective_facet_area;
+              system_matrix(row_index, row_index) -= flux_in * effective_facet_area;
+
+              load_vector(row_index) -= flux_out * effective_facet_area * current_iterate_accessor(other_cell);
+              load_vector(row_index) += flux_in * effective_facet_area * current_iterate_accessor(cell);
+            }
+          }
+
+          double cell_volume      = viennagrid::volume(cell);
+
+          system_matrix(row_index, row_index) += jit_matrix[r] * cell_volume;
+          load_vector(row_index) -= jit_matrix[r] * cell_volume * current_iterate_accessor(cell);
+
+          system_matrix(row_index, row_index) += jit_stabilization[r] * cell_volume;
+
+          load_vector(row_index) += jit_rhs[r] * cell_volume;
+        }
+      }
+
       template <typename SegmentT, typename StorageType>
       void setup(SegmentT const & segment, StorageType & storage)
+      {
+        setup(segment, storage, typename viennagrid::result_of::cell_tag<SegmentT>::type());
+      }
+
+      // triangles and tetrahedra: the cells of the facets are taken from a compact snapshot of the mesh,
+      // which is cheaper than a coboundary query per facet
+      template <typename SegmentT, typename StorageType>
+      void setup(SegmentT const & segment, StorageType & storage, viennagrid::triangle_tag)
+      {
+        setup_compact(segment, storage);
+      }
+
+      template <typename SegmentT, typename StorageType>
+      void setup(SegmentT const & segment, StorageType & storage, viennagrid::tetrahedron_tag)
+      {
+        setup_compact(segment, storage);
+      }
+
+      template <typename SegmentT, typename StorageType>
+      void setup_compact(SegmentT const & segment, StorageType & storage)
+      {
+        typedef viennagrid::compact_mesh<SegmentT>                                               CompactMeshType;
+        typedef typename CompactMeshType::index_type                                             IndexType;
+        typedef typename CompactMeshType::point_type                                             PointType;
+        typedef typename CompactMeshType::facet_tag                                              FacetTag;
+
+        typedef typename viennagrid::result_of::element<SegmentT, FacetTag>::type               FacetType;
+        typedef typename viennagrid::result_of::const_element_range<SegmentT, FacetTag>::type   FacetContainer;
+        typedef typename viennagrid::result_of::iterator<FacetContainer>::type                  FacetIterator;
+
+        typename viennadata::result_of::accessor<StorageType, viennafvm::facet_area_key, double, FacetType>::type facet_area_accessor =
+            viennadata::make_accessor(storage, viennafvm::facet_area_key());
+
+        typename viennadata::result_of::accessor<StorageType, viennafvm::facet_distance_key, double, FacetType>::type facet_distance_accessor =
+            viennadata::make_accessor(storage, viennafvm::facet_distance_key());
+
+        // the centroid of each cell is needed for each of its facets, hence it is computed once
+        CompactMeshType compact(segment);
+        std::vector<PointType> centroids(compact.cell_count());
+        for (IndexType c = 0; c < static_cast<IndexType>(compact.cell_count()); ++c)
+          centroids[c] = viennagrid::centroid(compact, c);
+
+        // the facets of the snapshot are numbered in the order of the facet range
+        FacetContainer facets(segment);
+        IndexType f = 0;
+        for (FacetIterator fit = facets.begin(); fit != facets.end(); ++fit, ++f)
+        {
+          if (compact.is_boundary_facet(f))
+            continue;
+
+          IndexType const * cells = compact.facet_cells(f);
+
+          PointType center_connection  = centroids[cells[0]] - centroids[cells[1]];
+          PointType outer_normal       = util::unit_outer_normal(compact, f, cells[1]); //note: consistent orientation of center_connection and outer_normal is important here!
+
+          double center_connection_len = viennagrid::norm(center_connection);
+          double effective_facet_ratio = viennagrid::inner_prod(center_connection, outer_normal) / center_connection_len;  // inner product of unit vectors
+          double effective_facet_area  = viennagrid::facet_volume(compact, f) * effective_facet_ratio;
+
+          facet_area_accessor(*fit) = effective_facet_area;
+          facet_distance_accessor(*fit) = center_connection_len;
+        }
+      }
+
+      template <typename SegmentT, typename StorageType, typename CellTagT>
+      void setup(SegmentT const & segment, StorageType & storage, CellTagT)
       {
         typedef typename SegmentT::config_type                config_type;
         typedef viennamath::equation                          equ_type;
@@ -381,6 +631,9 @@ namespace viennafvm
           }
         }
     }
+
+      jit_compiler * jit_;
+      bool           prepared_;
   };
 
   template <typename InterfaceType, typename SegmentT, typename MatrixT, typename VectorT>
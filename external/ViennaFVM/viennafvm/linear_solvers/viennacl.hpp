@@ -17,6 +17,9 @@
 
 #include <map>
 #include <vector>
+#include <string>
+#include <sstream>
+#include <iomanip>
 
 #ifndef VIENNACL_HAVE_UBLAS
  #define VIENNACL_HAVE_UBLAS
@@ -31,6 +34,11 @@
 #include "viennacl/linalg/jacobi_precond.hpp"
 #include "viennacl/linalg/row_scaling.hpp"
 #include "viennafvm/timer.hpp"
+#include "viennafvm/solver_observer.hpp"
+#include "viennafvm/cancellation.hpp"
+#include "viennafvm/profiler.hpp"
+#include "viennafvm/log.hpp"
+#include "viennafvm/io/system_capture.hpp"
 
 namespace viennafvm {
 
@@ -62,11 +70,77 @@ struct viennacl
     };
   };
 
+  /** @brief Solver and preconditioner overriding the defaults for the systems of a single PDE */
+  struct pde_settings
+  {
+    pde_settings() : solver(-1), preconditioner(-1) {}
+    pde_settings(long solver_id, long pc_id) : solver(solver_id), preconditioner(pc_id) {}
+
+    long solver;
+    long preconditioner;
+  };
+
+  typedef std::map<std::size_t, pde_settings>   PDESettingsType;
+
   viennacl() : pc_id_(viennafvm::linsolv::viennacl::preconditioner_ids::ilu0), 
                solver_id_(viennafvm::linsolv::viennacl::solver_ids::bicgstab), 
                break_tolerance_(1.0e-14),
-               max_iterations_(1000)
+               max_iterations_(1000),
+               last_iterations_(0),
+               last_error_(0),
+               last_pc_time_(0),
+               last_solver_time_(0),
+               observer_(NULL),
+               cancel_(NULL),
+               current_pde_(0),
+               max_captures_(0)
+  {
+  }
+
+  /** @brief Maps a solver name ("cg", "bicgstab", "gmres") to its id, returns -1 for unknown names */
+  static long solver_id(std::string const& name)
   {
+    if(name == "cg")        return solver_ids::cg;
+    if(name == "bicgstab")  return solver_ids::bicgstab;
+    if(name == "gmres")     return solver_ids::gmres;
+    return -1;
+  }
+
+  /** @brief Maps a preconditioner name ("none", "ilu0", "ilut", "block_ilu", "jacobi", "row_scaling") to its id, returns -1 for unknown names */
+  static long preconditioner_id(std::string const& name)
+  {
+    if(name == "none")        return preconditioner_ids::none;
+    if(name == "ilu0")        return preconditioner_ids::ilu0;
+    if(name == "ilut")        return preconditioner_ids::ilut;
+    if(name == "block_ilu")   return preconditioner_ids::block_ilu;
+    if(name == "jacobi")      return preconditioner_ids::jacobi;
+    if(name == "row_scaling") return preconditioner_ids::row_scaling;
+    return -1;
+  }
+
+  static std::string solver_name(long id)
+  {
+    switch(id)
+    {
+      case solver_ids::cg:        return "cg";
+      case solver_ids::bicgstab:  return "bicgstab";
+      case solver_ids::gmres:     return "gmres";
+      default:                    return "unknown";
+    }
+  }
+
+  static std::string preconditioner_name(long id)
+  {
+    switch(id)
+    {
+      case preconditioner_ids::none:        return "none";
+      case preconditioner_ids::ilu0:        return "ilu0";
+      case preconditioner_ids::ilut:        return "ilut";
+      case preconditioner_ids::block_ilu:   return "block_ilu";
+      case preconditioner_ids::jacobi:      return "jacobi";
+      case preconditioner_ids::row_scaling: return "row_scaling";
+      default:                              return "unknown";
+    }
   }
 
   long&         preconditioner()    { return pc_id_;           }
@@ -79,73 +153,127 @@ struct viennacl
   float         last_pc_time()      { return last_pc_time_;    }
   float         last_solver_time()  { return last_solver_time_;}
 
+  /** @brief Returns the record of the last solve, as it has been reported to the observer */
+  linear_solve_record const& last_record() { return last_record_; }
+
+  /** @brief Registers an observer which is notified after each solve. The observer is not owned. */
+  void set_observer(solver_observer* observer) { observer_ = observer; }
+
+  /** @brief Registers a token, which is checked before the preconditioner setup, before the Krylov solve and
+             within each Krylov iteration. A cancelled solve throws a viennafvm::cancelled_exception. The token
+             is not owned, NULL disables the checks. */
+  void set_cancellation_token(cancellation_token const* token) { cancel_ = token; }
+
+  /** @brief Uses the given solver and preconditioner for the systems of the PDE 'pde_index' instead of the defaults */
+  void set_pde_settings(std::size_t pde_index, long solver, long preconditioner)
+  {
+    pde_settings_[pde_index] = pde_settings(solver, preconditioner);
+  }
+  void clear_pde_settings() { pde_settings_.clear(); }
+  PDESettingsType const& get_pde_settings() { return pde_settings_; }
+
+  /** @brief Selects the PDE the following systems belong to, called by the pde_solver before each solve */
+  void select_pde(std::size_t pde_index) { current_pde_ = pde_index; }
+
+  /** @brief Enables the capture mode, the first 'max_captures' systems of each PDE are written
+             to '<prefix>_pde<index>_<number>.mtx' before they are solved, see viennafvm::io::write_system().
+             An empty prefix disables the capture mode. */
+  void set_capture(std::string const& prefix, std::size_t max_captures = 4)
+  {
+    capture_prefix_ = prefix;
+    max_captures_   = max_captures;
+    capture_counts_.clear();
+  }
+
   template <typename MatrixT, typename VectorT>
   void operator()(MatrixT& A, VectorT& b, VectorT& x)
   {
+    VIENNAUTILS_PROFILE_SCOPE("viennafvm::linear_solve");
+
+    viennafvm::check_cancellation(cancel_);
+
+    if(!capture_prefix_.empty())
+      capture_system(A, b);
+
+    long solver_id = solver_id_;
+    long pc_id     = pc_id_;
+    PDESettingsType::const_iterator settings = pde_settings_.find(current_pde_);
+    if(settings != pde_settings_.end())
+    {
+      if(settings->second.solver >= 0)         solver_id = settings->second.solver;
+      if(settings->second.preconditioner >= 0) pc_id     = settings->second.preconditioner;
+    }
+
+    VIENNAUTILS_PROFILE_SCOPE_NAMED(normalize_scope, "viennafvm::row_normalization");
     row_normalize_system(A, b); 
+    VIENNAUTILS_PROFILE_STOP(normalize_scope);
 
     //
     // Determine the linear solver kernel and forward to an internal solve method
     // which determines the preconditioner and actually calls the solver backend
     //
-    if(solver_id_ == viennafvm::linsolv::viennacl::solver_ids::bicgstab)
+    if(solver_id == viennafvm::linsolv::viennacl::solver_ids::bicgstab)
     {
 //      std::cout << "using solver: bicgstab .. " << std::endl;
       ::viennacl::linalg::bicgstab_tag  solver_tag(break_tolerance_, max_iterations_);
-      solve_intern(A, b, x, solver_tag);
+      solve_intern(A, b, x, solver_tag, solver_id, pc_id);
     }
     else
-    if(solver_id_ == viennafvm::linsolv::viennacl::solver_ids::gmres)
+    if(solver_id == viennafvm::linsolv::viennacl::solver_ids::gmres)
     {
 //      std::cout << "using solver: gmres .. " << std::endl;
       ::viennacl::linalg::gmres_tag     solver_tag(break_tolerance_, max_iterations_);
-      solve_intern(A, b, x, solver_tag);
+      solve_intern(A, b, x, solver_tag, solver_id, pc_id);
     }
     else
-    if(solver_id_ == viennafvm::linsolv::viennacl::solver_ids::cg)
+    if(solver_id == viennafvm::linsolv::viennacl::solver_ids::cg)
     {
 //      std::cout << "using solver: cg .. " << std::endl;
       ::viennacl::linalg::cg_tag        solver_tag(break_tolerance_, max_iterations_);
-      solve_intern(A, b, x, solver_tag);
+      solve_intern(A, b, x, solver_tag, solver_id, pc_id);
     }
     else
     {
-      std::cerr << "[ERROR] ViennaFVM::LinearSolver: solver not supported .. " << std::endl;
+      viennafvm::log::err() << "[ERROR] ViennaFVM::LinearSolver: solver not supported .. " << std::endl;
     }
   }
 
 private:
 
   template <typename MatrixT, typename VectorT, typename LinerSolverT>
-  void solve_intern(MatrixT& A, VectorT& b, VectorT& x, LinerSolverT& linear_solver)
+  void solve_intern(MatrixT& A, VectorT& b, VectorT& x, LinerSolverT& linear_solver, long solver_id, long pc_id)
   {
     viennafvm::Timer timer;
 
-    if(pc_id_ == viennafvm::linsolv::viennacl::preconditioner_ids::none)
+    if(pc_id == viennafvm::linsolv::viennacl::preconditioner_ids::none)
     {
 //      std::cout << "using pc: none .. " << std::endl;
       last_pc_time_ = 0.0;
       timer.start();
-      x = ::viennacl::linalg::solve(A, b, linear_solver);
+      VIENNAUTILS_PROFILE_SCOPE("viennafvm::krylov_solve");
+      x = krylov_solve(A, b, linear_solver, ::viennacl::linalg::no_precond());
       last_solver_time_ = timer.get();
     }
     else
-    if(pc_id_ == viennafvm::linsolv::viennacl::preconditioner_ids::ilu0)
+    if(pc_id == viennafvm::linsolv::viennacl::preconditioner_ids::ilu0)
     {
 //      std::cout << "using pc: ilu0 .. " << std::endl;
       ::viennacl::linalg::ilu0_tag pc_config;
       pc_config.use_level_scheduling(false);
 
       timer.start();
+      VIENNAUTILS_PROFILE_SCOPE_NAMED(pc_scope, "viennafvm::preconditioner_setup");
       ::viennacl::linalg::ilu0_precond<MatrixT>    preconditioner(A, pc_config);
+      VIENNAUTILS_PROFILE_STOP(pc_scope);
       last_pc_time_ = timer.get();
 
       timer.start();
-      x = ::viennacl::linalg::solve(A, b, linear_solver, preconditioner);
+      VIENNAUTILS_PROFILE_SCOPE("viennafvm::krylov_solve");
+      x = krylov_solve(A, b, linear_solver, preconditioner);
       last_solver_time_ = timer.get();
     }
     else
-    if(pc_id_ == viennafvm::linsolv::viennacl::preconditioner_ids::ilut)
+    if(pc_id == viennafvm::linsolv::viennacl::preconditioner_ids::ilut)
     {
 //      std::cout << "using pc: ilut .. " << std::endl;
       ::viennacl::linalg::ilut_tag pc_config;
@@ -154,59 +282,126 @@ private:
       pc_config.use_level_scheduling(false);
 
       timer.start();
+      VIENNAUTILS_PROFILE_SCOPE_NAMED(pc_scope, "viennafvm::preconditioner_setup");
       ::viennacl::linalg::ilut_precond<MatrixT>    preconditioner(A, pc_config);
+      VIENNAUTILS_PROFILE_STOP(pc_scope);
       last_pc_time_ = timer.get();
 
       timer.start();
-      x = ::viennacl::linalg::solve(A, b, linear_solver, preconditioner);
+      VIENNAUTILS_PROFILE_SCOPE("viennafvm::krylov_solve");
+      x = krylov_solve(A, b, linear_solver, preconditioner);
       last_solver_time_ = timer.get();
     }
     else
-    if(pc_id_ == viennafvm::linsolv::viennacl::preconditioner_ids::block_ilu)
+    if(pc_id == viennafvm::linsolv::viennacl::preconditioner_ids::block_ilu)
     {
 //      std::cout << "using pc: block ilu .. " << std::endl;
       ::viennacl::linalg::ilu0_tag pc_config;
       pc_config.use_level_scheduling(false);
 
       timer.start();
+      VIENNAUTILS_PROFILE_SCOPE_NAMED(pc_scope, "viennafvm::preconditioner_setup");
       ::viennacl::linalg::block_ilu_precond<MatrixT, ::viennacl::linalg::ilu0_tag>    preconditioner(A, pc_config);
+      VIENNAUTILS_PROFILE_STOP(pc_scope);
       last_pc_time_ = timer.get();
 
       timer.start();
-      x = ::viennacl::linalg::solve(A, b, linear_solver, preconditioner);
+      VIENNAUTILS_PROFILE_SCOPE("viennafvm::krylov_solve");
+      x = krylov_solve(A, b, linear_solver, preconditioner);
       last_solver_time_ = timer.get();
     }
     else
-    if(pc_id_ == viennafvm::linsolv::viennacl::preconditioner_ids::jacobi)
+    if(pc_id == viennafvm::linsolv::viennacl::preconditioner_ids::jacobi)
     {
 //      std::cout << "using pc: jacobi .. " << std::endl;
       timer.start();
+      VIENNAUTILS_PROFILE_SCOPE_NAMED(pc_scope, "viennafvm::preconditioner_setup");
       ::viennacl::linalg::jacobi_precond<MatrixT>    preconditioner(A, ::viennacl::linalg::jacobi_tag());
+      VIENNAUTILS_PROFILE_STOP(pc_scope);
       last_pc_time_ = timer.get();
 
       timer.start();
-      x = ::viennacl::linalg::solve(A, b, linear_solver, preconditioner);
+      VIENNAUTILS_PROFILE_SCOPE("viennafvm::krylov_solve");
+      x = krylov_solve(A, b, linear_solver, preconditioner);
       last_solver_time_ = timer.get();
     }
     else
-    if(pc_id_ == viennafvm::linsolv::viennacl::preconditioner_ids::row_scaling)
+    if(pc_id == viennafvm::linsolv::viennacl::preconditioner_ids::row_scaling)
     {
 //      std::cout << "using pc: row_scaling .. " << std::endl;
       timer.start();
+      VIENNAUTILS_PROFILE_SCOPE_NAMED(pc_scope, "viennafvm::preconditioner_setup");
       ::viennacl::linalg::row_scaling<MatrixT>    preconditioner(A, ::viennacl::linalg::row_scaling_tag());
+      VIENNAUTILS_PROFILE_STOP(pc_scope);
       last_pc_time_ = timer.get();
 
       timer.start();
-      x = ::viennacl::linalg::solve(A, b, linear_solver, preconditioner);
+      VIENNAUTILS_PROFILE_SCOPE("viennafvm::krylov_solve");
+      x = krylov_solve(A, b, linear_solver, preconditioner);
       last_solver_time_ = timer.get();
     }
     else
     {
-      std::cerr << "[ERROR] ViennaFVM::LinearSolver: preconditioner not supported .. " << std::endl;
+      viennafvm::log::err() << "[ERROR] ViennaFVM::LinearSolver: preconditioner not supported .. " << std::endl;
       return;
     }
     last_iterations_ = linear_solver.iters();
     last_error_      = linear_solver.error();
+
+    last_record_.size           = b.size();
+    last_record_.solver         = solver_id;
+    last_record_.preconditioner = pc_id;
+    last_record_.iterations     = last_iterations_;
+    last_record_.max_iterations = max_iterations_;
+    last_record_.error          = last_error_;
+    last_record_.pc_time        = last_pc_time_;
+    last_record_.solver_time    = last_solver_time_;
+
+    if(observer_) observer_->on_linear_solve(last_record_);
+  }
+
+  /** @brief Applies the preconditioner, but checks the cancellation token before. As the Krylov solvers
+             apply the preconditioner in each iteration, this makes them cancellable without modifying them */
+  template <typename PreconditionerT>
+  class cancellable_preconditioner
+  {
+  public:
+    cancellable_preconditioner(PreconditionerT const& preconditioner, cancellation_token const& token)
+      : preconditioner_(preconditioner), token_(token) {}
+
+    template <typename VectorT>
+    void apply(VectorT& vec) const
+    {
+      viennafvm::check_cancellation(&token_);
+      preconditioner_.apply(vec);
+    }
+
+  private:
+    PreconditionerT const&      preconditioner_;
+    cancellation_token const&   token_;
+  };
+
+  template <typename MatrixT, typename VectorT, typename SolverTagT, typename PreconditionerT>
+  VectorT krylov_solve(MatrixT const& A, VectorT const& b, SolverTagT const& solver_tag, PreconditionerT const& preconditioner)
+  {
+    if(!cancel_)
+      return ::viennacl::linalg::solve(A, b, solver_tag, preconditioner);
+
+    // the preconditioner setup may have taken a while ..
+    viennafvm::check_cancellation(cancel_);
+    return ::viennacl::linalg::solve(A, b, solver_tag, cancellable_preconditioner<PreconditionerT>(preconditioner, *cancel_));
+  }
+
+  template <typename MatrixT, typename VectorT>
+  void capture_system(MatrixT const& A, VectorT const& b)
+  {
+    std::size_t& count = capture_counts_[current_pde_];
+    if(count >= max_captures_) return;
+
+    std::stringstream name;
+    name << capture_prefix_ << "_pde" << current_pde_ << "_" << std::setw(4) << std::setfill('0') << count++;
+    if(!viennafvm::io::write_system(A, b, name.str()))
+      viennafvm::log::err() << "[Warning] ViennaFVM::LinearSolver: capturing the system to " << name.str() << " failed" << std::endl;
   }
 
 
@@ -257,6 +452,16 @@ private:
   float       last_pc_time_;
   float       last_solver_time_;
 
+  linear_solve_record last_record_;
+  solver_observer*    observer_;
+  cancellation_token const* cancel_;
+
+  PDESettingsType     pde_settings_;
+  std::size_t         current_pde_;
+
+  std::string                         capture_prefix_;
+  std::size_t                         max_captures_;
+  std::map<std::size_t, std::size_t>  capture_counts_;
 };
 
 
@@ -0,0 +1,47 @@
+#ifndef VIENNAFVM_LOG_HPP
+#define VIENNAFVM_LOG_HPP
+
+/* =======================================================================
+   Copyright (c) 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+           ViennaFVM - The Vienna Finite Volume Method Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+// ViennaFVM writes its messages to viennafvm::log::out() and viennafvm::log::err(). By default,
+// these are the standard streams and ViennaFVM does not depend on ViennaUtils. If
+// VIENNAFVM_WITH_VIENNAUTILS is defined, they are the per-thread log streams of ViennaUtils,
+// which can be redirected to a sink by the application, e.g. via viennautils::log::scoped_sink.
+//
+#ifdef VIENNAFVM_WITH_VIENNAUTILS
+  #include "viennautils/log.hpp"
+
+  namespace viennafvm
+  {
+    namespace log
+    {
+      using viennautils::log::out;
+      using viennautils::log::err;
+    }
+  }
+#else
+  #include <iostream>
+
+  namespace viennafvm
+  {
+    namespace log
+    {
+      inline std::ostream & out() { return std::cout; }
+      inline std::ostream & err() { return std::cerr; }
+    }
+  }
+#endif
+
+#endif // VIENNAFVM_LOG_HPP
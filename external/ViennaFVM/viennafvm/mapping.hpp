@@ -156,6 +156,36 @@ long create_mapping(LinPdeSysT & pde_system,
 }
 
 
+/** @brief Stores the mapping indices of the quantity associated with 'pde_index' in 'indices' (in cell iteration order)
+*
+*/
+template <typename LinPdeSysT, typename DomainType, typename StorageType>
+void backup_mapping(LinPdeSysT const & pde_system,
+                    std::size_t  pde_index,
+                    DomainType const & domain,
+                    StorageType & storage,
+                    std::vector<long> & indices)
+{
+  typedef typename viennagrid::result_of::cell_tag<DomainType>::type CellTag;
+  typedef typename viennagrid::result_of::element<DomainType, CellTag>::type    CellType;
+
+  typedef typename viennagrid::result_of::const_element_range<DomainType, CellTag>::type   CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type                       CellIterator;
+
+  typedef typename LinPdeSysT::mapping_key_type   MappingKeyType;
+
+  typename viennadata::result_of::accessor<StorageType, MappingKeyType, long, CellType>::type cell_mapping_accessor =
+      viennadata::make_accessor(storage, MappingKeyType(pde_system.unknown(pde_index)[0].id()));
+
+  CellContainer cells(domain);
+  indices.resize(cells.size());
+
+  std::size_t i = 0;
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+    indices[i++] = cell_mapping_accessor(*cit);
+}
+
+
 } // end namespace viennafvm
 
 #endif
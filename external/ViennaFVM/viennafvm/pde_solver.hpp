@@ -15,15 +15,20 @@
    license:    see file LICENSE in the ViennaFVM base directory
 ======================================================================= */
 
+#include <vector>
+#include <algorithm>
+
 #include <boost/numeric/ublas/io.hpp>
 #include <boost/numeric/ublas/matrix_sparse.hpp>
 #include <boost/numeric/ublas/operation.hpp>
 #include <boost/numeric/ublas/operation_sparse.hpp>
 
-#ifdef VIENNAFVM_VERBOSE
 #include "viennafvm/timer.hpp"
-#endif
 #include "viennafvm/forwards.h"
+#include "viennafvm/solver_observer.hpp"
+#include "viennafvm/cancellation.hpp"
+#include "viennafvm/profiler.hpp"
+#include "viennafvm/log.hpp"
 #include "viennafvm/linear_assembler.hpp"
 #include "viennafvm/linear_solvers/viennacl.hpp"
 
@@ -175,6 +180,54 @@ namespace viennafvm
   }
 
 
+  /** @brief Stores the current iterate of the quantity associated with 'pde_index' in 'values' (in cell iteration order) */
+  template <typename PDESystemType, typename DomainType, typename StorageType>
+  void backup_iterate(PDESystemType const & pde_system, std::size_t pde_index,
+                      DomainType const & domain,
+                      StorageType & storage,
+                      std::vector<numeric_type> & values)
+  {
+    typedef typename viennagrid::result_of::cell_tag<DomainType>::type CellTag;
+    typedef typename viennagrid::result_of::element<DomainType, CellTag>::type    CellType;
+
+    typedef typename viennagrid::result_of::const_element_range<DomainType, CellTag>::type   CellContainer;
+    typedef typename viennagrid::result_of::iterator<CellContainer>::type                       CellIterator;
+
+    typename viennadata::result_of::accessor<StorageType, viennafvm::current_iterate_key, double, CellType>::type current_iterate_accessor =
+        viennadata::make_accessor(storage, viennafvm::current_iterate_key(pde_system.unknown(pde_index)[0].id()));
+
+    CellContainer cells(domain);
+    values.resize(cells.size());
+
+    std::size_t i = 0;
+    for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+      values[i++] = current_iterate_accessor(*cit);
+  }
+
+  /** @brief Writes an iterate previously stored by backup_iterate() back to the storage */
+  template <typename PDESystemType, typename DomainType, typename StorageType>
+  void restore_iterate(PDESystemType const & pde_system, std::size_t pde_index,
+                       DomainType const & domain,
+                       StorageType & storage,
+                       std::vector<numeric_type> const & values)
+  {
+    typedef typename viennagrid::result_of::cell_tag<DomainType>::type CellTag;
+    typedef typename viennagrid::result_of::element<DomainType, CellTag>::type    CellType;
+
+    typedef typename viennagrid::result_of::const_element_range<DomainType, CellTag>::type   CellContainer;
+    typedef typename viennagrid::result_of::iterator<CellContainer>::type                       CellIterator;
+
+    typename viennadata::result_of::accessor<StorageType, viennafvm::current_iterate_key, double, CellType>::type current_iterate_accessor =
+        viennadata::make_accessor(storage, viennafvm::current_iterate_key(pde_system.unknown(pde_index)[0].id()));
+
+    CellContainer cells(domain);
+
+    std::size_t i = 0;
+    for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+      current_iterate_accessor(*cit) = values[i++];
+  }
+
+
   template<typename MatrixType = boost::numeric::ublas::compressed_matrix<viennafvm::numeric_type>,
            typename VectorType = boost::numeric::ublas::vector<viennafvm::numeric_type> >
   class pde_solver
@@ -188,81 +241,114 @@ namespace viennafvm
         nonlinear_iterations  = 100;
         nonlinear_breaktol    = 1.0e-3;
         damping               = 1.0;
+        adaptive_damping      = false;
+        min_damping           = 1.0e-3;
+        max_backtracking_steps = 8;
+        converged_            = false;
+        required_nonlinear_iterations_ = 0;
+        observer_             = NULL;
+        cancel_               = NULL;
+        cancelled_            = false;
+        jit_                  = NULL;
+        checkpoint_           = NULL;
+        continued_iterations_ = 0;
       }
 
       template<typename PDESystemT, typename DomainT, typename StorageT, typename LinearSolverT>
       void operator()(PDESystemT const & pde_system, DomainT const & domain, StorageT & storage, LinearSolverT& linear_solver, std::size_t break_pde = 0)
       {
+        VIENNAUTILS_PROFILE_SCOPE("viennafvm::pde_solver");
+
+        // the facet geometry only depends on the mesh, hence it is computed once for all assemblies of this solve
+        viennafvm::linear_assembler(jit_).prepare(domain, storage);
+
       #ifdef VIENNAFVM_VERBOSE
-        std::streamsize cout_precision = std::cout.precision();
+        std::streamsize cout_precision = viennafvm::log::out().precision();
       #endif
 
         bool is_linear = pde_system.is_linear(); //TODO: Replace with an automatic detection
 
+        cancelled_ = false;
+
         if (is_linear)
         {
           for (std::size_t pde_index = 0; pde_index < pde_system.size(); ++pde_index)
           {
+            if (cancellation_requested()) break;
+
+            iteration_record record;
+            record.pde_index = pde_index;
+
           #ifdef VIENNAFVM_VERBOSE
             viennafvm::Timer timer;
             timer.start();
-            std::cout << " * Quantity " << pde_index << " : " << std::endl;
-            std::cout << " ------------------------------------------" << std::endl;
+            viennafvm::log::out() << " * Quantity " << pde_index << " : " << std::endl;
+            viennafvm::log::out() << " ------------------------------------------" << std::endl;
           #endif
 
             MatrixType system_matrix;
             VectorType load_vector;
 
-          #ifdef VIENNAFVM_VERBOSE
             viennafvm::Timer subtimer;
             subtimer.start();
-          #endif
-            viennafvm::linear_assembler fvm_assembler;
+            VIENNAUTILS_PROFILE_SCOPE_NAMED(assembly_scope, "viennafvm::assembly");
+            viennafvm::linear_assembler fvm_assembler(jit_, true);
             fvm_assembler(pde_system, domain, storage, system_matrix, load_vector);
+            VIENNAUTILS_PROFILE_STOP(assembly_scope);
+            if (cancellation_requested()) break;
+            record.assembly_time = subtimer.get();
           #ifdef VIENNAFVM_VERBOSE
-            std::cout.precision(3);
-            subtimer.get();
-            std::cout << "   Assembly time : " << std::fixed << subtimer.get() << " s" << std::endl;
+            viennafvm::log::out().precision(3);
+            viennafvm::log::out() << "   Assembly time : " << std::fixed << record.assembly_time << " s" << std::endl;
           #endif
 
+            record.residual_norm = boost::numeric::ublas::norm_2(load_vector);
+
             VectorType update;
-            linear_solver(system_matrix, load_vector, update);
+            linear_solver.select_pde(pde_index);
+            if (!solve_linear_system(linear_solver, system_matrix, load_vector, update)) break;
+            record.linear_solve = linear_solver.last_record();
           #ifdef VIENNAFVM_VERBOSE
-            std::cout << "   Precond time  : " << std::fixed << linear_solver.last_pc_time() << " s" << std::endl;
-            std::cout << "   Solver time   : " << std::fixed << linear_solver.last_solver_time() << " s" << std::endl;
+            viennafvm::log::out() << "   Precond time  : " << std::fixed << linear_solver.last_pc_time() << " s" << std::endl;
+            viennafvm::log::out() << "   Solver time   : " << std::fixed << linear_solver.last_solver_time() << " s" << std::endl;
           #endif
 
-          #ifdef VIENNAFVM_VERBOSE
             subtimer.start();
+            VIENNAUTILS_PROFILE_SCOPE_NAMED(update_scope, "viennafvm::update");
             numeric_type update_norm = apply_update(pde_system, pde_index, domain, storage, update, damping);
-          #else
-            apply_update(pde_system, pde_index, domain, storage, update, damping);
-          #endif
-
+            VIENNAUTILS_PROFILE_STOP(update_scope);
+            record.update_time = subtimer.get();
+            record.update_norm = update_norm;
+            record.damping     = damping;
           #ifdef VIENNAFVM_VERBOSE
-            subtimer.get();
-            std::cout << "   Update time   : " << std::fixed << subtimer.get() << " s" << std::endl;
+            viennafvm::log::out() << "   Update time   : " << std::fixed << record.update_time << " s" << std::endl;
           #endif
 
           #ifdef VIENNAFVM_VERBOSE
             timer.get();
-            std::cout << "   Total time    : " << std::fixed << timer.get() << " s" << std::endl;
+            viennafvm::log::out() << "   Total time    : " << std::fixed << timer.get() << " s" << std::endl;
 
-            std::cout.precision(cout_precision);
-            std::cout.unsetf(std::ios_base::floatfield);
+            viennafvm::log::out().precision(cout_precision);
+            viennafvm::log::out().unsetf(std::ios_base::floatfield);
 
-            std::cout << "   Solver iters  : " << linear_solver.last_iterations();
+            viennafvm::log::out() << "   Solver iters  : " << linear_solver.last_iterations();
             if(linear_solver.last_iterations() == linear_solver.max_iterations())
-              std::cout << " ( not converged ) " << std::endl;
-            else std::cout << std::endl;
+              viennafvm::log::out() << " ( not converged ) " << std::endl;
+            else viennafvm::log::out() << std::endl;
 
-            std::cout << "   Solver error  : " << linear_solver.last_error() << std::endl;
+            viennafvm::log::out() << "   Solver error  : " << linear_solver.last_error() << std::endl;
 
-            std::cout << "   Update norm   : "  << update_norm << std::endl;
+            viennafvm::log::out() << "   Update norm   : "  << update_norm << std::endl;
 
-            std::cout << std::endl;
+            viennafvm::log::out() << std::endl;
           #endif
+
+            if (observer_) observer_->on_iteration(record);
           }
+          converged_                     = !cancelled_;
+          required_nonlinear_iterations_ = 1;
+          if (observer_) observer_->on_finished(converged_, required_nonlinear_iterations_);
+
           std::size_t map_index = create_mapping(pde_system, domain, storage);
           result_.resize(map_index);
 
@@ -277,70 +363,117 @@ namespace viennafvm
         #endif
 
           bool converged = false;
-          std::size_t required_nonlinear_iterations = 0;
-          for (std::size_t iter=0; iter < nonlinear_iterations; ++iter)
+          std::size_t required_nonlinear_iterations = continued_iterations_;
+
+          // each quantity starts with the configured damping, which acts as an upper bound
+          // for the adaptive damping. A continued solve starts with the damping it was saved with
+          if (continued_damping_.size() == pde_system.size())
+            current_damping_ = continued_damping_;
+          else
+            current_damping_.assign(pde_system.size(), damping);
+          last_damping_ = current_damping_;
+
+          continued_iterations_ = 0;
+          continued_damping_.clear();
+
+          for (std::size_t iter = required_nonlinear_iterations; iter < nonlinear_iterations; ++iter)
           {
+            if (cancellation_requested()) break;
+
+            VIENNAUTILS_PROFILE_SCOPE("viennafvm::nonlinear_iteration");
             required_nonlinear_iterations++;
           #ifdef VIENNAFVM_VERBOSE
-            std::cout << " --- Nonlinear iteration " << iter << " --- " << std::endl;
+            viennafvm::log::out() << " --- Nonlinear iteration " << iter << " --- " << std::endl;
           #endif
             if (picard_iteration_)
             {
               for (std::size_t pde_index = 0; pde_index < pde_system.size(); ++pde_index)
               {
+                // a cancelled iteration leaves the remaining quantities untouched, all of them
+                // keep a valid iterate, from which the run can be resumed
+                if (cancellation_requested()) break;
+
+                iteration_record record;
+                record.nonlinear_iteration = iter;
+                record.pde_index           = pde_index;
+                record.break_quantity      = (pde_index == break_pde);
+
               #ifdef VIENNAFVM_VERBOSE
                 viennafvm::Timer timer;
                 timer.start();
-                std::cout << " * Quantity " << pde_index << " : " << std::endl;
-                std::cout << "   ------------------------------------" << std::endl;
+                viennafvm::log::out() << " * Quantity " << pde_index << " : " << std::endl;
+                viennafvm::log::out() << "   ------------------------------------" << std::endl;
               #endif
 
 
                 MatrixType system_matrix;
                 VectorType load_vector;
 
-              #ifdef VIENNAFVM_VERBOSE
                 viennafvm::Timer subtimer;
                 subtimer.start();
-              #endif
                 // assemble linearized systems
-                viennafvm::linear_assembler fvm_assembler;
+                VIENNAUTILS_PROFILE_SCOPE_NAMED(assembly_scope, "viennafvm::assembly");
+                viennafvm::linear_assembler fvm_assembler(jit_, true);
                 fvm_assembler(pde_system, pde_index, domain, storage, system_matrix, load_vector);
+                VIENNAUTILS_PROFILE_STOP(assembly_scope);
+                if (cancellation_requested()) break;
+                record.assembly_time = subtimer.get();
               #ifdef VIENNAFVM_VERBOSE
-                std::cout.precision(3);
-                subtimer.get();
-                std::cout << "   Assembly time : " << std::fixed << subtimer.get() << " s" << std::endl;
+                viennafvm::log::out().precision(3);
+                viennafvm::log::out() << "   Assembly time : " << std::fixed << record.assembly_time << " s" << std::endl;
               #endif
 
+                // the load vector holds the residual of the current iterate,
+                // the norm has to be taken before the linear solver normalizes the rows
+                numeric_type residual_norm = boost::numeric::ublas::norm_2(load_vector);
+
                 VectorType update;
-                linear_solver(system_matrix, load_vector, update);
+                linear_solver.select_pde(pde_index);
+                if (!solve_linear_system(linear_solver, system_matrix, load_vector, update)) break;
+                record.linear_solve = linear_solver.last_record();
               #ifdef VIENNAFVM_VERBOSE
-                std::cout << "   Precond time  : " << std::fixed << linear_solver.last_pc_time() << " s" << std::endl;
-                std::cout << "   Solver time   : " << std::fixed << linear_solver.last_solver_time() << " s" << std::endl;
+                viennafvm::log::out() << "   Precond time  : " << std::fixed << linear_solver.last_pc_time() << " s" << std::endl;
+                viennafvm::log::out() << "   Solver time   : " << std::fixed << linear_solver.last_solver_time() << " s" << std::endl;
               #endif
 
-              #ifdef VIENNAFVM_VERBOSE
                 subtimer.start();
-              #endif
-                numeric_type update_norm = apply_update(pde_system, pde_index, domain, storage, update, damping);
+                VIENNAUTILS_PROFILE_SCOPE_NAMED(update_scope, "viennafvm::update");
+                numeric_type update_norm;
+                std::size_t  backtracking_steps = 0;
+                if (adaptive_damping)
+                  update_norm = apply_damped_update(pde_system, pde_index, domain, storage, update, residual_norm, backtracking_steps);
+                else
+                  update_norm = apply_update(pde_system, pde_index, domain, storage, update, damping);
+                VIENNAUTILS_PROFILE_STOP(update_scope);
+                record.update_time        = subtimer.get();
+                record.residual_norm      = residual_norm;
+                record.update_norm        = update_norm;
+                record.damping            = adaptive_damping ? last_damping_[pde_index] : damping;
+                record.backtracking_steps = backtracking_steps;
               #ifdef VIENNAFVM_VERBOSE
-                subtimer.get();
-                std::cout << "   Update time   : " << std::fixed << subtimer.get() << " s" << std::endl;
+                viennafvm::log::out() << "   Update time   : " << std::fixed << record.update_time << " s" << std::endl;
               #endif
 
               #ifdef VIENNAFVM_VERBOSE
                 timer.get();
-                std::cout << "   Total time    : " << std::fixed << timer.get() << " s" << std::endl;
+                viennafvm::log::out() << "   Total time    : " << std::fixed << timer.get() << " s" << std::endl;
 
-                std::cout.precision(cout_precision);
-                std::cout.unsetf(std::ios_base::floatfield);
+                viennafvm::log::out().precision(cout_precision);
+                viennafvm::log::out().unsetf(std::ios_base::floatfield);
 
-                std::cout << "   Solver iters  : " << linear_solver.last_iterations();
+                viennafvm::log::out() << "   Solver iters  : " << linear_solver.last_iterations();
                 if(linear_solver.last_iterations() == linear_solver.max_iterations())
-                  std::cout << " ( not converged ) " << std::endl;
-                else std::cout << std::endl;
+                  viennafvm::log::out() << " ( not converged ) " << std::endl;
+                else viennafvm::log::out() << std::endl;
+
+                viennafvm::log::out() << "   Solver error  : " << linear_solver.last_error() << std::endl;
+
+                viennafvm::log::out() << "   Residual norm : " << residual_norm << std::endl;
 
-                std::cout << "   Solver error  : " << linear_solver.last_error() << std::endl;
+                viennafvm::log::out() << "   Damping       : " << last_damping_[pde_index];
+                if (backtracking_steps > 0)
+                  viennafvm::log::out() << " ( " << backtracking_steps << " backtracking steps )";
+                viennafvm::log::out() << std::endl;
 
                 std::string norm_tendency_indicator;
                 if(iter == 0)
@@ -360,15 +493,17 @@ namespace viennafvm
                   previous_update_norms[pde_index] = update_norm;
                 }
 
-                std::cout << "   Update norm   : "  << update_norm << " " << norm_tendency_indicator;
+                viennafvm::log::out() << "   Update norm   : "  << update_norm << " " << norm_tendency_indicator;
                 if(pde_index == break_pde)
-                  std::cout << " ( **** )" << std::endl;
+                  viennafvm::log::out() << " ( **** )" << std::endl;
                 else
-                  std::cout << std::endl;
+                  viennafvm::log::out() << std::endl;
 
-                std::cout << std::endl;
+                viennafvm::log::out() << std::endl;
               #endif
 
+                if (observer_) observer_->on_iteration(record);
+
                 if(pde_index == break_pde) // check if the potential update has converged ..
                 {
                     if(update_norm <= nonlinear_breaktol) converged = true;
@@ -380,30 +515,45 @@ namespace viennafvm
               throw "not implemented!";
             }
           #ifdef VIENNAFVM_VERBOSE
-            std::cout << std::endl;
+            viennafvm::log::out() << std::endl;
           #endif
-            if(converged) break; // .. the nonlinear for-loop
+            if (checkpoint_ && !cancelled_) checkpoint_->on_checkpoint(required_nonlinear_iterations);
+
+            if(converged || cancelled_) break; // .. the nonlinear for-loop
 
           } // nonlinear for-loop
 
+          converged_                     = converged && !cancelled_;
+          required_nonlinear_iterations_ = required_nonlinear_iterations;
+          if (observer_) observer_->on_finished(converged_, required_nonlinear_iterations_);
+
         #ifdef VIENNAFVM_VERBOSE
+          if(cancelled_)
+          {
+              viennafvm::log::out() << std::endl;
+              viennafvm::log::out() << "--------" << std::endl;
+              viennafvm::log::out() << "Cancelled: Simulation stopped after " << required_nonlinear_iterations << " iterations," << std::endl;
+              viennafvm::log::out() << "  the current iterate has been kept" << std::endl;
+              viennafvm::log::out() << "--------" << std::endl;
+          }
+          else
           if(converged)
           {
-              std::cout << std::endl;
-              std::cout << "--------" << std::endl;
-              std::cout << "Success: Simulation converged successfully!" << std::endl;
-              std::cout << "  Update norm of observed variable reached the break-tolerance of " << nonlinear_breaktol
+              viennafvm::log::out() << std::endl;
+              viennafvm::log::out() << "--------" << std::endl;
+              viennafvm::log::out() << "Success: Simulation converged successfully!" << std::endl;
+              viennafvm::log::out() << "  Update norm of observed variable reached the break-tolerance of " << nonlinear_breaktol
                         << " in " << required_nonlinear_iterations << " iterations" << std::endl;
-              std::cout << "--------" << std::endl;
+              viennafvm::log::out() << "--------" << std::endl;
           }
           else
           {
-              std::cout << std::endl;
-              std::cout << "--------" << std::endl;
-              std::cout << "Warning: Simulation did not converge!" << std::endl;
-              std::cout << "  Update norm of observed variable did not reach the break-tolerance of " << nonlinear_breaktol
+              viennafvm::log::out() << std::endl;
+              viennafvm::log::out() << "--------" << std::endl;
+              viennafvm::log::out() << "Warning: Simulation did not converge!" << std::endl;
+              viennafvm::log::out() << "  Update norm of observed variable did not reach the break-tolerance of " << nonlinear_breaktol
                         << " in " << nonlinear_iterations << " iterations" << std::endl;
-              std::cout << "--------" << std::endl;
+              viennafvm::log::out() << "--------" << std::endl;
           }
         #endif
 
@@ -420,18 +570,165 @@ namespace viennafvm
       std::size_t get_nonlinear_iterations() { return nonlinear_iterations; }
       void set_nonlinear_iterations(std::size_t max_iters) { nonlinear_iterations = max_iters; }
 
-      numeric_type get_nonlinear_breaktol() { return nonlinear_iterations; }
+      numeric_type get_nonlinear_breaktol() { return nonlinear_breaktol; }
       void set_nonlinear_breaktol(numeric_type value) { nonlinear_breaktol = value; }
 
       numeric_type get_damping() { return damping; }
       void set_damping(numeric_type value) { damping = value; }
 
+      /** @brief If enabled, the damping of each quantity is adapted based on the residual norm of its equation.
+                 The value set via set_damping() serves as the upper bound of the damping */
+      bool get_adaptive_damping() { return adaptive_damping; }
+      void set_adaptive_damping(bool state) { adaptive_damping = state; }
+
+      numeric_type get_min_damping() { return min_damping; }
+      void set_min_damping(numeric_type value) { min_damping = value; }
+
+      std::size_t get_max_backtracking_steps() { return max_backtracking_steps; }
+      void set_max_backtracking_steps(std::size_t steps) { max_backtracking_steps = steps; }
+
+      /** @brief Returns whether the last nonlinear solve reached the break tolerance */
+      bool converged() const { return converged_; }
+
+      /** @brief Returns the number of nonlinear iterations performed by the last solve */
+      std::size_t get_required_nonlinear_iterations() const { return required_nonlinear_iterations_; }
+
+      /** @brief Registers an observer which is notified about each iteration. The observer is not owned. */
+      void set_observer(solver_observer* observer) { observer_ = observer; }
+      solver_observer* get_observer() { return observer_; }
+
+      /** @brief Registers a token, by which another thread can stop the solver. The token is checked before each
+                 nonlinear iteration, before the assembly and before the linear solve of each quantity. The token
+                 is not owned, NULL disables the checks. To stop within the linear solves as well, the token has
+                 to be registered with the linear solver, too. */
+      void set_cancellation_token(cancellation_token const* token) { cancel_ = token; }
+
+      /** @brief Registers a compiler, by which the integrands of the equations are compiled to native code. The compiler
+                 is not owned, NULL (the default) interprets the integrands. See viennafvm::jit_compiler */
+      void set_jit_compiler(jit_compiler* jit) { jit_ = jit; }
+
+      /** @brief Registers a handler, which is called after each completed nonlinear iteration to save the state of the
+                 solve. The handler is not owned, NULL (the default) disables the calls */
+      void set_checkpoint_handler(checkpoint_handler* handler) { checkpoint_ = handler; }
+
+      /** @brief Makes the next nonlinear solve continue a saved one: the iteration count starts at 'iterations' and the
+                 quantities start with the given damping, see get_current_damping(). The iterates have to be restored
+                 to the storage by the caller */
+      void continue_from(std::size_t iterations, std::vector<numeric_type> const & damping)
+      {
+        continued_iterations_ = iterations;
+        continued_damping_    = damping;
+      }
+
+      /** @brief Returns whether the last solve has been cancelled. The storage then holds the iterate of the last
+                 completed quantity update, hence calling the solver again resumes the run */
+      bool cancelled() const { return cancelled_; }
+
+      /** @brief Returns the damping applied to the quantity 'pde_index' in the last nonlinear iteration */
+      numeric_type get_last_damping(std::size_t pde_index) const
+      {
+        return (pde_index < last_damping_.size()) ? last_damping_[pde_index] : damping;
+      }
+
+      /** @brief Returns the damping each quantity starts the next nonlinear iteration with */
+      std::vector<numeric_type> const & get_current_damping() const { return current_damping_; }
+
     private:
+
+      bool cancellation_requested()
+      {
+        if (cancel_ && cancel_->requested()) cancelled_ = true;
+        return cancelled_;
+      }
+
+      /** @brief Runs the linear solver, returns false if it has been cancelled. The update is then incomplete and must not be applied */
+      template<typename LinearSolverT>
+      bool solve_linear_system(LinearSolverT& linear_solver, MatrixType& system_matrix, VectorType& load_vector, VectorType& update)
+      {
+        try
+        {
+          linear_solver(system_matrix, load_vector, update);
+        }
+        catch (viennafvm::cancelled_exception const&)
+        {
+          cancelled_ = true;
+        }
+        return !cancelled_;
+      }
+
+      /** @brief Assembles the linearized system of 'pde_index' for the current iterate and returns the norm of its residual. Only called by operator(), which prepares the facet geometry */
+      template<typename PDESystemT, typename DomainT, typename StorageT>
+      numeric_type compute_residual_norm(PDESystemT const & pde_system, std::size_t pde_index, DomainT const & domain, StorageT & storage)
+      {
+        VIENNAUTILS_PROFILE_SCOPE("viennafvm::residual_assembly");
+
+        MatrixType system_matrix;
+        VectorType load_vector;
+
+        viennafvm::linear_assembler fvm_assembler(jit_, true);
+        fvm_assembler(pde_system, pde_index, domain, storage, system_matrix, load_vector);
+
+        return boost::numeric::ublas::norm_2(load_vector);
+      }
+
+      /** @brief Applies the update with a backtracking line search on the residual norm:
+                 the damping is halved until the residual decreases sufficiently. A full step
+                 lets the damping recover towards the configured upper bound in the next iteration */
+      template<typename PDESystemT, typename DomainT, typename StorageT>
+      numeric_type apply_damped_update(PDESystemT const & pde_system, std::size_t pde_index,
+                                       DomainT const & domain, StorageT & storage,
+                                       VectorType const & update, numeric_type initial_residual_norm,
+                                       std::size_t & backtracking_steps)
+      {
+        std::vector<numeric_type> previous_iterate;
+        backup_iterate(pde_system, pde_index, domain, storage, previous_iterate);
+
+        numeric_type alpha = current_damping_[pde_index];
+        numeric_type update_norm = 0;
+        backtracking_steps = 0;
+        while (true)
+        {
+          update_norm = apply_update(pde_system, pde_index, domain, storage, update, alpha);
+
+          numeric_type new_residual_norm = compute_residual_norm(pde_system, pde_index, domain, storage);
+
+          // sufficient decrease condition, or no further reduction of the damping possible
+          if (new_residual_norm <= (1.0 - 1.0e-4 * alpha) * initial_residual_norm
+              || backtracking_steps >= max_backtracking_steps
+              || 0.5 * alpha < min_damping)
+            break;
+
+          restore_iterate(pde_system, pde_index, domain, storage, previous_iterate);
+          alpha *= 0.5;
+          ++backtracking_steps;
+        }
+
+        last_damping_[pde_index]    = alpha;
+        current_damping_[pde_index] = (backtracking_steps == 0) ? std::min(damping, 2.0 * alpha) : alpha;
+
+        return update_norm;
+      }
+
       VectorType result_;
       bool picard_iteration_;
       std::size_t     nonlinear_iterations;
       numeric_type    nonlinear_breaktol;
       numeric_type    damping;
+      bool            adaptive_damping;
+      numeric_type    min_damping;
+      std::size_t     max_backtracking_steps;
+
+      bool                      converged_;
+      std::size_t               required_nonlinear_iterations_;
+      std::vector<numeric_type> current_damping_;
+      std::vector<numeric_type> last_damping_;
+      solver_observer*          observer_;
+      cancellation_token const* cancel_;
+      bool                      cancelled_;
+      jit_compiler*             jit_;
+      checkpoint_handler*       checkpoint_;
+      std::size_t               continued_iterations_;
+      std::vector<numeric_type> continued_damping_;
   };
 
 }
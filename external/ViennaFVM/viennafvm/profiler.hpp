@@ -0,0 +1,31 @@
+#ifndef VIENNAFVM_PROFILER_HPP
+#define VIENNAFVM_PROFILER_HPP
+
+/* =======================================================================
+   Copyright (c) 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+           ViennaFVM - The Vienna Finite Volume Method Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+// The profiling instrumentation is provided by ViennaUtils and only compiled in
+// if VIENNAUTILS_WITH_PROFILER is defined. Otherwise, ViennaFVM does not depend on ViennaUtils.
+//
+#ifdef VIENNAUTILS_WITH_PROFILER
+  #include "viennautils/profiler.hpp"
+#else
+  #ifndef VIENNAUTILS_PROFILE_SCOPE
+    #define VIENNAUTILS_PROFILE_SCOPE(name)
+    #define VIENNAUTILS_PROFILE_SCOPE_NAMED(var, name)
+    #define VIENNAUTILS_PROFILE_STOP(var)
+  #endif
+#endif
+
+#endif // VIENNAFVM_PROFILER_HPP
@@ -0,0 +1,94 @@
+#ifndef VIENNAFVM_SOLVER_OBSERVER_HPP
+#define VIENNAFVM_SOLVER_OBSERVER_HPP
+
+/* =======================================================================
+   Copyright (c) 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+           ViennaFVM - The Vienna Finite Volume Method Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+#include <cstddef>
+
+namespace viennafvm
+{
+
+  /** @brief Convergence record of a single linear solve */
+  struct linear_solve_record
+  {
+    linear_solve_record() : size(0), solver(0), preconditioner(0), iterations(0), max_iterations(0),
+                            error(0), pc_time(0), solver_time(0) {}
+
+    std::size_t size;             // number of unknowns
+    long        solver;           // linsolv::viennacl::solver_ids
+    long        preconditioner;   // linsolv::viennacl::preconditioner_ids
+    std::size_t iterations;       // Krylov iterations
+    std::size_t max_iterations;
+    double      error;            // estimated relative residual of the Krylov solver
+    double      pc_time;          // [s]
+    double      solver_time;      // [s]
+  };
+
+  /** @brief Record of a single quantity solve within a (non)linear iteration of the pde_solver */
+  struct iteration_record
+  {
+    iteration_record() : nonlinear_iteration(0), pde_index(0), assembly_time(0), update_time(0),
+                         residual_norm(0), update_norm(0), damping(0), backtracking_steps(0), break_quantity(false) {}
+
+    std::size_t         nonlinear_iteration;
+    std::size_t         pde_index;
+    double              assembly_time;        // [s]
+    double              update_time;          // [s]
+    linear_solve_record linear_solve;
+    double              residual_norm;        // residual norm of the equation before the update
+    double              update_norm;
+    double              damping;              // damping applied to the update
+    std::size_t         backtracking_steps;
+    bool                break_quantity;       // this quantity is used for the convergence check
+  };
+
+  /** @brief Interface for objects which want to be notified about the progress of the solvers.
+   *
+   *  The callbacks are invoked synchronously from the solving thread, hence implementations
+   *  should return quickly and have to take care of thread safety themselves.
+   */
+  class solver_observer
+  {
+  public:
+    virtual ~solver_observer() {}
+
+    /** @brief Called by the linear solvers after each solve */
+    virtual void on_linear_solve(linear_solve_record const & /*record*/) {}
+
+    /** @brief Called by the pde_solver after the update of a quantity has been applied */
+    virtual void on_iteration(iteration_record const & /*record*/) {}
+
+    /** @brief Called by the pde_solver after the last iteration */
+    virtual void on_finished(bool /*converged*/, std::size_t /*iterations*/) {}
+  };
+
+  /** @brief Interface for objects which save the state of a nonlinear solve, from which the solve can be continued.
+   *
+   *  The pde_solver calls the handler after each completed nonlinear iteration, i.e., whenever the iterates
+   *  of all quantities belong to the same iteration. The call is synchronous, so the handler may read the
+   *  storage, but should defer expensive work such as file output to another thread.
+   */
+  class checkpoint_handler
+  {
+  public:
+    virtual ~checkpoint_handler() {}
+
+    /** @brief 'iterations' is the number of nonlinear iterations completed so far, including those of a continued solve */
+    virtual void on_checkpoint(std::size_t iterations) = 0;
+  };
+
+}
+
+#endif // VIENNAFVM_SOLVER_OBSERVER_HPP
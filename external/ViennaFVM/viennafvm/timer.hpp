@@ -16,13 +16,14 @@
 ======================================================================= */
 
 #include <iostream>
+#include "viennafvm/log.hpp"
 
 namespace viennafvm
 {
 
 inline void printOps(double num_ops, double exec_time)
 {
-  std::cout << "GFLOPs: " << num_ops / (1000000 * exec_time * 1000) << std::endl;
+  viennafvm::log::out() << "GFLOPs: " << num_ops / (1000000 * exec_time * 1000) << std::endl;
 }
 
 } // viennafvm
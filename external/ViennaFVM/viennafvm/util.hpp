@@ -21,11 +21,13 @@
 #include <string>
 #include <stdexcept>
 #include <cmath>
+#include <algorithm>
 
 #include "viennadata/api.hpp"
 #include "viennafvm/forwards.h"
 #include "viennagrid/algorithm/voronoi.hpp"
 #include "viennagrid/mesh/coboundary_iteration.hpp"
+#include "viennagrid/mesh/compact_mesh.hpp"
 
 
 
@@ -194,6 +196,69 @@ namespace viennafvm
     }
 
 
+    // compact meshes of triangles and tetrahedra, same operations as above on the snapshot's arrays
+    namespace detail
+    {
+      template <typename CompactMeshType, typename IndexType>
+      typename CompactMeshType::point_type
+      unit_outer_normal_compact(CompactMeshType const & mesh_obj, IndexType const * facet_vertices, IndexType non_facet_vertex, viennagrid::line_tag)
+      {
+        typedef typename CompactMeshType::point_type PointType;
+
+        PointType edge_vec  = mesh_obj.point(facet_vertices[1]) - mesh_obj.point(facet_vertices[0]);
+        edge_vec /= viennagrid::norm(edge_vec);
+
+        PointType other_vec = mesh_obj.point(non_facet_vertex) - mesh_obj.point(facet_vertices[0]);
+        other_vec -= viennagrid::inner_prod(edge_vec, other_vec) * edge_vec; //orthogonalize (one step of Gram-Schmidt)
+        other_vec /= -1.0 * viennagrid::norm(other_vec); //make it unit length and flip direction
+
+        return other_vec;
+      }
+
+      template <typename CompactMeshType, typename IndexType>
+      typename CompactMeshType::point_type
+      unit_outer_normal_compact(CompactMeshType const & mesh_obj, IndexType const * facet_vertices, IndexType non_facet_vertex, viennagrid::triangle_tag)
+      {
+        typedef typename CompactMeshType::point_type PointType;
+
+        PointType edge_vec1  = mesh_obj.point(facet_vertices[1]) - mesh_obj.point(facet_vertices[0]);
+        PointType edge_vec2  = mesh_obj.point(facet_vertices[2]) - mesh_obj.point(facet_vertices[0]);
+        PointType normal_vec = viennagrid::cross_prod(edge_vec1, edge_vec2);
+        normal_vec /= viennagrid::norm(normal_vec);
+
+        // ensure normal vector is pointing outwards:
+        PointType other_vec = mesh_obj.point(non_facet_vertex) - mesh_obj.point(facet_vertices[0]);
+        if (viennagrid::inner_prod(normal_vec, other_vec) > 0)
+          normal_vec *= -1.0;
+
+        return normal_vec;
+      }
+    }
+
+    // interface for facets of a compact mesh, the cell is one of the two cells of the facet
+    template <typename MeshType, typename IndexType>
+    typename viennagrid::compact_mesh<MeshType, IndexType>::point_type
+    unit_outer_normal(viennagrid::compact_mesh<MeshType, IndexType> const & mesh_obj, IndexType facet, IndexType cell)
+    {
+      typedef viennagrid::compact_mesh<MeshType, IndexType> CompactMeshType;
+
+      //
+      // Find a vertex which is not part of the face
+      //
+      IndexType const * facet_vertices = mesh_obj.facet_vertices(facet);
+      IndexType const * cell_vertices  = mesh_obj.cell_vertices(cell);
+      IndexType non_facet_vertex = cell_vertices[0];
+      for (int i = 0; i < CompactMeshType::vertices_per_cell; ++i)
+      {
+        non_facet_vertex = cell_vertices[i];
+        if (std::find(facet_vertices, facet_vertices + CompactMeshType::vertices_per_facet, non_facet_vertex) == facet_vertices + CompactMeshType::vertices_per_facet)
+          break;
+      }
+
+      return detail::unit_outer_normal_compact(mesh_obj, facet_vertices, non_facet_vertex, typename CompactMeshType::facet_tag());
+    }
+
+
 
 
 
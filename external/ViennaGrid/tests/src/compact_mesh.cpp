@@ -0,0 +1,176 @@
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#ifdef _MSC_VER
+  #pragma warning( disable : 4503 )     //truncated name decoration
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/io/netgen_reader.hpp"
+#include "viennagrid/algorithm/volume.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+#include "viennagrid/algorithm/norm.hpp"
+#include "viennagrid/mesh/coboundary_iteration.hpp"
+#include "viennagrid/mesh/compact_mesh.hpp"
+
+template <typename MeshType, typename SegmentationType>
+void test(std::string const & infile)
+{
+  typedef typename viennagrid::result_of::cell_tag<MeshType>::type                                   CellTag;
+  typedef typename CellTag::facet_tag                                                                FacetTag;
+  typedef viennagrid::compact_mesh<MeshType>                                                         CompactMeshType;
+  typedef typename CompactMeshType::index_type                                                       IndexType;
+
+  typedef typename viennagrid::result_of::const_element_range<MeshType, viennagrid::vertex_tag>::type  VertexRange;
+  typedef typename viennagrid::result_of::iterator<VertexRange>::type                                  VertexIterator;
+  typedef typename viennagrid::result_of::const_element_range<MeshType, CellTag>::type                 CellRange;
+  typedef typename viennagrid::result_of::iterator<CellRange>::type                                    CellIterator;
+  typedef typename viennagrid::result_of::const_element_range<MeshType, FacetTag>::type                FacetRange;
+  typedef typename viennagrid::result_of::iterator<FacetRange>::type                                   FacetIterator;
+  typedef typename viennagrid::result_of::const_coboundary_range<MeshType, FacetTag, CellTag>::type    CellOnFacetRange;
+
+  MeshType mesh;
+  SegmentationType segmentation(mesh);
+
+  if (CompactMeshType(mesh).coordinates(0) != NULL)
+  {
+    std::cerr << "Error in check: Coordinates of an empty mesh are not NULL!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  try
+  {
+    viennagrid::io::netgen_reader my_netgen_reader;
+    my_netgen_reader(mesh, segmentation, infile);
+  }
+  catch (std::exception const & ex)
+  {
+    std::cout << "what(): " << ex.what() << std::endl;
+    std::cerr << "File-Reader failed. Aborting program..." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  CompactMeshType compact(mesh, segmentation);
+
+  VertexRange vertices(mesh);
+  CellRange   cells(mesh);
+  FacetRange  facets(mesh);
+
+  std::cout << "* vertices: " << compact.vertex_count() << ", cells: " << compact.cell_count()
+            << ", facets: " << compact.facet_count() << ", edges: " << compact.edge_count()
+            << ", bytes: " << compact.memory_size() << std::endl;
+
+  if (compact.vertex_count() != vertices.size() || compact.cell_count() != cells.size()
+      || compact.facet_count() != facets.size() || compact.edge_count() != viennagrid::elements<viennagrid::line_tag>(mesh).size())
+  {
+    std::cerr << "Error in check: Number of elements mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // coordinates
+  IndexType v = 0;
+  for (VertexIterator vit = vertices.begin(); vit != vertices.end(); ++vit, ++v)
+    for (int d = 0; d < CompactMeshType::geometric_dimension; ++d)
+      if (compact.coordinates(d)[v] != viennagrid::point(mesh, *vit)[d])
+      {
+        std::cerr << "Error in check: Coordinate " << d << " of vertex " << v << " mismatch!" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+
+  // cell vertices, volumes, centroids and segments
+  IndexType c = 0;
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit, ++c)
+  {
+    for (int k = 0; k < CompactMeshType::vertices_per_cell; ++k)
+      if (viennagrid::norm(compact.point(compact.cell_vertices(c)[k]) - viennagrid::point(mesh, viennagrid::vertices(*cit)[k])) != 0)
+      {
+        std::cerr << "Error in check: Vertex " << k << " of cell " << c << " mismatch!" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+
+    if (std::fabs(viennagrid::volume(compact, c) - viennagrid::volume(*cit)) > 1e-12)
+    {
+      std::cerr << "Error in check: Volume of cell " << c << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    if (viennagrid::norm(viennagrid::centroid(compact, c) - viennagrid::centroid(*cit)) != 0)
+    {
+      std::cerr << "Error in check: Centroid of cell " << c << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    if (!viennagrid::is_in_segment(segmentation[compact.cell_segment(c)], *cit))
+    {
+      std::cerr << "Error in check: Segment of cell " << c << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // the cells of each facet are the coboundary cells
+  IndexType f = 0;
+  for (FacetIterator fit = facets.begin(); fit != facets.end(); ++fit, ++f)
+  {
+    CellOnFacetRange cells_on_facet = viennagrid::coboundary_elements<FacetTag, CellTag>(static_cast<MeshType const &>(mesh), fit.handle());
+    IndexType const * facet_cells = compact.facet_cells(f);
+
+    if (compact.is_boundary_facet(f) != (cells_on_facet.size() == 1))
+    {
+      std::cerr << "Error in check: Boundary flag of facet " << f << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    if (std::fabs(viennagrid::facet_volume(compact, f) - viennagrid::volume(*fit)) > 1e-12)
+    {
+      std::cerr << "Error in check: Volume of facet " << f << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    for (int k = 0; k < static_cast<int>(cells_on_facet.size()); ++k)
+    {
+      IndexType const * cell_facets = compact.cell_facets(facet_cells[k]);
+      if (cells[facet_cells[k]].id() != cells_on_facet[k].id()
+          || std::count(cell_facets, cell_facets + CompactMeshType::facets_per_cell, f) != 1)
+      {
+        std::cerr << "Error in check: Cell " << k << " of facet " << f << " mismatch!" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+}
+
+int main()
+{
+  std::cout << "*****************" << std::endl;
+  std::cout << "* Test started! *" << std::endl;
+  std::cout << "*****************" << std::endl;
+
+  std::string path = "../../examples/data/";
+
+  std::cout << "Testing 2d..." << std::endl;
+  test<viennagrid::triangular_2d_mesh, viennagrid::triangular_2d_segmentation>(path + "square32.mesh");
+  std::cout << "Testing 3d..." << std::endl;
+  test<viennagrid::tetrahedral_3d_mesh, viennagrid::tetrahedral_3d_segmentation>(path + "cube48.mesh");
+  std::cout << "Testing 3d with hashed boundary elements..." << std::endl;
+  test<viennagrid::tetrahedral_3d_hashed_mesh, viennagrid::tetrahedral_3d_hashed_segmentation>(path + "cube48.mesh");
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -16,11 +16,13 @@
 
 #include "viennagrid/algorithm/boundary.hpp"
 #include "viennagrid/algorithm/centroid.hpp"
+#include "viennagrid/algorithm/norm.hpp"
 #include "viennagrid/config/default_configs.hpp"
 #include "viennagrid/io/vtk_reader.hpp"
 #include "viennagrid/io/vtk_writer.hpp"
 #include "viennagrid/io/opendx_writer.hpp"
 #include "viennagrid/io/netgen_reader.hpp"
+#include "viennagrid/io/mesh_cache.hpp"
 
 void print(std::vector<std::string> const & vec)
 {
@@ -235,6 +237,99 @@ void test_vtk(ReaderType & my_reader, std::string const & infile, std::string co
 
 
 
+template <typename MeshType>
+void test_cache(std::string const & infile, std::string const & copyfile)
+{
+  typedef typename viennagrid::result_of::segmentation<MeshType>::type          SegmentationType;
+  typedef typename viennagrid::result_of::vertex_range<MeshType>::type          VertexContainer;
+  typedef typename viennagrid::result_of::cell_range<MeshType>::type            CellContainer;
+
+  // the cache is written next to the mesh file, hence the mesh file is copied to the working directory
+  {
+    std::ifstream source(infile.c_str(), std::ios::binary);
+    std::ofstream copy(copyfile.c_str(), std::ios::binary);
+    copy << source.rdbuf();
+  }
+  std::remove( viennagrid::io::cached_reader<viennagrid::io::netgen_reader>::cache_filename(copyfile).c_str() );
+
+  MeshType netgen_mesh;
+  SegmentationType netgen_segmentation(netgen_mesh);
+  viennagrid::io::cached_reader<viennagrid::io::netgen_reader> first_reader;
+  first_reader(netgen_mesh, netgen_segmentation, copyfile);
+
+  MeshType cached_mesh;
+  SegmentationType cached_segmentation(cached_mesh);
+  viennagrid::io::cached_reader<viennagrid::io::netgen_reader> second_reader;
+  second_reader(cached_mesh, cached_segmentation, copyfile);
+
+  if (first_reader.from_cache() || !second_reader.from_cache())
+  {
+    std::cerr << "Failed: the cache file was not written on the first read or not used on the second read" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // with a cache directory, nothing is written next to the original file
+  std::string directory_cache = viennagrid::io::cached_reader<viennagrid::io::netgen_reader>::cache_filename(infile, ".");
+  std::remove( directory_cache.c_str() );
+  MeshType directory_mesh;
+  SegmentationType directory_segmentation(directory_mesh);
+  viennagrid::io::cached_reader<viennagrid::io::netgen_reader> directory_reader(viennagrid::io::netgen_reader(), ".");
+  directory_reader(directory_mesh, directory_segmentation, infile);
+  if ( !std::ifstream(directory_cache.c_str())
+       || std::ifstream(viennagrid::io::cached_reader<viennagrid::io::netgen_reader>::cache_filename(infile).c_str()) )
+  {
+    std::cerr << "Failed: the cache file was not written to the cache directory" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  VertexContainer netgen_vertices(netgen_mesh), cached_vertices(cached_mesh);
+  CellContainer   netgen_cells(netgen_mesh),    cached_cells(cached_mesh);
+  if (netgen_vertices.size() != cached_vertices.size() || netgen_cells.size() != cached_cells.size()
+      || netgen_segmentation.size() != cached_segmentation.size()
+      || viennagrid::elements<viennagrid::line_tag>(netgen_mesh).size() != viennagrid::elements<viennagrid::line_tag>(cached_mesh).size())
+  {
+    std::cerr << "Failed: the element counts of the cached mesh differ" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  for (std::size_t i = 0; i < netgen_cells.size(); ++i)
+  {
+    for (std::size_t j = 0; j < viennagrid::vertices(netgen_cells[i]).size(); ++j)
+      if (viennagrid::vertices(netgen_cells[i])[j].id() != viennagrid::vertices(cached_cells[i])[j].id()
+          || viennagrid::norm(viennagrid::point(viennagrid::vertices(netgen_cells[i])[j]) - viennagrid::point(viennagrid::vertices(cached_cells[i])[j])) > 0)
+      {
+        std::cerr << "Failed: the vertices of cell " << i << " differ in the cached mesh" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+
+    // the stored boundary elements replace the ones found while creating the cells, they have to agree including their local vertex order
+    for (std::size_t j = 0; j < viennagrid::facets(netgen_cells[i]).size(); ++j)
+    {
+      if (viennagrid::facets(netgen_cells[i])[j].id() != viennagrid::facets(cached_cells[i])[j].id())
+      {
+        std::cerr << "Failed: the facets of cell " << i << " differ in the cached mesh" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      for (std::size_t k = 0; k < viennagrid::vertices(viennagrid::facets(netgen_cells[i])[j]).size(); ++k)
+        if (viennagrid::vertices(viennagrid::facets(netgen_cells[i])[j])[k].id() != viennagrid::vertices(viennagrid::facets(cached_cells[i])[j])[k].id()
+            || netgen_cells[i].global_to_local_orientation(viennagrid::facets(netgen_cells[i]).handle_at(j), static_cast<long>(k))
+               != cached_cells[i].global_to_local_orientation(viennagrid::facets(cached_cells[i]).handle_at(j), static_cast<long>(k)))
+        {
+          std::cerr << "Failed: the facet vertices of cell " << i << " differ in the cached mesh" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+    }
+
+    for (typename SegmentationType::iterator sit = netgen_segmentation.begin(); sit != netgen_segmentation.end(); ++sit)
+      if (viennagrid::is_in_segment(*sit, netgen_cells[i]) != viennagrid::is_in_segment(cached_segmentation[sit->id()], cached_cells[i]))
+      {
+        std::cerr << "Failed: the segments of cell " << i << " differ in the cached mesh" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+  }
+}
+
+
 
 
 
@@ -256,51 +351,61 @@ int main()
   std::cout << "*********** Reading from Netgen, 3d ***********" << std::endl;
   test<viennagrid::tetrahedral_3d_mesh>(my_netgen_reader, path + "cube48.mesh", "io_3d");
 
+  std::cout << "*********** Reading from Netgen, 3d, hashed boundary elements ***********" << std::endl;
+  test<viennagrid::tetrahedral_3d_hashed_mesh>(my_netgen_reader, path + "cube48.mesh", "io_3d_hashed");
+
+  std::cout << "*********** Reading from Netgen through the binary cache, 2d and 3d ***********" << std::endl;
+  test_cache<viennagrid::triangular_2d_mesh>(path + "square32.mesh", "io_cache_2d.mesh");
+  test_cache<viennagrid::tetrahedral_3d_mesh>(path + "cube48.mesh", "io_cache_3d.mesh");
+  test_cache<viennagrid::tetrahedral_3d_hashed_mesh>(path + "cube48.mesh", "io_cache_3d_hashed.mesh");
+
 
 
   //Stage 2: Read VTK files, write to VTK
+  //the Netgen meshes above consist of a single segment, which the VTK writer stores as a single .vtu file
+  //without a .pvd file, and which the VTK reader reads back as segment 0
   //test<viennagrid::config::line_1d>("io_1d", "io_1d_2");
 
   viennagrid::io::vtk_reader<viennagrid::triangular_2d_mesh>  vtk_reader_2d;
 
 
   std::cout << "*********** Reading from VTK, 2d ***********" << std::endl;
-  test_vtk<viennagrid::triangular_2d_mesh>(vtk_reader_2d, "io_2d_main.pvd", "io_2d_2");
+  test_vtk<viennagrid::triangular_2d_mesh>(vtk_reader_2d, "io_2d.vtu", "io_2d_2");
 
   std::cout << "-- Scalar vertex quantities: --" << std::endl;
-  print(vtk_reader_2d.scalar_vertex_data_names(1));
+  print(vtk_reader_2d.scalar_vertex_data_names(0));
   std::cout << "-- Vector vertex quantities: --" << std::endl;
-  print(vtk_reader_2d.vector_vertex_data_names(1));
+  print(vtk_reader_2d.vector_vertex_data_names(0));
   std::cout << "-- Scalar cell quantities: --" << std::endl;
-  print(vtk_reader_2d.scalar_cell_data_names(1));
+  print(vtk_reader_2d.scalar_cell_data_names(0));
   std::cout << "-- Vector cell quantities: --" << std::endl;
-  print(vtk_reader_2d.vector_cell_data_names(1));
+  print(vtk_reader_2d.vector_cell_data_names(0));
 
-  assert( (vtk_reader_2d.scalar_vertex_data_names(1).size() == 2) && "Not all data parsed!");
-  assert( (vtk_reader_2d.vector_vertex_data_names(1).size() == 1) && "Not all data parsed!");
-  assert( (vtk_reader_2d.scalar_cell_data_names(1).size() == 2) && "Not all data parsed!");
-  assert( (vtk_reader_2d.vector_cell_data_names(1).size() == 1) && "Not all data parsed!");
+  assert( (vtk_reader_2d.scalar_vertex_data_names(0).size() == 2) && "Not all data parsed!");
+  assert( (vtk_reader_2d.vector_vertex_data_names(0).size() == 1) && "Not all data parsed!");
+  assert( (vtk_reader_2d.scalar_cell_data_names(0).size() == 2) && "Not all data parsed!");
+  assert( (vtk_reader_2d.vector_cell_data_names(0).size() == 1) && "Not all data parsed!");
 
 
   viennagrid::io::vtk_reader<viennagrid::tetrahedral_3d_mesh>  vtk_reader_3d;
 
 
   std::cout << "*********** Reading from VTK, 3d ***********" << std::endl;
-  test_vtk<viennagrid::tetrahedral_3d_mesh>(vtk_reader_3d, "io_3d_main.pvd", "io_3d_2");
+  test_vtk<viennagrid::tetrahedral_3d_mesh>(vtk_reader_3d, "io_3d.vtu", "io_3d_2");
 
   std::cout << "-- Scalar vertex quantities: --" << std::endl;
-  print(vtk_reader_3d.scalar_vertex_data_names(1));
+  print(vtk_reader_3d.scalar_vertex_data_names(0));
   std::cout << "-- Vector vertex quantities: --" << std::endl;
-  print(vtk_reader_3d.vector_vertex_data_names(1));
+  print(vtk_reader_3d.vector_vertex_data_names(0));
   std::cout << "-- Scalar cell quantities: --" << std::endl;
-  print(vtk_reader_3d.scalar_cell_data_names(1));
+  print(vtk_reader_3d.scalar_cell_data_names(0));
   std::cout << "-- Vector cell quantities: --" << std::endl;
-  print(vtk_reader_3d.vector_cell_data_names(1));
+  print(vtk_reader_3d.vector_cell_data_names(0));
 
-  assert( (vtk_reader_3d.scalar_vertex_data_names(1).size() == 2) && "Not all data parsed!");
-  assert( (vtk_reader_3d.vector_vertex_data_names(1).size() == 1) && "Not all data parsed!");
-  assert( (vtk_reader_3d.scalar_cell_data_names(1).size() == 2) && "Not all data parsed!");
-  assert( (vtk_reader_3d.vector_cell_data_names(1).size() == 1) && "Not all data parsed!");
+  assert( (vtk_reader_3d.scalar_vertex_data_names(0).size() == 2) && "Not all data parsed!");
+  assert( (vtk_reader_3d.vector_vertex_data_names(0).size() == 1) && "Not all data parsed!");
+  assert( (vtk_reader_3d.scalar_cell_data_names(0).size() == 2) && "Not all data parsed!");
+  assert( (vtk_reader_3d.vector_cell_data_names(0).size() == 1) && "Not all data parsed!");
 
 //   test<viennagrid::config::tetrahedral_3d>(vtk_reader_3d, "multi-segment_main.pvd", "io_3d_2");
 
@@ -43,6 +43,8 @@ int main()
   viennagrid::result_of::mesh<viennagrid::config::triangular_3d>::type  mesh_simplex_32u;
   std::cout << "* instantiating simplex 33u mesh.. " << std::endl;
   viennagrid::result_of::mesh<viennagrid::config::tetrahedral_3d>::type mesh_simplex_33u;
+  std::cout << "* instantiating simplex 33u mesh with hashed boundary elements.. " << std::endl;
+  viennagrid::result_of::mesh<viennagrid::config::tetrahedral_3d_hashed>::type mesh_simplex_33u_hashed;
 
 
   std::cout << " ------ Part 2: Non-simplex meshs ------- " << std::endl;
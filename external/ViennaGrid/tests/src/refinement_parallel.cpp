@@ -0,0 +1,222 @@
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#ifdef _MSC_VER
+  #pragma warning( disable : 4503 )     //truncated name decoration
+#endif
+
+#include "refinement-common.hpp"
+#include "viennagrid/io/netgen_reader.hpp"
+
+//
+// Compares the parallel refinement of tetrahedra with the cell by cell refinement, which have to result in the same mesh
+//
+
+template <typename MeshT, typename SegmentationT>
+void check_equal(MeshT const & mesh1, SegmentationT const & segmentation1, MeshT const & mesh2, SegmentationT const & segmentation2)
+{
+  typedef typename viennagrid::result_of::line<MeshT>::type                        EdgeType;
+  typedef typename viennagrid::result_of::const_vertex_range<MeshT>::type          VertexContainer;
+  typedef typename viennagrid::result_of::const_line_range<MeshT>::type            EdgeContainer;
+  typedef typename viennagrid::result_of::const_triangle_range<MeshT>::type        TriangleContainer;
+  typedef typename viennagrid::result_of::iterator<VertexContainer>::type          VertexIterator;
+  typedef typename viennagrid::result_of::const_cell_range<MeshT>::type            CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type            CellIterator;
+  typedef typename viennagrid::result_of::const_vertex_range<typename viennagrid::result_of::cell<MeshT>::type>::type  VertexOnCellContainer;
+  typedef typename viennagrid::result_of::segment_handle<SegmentationT>::type      SegmentHandleType;
+  typedef typename viennagrid::result_of::const_cell_range<SegmentHandleType>::type  SegmentCellContainer;
+
+  VertexContainer vertices1(mesh1), vertices2(mesh2);
+  CellContainer   cells1(mesh1),    cells2(mesh2);
+  std::cout << "Vertices: " << vertices1.size() << " / " << vertices2.size() << ", cells: " << cells1.size() << " / " << cells2.size() << std::endl;
+
+  if (vertices1.size() != vertices2.size() || cells1.size() != cells2.size()
+      || EdgeContainer(mesh1).size() != EdgeContainer(mesh2).size()
+      || TriangleContainer(mesh1).size() != TriangleContainer(mesh2).size())
+  {
+    std::cerr << "Error in check: Number of elements mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  for (VertexIterator vit1 = vertices1.begin(), vit2 = vertices2.begin(); vit1 != vertices1.end(); ++vit1, ++vit2)
+  {
+    if ( vit1->id() != vit2->id() || viennagrid::norm(viennagrid::point(*vit1) - viennagrid::point(*vit2)) > 0.0 )
+    {
+      std::cerr << "Error in check: Vertex " << vit1->id() << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  for (CellIterator cit1 = cells1.begin(), cit2 = cells2.begin(); cit1 != cells1.end(); ++cit1, ++cit2)
+  {
+    VertexOnCellContainer cell_vertices1(*cit1), cell_vertices2(*cit2);
+    for (std::size_t j = 0; j < cell_vertices1.size(); ++j)
+    {
+      if ( cit1->id() != cit2->id() || cell_vertices1[j].id() != cell_vertices2[j].id() )
+      {
+        std::cerr << "Error in check: Cell " << cit1->id() << " mismatch!" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+
+  // the IDs of boundary elements created with given IDs continue after them
+  if ( static_cast<std::size_t>(viennagrid::id_upper_bound<EdgeType>(mesh1).get()) != EdgeContainer(mesh1).size() )
+  {
+    std::cerr << "Error in check: Edge ID upper bound mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  if (segmentation1.size() != segmentation2.size())
+  {
+    std::cerr << "Error in check: Number of segments mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  for (typename SegmentationT::const_iterator sit1 = segmentation1.begin(), sit2 = segmentation2.begin(); sit1 != segmentation1.end(); ++sit1, ++sit2)
+  {
+    if ( sit1->id() != sit2->id() || SegmentCellContainer(*sit1).size() != SegmentCellContainer(*sit2).size() )
+    {
+      std::cerr << "Error in check: Segment " << sit1->id() << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  if ( fabs(viennagrid::volume(mesh1) - viennagrid::volume(mesh2)) > 1e-10 * viennagrid::volume(mesh2) )
+  {
+    std::cerr << "Error in check: Mesh volumes mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+template <typename MeshT, typename SegmentationT, typename EdgeRefinementFlagAccessorT>
+void test_refinement(MeshT & mesh, SegmentationT const & segmentation, EdgeRefinementFlagAccessorT const edge_refinement_flag_accessor,
+                     bool overlapping_segments = false)
+{
+  typedef typename viennagrid::result_of::vertex<MeshT>::type          VertexType;
+  typedef typename viennagrid::result_of::line<MeshT>::type            EdgeType;
+  typedef typename viennagrid::result_of::vertex_handle<MeshT>::type   VertexHandleType;
+
+  // parallel
+  MeshT parallel_mesh;
+  SegmentationT parallel_segmentation(parallel_mesh);
+  viennagrid::refine<viennagrid::tetrahedron_tag>(mesh, segmentation, parallel_mesh, parallel_segmentation, edge_refinement_flag_accessor);
+
+  // cell by cell
+  MeshT serial_mesh;
+  SegmentationT serial_segmentation(serial_mesh);
+  std::deque<VertexHandleType> vertex_refinement_vertex_handle;
+  std::deque<VertexHandleType> edge_refinement_vertex_handle;
+  viennagrid::detail::refine_impl<viennagrid::tetrahedron_tag>(mesh, segmentation, serial_mesh, serial_segmentation,
+                                                              viennagrid::default_point_accessor(mesh), edge_refinement_flag_accessor,
+                                                              viennagrid::make_accessor<VertexType>(vertex_refinement_vertex_handle),
+                                                              viennagrid::make_accessor<EdgeType>(edge_refinement_vertex_handle));
+
+  check_equal(parallel_mesh, parallel_segmentation, serial_mesh, serial_segmentation);
+
+  // the cells of overlapping segments are refined once per segment, hence the refined mesh covers them several times
+  if (overlapping_segments)
+    return;
+
+  if ( fabs(viennagrid::volume(parallel_mesh) - viennagrid::volume(mesh)) / viennagrid::volume(mesh) > 1e-3
+       || fabs(mesh_surface(parallel_mesh) - mesh_surface(mesh)) / mesh_surface(mesh) > 1e-3 )
+  {
+    std::cerr << "Error in check: Refined mesh volume or surface mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+
+template <typename MeshT>
+void test(std::string & infile)
+{
+  typedef typename viennagrid::result_of::segmentation<MeshT>::type           SegmentationType;
+  typedef typename viennagrid::result_of::point<MeshT>::type                  PointType;
+  typedef typename viennagrid::result_of::line<MeshT>::type                   EdgeType;
+  typedef typename viennagrid::result_of::cell<MeshT>::type                   CellType;
+
+  typedef typename viennagrid::result_of::cell_range<MeshT>::type             CellContainer;
+  typedef typename viennagrid::result_of::iterator<CellContainer>::type       CellIterator;
+  typedef typename viennagrid::result_of::line_range<CellType>::type          EdgeOnCellContainer;
+  typedef typename viennagrid::result_of::iterator<EdgeOnCellContainer>::type EdgeOnCellIterator;
+
+  MeshT mesh;
+  SegmentationType segmentation(mesh);
+
+  try{
+    viennagrid::io::netgen_reader my_netgen_reader;
+    my_netgen_reader(mesh, segmentation, infile);
+  } catch (...){
+     std::cerr << "File-Reader failed. Aborting program..." << std::endl;
+     exit(EXIT_FAILURE);
+  }
+
+  std::size_t edge_count = static_cast<std::size_t>(viennagrid::id_upper_bound<EdgeType>(mesh).get());
+
+  // uniform refinement
+  std::cout << "Uniform refinement" << std::endl;
+  std::deque<bool> uniform_flags(edge_count, true);
+  test_refinement(mesh, segmentation, viennagrid::make_accessor<EdgeType>(uniform_flags));
+
+  // refinement of the cells with centroid at x \in [2,3], y \in [0,1], closed by refining the longest edges
+  std::cout << "Local refinement" << std::endl;
+  std::deque<bool> local_flags(edge_count, false);
+  CellContainer cells(mesh);
+  for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+  {
+    PointType centroid = viennagrid::centroid(*cit);
+    if (centroid[0] >= 2.0 && centroid[0] <= 3.0 && centroid[1] >= 0.0 && centroid[1] <= 1.0)
+    {
+      EdgeOnCellContainer edges_on_cell(*cit);
+      for (EdgeOnCellIterator eocit = edges_on_cell.begin(); eocit != edges_on_cell.end(); ++eocit)
+        local_flags[eocit->id().get()] = true;
+    }
+  }
+  viennagrid::ensure_longest_edge_refinement<viennagrid::tetrahedron_tag>(mesh, viennagrid::make_accessor<EdgeType>(local_flags));
+  test_refinement(mesh, segmentation, viennagrid::make_accessor<EdgeType>(local_flags));
+
+  // every third edge, which results in all numbers of refined edges per cell
+  std::cout << "Refinement of every third edge" << std::endl;
+  std::deque<bool> sparse_flags(edge_count, false);
+  for (std::size_t i = 0; i < edge_count; i += 3)
+    sparse_flags[i] = true;
+  test_refinement(mesh, segmentation, viennagrid::make_accessor<EdgeType>(sparse_flags));
+
+  // every second cell is in an additional segment as well
+  std::cout << "Refinement of overlapping segments" << std::endl;
+  typename SegmentationType::segment_handle_type & overlap = segmentation.make_segment();
+  for (std::size_t i = 0; i < cells.size(); i += 2)
+    viennagrid::add(overlap, cells[i]);
+  test_refinement(mesh, segmentation, viennagrid::make_accessor<EdgeType>(local_flags), true);
+}
+
+
+int main()
+{
+  std::cout << "*****************" << std::endl;
+  std::cout << "* Test started! *" << std::endl;
+  std::cout << "*****************" << std::endl;
+
+  std::string path = "../../examples/data/";
+
+  std::string infile = path + "interconnect3d.mesh";
+  test<viennagrid::tetrahedral_3d_mesh>(infile);
+
+  infile = path + "cube48.mesh";
+  test<viennagrid::tetrahedral_3d_mesh>(infile);
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,234 @@
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#ifdef _MSC_VER
+  #pragma warning( disable : 4503 )     //truncated name decoration
+#endif
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/io/netgen_reader.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+#include "viennagrid/algorithm/distance.hpp"
+#include "viennagrid/algorithm/spatial_index.hpp"
+
+template <typename PointType>
+PointType random_point(double lower, double upper)
+{
+  PointType p;
+  for (std::size_t d = 0; d < p.size(); ++d)
+    p[d] = lower + (upper - lower) * std::rand() / RAND_MAX;
+  return p;
+}
+
+template <typename MeshType, typename SegmentationType>
+void test(std::string const & infile)
+{
+  typedef typename viennagrid::result_of::point<MeshType>::type                                      PointType;
+  typedef typename viennagrid::result_of::cell_range<MeshType>::type                                 CellRange;
+  typedef viennagrid::spatial_index<MeshType>                                                        IndexType;
+  typedef typename IndexType::segment_hit                                                            SegmentHit;
+
+  MeshType mesh;
+  SegmentationType segmentation(mesh);
+
+  try
+  {
+    viennagrid::io::netgen_reader my_netgen_reader;
+    my_netgen_reader(mesh, segmentation, infile);
+  }
+  catch (std::exception const & ex)
+  {
+    std::cout << "what(): " << ex.what() << std::endl;
+    std::cerr << "File-Reader failed. Aborting program..." << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  CellRange cells(mesh);
+  IndexType index(mesh, 2);
+
+  std::cout << "* cells: " << index.cell_count() << ", bytes: " << index.memory_size() << std::endl;
+  if (index.cell_count() != cells.size())
+  {
+    std::cerr << "Error in check: Number of cells mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // the centroid of each cell is located in the cell itself
+  for (std::size_t c = 0; c < cells.size(); ++c)
+  {
+    PointType p = viennagrid::centroid(cells[c]);
+    if (!index.contains(static_cast<int>(c), p) || index.locate(p) != static_cast<int>(c) || index.nearest(p) != static_cast<int>(c))
+    {
+      std::cerr << "Error in check: Centroid of cell " << c << " not located in the cell!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // random points inside and outside of the unit cube, compared to brute force
+  std::vector<PointType> points;
+  for (int i = 0; i < 500; ++i)
+    points.push_back(random_point<PointType>(-0.25, 1.25));
+
+  std::vector<int> located;
+  index.locate(points, located);
+  if (located.size() != points.size())
+  {
+    std::cerr << "Error in check: Number of located points mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  for (std::size_t i = 0; i < points.size(); ++i)
+  {
+    std::vector<double> distances(cells.size());
+    bool inside = false;
+    for (std::size_t c = 0; c < cells.size(); ++c)
+    {
+      distances[c] = viennagrid::distance(points[i], cells[c]);
+      inside = inside || distances[c] < 1e-12;
+    }
+
+    bool found = inside ? (located[i] != IndexType::invalid_index() && distances[located[i]] < 1e-12)
+                        : (located[i] == IndexType::invalid_index());
+    if (located[i] != index.locate(points[i]) || !found)
+    {
+      std::cerr << "Error in check: Location of point " << i << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // the k nearest cells have the k smallest distances
+    std::vector<int> nearest;
+    std::vector<double> nearest_distances;
+    index.nearest(points[i], 5, nearest, &nearest_distances);
+
+    std::vector<double> sorted = distances;
+    std::sort(sorted.begin(), sorted.end());
+    bool ordered = (nearest.size() == 5);
+    for (std::size_t k = 0; ordered && k < nearest.size(); ++k)
+      ordered = std::fabs(nearest_distances[k] - distances[nearest[k]]) < 1e-10 && std::fabs(nearest_distances[k] - sorted[k]) < 1e-10;
+    if (!ordered)
+    {
+      std::cerr << "Error in check: Nearest cells of point " << i << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  // a segment through the mesh is covered by the hits without gaps
+  for (int i = 0; i < 50; ++i)
+  {
+    PointType p0 = random_point<PointType>(0.0, 1.0);
+    PointType p1 = random_point<PointType>(0.0, 1.0);
+
+    std::vector<SegmentHit> hits;
+    index.intersect(p0, p1, hits);
+    if (hits.empty() || std::fabs(hits.front().entry) > 1e-8 || std::fabs(hits.back().exit - 1) > 1e-8)
+    {
+      std::cerr << "Error in check: Segment " << i << " not covered by the hits!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    double covered = 0;
+    for (std::size_t h = 0; h < hits.size(); ++h)
+    {
+      PointType middle = p0 + 0.5 * (hits[h].entry + hits[h].exit) * (p1 - p0);
+      if (hits[h].entry > hits[h].exit || (h > 0 && hits[h].entry > hits[h-1].exit + 1e-8) || !index.contains(hits[h].cell, middle))
+      {
+        std::cerr << "Error in check: Hit " << h << " of segment " << i << " mismatch!" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      covered += hits[h].exit - hits[h].entry;
+    }
+    // facets crossed at a vertex or an edge may overlap slightly, but never leave gaps
+    if (covered < 1 - 1e-8)
+    {
+      std::cerr << "Error in check: Length of segment " << i << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+
+    // the samples on the segment are located in cells containing them
+    std::vector<int> samples;
+    index.sample_line(p0, p1, 17, samples);
+    for (std::size_t j = 0; j < samples.size(); ++j)
+    {
+      PointType p = p0 + (double(j) / 16) * (p1 - p0);
+      if (samples[j] == IndexType::invalid_index() || !index.contains(samples[j], p))
+      {
+        std::cerr << "Error in check: Sample " << j << " of segment " << i << " not located!" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+
+  // the samples of a plane through the mesh agree with the individually located samples
+  PointType plane_origin, u_end, v_end;
+  for (std::size_t d = 0; d < plane_origin.size(); ++d)
+    plane_origin[d] = u_end[d] = v_end[d] = (d < 2) ? -0.25 : 0.4;
+  u_end[0] = 1.25;
+  v_end[1] = 1.25;
+
+  std::vector<int> plane;
+  index.sample_plane(plane_origin, u_end, v_end, 9, 8, plane);
+  if (plane.size() != 9 * 8)
+  {
+    std::cerr << "Error in check: Number of plane samples mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  for (std::size_t j = 0; j < 8; ++j)
+    for (std::size_t i = 0; i < 9; ++i)
+    {
+      PointType p = plane_origin + (double(i) / 8) * (u_end - plane_origin) + (double(j) / 7) * (v_end - plane_origin);
+      int cell = plane[j * 9 + i];
+      if (cell == IndexType::invalid_index() ? index.locate(p) != IndexType::invalid_index() : !index.contains(cell, p))
+      {
+        std::cerr << "Error in check: Plane sample (" << i << ", " << j << ") not located!" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+    }
+
+  // a ray starting outside the mesh enters it at the boundary
+  PointType origin, direction;
+  origin[0] = -1.0;
+  direction[0] = 1.0;
+  for (std::size_t d = 1; d < origin.size(); ++d)
+    origin[d] = 0.3;
+
+  std::vector<SegmentHit> hits;
+  index.intersect_ray(origin, direction, hits);
+  if (hits.empty() || std::fabs(hits.front().entry - 1) > 1e-8 || std::fabs(hits.back().exit - 2) > 1e-8)
+  {
+    std::cerr << "Error in check: Ray hits mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+int main()
+{
+  std::cout << "*****************" << std::endl;
+  std::cout << "* Test started! *" << std::endl;
+  std::cout << "*****************" << std::endl;
+
+  std::string path = "../../examples/data/";
+
+  std::cout << "Testing 2d..." << std::endl;
+  test<viennagrid::triangular_2d_mesh, viennagrid::triangular_2d_segmentation>(path + "square32.mesh");
+  std::cout << "Testing 3d..." << std::endl;
+  test<viennagrid::tetrahedral_3d_mesh, viennagrid::tetrahedral_3d_segmentation>(path + "cube48.mesh");
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,266 @@
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#ifdef _MSC_VER
+  #pragma warning( disable : 4503 )     //truncated name decoration
+#endif
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cmath>
+
+#include "viennagrid/config/default_configs.hpp"
+#include "viennagrid/io/vtk_reader.hpp"
+#include "viennagrid/algorithm/volume.hpp"
+
+//
+// Writes the data arrays of a VTU file in one of the formats ascii, binary or appended
+//
+struct vtu_data_writer
+{
+  vtu_data_writer(std::string const & format, bool base64, bool header64) : format_(format), base64_(base64), header64_(header64) {}
+
+  static std::string encode_base64(std::string const & bytes)
+  {
+    static const char * alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string text;
+    for (std::size_t i = 0; i < bytes.size(); i += 3)
+    {
+      unsigned int group = static_cast<unsigned char>(bytes[i]) << 16;
+      if (i + 1 < bytes.size()) group |= static_cast<unsigned char>(bytes[i+1]) << 8;
+      if (i + 2 < bytes.size()) group |= static_cast<unsigned char>(bytes[i+2]);
+
+      text += alphabet[(group >> 18) & 63];
+      text += alphabet[(group >> 12) & 63];
+      text += (i + 1 < bytes.size()) ? alphabet[(group >> 6) & 63] : '=';
+      text += (i + 2 < bytes.size()) ? alphabet[group & 63] : '=';
+    }
+    return text;
+  }
+
+  // the header with the number of bytes followed by the data, encoded separately as written by VTK
+  template <typename T>
+  std::string block(std::vector<T> const & values) const
+  {
+    std::string data(values.size() * sizeof(T), '\0');
+    if (!values.empty())
+      std::memcpy(&data[0], &values[0], data.size());
+
+    std::string header;
+    if (header64_)
+    {
+      unsigned long long size = data.size();
+      header.assign(reinterpret_cast<char const *>(&size), sizeof(size));
+    }
+    else
+    {
+      unsigned int size = static_cast<unsigned int>(data.size());
+      header.assign(reinterpret_cast<char const *>(&size), sizeof(size));
+    }
+
+    if (base64_)
+      return encode_base64(header) + encode_base64(data);
+    return header + data;
+  }
+
+  template <typename T>
+  std::string data_array(std::string const & type, std::string const & name, int components, std::vector<T> const & values)
+  {
+    std::stringstream ss;
+    ss << "<DataArray type=\"" << type << "\" Name=\"" << name << "\" NumberOfComponents=\"" << components << "\" format=\"" << format_ << "\"";
+    if (format_ == "appended")
+    {
+      ss << " offset=\"" << appended_.size() << "\"/>" << std::endl;
+      appended_ += block(values);
+    }
+    else if (format_ == "binary")
+      ss << ">" << std::endl << "  " << block(values) << std::endl << "</DataArray>" << std::endl;
+    else
+    {
+      ss << ">" << std::endl;
+      ss.precision(17);
+      for (std::size_t i = 0; i < values.size(); ++i)
+        ss << static_cast<double>(values[i]) << " ";
+      ss << std::endl << "</DataArray>" << std::endl;
+    }
+    return ss.str();
+  }
+
+  std::string appended_data() const
+  {
+    if (format_ != "appended")
+      return "";
+    return std::string("<AppendedData encoding=\"") + (base64_ ? "base64" : "raw") + "\">\n   _" + appended_ + "\n</AppendedData>\n";
+  }
+
+  std::string format_;
+  bool base64_;
+  bool header64_;
+  std::string appended_;
+};
+
+
+//
+// Writes a strip of two unit squares, each square is a piece of two triangles. The second piece is shifted by 'shift' in y-direction.
+//
+void write_vtu(std::string const & filename, vtu_data_writer writer, bool data_first, double shift)
+{
+  std::stringstream file;
+  file << "<?xml version=\"1.0\"?>" << std::endl;
+  file << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\"LittleEndian\" header_type=\""
+       << (writer.header64_ ? "UInt64" : "UInt32") << "\">" << std::endl;
+  file << "<UnstructuredGrid>" << std::endl;
+
+  for (int piece = 0; piece < 2; ++piece)
+  {
+    std::vector<double> points;
+    std::vector<float>  point_x;
+    std::vector<double> point_vector;
+    for (int i = 0; i < 4; ++i)
+    {
+      double x = piece + (i % 2);
+      double y = (i / 2) + (piece == 1 ? shift : 0.0);
+      points.push_back(x); points.push_back(y); points.push_back(0);
+      point_x.push_back(static_cast<float>(x));
+      point_vector.push_back(x); point_vector.push_back(y); point_vector.push_back(0);
+    }
+
+    std::vector<int> connectivity;
+    connectivity.push_back(0); connectivity.push_back(1); connectivity.push_back(3);
+    connectivity.push_back(0); connectivity.push_back(3); connectivity.push_back(2);
+    std::vector<int> offsets;
+    offsets.push_back(3); offsets.push_back(6);
+    std::vector<unsigned char> types(2, 5);
+    std::vector<long long> cell_index;
+    cell_index.push_back(2 * piece); cell_index.push_back(2 * piece + 1);
+
+    std::string point_data = "<PointData>\n" + writer.data_array("Float32", "x", 1, point_x)
+                           + writer.data_array("Float64", "p", 3, point_vector) + "</PointData>\n";
+    std::string cell_data  = "<CellData>\n" + writer.data_array("Int64", "index", 1, cell_index) + "</CellData>\n";
+
+    file << "<Piece NumberOfPoints=\"4\" NumberOfCells=\"2\">" << std::endl;
+    if (data_first)   // the order of ParaView
+      file << point_data << cell_data;
+    file << "<Points>" << std::endl << writer.data_array("Float64", "Points", 3, points) << "</Points>" << std::endl;
+    file << "<Cells>" << std::endl
+         << writer.data_array("Int32", "connectivity", 1, connectivity)
+         << writer.data_array("Int32", "offsets", 1, offsets)
+         << writer.data_array("UInt8", "types", 1, types)
+         << "</Cells>" << std::endl;
+    if (!data_first)
+      file << point_data << cell_data;
+    file << "</Piece>" << std::endl;
+  }
+
+  file << "</UnstructuredGrid>" << std::endl;
+  file << writer.appended_data();
+  file << "</VTKFile>" << std::endl;
+
+  std::ofstream out(filename.c_str(), std::ios::binary);
+  out << file.str();
+}
+
+
+void test(std::string const & name, vtu_data_writer const & writer, bool data_first, double shift = 0.0, double tolerance = 0.0)
+{
+  typedef viennagrid::triangular_2d_mesh                                          MeshType;
+  typedef viennagrid::result_of::segmentation<MeshType>::type                     SegmentationType;
+  typedef viennagrid::result_of::vertex<MeshType>::type                           VertexType;
+  typedef viennagrid::result_of::cell<MeshType>::type                             CellType;
+  typedef viennagrid::result_of::vertex_range<MeshType>::type                     VertexRange;
+  typedef viennagrid::result_of::cell_range<MeshType>::type                       CellRange;
+
+  std::cout << "* " << name << std::endl;
+
+  std::string filename = "vtk_reader_" + name + ".vtu";
+  write_vtu(filename, writer, data_first, shift);
+
+  MeshType mesh;
+  SegmentationType segmentation(mesh);
+
+  std::vector<double> vertex_x;
+  std::vector< std::vector<double> > vertex_p;
+  std::vector<double> cell_index;
+
+  viennagrid::io::vtk_reader<MeshType> reader;
+  reader.set_merge_tolerance(tolerance);
+  viennagrid::io::add_scalar_data_on_vertices(reader, viennagrid::make_accessor<VertexType>(vertex_x), "x");
+  viennagrid::io::add_vector_data_on_vertices(reader, viennagrid::make_accessor<VertexType>(vertex_p), "p");
+  viennagrid::io::add_scalar_data_on_cells(reader, viennagrid::make_accessor<CellType>(cell_index), "index");
+  reader(mesh, segmentation, filename);
+
+  VertexRange vertices(mesh);
+  CellRange cells(mesh);
+
+  // the points on the common edge of the pieces are merged unless they are shifted by more than the tolerance
+  std::size_t expected_vertices = (std::fabs(shift) > tolerance) ? 8 : 6;
+  if (vertices.size() != expected_vertices || cells.size() != 4 || segmentation.size() != 1)
+  {
+    std::cerr << "Error in check: Number of vertices, cells or segments mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  double area = 0;
+  for (std::size_t i = 0; i < cells.size(); ++i)
+  {
+    area += viennagrid::volume(cells[i]);
+    if (static_cast<std::size_t>(cell_index[cells[i].id().get()]) != i)
+    {
+      std::cerr << "Error in check: Data of cell " << i << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (std::fabs(area - 2) > 1e-8)
+  {
+    std::cerr << "Error in check: Cell area mismatch!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  for (std::size_t i = 0; i < vertices.size(); ++i)
+  {
+    VertexType const & vertex = vertices[i];
+    std::vector<double> const & p = vertex_p[vertex.id().get()];
+    if ( std::fabs(vertex_x[vertex.id().get()] - viennagrid::point(vertex)[0]) > 1e-6
+         || p.size() != 3
+         || std::fabs(p[0] - viennagrid::point(vertex)[0]) > 1e-6
+         || std::fabs(p[1] - viennagrid::point(vertex)[1]) > 1e-6 )
+    {
+      std::cerr << "Error in check: Data of vertex " << vertex.id() << " mismatch!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+}
+
+int main()
+{
+  std::cout << "*****************" << std::endl;
+  std::cout << "* Test started! *" << std::endl;
+  std::cout << "*****************" << std::endl;
+
+  test("ascii", vtu_data_writer("ascii", false, false), false);
+  test("ascii_data_first", vtu_data_writer("ascii", false, false), true);
+  test("binary", vtu_data_writer("binary", true, false), true);
+  test("binary_header64", vtu_data_writer("binary", true, true), true);
+  test("appended_raw", vtu_data_writer("appended", false, false), true);
+  test("appended_base64", vtu_data_writer("appended", true, true), true);
+
+  test("shifted", vtu_data_writer("ascii", false, false), false, 1e-9);
+  test("shifted_tolerance", vtu_data_writer("binary", true, false), false, 1e-9, 1e-6);
+
+  std::cout << "*******************************" << std::endl;
+  std::cout << "* Test finished successfully! *" << std::endl;
+  std::cout << "*******************************" << std::endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,557 @@
+#ifndef VIENNAGRID_ALGORITHM_DETAIL_REFINE_PARALLEL_HPP
+#define VIENNAGRID_ALGORITHM_DETAIL_REFINE_PARALLEL_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#include <vector>
+#include <algorithm>
+
+#include "viennagrid/forwards.hpp"
+#include "viennagrid/mesh/mesh.hpp"
+#include "viennagrid/mesh/segmentation.hpp"
+#include "viennagrid/mesh/element_creation.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
+#include "viennagrid/algorithm/norm.hpp"
+#include "viennagrid/io/mesh_cache.hpp"
+#include "viennagrid/algorithm/detail/refine_tet.hpp"
+
+/** @file viennagrid/algorithm/detail/refine_parallel.hpp
+    @brief Provides the parallel refinement of tetrahedral meshes on flat index arrays
+
+    The refinement runs in passes over flat arrays, each pass is parallel (OpenMP) and the positions of its results are assigned by prefix sums:
+      - the refined edges are numbered, their midpoints are the new vertices
+      - the tetrahedra are refined with the cases of element_refinement<tetrahedron_tag>, first counting, then writing the children to their positions
+      - the edges and triangles of the children are numbered by bucketing them by their smallest vertex
+    Finally, the refined mesh is created from the arrays with its boundary elements given, as a mesh from a cache file (see viennagrid/io/mesh_cache.hpp),
+    hence no boundary element is searched. This last step and the insertion into segments are sequential, as the mesh containers are not thread-safe.
+
+    The vertices and cells of the refined mesh are the same as the ones of the cell by cell refinement, with the same IDs and in the same order.
+*/
+
+namespace viennagrid
+{
+  namespace detail
+  {
+
+    /** @brief Records the tetrahedra created by element_refinement<tetrahedron_tag> as vertex indices instead of creating them in a mesh.
+     *
+     * The vertex handles are the indices of the vertices in the refined mesh. If no output array is given, the tetrahedra are only counted.
+     */
+    template <typename PointT>
+    class refinement_recorder
+    {
+    public:
+      refinement_recorder(std::vector<PointT> const & points, int * cells) : points_(points), cells_(cells), count_(0) {}
+
+      PointT const & point(int vertex) const { return points_[static_cast<std::size_t>(vertex)]; }
+
+      void record(int v0, int v1, int v2, int v3)
+      {
+        if (cells_)
+        {
+          int * cell = cells_ + 4 * count_;
+          cell[0] = v0; cell[1] = v1; cell[2] = v2; cell[3] = v3;
+        }
+        ++count_;
+      }
+
+      std::size_t count() const { return count_; }
+
+    private:
+      std::vector<PointT> const & points_;
+      int *                       cells_;
+      std::size_t                 count_;
+    };
+
+  }
+
+  namespace result_of
+  {
+    /** \cond */
+    template <typename PointT>
+    struct handle< viennagrid::detail::refinement_recorder<PointT>, vertex_tag >
+    {
+      typedef int type;
+    };
+    /** \endcond */
+  }
+
+  namespace detail
+  {
+
+    /** @brief Records a tetrahedron instead of creating it, found by argument dependent lookup from element_refinement<tetrahedron_tag> */
+    template <typename ElementType, typename PointT, typename VertexHandleContainer>
+    void make_refinement_element(refinement_recorder<PointT> & recorder, VertexHandleContainer vertex_handle_container, unsigned int i0, unsigned int i1, unsigned int i2, unsigned int i3)
+    {
+      recorder.record(*viennagrid::advance(vertex_handle_container.begin(), i0), *viennagrid::advance(vertex_handle_container.begin(), i1),
+                      *viennagrid::advance(vertex_handle_container.begin(), i2), *viennagrid::advance(vertex_handle_container.begin(), i3));
+    }
+
+    /** @brief Same as stable_line_is_longer() for the vertices of a mesh, the vertex indices take the place of the vertex IDs */
+    template <typename PointT, typename VertexHandleContainer>
+    bool stable_line_is_longer(refinement_recorder<PointT> const & recorder, VertexHandleContainer vertices, unsigned int i0, unsigned int i1, unsigned int i2, unsigned int i3)
+    {
+      typedef typename viennagrid::result_of::coord<PointT>::type ScalarType;
+
+      int v1_1 = *viennagrid::advance(vertices.begin(), i0);
+      int v1_2 = *viennagrid::advance(vertices.begin(), i1);
+      int v2_1 = *viennagrid::advance(vertices.begin(), i2);
+      int v2_2 = *viennagrid::advance(vertices.begin(), i3);
+
+      ScalarType line1 = viennagrid::norm( recorder.point(v1_1) - recorder.point(v1_2) );
+      ScalarType line2 = viennagrid::norm( recorder.point(v2_1) - recorder.point(v2_2) );
+
+      if (line1 > line2)
+        return true;
+      if (line1 < line2)
+        return false;
+
+      // equal length: the line with the larger vertex indices is considered as longer
+      int min1 = std::min(v1_1, v1_2), max1 = std::max(v1_1, v1_2);
+      int min2 = std::min(v2_1, v2_2), max2 = std::max(v2_1, v2_2);
+      return min1 > min2 || (min1 == min2 && max1 > max2);
+    }
+
+
+    /** @brief Same as refinement_line_length() for the vertices of a mesh */
+    template <typename PointT, typename VertexHandleContainer>
+    double refinement_line_length(refinement_recorder<PointT> const & recorder, VertexHandleContainer vertices, unsigned int i0, unsigned int i1)
+    {
+      return viennagrid::norm( recorder.point(vertices[i0]) - recorder.point(vertices[i1]) );
+    }
+
+
+    /** @brief The local vertices of the edges and triangles of a tetrahedron, in the order of its boundary elements */
+    inline int const * tetrahedron_edge_vertices(int edge)
+    {
+      static const int vertices[6][2] = { {0, 1}, {0, 2}, {0, 3}, {1, 2}, {1, 3}, {2, 3} };
+      return vertices[edge];
+    }
+
+    inline int const * tetrahedron_triangle_vertices(int triangle)
+    {
+      static const int vertices[4][3] = { {0, 1, 2}, {0, 1, 3}, {0, 2, 3}, {1, 2, 3} };
+      return vertices[triangle];
+    }
+
+    /** @brief Returns the local index of the edge between two local vertices (i < j) of a tetrahedron */
+    inline int tetrahedron_edge(int i, int j)
+    {
+      static const int edges[4][4] = { {-1, 0, 1, 2}, {0, -1, 3, 4}, {1, 3, -1, 5}, {2, 4, 5, -1} };
+      return edges[i][j];
+    }
+
+    /** @brief Writes the vertex indices of the boundary simplex 'entry' = cell * num + local to 'key', sorted ascending */
+    template <int SizeT>
+    void tetrahedron_boundary_key(std::vector<int> const & cell_vertices, std::size_t entry, int * key)
+    {
+      static const int num = (SizeT == 2) ? 6 : 4;
+      int const * cell  = &cell_vertices[4 * (entry / num)];
+      int const * local = (SizeT == 2) ? tetrahedron_edge_vertices(static_cast<int>(entry % num))
+                                       : tetrahedron_triangle_vertices(static_cast<int>(entry % num));
+      for (int i = 0; i < SizeT; ++i)
+        key[i] = cell[local[i]];
+      std::sort(key, key + SizeT);
+    }
+
+    /** @brief Numbers the distinct edges (SizeT = 2) or triangles (SizeT = 3) of tetrahedra given by their vertex indices.
+     *
+     * Each entry, i.e. an edge or triangle of a cell, is put into the bucket of its smallest vertex and compared to the earlier entries of the bucket only.
+     * The distinct simplices are numbered in the order of their first entries.
+     *
+     * @param cell_vertices    The four vertex indices of each cell
+     * @param vertex_count     The number of vertices
+     * @param index_of_entry   Returns the index of the simplex of each entry
+     * @param first_entries    Returns the first entry of each simplex
+     */
+    template <int SizeT>
+    void number_tetrahedron_boundary(std::vector<int> const & cell_vertices, std::size_t vertex_count,
+                                     std::vector<int> & index_of_entry, std::vector<std::size_t> & first_entries)
+    {
+      static const int num = (SizeT == 2) ? 6 : 4;
+      std::size_t const entry_count = cell_vertices.size() / 4 * num;
+
+      // the entries sorted by their smallest vertex, in ascending order within a bucket
+      std::vector<std::size_t> bucket_offsets(vertex_count + 1, 0);
+      std::vector<int>         smallest(entry_count);
+      for (std::size_t e = 0; e < entry_count; ++e)
+      {
+        int key[SizeT];
+        tetrahedron_boundary_key<SizeT>(cell_vertices, e, key);
+        smallest[e] = key[0];
+        ++bucket_offsets[static_cast<std::size_t>(key[0]) + 1];
+      }
+      for (std::size_t v = 0; v < vertex_count; ++v)
+        bucket_offsets[v+1] += bucket_offsets[v];
+
+      std::vector<std::size_t> bucket_entries(entry_count);
+      {
+        std::vector<std::size_t> position(bucket_offsets.begin(), bucket_offsets.end() - 1);
+        for (std::size_t e = 0; e < entry_count; ++e)
+          bucket_entries[position[static_cast<std::size_t>(smallest[e])]++] = e;
+      }
+
+      // the first entry with the same vertices
+      std::vector<std::size_t> first(entry_count);
+      long const bucket_count = static_cast<long>(vertex_count);
+#ifdef _OPENMP
+      #pragma omp parallel
+#endif
+      {
+        std::vector<int> keys;
+#ifdef _OPENMP
+        #pragma omp for schedule(dynamic, 1024)
+#endif
+        for (long v = 0; v < bucket_count; ++v)
+        {
+          std::size_t const begin = bucket_offsets[v], end = bucket_offsets[v+1];
+          keys.resize(SizeT * (end - begin));
+          for (std::size_t i = begin; i < end; ++i)
+          {
+            int * key = &keys[SizeT * (i - begin)];
+            tetrahedron_boundary_key<SizeT>(cell_vertices, bucket_entries[i], key);
+
+            first[bucket_entries[i]] = bucket_entries[i];
+            for (std::size_t j = begin; j < i; ++j)
+              if (std::equal(key, key + SizeT, &keys[SizeT * (j - begin)]))
+              {
+                first[bucket_entries[i]] = bucket_entries[j];
+                break;
+              }
+          }
+        }
+      }
+
+      // numbered in the order of the first entries
+      index_of_entry.resize(entry_count);
+      first_entries.clear();
+      for (std::size_t e = 0; e < entry_count; ++e)
+        if (first[e] == e)
+        {
+          index_of_entry[e] = static_cast<int>(first_entries.size());
+          first_entries.push_back(e);
+        }
+
+      long const count = static_cast<long>(entry_count);
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long e = 0; e < count; ++e)
+        if (first[e] != static_cast<std::size_t>(e))
+          index_of_entry[e] = index_of_entry[first[e]];
+    }
+
+    /** @brief Collects the topology arrays of tetrahedra given by their vertex indices in the layout of a mesh cache file (see viennagrid/io/mesh_cache.hpp).
+     *
+     * The edges and triangles take the vertex order of the cell in which they appear first, as if the cells were created one after the other.
+     */
+    inline void tetrahedral_topology(std::vector<int> const & cell_vertices, std::size_t vertex_count,
+                                     io::mesh_cache_header & header, std::vector< std::vector<int> > & topology)
+    {
+      std::size_t const cell_count = cell_vertices.size() / 4;
+
+      std::vector<int>         edge_of_entry, triangle_of_entry;
+      std::vector<std::size_t> first_edge_entries, first_triangle_entries;
+      number_tetrahedron_boundary<2>(cell_vertices, vertex_count, edge_of_entry, first_edge_entries);
+      number_tetrahedron_boundary<3>(cell_vertices, vertex_count, triangle_of_entry, first_triangle_entries);
+
+      std::size_t const edge_count     = first_edge_entries.size();
+      std::size_t const triangle_count = first_triangle_entries.size();
+      header.cell_count         = cell_count;
+      header.boundary_counts[0] = edge_count;
+      header.boundary_counts[1] = triangle_count;
+
+      // edges: IDs, vertices; triangles: IDs, vertices, edges; cells: edges, triangles
+      topology.resize(7);
+      topology[0].resize(edge_count);
+      topology[1].resize(2 * edge_count);
+      topology[2].resize(triangle_count);
+      topology[3].resize(3 * triangle_count);
+      topology[4].resize(3 * triangle_count);
+
+      long const edges = static_cast<long>(edge_count);
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long i = 0; i < edges; ++i)
+      {
+        std::size_t const entry = first_edge_entries[i];
+        int const * cell  = &cell_vertices[4 * (entry / 6)];
+        int const * local = tetrahedron_edge_vertices(static_cast<int>(entry % 6));
+
+        topology[0][i]       = static_cast<int>(i);
+        topology[1][2*i]     = cell[local[0]];
+        topology[1][2*i + 1] = cell[local[1]];
+      }
+
+      long const triangles = static_cast<long>(triangle_count);
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long i = 0; i < triangles; ++i)
+      {
+        std::size_t const entry = first_triangle_entries[i];
+        std::size_t const c     = entry / 4;
+        int const * cell  = &cell_vertices[4 * c];
+        int const * local = tetrahedron_triangle_vertices(static_cast<int>(entry % 4));
+
+        topology[2][i] = static_cast<int>(i);
+        for (int j = 0; j < 3; ++j)
+          topology[3][3*i + j] = cell[local[j]];
+
+        // the edges of the triangle in the order of its boundary elements, taken from the same cell
+        topology[4][3*i]     = edge_of_entry[6 * c + tetrahedron_edge(local[0], local[1])];
+        topology[4][3*i + 1] = edge_of_entry[6 * c + tetrahedron_edge(local[0], local[2])];
+        topology[4][3*i + 2] = edge_of_entry[6 * c + tetrahedron_edge(local[1], local[2])];
+      }
+
+      edge_of_entry.swap(topology[5]);
+      triangle_of_entry.swap(topology[6]);
+    }
+
+
+    /** @brief Appends pointers to the elements of a range to 'elements' */
+    template <typename RangeT, typename ElementT>
+    void collect_elements(RangeT const & range, std::vector<ElementT const *> & elements)
+    {
+      elements.reserve(elements.size() + range.size());
+      for (typename viennagrid::result_of::iterator<RangeT const>::type it = range.begin(); it != range.end(); ++it)
+        elements.push_back( &*it );
+    }
+
+
+    /** @brief Refines tetrahedra in parallel into an empty mesh, see the file description.
+     *
+     * The vertices of the refined mesh are the vertices of the input mesh followed by the midpoints of the refined edges, both in the order of their ranges.
+     * The refined cells are created in the order of the input cells.
+     *
+     * @param mesh_in                           Input mesh
+     * @param cells_in                          The cells to be refined, in the order in which their children are created
+     * @param mesh_out                          Output refined mesh, must be empty
+     * @param point_accessor_in                 Point accessor for input points
+     * @param edge_refinement_flag_accessor     Accessor storing flags if an edge is marked for refinement
+     * @param vertex_to_vertex_handle_accessor  Returns the vertex of the refined mesh of each input vertex
+     * @param edge_to_vertex_handle_accessor    Returns the vertex of the refined mesh of each refined input edge
+     * @param child_offsets                     Returns the children of input cell i, which are the cells child_offsets[i] to child_offsets[i+1]-1 of 'children'
+     * @param children                          Returns the handles of the refined cells
+     */
+    template <typename WrappedMeshConfigInT, typename CellInT, typename WrappedMeshConfigOutT, typename PointAccessorT,
+              typename EdgeRefinementFlagAccessorT, typename VertexToVertexHandleAccessorT, typename RefinementVertexAccessorT, typename CellHandleOutT>
+    void refine_tetrahedra_parallel(mesh<WrappedMeshConfigInT> const & mesh_in, std::vector<CellInT const *> const & cells_in,
+                                    mesh<WrappedMeshConfigOutT> & mesh_out,
+                                    PointAccessorT const point_accessor_in,
+                                    EdgeRefinementFlagAccessorT const edge_refinement_flag_accessor,
+                                    VertexToVertexHandleAccessorT vertex_to_vertex_handle_accessor,
+                                    RefinementVertexAccessorT edge_to_vertex_handle_accessor,
+                                    std::vector<std::size_t> & child_offsets, std::vector<CellHandleOutT> & children)
+    {
+      typedef mesh<WrappedMeshConfigInT>                                                                MeshInType;
+      typedef mesh<WrappedMeshConfigOutT>                                                               MeshOutType;
+
+      typedef typename viennagrid::result_of::const_element_range<MeshInType, vertex_tag>::type          VertexRange;
+      typedef typename viennagrid::result_of::const_element_range<MeshInType, line_tag>::type            EdgeRange;
+      typedef typename viennagrid::result_of::element<MeshInType, vertex_tag>::type                      VertexInType;
+      typedef typename viennagrid::result_of::element<MeshInType, line_tag>::type                        EdgeInType;
+
+      typedef typename viennagrid::result_of::point<MeshOutType>::type                                   PointType;
+      typedef typename viennagrid::result_of::element<MeshOutType, vertex_tag>::type                     VertexOutType;
+      typedef typename viennagrid::result_of::handle<MeshOutType, vertex_tag>::type                      VertexHandleOutType;
+
+      //
+      // Step 1: The vertices of the input mesh, followed by the midpoints of the refined edges, numbered by a prefix sum over the edges
+      //
+      // the ranges are not random access, the elements are collected for the parallel loops
+      std::vector<VertexInType const *> vertices;
+      std::vector<EdgeInType const *>   edges;
+      collect_elements(VertexRange(mesh_in), vertices);
+      collect_elements(EdgeRange(mesh_in), edges);
+      long const vertex_count = static_cast<long>(vertices.size());
+      long const edge_count   = static_cast<long>(edges.size());
+
+      std::vector<int> vertex_index(static_cast<std::size_t>(viennagrid::id_upper_bound<VertexInType>(mesh_in).get()) + 1, -1);
+      std::vector<int> edge_index(static_cast<std::size_t>(viennagrid::id_upper_bound<EdgeInType>(mesh_in).get()) + 1, -1);
+
+      std::vector<int> edge_offsets(edge_count + 1, 0);
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long i = 0; i < edge_count; ++i)
+        edge_offsets[i+1] = edge_refinement_flag_accessor(*edges[i]) ? 1 : 0;
+      for (long i = 0; i < edge_count; ++i)
+        edge_offsets[i+1] += edge_offsets[i];
+
+      std::vector<PointType> points(static_cast<std::size_t>(vertex_count + edge_offsets[edge_count]));
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long i = 0; i < vertex_count; ++i)
+      {
+        vertex_index[static_cast<std::size_t>(vertices[i]->id().get())] = static_cast<int>(i);
+        points[i] = point_accessor_in(*vertices[i]);
+      }
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long i = 0; i < edge_count; ++i)
+        if (edge_offsets[i+1] > edge_offsets[i])
+        {
+          int index = static_cast<int>(vertex_count) + edge_offsets[i];
+          edge_index[static_cast<std::size_t>(edges[i]->id().get())] = index;
+          points[index] = viennagrid::centroid(point_accessor_in, *edges[i]);
+        }
+
+      //
+      // Step 2: The children of each cell, counted first and then written to the positions given by a prefix sum over the cells
+      //
+      typedef typename viennagrid::result_of::accessor<std::vector<int> const, VertexInType>::type   VertexIndexAccessorType;
+      typedef typename viennagrid::result_of::accessor<std::vector<int> const, EdgeInType>::type     EdgeIndexAccessorType;
+      VertexIndexAccessorType vertex_index_accessor(vertex_index);
+      EdgeIndexAccessorType   edge_index_accessor(edge_index);
+
+      long const cell_count = static_cast<long>(cells_in.size());
+      child_offsets.assign(cells_in.size() + 1, 0);
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long i = 0; i < cell_count; ++i)
+      {
+        refinement_recorder<PointType> recorder(points, NULL);
+        element_refinement<tetrahedron_tag>::apply(*cells_in[i], recorder, edge_refinement_flag_accessor, vertex_index_accessor, edge_index_accessor);
+        child_offsets[i+1] = recorder.count();
+      }
+      for (long i = 0; i < cell_count; ++i)
+        child_offsets[i+1] += child_offsets[i];
+
+      std::vector<int> cell_vertices(4 * child_offsets[cell_count]);
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long i = 0; i < cell_count; ++i)
+      {
+        refinement_recorder<PointType> recorder(points, cell_vertices.empty() ? NULL : &cell_vertices[4 * child_offsets[i]]);
+        element_refinement<tetrahedron_tag>::apply(*cells_in[i], recorder, edge_refinement_flag_accessor, vertex_index_accessor, edge_index_accessor);
+      }
+
+      //
+      // Step 3: The edges and triangles of the children
+      //
+      io::mesh_cache_header header;
+      std::vector< std::vector<int> > topology;
+      tetrahedral_topology(cell_vertices, points.size(), header, topology);
+
+      //
+      // Step 4: Create the refined mesh with the given boundary elements, as from a mesh cache file
+      //
+      io::detail::mesh_cache_handles<MeshOutType, 2> handles;
+      std::vector<VertexHandleOutType> & vertex_handles = static_cast<io::detail::mesh_cache_handles<MeshOutType, 0> &>(handles).handles;
+      vertex_handles.resize(points.size());
+      for (std::size_t i = 0; i < points.size(); ++i)
+        vertex_handles[i] = viennagrid::make_vertex_with_id( mesh_out, typename VertexOutType::id_type(i), points[i] );
+
+      io::detail::mesh_cache_topology_reader<1, 3>::create(mesh_out, header, &topology[0], handles);
+
+      std::vector<int> const * cell_arrays[3] = { &cell_vertices, &topology[5], &topology[6] };
+      children.resize(child_offsets[cell_count]);
+      for (std::size_t i = 0; i < children.size(); ++i)
+        children[i] = io::detail::mesh_cache_make_element<3>(mesh_out, static_cast<int>(i), cell_arrays, i, handles);
+
+      // the temporary accessors of the cell by cell refinement
+      for (long i = 0; i < vertex_count; ++i)
+        vertex_to_vertex_handle_accessor(*vertices[i]) = vertex_handles[i];
+      for (long i = 0; i < edge_count; ++i)
+        if (edge_offsets[i+1] > edge_offsets[i])
+          edge_to_vertex_handle_accessor(*edges[i]) = vertex_handles[vertex_count + edge_offsets[i]];
+    }
+
+
+
+    /** @brief Refines a tetrahedral mesh in parallel into an empty mesh, the parameters are the ones of refine_impl() */
+    template <typename WrappedMeshConfigInT, typename WrappedMeshConfigOutT, typename PointAccessorT,
+              typename EdgeRefinementFlagAccessorT, typename VertexToVertexHandleAccessorT, typename RefinementVertexAccessorT>
+    void refine_parallel_impl(mesh<WrappedMeshConfigInT> const & mesh_in,
+                              mesh<WrappedMeshConfigOutT> & mesh_out,
+                              PointAccessorT const point_accessor_in,
+                              EdgeRefinementFlagAccessorT const edge_refinement_flag_accessor,
+                              VertexToVertexHandleAccessorT vertex_to_vertex_handle_accessor,
+                              RefinementVertexAccessorT edge_to_vertex_handle_accessor)
+    {
+      typedef mesh<WrappedMeshConfigInT>                                                                MeshInType;
+      typedef typename viennagrid::result_of::const_element_range<MeshInType, tetrahedron_tag>::type     CellRange;
+      typedef typename viennagrid::result_of::element<MeshInType, tetrahedron_tag>::type                 CellInType;
+      typedef typename viennagrid::result_of::handle<mesh<WrappedMeshConfigOutT>, tetrahedron_tag>::type CellHandleOutType;
+
+      std::vector<CellInType const *> cells_in;
+      collect_elements(CellRange(mesh_in), cells_in);
+
+      std::vector<std::size_t>       child_offsets;
+      std::vector<CellHandleOutType> children;
+      refine_tetrahedra_parallel(mesh_in, cells_in, mesh_out, point_accessor_in, edge_refinement_flag_accessor,
+                                 vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor, child_offsets, children);
+    }
+
+
+    /** @brief Refines a tetrahedral mesh with segmentation in parallel into an empty mesh, the parameters are the ones of refine_impl().
+     *
+     * As in the cell by cell refinement, a cell in several segments is refined once per segment, each segment gets children of its own.
+     */
+    template <typename WrappedMeshConfigInT,  typename WrappedSegmentationConfigInT,
+              typename WrappedMeshConfigOutT, typename WrappedSegmentationConfigOutT,
+              typename PointAccessorT,
+              typename EdgeRefinementFlagAccessorT, typename VertexToVertexHandleAccessorT, typename RefinementVertexAccessorT>
+    void refine_parallel_impl(mesh<WrappedMeshConfigInT> const & mesh_in,    segmentation<WrappedSegmentationConfigInT> const & segmentation_in,
+                              mesh<WrappedMeshConfigOutT>      & mesh_out,   segmentation<WrappedSegmentationConfigOutT>      & segmentation_out,
+                              PointAccessorT const point_accessor_in,
+                              EdgeRefinementFlagAccessorT const edge_refinement_flag_accessor,
+                              VertexToVertexHandleAccessorT vertex_to_vertex_handle_accessor,
+                              RefinementVertexAccessorT edge_to_vertex_handle_accessor)
+    {
+      typedef mesh<WrappedMeshConfigInT>                                                                MeshInType;
+      typedef mesh<WrappedMeshConfigOutT>                                                               MeshOutType;
+      typedef segmentation<WrappedSegmentationConfigInT>                                                SegmentationInType;
+      typedef segmentation<WrappedSegmentationConfigOutT>                                               SegmentationOutType;
+
+      typedef typename viennagrid::result_of::segment_handle<SegmentationInType>::type                   SegmentHandleInType;
+      typedef typename viennagrid::result_of::segment_handle<SegmentationOutType>::type                  SegmentHandleOutType;
+      typedef typename viennagrid::result_of::const_element_range<SegmentHandleInType, tetrahedron_tag>::type  CellRange;
+      typedef typename viennagrid::result_of::element<MeshInType, tetrahedron_tag>::type                 CellInType;
+      typedef typename viennagrid::result_of::handle<MeshOutType, tetrahedron_tag>::type                 CellHandleOutType;
+
+      // the cells in the order of the segments, once per segment containing them
+      std::vector<CellInType const *> cells_in;
+      for (typename SegmentationInType::const_iterator sit = segmentation_in.begin(); sit != segmentation_in.end(); ++sit)
+      {
+        segmentation_out( sit->id() );
+        collect_elements(CellRange(*sit), cells_in);
+      }
+
+      std::vector<std::size_t>       child_offsets;
+      std::vector<CellHandleOutType> children;
+      refine_tetrahedra_parallel(mesh_in, cells_in, mesh_out, point_accessor_in, edge_refinement_flag_accessor,
+                                 vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor, child_offsets, children);
+
+      std::size_t index = 0;
+      for (typename SegmentationInType::const_iterator sit = segmentation_in.begin(); sit != segmentation_in.end(); ++sit)
+      {
+        SegmentHandleOutType & segment_out = segmentation_out( sit->id() );
+
+        std::size_t const cell_count = CellRange(*sit).size();
+        for (std::size_t j = 0; j < cell_count; ++j, ++index)
+          for (std::size_t i = child_offsets[index]; i < child_offsets[index+1]; ++i)
+            viennagrid::add( segment_out, viennagrid::dereference_handle(mesh_out, children[i]) );
+      }
+    }
+
+  } // namespace detail
+}
+
+#endif
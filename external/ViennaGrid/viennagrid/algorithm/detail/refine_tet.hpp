@@ -103,6 +103,13 @@ namespace viennagrid
       viennagrid::make_element<ElementType>( mesh_obj, cellvertices.begin(), cellvertices.end() );
     }
 
+    /** @brief Returns the distance of the vertices i0 and i1 of a container of vertex handles */
+    template<typename GeometricContainerType, typename VertexHandleContainer>
+    double refinement_line_length(GeometricContainerType const & mesh_obj, VertexHandleContainer vertices, unsigned int i0, unsigned int i1)
+    {
+      return viennagrid::norm( viennagrid::point(mesh_obj, vertices[i0]) - viennagrid::point(mesh_obj, vertices[i1]) );
+    }
+
 
 
 
@@ -138,7 +145,7 @@ namespace viennagrid
         vertex_handles[3] = vertex_to_vertex_handle_accessor(*vocit);
 
         // Step 2: Add new cells to new mesh:
-        viennagrid::make_element<ElementType>( segment_out, vertex_handles.begin(), vertex_handles.end() );
+        make_refinement_element<ElementType>( segment_out, vertex_handles, 0, 1, 2, 3);
 
       }
 
@@ -328,7 +335,7 @@ namespace viennagrid
         typedef typename viennagrid::result_of::const_element_range<ElementType, line_tag>::type            EdgeOnCellRange;
         typedef typename viennagrid::result_of::iterator<EdgeOnCellRange>::type           EdgeOnCellIterator;
 
-        typedef typename viennagrid::result_of::handle<ElementType, vertex_tag>::type             VertexHandleType;
+        typedef typename viennagrid::result_of::handle<MeshTypeOut, vertex_tag>::type             VertexHandleType;
         typedef typename viennagrid::result_of::element<ElementType, line_tag>::type             EdgeType;
 
         static_array< VertexHandleType, boundary_elements<tetrahedron_tag, vertex_tag>::num > vertices;
@@ -821,7 +828,7 @@ namespace viennagrid
         typedef typename viennagrid::result_of::const_element_range<ElementType, line_tag>::type            EdgeOnCellRange;
         typedef typename viennagrid::result_of::iterator<EdgeOnCellRange>::type           EdgeOnCellIterator;
 
-        typedef typename viennagrid::result_of::handle<ElementType, vertex_tag>::type             VertexHandleType;
+        typedef typename viennagrid::result_of::handle<MeshTypeOut, vertex_tag>::type             VertexHandleType;
         typedef typename viennagrid::result_of::element<ElementType, line_tag>::type             EdgeType;
 
         static_array< VertexHandleType, boundary_elements<tetrahedron_tag, vertex_tag>::num > vertices;
@@ -1450,7 +1457,7 @@ namespace viennagrid
         typedef typename viennagrid::result_of::const_element_range<ElementType, line_tag>::type            EdgeOnCellRange;
         typedef typename viennagrid::result_of::iterator<EdgeOnCellRange>::type           EdgeOnCellIterator;
 
-        typedef typename viennagrid::result_of::handle<ElementType, vertex_tag>::type             VertexHandleType;
+        typedef typename viennagrid::result_of::handle<MeshTypeOut, vertex_tag>::type             VertexHandleType;
         typedef typename viennagrid::result_of::element<ElementType, line_tag>::type             EdgeType;
 
         static_array< VertexHandleType, boundary_elements<tetrahedron_tag, vertex_tag>::num > vertices;
@@ -1794,7 +1801,7 @@ namespace viennagrid
         typedef typename viennagrid::result_of::const_element_range<ElementType, line_tag>::type            EdgeOnCellRange;
         typedef typename viennagrid::result_of::iterator<EdgeOnCellRange>::type           EdgeOnCellIterator;
 
-        typedef typename viennagrid::result_of::handle<ElementType, vertex_tag>::type             VertexHandleType;
+        typedef typename viennagrid::result_of::handle<MeshTypeOut, vertex_tag>::type             VertexHandleType;
         typedef typename viennagrid::result_of::element<ElementType, line_tag>::type             EdgeType;
 
         static_array< VertexHandleType, boundary_elements<tetrahedron_tag, vertex_tag>::num > vertices;
@@ -1930,7 +1937,7 @@ namespace viennagrid
         typedef typename viennagrid::result_of::const_element_range<ElementType, line_tag>::type            EdgeOnCellRange;
         typedef typename viennagrid::result_of::iterator<EdgeOnCellRange>::type           EdgeOnCellIterator;
 
-        typedef typename viennagrid::result_of::handle<ElementType, vertex_tag>::type             VertexHandleType;
+        typedef typename viennagrid::result_of::handle<MeshTypeOut, vertex_tag>::type             VertexHandleType;
 
         static_array< VertexHandleType, boundary_elements<tetrahedron_tag, vertex_tag>::num +
                                                boundary_elements<tetrahedron_tag, line_tag>::num> vertices;
@@ -1976,9 +1983,9 @@ namespace viennagrid
         //3-8-6-9:
         make_refinement_element<ElementType>( segment_out, vertices, 3, 8, 6, 9);
 
-        double diag58 = viennagrid::norm( viennagrid::point(segment_out, vertices[5]) - viennagrid::point(segment_out, vertices[8]) );
-        double diag67 = viennagrid::norm( viennagrid::point(segment_out, vertices[6]) - viennagrid::point(segment_out, vertices[7]) );
-        double diag49 = viennagrid::norm( viennagrid::point(segment_out, vertices[4]) - viennagrid::point(segment_out, vertices[9]) );
+        double diag58 = refinement_line_length(segment_out, vertices, 5, 8);
+        double diag67 = refinement_line_length(segment_out, vertices, 6, 7);
+        double diag49 = refinement_line_length(segment_out, vertices, 4, 9);
 
         if ( (diag58 <= diag67) && (diag58 <= diag49) )  //diag58 is shortest: keep it, split others
         {
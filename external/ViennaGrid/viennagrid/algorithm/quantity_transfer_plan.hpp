@@ -0,0 +1,243 @@
+#ifndef VIENNAGRID_ALGORITHM_QUANTITY_TRANSFER_PLAN_HPP
+#define VIENNAGRID_ALGORITHM_QUANTITY_TRANSFER_PLAN_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#include <vector>
+#include <limits>
+#include "viennagrid/forwards.hpp"
+#include "viennagrid/mesh/mesh.hpp"
+#include "viennagrid/algorithm/volume.hpp"
+#include "viennagrid/algorithm/quantity_transfer.hpp"
+
+/** @file viennagrid/algorithm/quantity_transfer_plan.hpp
+    @brief Provides a precomputed transfer of quantities from elements to their boundary elements (e.g. from cells to vertices), which is reused for several quantities.
+*/
+
+namespace viennagrid
+{
+  /** @brief All adjacent source elements contribute with the same weight, i.e. the arithmetic average of viennautils::arithmetic_averaging */
+  struct arithmetic_transfer_weighting_tag {};
+
+  /** @brief The adjacent source elements contribute according to their volume */
+  struct volume_transfer_weighting_tag {};
+
+  namespace detail
+  {
+    /** @brief A filter accepting all elements */
+    struct any_transfer_filter
+    {
+      template <typename ElementT>
+      bool operator()(ElementT const &) const { return true; }
+    };
+
+    template <typename ElementT>
+    double transfer_weight(ElementT const &, arithmetic_transfer_weighting_tag) { return 1.0; }
+
+    template <typename ElementT>
+    double transfer_weight(ElementT const & element, volume_transfer_weighting_tag) { return viennagrid::volume(element); }
+  }
+
+  /** @brief A transfer of quantities from elements of topological dimension 'dim_src' to their boundary elements of dimension 'dim_dest', e.g. from cells to vertices.
+   *
+   * The adjacency and the weights are set up once per mesh and stored as a compressed sparse row table: the row of a destination element holds
+   * the indices of the adjacent source elements along with their normalized weights. Any number of quantities are then transferred in a single pass over the table,
+   * which is run in parallel if OpenMP is enabled. The values are exchanged through contiguous arrays, in which field 'f' occupies the block starting at
+   * f * source_size() (f * destination_size(), respectively). The elements are ordered as in the plan, see gather() and scatter().
+   *
+   * Same as quantity_transfer(), a destination element is only set if at least one accepted source element is adjacent to it.
+   *
+   * @tparam MeshOrSegmentT         The mesh or segment, in which the source and destination elements reside. The plan is valid as long as the mesh is not modified.
+   * @tparam SourceTypeOrTag        Element type or tag of the source elements
+   * @tparam DestinationTypeOrTag   Element type or tag of the destination elements, of lower topological dimension than the source elements
+   */
+  template <typename MeshOrSegmentT, typename SourceTypeOrTag, typename DestinationTypeOrTag>
+  class quantity_transfer_plan
+  {
+    typedef typename viennagrid::result_of::element_tag<SourceTypeOrTag>::type                      SourceTag;
+    typedef typename viennagrid::result_of::element_tag<DestinationTypeOrTag>::type                 DestinationTag;
+
+    typedef typename viennagrid::result_of::element<MeshOrSegmentT, SourceTag>::type                SourceElementType;
+    typedef typename viennagrid::result_of::element<MeshOrSegmentT, DestinationTag>::type           DestElementType;
+
+    typedef typename viennagrid::result_of::const_element_range<MeshOrSegmentT, SourceTag>::type    SourceContainer;
+    typedef typename viennagrid::result_of::iterator<SourceContainer>::type                         SourceIterator;
+
+    typedef typename viennagrid::result_of::const_element_range<SourceElementType, DestinationTag>::type  DestOnSrcContainer;
+    typedef typename viennagrid::result_of::iterator<DestOnSrcContainer>::type                            DestOnSrcIterator;
+
+  public:
+    typedef std::size_t   size_type;
+
+    /** @brief Sets up the plan for all source and destination elements of the mesh or segment */
+    template <typename WeightingTagT>
+    quantity_transfer_plan(MeshOrSegmentT const & mesh_or_segment, WeightingTagT weighting)
+    {
+      build(mesh_or_segment, weighting, detail::any_transfer_filter(), detail::any_transfer_filter(),
+            typename detail::quantity_transfer_dispatcher<SourceTag, DestinationTag>::type());
+    }
+
+    /** @brief Sets up the plan for the source and destination elements accepted by the respective filter */
+    template <typename WeightingTagT, typename SourceFilterT, typename DestinationFilterT>
+    quantity_transfer_plan(MeshOrSegmentT const & mesh_or_segment, WeightingTagT weighting,
+                           SourceFilterT const & filter_src, DestinationFilterT const & filter_dest)
+    {
+      build(mesh_or_segment, weighting, filter_src, filter_dest,
+            typename detail::quantity_transfer_dispatcher<SourceTag, DestinationTag>::type());
+    }
+
+    /** @brief Returns the number of source elements taking part in the transfer */
+    size_type source_size() const { return sources_.size(); }
+
+    /** @brief Returns the number of destination elements, which receive a value */
+    size_type destination_size() const { return destinations_.size(); }
+
+    /** @brief Reads a quantity on the source elements into field 'field' of 'values', which is resized if required */
+    template <typename SourceAccessorT, typename NumericT>
+    void gather(SourceAccessorT const & accessor_src, std::vector<NumericT> & values, size_type field = 0) const
+    {
+      if (values.size() < (field + 1) * sources_.size())
+        values.resize((field + 1) * sources_.size());
+
+      size_type offset = field * sources_.size();
+      for (size_type i = 0; i < sources_.size(); ++i)
+        values[offset + i] = accessor_src(*sources_[i]);
+    }
+
+    /** @brief Transfers 'fields' quantities at once from the source values to the destination values, the latter are resized to 'fields' * destination_size() */
+    template <typename NumericT>
+    void apply(std::vector<NumericT> const & source_values, std::vector<NumericT> & destination_values, size_type fields = 1) const
+    {
+      destination_values.resize(fields * destinations_.size());
+
+      long rows = static_cast<long>(destinations_.size());
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long row = 0; row < rows; ++row)
+      {
+        for (size_type f = 0; f < fields; ++f)
+        {
+          size_type source_offset = f * sources_.size();
+          NumericT value = 0;
+          for (size_type k = row_offsets_[row]; k < row_offsets_[row + 1]; ++k)
+            value += weights_[k] * source_values[source_offset + columns_[k]];
+          destination_values[f * destinations_.size() + row] = value;
+        }
+      }
+    }
+
+    /** @brief Passes field 'field' of the destination values to the setter (first argument is the destination element, second argument is the value) */
+    template <typename DestinationSetterT, typename NumericT>
+    void scatter(std::vector<NumericT> const & destination_values, DestinationSetterT & setter_dest, size_type field = 0) const
+    {
+      size_type offset = field * destinations_.size();
+      for (size_type i = 0; i < destinations_.size(); ++i)
+        setter_dest(*destinations_[i], destination_values[offset + i]);
+    }
+
+    /** @brief Transfers a single quantity, the equivalent of quantity_transfer() */
+    template <typename SourceAccessorT, typename DestinationSetterT>
+    void operator()(SourceAccessorT const & accessor_src, DestinationSetterT & setter_dest) const
+    {
+      std::vector<typename SourceAccessorT::value_type> source_values, destination_values;
+      gather(accessor_src, source_values);
+      apply(source_values, destination_values);
+      scatter(destination_values, setter_dest);
+    }
+
+  private:
+
+    template <typename WeightingTagT, typename SourceFilterT, typename DestinationFilterT>
+    void build(MeshOrSegmentT const & mesh_or_segment, WeightingTagT weighting,
+               SourceFilterT const & filter_src, DestinationFilterT const & filter_dest,
+               detail::boundary_quantity_transfer_tag)
+    {
+      size_type const unset = std::numeric_limits<size_type>::max();
+
+      // the element ids of a mesh are dense, hence they index the destination rows
+      std::vector<size_type> row_of_id;
+      std::vector<size_type> row_sizes;
+
+      SourceContainer source_elements(mesh_or_segment);
+
+      // Step 1: Number the accepted elements and count the sources of each destination
+      for (SourceIterator sit = source_elements.begin(); sit != source_elements.end(); ++sit)
+      {
+        if ( !filter_src(*sit) ) continue;
+        sources_.push_back(&(*sit));
+
+        DestOnSrcContainer dest_on_src(*sit);
+        for (DestOnSrcIterator dosit = dest_on_src.begin(); dosit != dest_on_src.end(); ++dosit)
+        {
+          if ( !filter_dest(*dosit) ) continue;
+
+          size_type id = static_cast<size_type>(dosit->id().get());
+          if (id >= row_of_id.size())
+            row_of_id.resize(id + 1, unset);
+          if (row_of_id[id] == unset)
+          {
+            row_of_id[id] = destinations_.size();
+            destinations_.push_back(&(*dosit));
+            row_sizes.push_back(0);
+          }
+          ++row_sizes[row_of_id[id]];
+        }
+      }
+
+      row_offsets_.resize(destinations_.size() + 1);
+      row_offsets_[0] = 0;
+      for (size_type row = 0; row < destinations_.size(); ++row)
+        row_offsets_[row + 1] = row_offsets_[row] + row_sizes[row];
+
+      columns_.resize(row_offsets_.back());
+      weights_.resize(row_offsets_.back());
+
+      // Step 2: Fill the rows with the source indices and their weights
+      std::vector<size_type> fill(row_offsets_.begin(), row_offsets_.end() - 1);
+      for (size_type column = 0; column < sources_.size(); ++column)
+      {
+        double weight = detail::transfer_weight(*sources_[column], weighting);
+
+        DestOnSrcContainer dest_on_src(*sources_[column]);
+        for (DestOnSrcIterator dosit = dest_on_src.begin(); dosit != dest_on_src.end(); ++dosit)
+        {
+          if ( !filter_dest(*dosit) ) continue;
+
+          size_type k = fill[row_of_id[static_cast<size_type>(dosit->id().get())]]++;
+          columns_[k] = column;
+          weights_[k] = weight;
+        }
+      }
+
+      // Step 3: Normalize the weights of each row
+      for (size_type row = 0; row < destinations_.size(); ++row)
+      {
+        double sum = 0;
+        for (size_type k = row_offsets_[row]; k < row_offsets_[row + 1]; ++k)
+          sum += weights_[k];
+        for (size_type k = row_offsets_[row]; k < row_offsets_[row + 1]; ++k)
+          weights_[k] = (sum > 0) ? weights_[k] / sum : 1.0 / (row_offsets_[row + 1] - row_offsets_[row]);
+      }
+    }
+
+    std::vector<SourceElementType const *>  sources_;
+    std::vector<DestElementType const *>    destinations_;
+    std::vector<size_type>                  row_offsets_;
+    std::vector<size_type>                  columns_;
+    std::vector<double>                     weights_;
+  };
+
+}
+
+#endif
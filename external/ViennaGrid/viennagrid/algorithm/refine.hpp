@@ -21,9 +21,13 @@
 
 #include "viennagrid/algorithm/detail/refine_tri.hpp"
 #include "viennagrid/algorithm/detail/refine_tet.hpp"
+#include "viennagrid/algorithm/detail/refine_parallel.hpp"
 
 /** @file viennagrid/algorithm/refine.hpp
     @brief Provides the routines for a refinement of a mesh
+
+    Tetrahedral meshes refined into an empty mesh are refined in parallel, see viennagrid/algorithm/detail/refine_parallel.hpp.
+    The result is the same as the one of the cell by cell refinement, including overlapping segments, whose shared cells are refined once per segment.
 */
 
 namespace viennagrid
@@ -166,6 +170,82 @@ namespace viennagrid
     }
 
 
+
+
+    /** @brief For internal use only: Selects the refinement of a cell type, the cells are refined one after the other */
+    template <typename CellTagInT>
+    struct refinement_selector
+    {
+      template <typename WrappedMeshConfigInT, typename WrappedMeshConfigOutT, typename PointAccessorT,
+                typename EdgeRefinementFlagAccessorT, typename VertexToVertexHandleAccessorT, typename RefinementVertexAccessorT>
+      static void apply(mesh<WrappedMeshConfigInT> const & mesh_in,
+                        mesh<WrappedMeshConfigOutT> & mesh_out,
+                        PointAccessorT const point_accessor_in,
+                        EdgeRefinementFlagAccessorT const edge_refinement_flag_accessor,
+                        VertexToVertexHandleAccessorT vertex_to_vertex_handle_accessor,
+                        RefinementVertexAccessorT edge_to_vertex_handle_accessor)
+      {
+        refine_impl<CellTagInT>(mesh_in, mesh_out, point_accessor_in,
+                                edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
+      }
+
+      template <typename WrappedMeshConfigInT,  typename WrappedSegmentationConfigInT,
+                typename WrappedMeshConfigOutT, typename WrappedSegmentationConfigOutT,
+                typename PointAccessorT,
+                typename EdgeRefinementFlagAccessorT, typename VertexToVertexHandleAccessorT, typename RefinementVertexAccessorT>
+      static void apply(mesh<WrappedMeshConfigInT> const & mesh_in,    segmentation<WrappedSegmentationConfigInT> const & segmentation_in,
+                        mesh<WrappedMeshConfigOutT>      & mesh_out,   segmentation<WrappedSegmentationConfigOutT>      & segmentation_out,
+                        PointAccessorT const point_accessor_in,
+                        EdgeRefinementFlagAccessorT const edge_refinement_flag_accessor,
+                        VertexToVertexHandleAccessorT vertex_to_vertex_handle_accessor,
+                        RefinementVertexAccessorT edge_to_vertex_handle_accessor)
+      {
+        refine_impl<CellTagInT>(mesh_in, segmentation_in, mesh_out, segmentation_out, point_accessor_in,
+                                edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
+      }
+    };
+
+    /** @brief For internal use only: Tetrahedra are refined in parallel if the output mesh is empty */
+    template <>
+    struct refinement_selector<tetrahedron_tag>
+    {
+      template <typename WrappedMeshConfigInT, typename WrappedMeshConfigOutT, typename PointAccessorT,
+                typename EdgeRefinementFlagAccessorT, typename VertexToVertexHandleAccessorT, typename RefinementVertexAccessorT>
+      static void apply(mesh<WrappedMeshConfigInT> const & mesh_in,
+                        mesh<WrappedMeshConfigOutT> & mesh_out,
+                        PointAccessorT const point_accessor_in,
+                        EdgeRefinementFlagAccessorT const edge_refinement_flag_accessor,
+                        VertexToVertexHandleAccessorT vertex_to_vertex_handle_accessor,
+                        RefinementVertexAccessorT edge_to_vertex_handle_accessor)
+      {
+        if ( viennagrid::elements<vertex_tag>(mesh_out).empty() )
+          refine_parallel_impl(mesh_in, mesh_out, point_accessor_in,
+                               edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
+        else
+          refine_impl<tetrahedron_tag>(mesh_in, mesh_out, point_accessor_in,
+                                       edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
+      }
+
+      template <typename WrappedMeshConfigInT,  typename WrappedSegmentationConfigInT,
+                typename WrappedMeshConfigOutT, typename WrappedSegmentationConfigOutT,
+                typename PointAccessorT,
+                typename EdgeRefinementFlagAccessorT, typename VertexToVertexHandleAccessorT, typename RefinementVertexAccessorT>
+      static void apply(mesh<WrappedMeshConfigInT> const & mesh_in,    segmentation<WrappedSegmentationConfigInT> const & segmentation_in,
+                        mesh<WrappedMeshConfigOutT>      & mesh_out,   segmentation<WrappedSegmentationConfigOutT>      & segmentation_out,
+                        PointAccessorT const point_accessor_in,
+                        EdgeRefinementFlagAccessorT const edge_refinement_flag_accessor,
+                        VertexToVertexHandleAccessorT vertex_to_vertex_handle_accessor,
+                        RefinementVertexAccessorT edge_to_vertex_handle_accessor)
+      {
+        if ( viennagrid::elements<vertex_tag>(mesh_out).empty() )
+          refine_parallel_impl(mesh_in, segmentation_in, mesh_out, segmentation_out, point_accessor_in,
+                               edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
+        else
+          refine_impl<tetrahedron_tag>(mesh_in, segmentation_in, mesh_out, segmentation_out, point_accessor_in,
+                                       edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
+      }
+    };
+
   } //namespace detail
 
 
@@ -334,8 +414,8 @@ namespace viennagrid
   {
       typedef typename viennagrid::result_of::element_tag<ElementTypeOrTagT>::type CellTag;
 
-      detail::refine_impl<CellTag>(mesh_in, mesh_out, point_accessor_in,
-                                  edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
+      detail::refinement_selector<CellTag>::apply(mesh_in, mesh_out, point_accessor_in,
+                                                  edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
   }
 
 
@@ -573,10 +653,10 @@ namespace viennagrid
   {
     typedef typename viennagrid::result_of::element_tag<ElementTypeOrTagT>::type CellTag;
 
-    detail::refine_impl<CellTag>(mesh_in, segmentation_in,
-                                 mesh_out, segmentation_out,
-                                 point_accessor_in,
-                                 edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
+    detail::refinement_selector<CellTag>::apply(mesh_in, segmentation_in,
+                                                mesh_out, segmentation_out,
+                                                point_accessor_in,
+                                                edge_refinement_flag_accessor, vertex_to_vertex_handle_accessor, edge_to_vertex_handle_accessor);
   }
 
 
@@ -0,0 +1,719 @@
+#ifndef VIENNAGRID_ALGORITHM_SPATIAL_INDEX_HPP
+#define VIENNAGRID_ALGORITHM_SPATIAL_INDEX_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include <functional>
+
+#include "viennagrid/forwards.hpp"
+#include "viennagrid/mesh/mesh.hpp"
+#include "viennagrid/algorithm/inner_prod.hpp"
+#include "viennagrid/algorithm/closest_points.hpp"
+
+/** @file viennagrid/algorithm/spatial_index.hpp
+    @brief Provides a bounding volume hierarchy over the cells of a simplex mesh for point location, nearest cell and segment queries
+*/
+
+namespace viennagrid
+{
+  namespace detail
+  {
+    /** @brief Assembles a point from consecutive coordinates */
+    template<typename PointT, typename CoordT>
+    PointT spatial_index_point(CoordT const * coords)
+    {
+      PointT p;
+      for (std::size_t d = 0; d < p.size(); ++d)
+        p[d] = coords[d];
+      return p;
+    }
+
+    /** @brief Geometric kernels for a simplex of full dimension (line in 1D, triangle in 2D, tetrahedron in 3D),
+      * whose vertex coordinates are stored consecutively in 'v'. */
+    template<int DimensionV>
+    struct spatial_index_simplex;
+
+    template<>
+    struct spatial_index_simplex<1>
+    {
+      template<typename CoordT>
+      static void barycentric(CoordT const * v, CoordT const * p, CoordT * lambda)
+      {
+        lambda[1] = (p[0] - v[0]) / (v[1] - v[0]);
+        lambda[0] = 1 - lambda[1];
+      }
+
+      template<typename PointT, typename CoordT>
+      static PointT closest_point(PointT const & p, CoordT const * v)
+      {
+        return closest_points_point_line(p, spatial_index_point<PointT>(v), spatial_index_point<PointT>(v + 1)).second;
+      }
+    };
+
+    template<>
+    struct spatial_index_simplex<2>
+    {
+      template<typename CoordT>
+      static void barycentric(CoordT const * v, CoordT const * p, CoordT * lambda)
+      {
+        CoordT e1x = v[2] - v[0], e1y = v[3] - v[1];
+        CoordT e2x = v[4] - v[0], e2y = v[5] - v[1];
+        CoordT qx  = p[0] - v[0], qy  = p[1] - v[1];
+        CoordT det = e1x * e2y - e2x * e1y;
+
+        lambda[1] = (qx * e2y - e2x * qy) / det;
+        lambda[2] = (e1x * qy - qx * e1y) / det;
+        lambda[0] = 1 - lambda[1] - lambda[2];
+      }
+
+      template<typename PointT, typename CoordT>
+      static PointT closest_point(PointT const & p, CoordT const * v)
+      {
+        return closest_points_point_triangle(p, spatial_index_point<PointT>(v), spatial_index_point<PointT>(v + 2),
+                                                spatial_index_point<PointT>(v + 4)).second;
+      }
+    };
+
+    template<>
+    struct spatial_index_simplex<3>
+    {
+      template<typename CoordT>
+      static CoordT triple_product(CoordT const * a, CoordT const * b, CoordT const * c)
+      {
+        return a[0] * (b[1] * c[2] - b[2] * c[1])
+             + a[1] * (b[2] * c[0] - b[0] * c[2])
+             + a[2] * (b[0] * c[1] - b[1] * c[0]);
+      }
+
+      template<typename CoordT>
+      static void barycentric(CoordT const * v, CoordT const * p, CoordT * lambda)
+      {
+        CoordT e1[3], e2[3], e3[3], q[3];
+        for (int d = 0; d < 3; ++d)
+        {
+          e1[d] = v[3 + d] - v[d];
+          e2[d] = v[6 + d] - v[d];
+          e3[d] = v[9 + d] - v[d];
+          q[d]  = p[d] - v[d];
+        }
+        CoordT det = triple_product(e1, e2, e3);
+
+        lambda[1] = triple_product(q, e2, e3) / det;
+        lambda[2] = triple_product(e1, q, e3) / det;
+        lambda[3] = triple_product(e1, e2, q) / det;
+        lambda[0] = 1 - lambda[1] - lambda[2] - lambda[3];
+      }
+
+      template<typename PointT, typename CoordT>
+      static PointT closest_point(PointT const & p, CoordT const * v)
+      {
+        return closest_points_point_tetrahedron(p, spatial_index_point<PointT>(v), spatial_index_point<PointT>(v + 3),
+                                                   spatial_index_point<PointT>(v + 6), spatial_index_point<PointT>(v + 9)).second;
+      }
+    };
+  }
+
+
+  /** @brief A bounding volume hierarchy over the cells of a simplex mesh, which answers point location, k-nearest cell and
+    * segment/ray traversal queries in logarithmic time.
+    *
+    * The hierarchy is a binary tree of axis-aligned boxes stored in a flat array, built by median splits of the cell centroids
+    * along the longest axis. The cells are referred to by their position in the cell range of the mesh, as in compact_mesh.
+    * Like compact_mesh, the index copies the vertex coordinates and the cell vertices and does not reference the mesh after
+    * construction, later modifications of the mesh are not reflected.
+    *
+    * The queries do not modify the index, hence they may be issued concurrently. The batched queries are run in parallel if
+    * OpenMP is enabled.
+    *
+    * @tparam MeshT   The mesh type, whose cells are simplices of the geometric dimension, i.e. lines in 1D, triangles in 2D or tetrahedra in 3D
+    * @tparam IndexT  The signed integer type of the cell indices
+    */
+  template<typename MeshT, typename IndexT = int>
+  class spatial_index
+  {
+  public:
+    typedef MeshT                                                                     mesh_type;
+    typedef IndexT                                                                    index_type;
+    typedef std::size_t                                                               size_type;
+
+    typedef typename viennagrid::result_of::point<MeshT>::type                        point_type;
+    typedef typename viennagrid::result_of::coord<point_type>::type                   coord_type;
+    typedef typename viennagrid::result_of::cell_tag<MeshT>::type                     cell_tag;
+
+    static const int geometric_dimension = viennagrid::result_of::static_size<point_type>::value;
+    static const int vertices_per_cell   = boundary_elements<cell_tag, vertex_tag>::num;
+
+    /** @brief A cell crossed by a segment, the segment is inside the cell for the parameters in [entry, exit] */
+    struct segment_hit
+    {
+      index_type  cell;
+      coord_type  entry;
+      coord_type  exit;
+
+      bool operator<(segment_hit const & other) const { return entry < other.entry; }
+    };
+
+    /** @brief Returned by the queries for points outside of the mesh */
+    static index_type invalid_index() { return -1; }
+
+    /** @brief Builds the index over the cells of a mesh. 'leaf_size' is the maximum number of cells per leaf of the hierarchy. */
+    explicit spatial_index(MeshT const & mesh_obj, size_type leaf_size = 4) : leaf_size_(std::max<size_type>(leaf_size, 1)), tolerance_(1e-10)
+    {
+      assign(mesh_obj);
+      build();
+    }
+
+    size_type cell_count() const { return cell_vertices_.size() / vertices_per_cell; }
+    size_type vertex_count() const { return coordinates_.size() / geometric_dimension; }
+
+    /** @brief The vertices of a cell, numbered in the order of the vertex range of the mesh */
+    index_type const * cell_vertices(index_type cell) const { return &cell_vertices_[vertices_per_cell * cell]; }
+
+    /** @brief Computes the barycentric coordinates of a point with respect to a cell, 'lambda' receives vertices_per_cell values */
+    void barycentric_coordinates(index_type cell, point_type const & p, coord_type * lambda) const
+    {
+      coord_type v[vertices_per_cell * geometric_dimension], q[geometric_dimension];
+      gather(cell, v);
+      copy_point(p, q);
+      detail::spatial_index_simplex<geometric_dimension>::barycentric(v, q, lambda);
+    }
+
+    /** @brief The tolerance of the barycentric coordinates, by which a point on the boundary of a cell is considered inside. Default: 1e-10 */
+    coord_type tolerance() const { return tolerance_; }
+    void set_tolerance(coord_type tolerance) { tolerance_ = tolerance; }
+
+    /** @brief Returns the number of bytes allocated by the index */
+    size_type memory_size() const
+    {
+      return coordinates_.capacity() * sizeof(coord_type) + cell_vertices_.capacity() * sizeof(index_type)
+           + cell_order_.capacity() * sizeof(index_type) + nodes_.capacity() * sizeof(node);
+    }
+
+    /** @brief Returns whether the cell with the given index contains the point */
+    bool contains(index_type cell, point_type const & p) const
+    {
+      coord_type q[geometric_dimension];
+      copy_point(p, q);
+      return cell_contains(cell, q);
+    }
+
+    /** @brief Returns the index of a cell containing the point, invalid_index() if the point is outside the mesh.
+      * Points on facets shared by several cells are assigned to any one of them. */
+    index_type locate(point_type const & p) const
+    {
+      if (nodes_.empty())
+        return invalid_index();
+
+      coord_type q[geometric_dimension];
+      copy_point(p, q);
+
+      index_type stack[max_depth];
+      int top = 0;
+      stack[top++] = 0;
+      while (top > 0)
+      {
+        node const & current = nodes_[stack[--top]];
+        if (!box_contains(current, q))
+          continue;
+
+        if (current.count == 0)
+        {
+          stack[top++] = current.first;
+          stack[top++] = current.first + 1;
+        }
+        else
+        {
+          for (index_type i = current.first; i < current.first + current.count; ++i)
+            if (cell_contains(cell_order_[i], q))
+              return cell_order_[i];
+        }
+      }
+      return invalid_index();
+    }
+
+    /** @brief Locates each of the points, see locate(). Runs in parallel if OpenMP is enabled. */
+    void locate(std::vector<point_type> const & points, std::vector<index_type> & cells) const
+    {
+      cells.resize(points.size());
+      long count = static_cast<long>(points.size());
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long i = 0; i < count; ++i)
+        cells[i] = locate(points[i]);
+    }
+
+    /** @brief Finds the (at most) k cells nearest to the point, in increasing order of their distance. Cells containing the point have distance zero.
+      * If 'distances' is not NULL, it receives the distance of each cell. */
+    void nearest(point_type const & p, size_type k, std::vector<index_type> & cells, std::vector<coord_type> * distances = NULL) const
+    {
+      typedef std::pair<coord_type, index_type>                                                          Entry;
+      typedef std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> >                       NodeQueue;
+      typedef std::priority_queue<Entry>                                                                 CellQueue;
+
+      cells.clear();
+      if (distances)
+        distances->clear();
+      if (nodes_.empty() || k == 0)
+        return;
+
+      coord_type q[geometric_dimension];
+      copy_point(p, q);
+
+      // the nodes are visited in increasing order of the distance of their boxes, the best cells are kept in a max-heap
+      NodeQueue nodes;
+      CellQueue best;
+      nodes.push(Entry(box_distance2(nodes_[0], q), 0));
+      while (!nodes.empty())
+      {
+        Entry entry = nodes.top();
+        if (best.size() == k && entry.first > best.top().first)
+          break;
+        nodes.pop();
+
+        node const & current = nodes_[entry.second];
+        if (current.count == 0)
+        {
+          nodes.push(Entry(box_distance2(nodes_[current.first], q), current.first));
+          nodes.push(Entry(box_distance2(nodes_[current.first + 1], q), current.first + 1));
+          continue;
+        }
+
+        for (index_type i = current.first; i < current.first + current.count; ++i)
+        {
+          index_type cell = cell_order_[i];
+          coord_type distance2 = cell_distance2(cell, p, q);
+          if (best.size() < k)
+            best.push(Entry(distance2, cell));
+          else if (distance2 < best.top().first)
+          {
+            best.pop();
+            best.push(Entry(distance2, cell));
+          }
+        }
+      }
+
+      cells.resize(best.size());
+      if (distances)
+        distances->resize(best.size());
+      for (size_type i = best.size(); i > 0; --i)
+      {
+        cells[i - 1] = best.top().second;
+        if (distances)
+          (*distances)[i - 1] = std::sqrt(best.top().first);
+        best.pop();
+      }
+    }
+
+    /** @brief Returns the index of the cell nearest to the point */
+    index_type nearest(point_type const & p) const
+    {
+      std::vector<index_type> cells;
+      nearest(p, 1, cells);
+      return cells.empty() ? invalid_index() : cells[0];
+    }
+
+    /** @brief Finds the cells crossed by the segment from 'p0' to 'p1'. The segment parameters of the hits are in [0, 1]
+      * and the hits are sorted by their entry parameter. Cells only touched by the segment are not reported. */
+    void intersect(point_type const & p0, point_type const & p1, std::vector<segment_hit> & hits) const
+    {
+      hits.clear();
+      if (nodes_.empty())
+        return;
+
+      coord_type a[geometric_dimension], b[geometric_dimension], direction[geometric_dimension];
+      copy_point(p0, a);
+      copy_point(p1, b);
+      for (int d = 0; d < geometric_dimension; ++d)
+        direction[d] = b[d] - a[d];
+
+      index_type stack[max_depth];
+      int top = 0;
+      stack[top++] = 0;
+      while (top > 0)
+      {
+        node const & current = nodes_[stack[--top]];
+        if (!box_intersects(current, a, direction))
+          continue;
+
+        if (current.count == 0)
+        {
+          stack[top++] = current.first;
+          stack[top++] = current.first + 1;
+        }
+        else
+        {
+          for (index_type i = current.first; i < current.first + current.count; ++i)
+          {
+            segment_hit hit;
+            hit.cell = cell_order_[i];
+            if (clip_segment(hit.cell, a, b, hit.entry, hit.exit))
+              hits.push_back(hit);
+          }
+        }
+      }
+      std::sort(hits.begin(), hits.end());
+    }
+
+    /** @brief Finds the cells crossed by the ray starting at 'origin' in the given direction. The parameters of the hits
+      * are in units of 'direction', i.e. the ray is at origin + t * direction */
+    void intersect_ray(point_type const & origin, point_type const & direction, std::vector<segment_hit> & hits) const
+    {
+      hits.clear();
+      if (nodes_.empty())
+        return;
+
+      // the ray leaves the box of the mesh at 't_exit', behind which there are no cells
+      node const & root = nodes_[0];
+      coord_type t_exit = std::numeric_limits<coord_type>::max();
+      for (int d = 0; d < geometric_dimension; ++d)
+      {
+        if (direction[d] > 0)
+          t_exit = std::min(t_exit, (root.upper[d] - origin[d]) / direction[d]);
+        else if (direction[d] < 0)
+          t_exit = std::min(t_exit, (root.lower[d] - origin[d]) / direction[d]);
+      }
+      if (t_exit <= 0 || t_exit == std::numeric_limits<coord_type>::max())
+        return;
+
+      point_type end = origin + t_exit * direction;
+      intersect(origin, end, hits);
+      for (size_type i = 0; i < hits.size(); ++i)
+      {
+        hits[i].entry *= t_exit;
+        hits[i].exit  *= t_exit;
+      }
+    }
+
+    /** @brief Locates 'samples' equidistant points on the segment from 'p0' to 'p1' (including the end points) by a single
+      * traversal of the segment, which is much faster than locating the points individually */
+    void sample_line(point_type const & p0, point_type const & p1, size_type samples, std::vector<index_type> & cells) const
+    {
+      std::vector<segment_hit> hits;
+      intersect(p0, p1, hits);
+
+      cells.assign(samples, invalid_index());
+      size_type h = 0;
+      for (size_type j = 0; j < samples; ++j)
+      {
+        coord_type t = (samples > 1) ? coord_type(j) / coord_type(samples - 1) : coord_type(0);
+        while (h < hits.size() && hits[h].exit < t - tolerance_)
+          ++h;
+        if (h < hits.size() && hits[h].entry <= t + tolerance_)
+          cells[j] = hits[h].cell;
+      }
+    }
+
+    /** @brief Locates a grid of samples on the parallelogram spanned by 'origin', 'u_end' and 'v_end'. The result is stored
+      * row by row: the sample (i, j) at origin + i/(u_samples-1) * (u_end - origin) + j/(v_samples-1) * (v_end - origin)
+      * is at position j * u_samples + i. Each row is sampled by sample_line(), the rows run in parallel if OpenMP is enabled. */
+    void sample_plane(point_type const & origin, point_type const & u_end, point_type const & v_end,
+                      size_type u_samples, size_type v_samples, std::vector<index_type> & cells) const
+    {
+      cells.resize(u_samples * v_samples);
+      long rows = static_cast<long>(v_samples);
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long j = 0; j < rows; ++j)
+      {
+        coord_type s = (v_samples > 1) ? coord_type(j) / coord_type(v_samples - 1) : coord_type(0);
+        point_type row_start = origin + s * (v_end - origin);
+        point_type row_end   = u_end  + s * (v_end - origin);
+
+        std::vector<index_type> row;
+        sample_line(row_start, row_end, u_samples, row);
+        std::copy(row.begin(), row.end(), cells.begin() + j * u_samples);
+      }
+    }
+
+  private:
+
+    // a median split keeps the depth of the tree below log2 of the number of cells, the traversal stack holds at most two nodes per level
+    static const int max_depth = 128;
+
+    /** @brief A node of the hierarchy. Leaves refer to 'count' consecutive cells in cell_order_ starting at 'first',
+      * inner nodes have count == 0 and their two children at the positions 'first' and 'first + 1'. */
+    struct node
+    {
+      coord_type  lower[geometric_dimension];
+      coord_type  upper[geometric_dimension];
+      index_type  first;
+      index_type  count;
+    };
+
+    /** @brief Compares cells by one coordinate of their centroids */
+    struct centroid_less
+    {
+      centroid_less(std::vector<coord_type> const & centroids, int axis) : centroids_(centroids), axis_(axis) {}
+
+      bool operator()(index_type a, index_type b) const
+      {
+        return centroids_[geometric_dimension * a + axis_] < centroids_[geometric_dimension * b + axis_];
+      }
+
+      std::vector<coord_type> const & centroids_;
+      int axis_;
+    };
+
+    static void copy_point(point_type const & p, coord_type * q)
+    {
+      for (int d = 0; d < geometric_dimension; ++d)
+        q[d] = p[d];
+    }
+
+    /** @brief Copies the vertex coordinates of a cell to 'v' */
+    void gather(index_type cell, coord_type * v) const
+    {
+      index_type const * vertices = &cell_vertices_[vertices_per_cell * cell];
+      for (int k = 0; k < vertices_per_cell; ++k)
+        for (int d = 0; d < geometric_dimension; ++d)
+          v[geometric_dimension * k + d] = coordinates_[geometric_dimension * vertices[k] + d];
+    }
+
+    bool cell_contains(index_type cell, coord_type const * q) const
+    {
+      coord_type v[vertices_per_cell * geometric_dimension], lambda[vertices_per_cell];
+      gather(cell, v);
+      detail::spatial_index_simplex<geometric_dimension>::barycentric(v, q, lambda);
+
+      for (int k = 0; k < vertices_per_cell; ++k)
+        if (!(lambda[k] >= -tolerance_))    // also rejects NaN of degenerate cells
+          return false;
+      return true;
+    }
+
+    coord_type cell_distance2(index_type cell, point_type const & p, coord_type const * q) const
+    {
+      if (cell_contains(cell, q))
+        return 0;
+
+      coord_type v[vertices_per_cell * geometric_dimension];
+      gather(cell, v);
+      point_type closest = detail::spatial_index_simplex<geometric_dimension>::closest_point(p, v);
+      return viennagrid::inner_prod(p - closest, p - closest);
+    }
+
+    /** @brief Computes the part [entry, exit] of the segment from 'a' to 'b' inside a cell, from the barycentric coordinates at
+      * the end points, which are linear along the segment. Returns false if the segment does not cross the cell. */
+    bool clip_segment(index_type cell, coord_type const * a, coord_type const * b, coord_type & entry, coord_type & exit) const
+    {
+      coord_type v[vertices_per_cell * geometric_dimension], lambda_a[vertices_per_cell], lambda_b[vertices_per_cell];
+      gather(cell, v);
+      detail::spatial_index_simplex<geometric_dimension>::barycentric(v, a, lambda_a);
+      detail::spatial_index_simplex<geometric_dimension>::barycentric(v, b, lambda_b);
+
+      entry = 0;
+      exit  = 1;
+      for (int k = 0; k < vertices_per_cell; ++k)
+      {
+        coord_type slope = lambda_b[k] - lambda_a[k];
+        if (slope > 0)
+          entry = std::max(entry, (-tolerance_ - lambda_a[k]) / slope);
+        else if (slope < 0)
+          exit  = std::min(exit,  (-tolerance_ - lambda_a[k]) / slope);
+        else if (!(lambda_a[k] >= -tolerance_))
+          return false;
+      }
+      entry = std::max<coord_type>(entry, 0);
+      exit  = std::min<coord_type>(exit, 1);
+      return exit - entry > tolerance_;
+    }
+
+    static bool box_contains(node const & n, coord_type const * q)
+    {
+      for (int d = 0; d < geometric_dimension; ++d)
+        if (q[d] < n.lower[d] || q[d] > n.upper[d])
+          return false;
+      return true;
+    }
+
+    static coord_type box_distance2(node const & n, coord_type const * q)
+    {
+      coord_type distance2 = 0;
+      for (int d = 0; d < geometric_dimension; ++d)
+      {
+        coord_type delta = std::max<coord_type>(0, std::max(n.lower[d] - q[d], q[d] - n.upper[d]));
+        distance2 += delta * delta;
+      }
+      return distance2;
+    }
+
+    /** @brief Slab test of the segment a + t * direction, t in [0, 1], against the box of a node */
+    static bool box_intersects(node const & n, coord_type const * a, coord_type const * direction)
+    {
+      coord_type t_min = 0, t_max = 1;
+      for (int d = 0; d < geometric_dimension; ++d)
+      {
+        if (direction[d] == 0)
+        {
+          if (a[d] < n.lower[d] || a[d] > n.upper[d])
+            return false;
+          continue;
+        }
+
+        coord_type t0 = (n.lower[d] - a[d]) / direction[d];
+        coord_type t1 = (n.upper[d] - a[d]) / direction[d];
+        if (t0 > t1)
+          std::swap(t0, t1);
+        t_min = std::max(t_min, t0);
+        t_max = std::min(t_max, t1);
+        if (t_min > t_max)
+          return false;
+      }
+      return true;
+    }
+
+    void assign(MeshT const & mesh_obj)
+    {
+      typedef typename viennagrid::result_of::const_element_range<MeshT, vertex_tag>::type   VertexRange;
+      typedef typename viennagrid::result_of::iterator<VertexRange>::type                   VertexIterator;
+      typedef typename viennagrid::result_of::const_element_range<MeshT, cell_tag>::type     CellRange;
+      typedef typename viennagrid::result_of::iterator<CellRange>::type                     CellIterator;
+      typedef typename viennagrid::result_of::const_element_range<typename CellRange::value_type, vertex_tag>::type  CellVertexRange;
+      typedef typename viennagrid::result_of::iterator<CellVertexRange>::type                                      CellVertexIterator;
+
+      VertexRange vertices(mesh_obj);
+      CellRange   cells(mesh_obj);
+
+      // the vertices are numbered in the order of the vertex range
+      std::vector<index_type> vertex_of_id;
+      coordinates_.resize(geometric_dimension * vertices.size());
+      index_type v = 0;
+      for (VertexIterator vit = vertices.begin(); vit != vertices.end(); ++vit, ++v)
+      {
+        size_type id = static_cast<size_type>((*vit).id().get());
+        if (id >= vertex_of_id.size())
+          vertex_of_id.resize(id + 1, invalid_index());
+        vertex_of_id[id] = v;
+
+        point_type const & p = viennagrid::point(mesh_obj, *vit);
+        for (int d = 0; d < geometric_dimension; ++d)
+          coordinates_[geometric_dimension * v + d] = p[d];
+      }
+
+      cell_vertices_.resize(vertices_per_cell * cells.size());
+      size_type position = 0;
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+      {
+        CellVertexRange cell_vertices(*cit);
+        for (CellVertexIterator vit = cell_vertices.begin(); vit != cell_vertices.end(); ++vit)
+          cell_vertices_[position++] = vertex_of_id[static_cast<size_type>((*vit).id().get())];
+      }
+    }
+
+    void build()
+    {
+      size_type cells = cell_count();
+      nodes_.clear();
+      cell_order_.resize(cells);
+      if (cells == 0)
+        return;
+
+      // bounding boxes and centroids of all cells
+      std::vector<coord_type> lower(geometric_dimension * cells), upper(geometric_dimension * cells), centroids(geometric_dimension * cells);
+      for (size_type c = 0; c < cells; ++c)
+      {
+        cell_order_[c] = static_cast<index_type>(c);
+
+        coord_type v[vertices_per_cell * geometric_dimension];
+        gather(static_cast<index_type>(c), v);
+        for (int d = 0; d < geometric_dimension; ++d)
+        {
+          coord_type lo = v[d], hi = v[d], sum = 0;
+          for (int k = 0; k < vertices_per_cell; ++k)
+          {
+            lo = std::min(lo, v[geometric_dimension * k + d]);
+            hi = std::max(hi, v[geometric_dimension * k + d]);
+            sum += v[geometric_dimension * k + d];
+          }
+          lower[geometric_dimension * c + d]     = lo;
+          upper[geometric_dimension * c + d]     = hi;
+          centroids[geometric_dimension * c + d] = sum / vertices_per_cell;
+        }
+      }
+
+      // the nodes are split depth first, each task is a node with its range of cells
+      nodes_.reserve(2 * (cells / leaf_size_ + 1));
+      nodes_.resize(1);
+      std::vector< std::pair<index_type, std::pair<index_type, index_type> > > tasks;
+      tasks.push_back(std::make_pair(0, std::make_pair(0, static_cast<index_type>(cells))));
+      while (!tasks.empty())
+      {
+        index_type current = tasks.back().first;
+        index_type first   = tasks.back().second.first;
+        index_type count   = tasks.back().second.second;
+        tasks.pop_back();
+
+        // the box of the node and the box of the centroids of its cells
+        node n;
+        coord_type centroid_lower[geometric_dimension], centroid_upper[geometric_dimension];
+        for (int d = 0; d < geometric_dimension; ++d)
+        {
+          n.lower[d] = centroid_lower[d] = std::numeric_limits<coord_type>::max();
+          n.upper[d] = centroid_upper[d] = -std::numeric_limits<coord_type>::max();
+        }
+        for (index_type i = first; i < first + count; ++i)
+        {
+          index_type c = cell_order_[i];
+          for (int d = 0; d < geometric_dimension; ++d)
+          {
+            n.lower[d]        = std::min(n.lower[d], lower[geometric_dimension * c + d]);
+            n.upper[d]        = std::max(n.upper[d], upper[geometric_dimension * c + d]);
+            centroid_lower[d] = std::min(centroid_lower[d], centroids[geometric_dimension * c + d]);
+            centroid_upper[d] = std::max(centroid_upper[d], centroids[geometric_dimension * c + d]);
+          }
+        }
+
+        int axis = 0;
+        for (int d = 1; d < geometric_dimension; ++d)
+          if (centroid_upper[d] - centroid_lower[d] > centroid_upper[axis] - centroid_lower[axis])
+            axis = d;
+
+        if (static_cast<size_type>(count) <= leaf_size_ || !(centroid_upper[axis] > centroid_lower[axis]))
+        {
+          n.first = first;
+          n.count = count;
+          nodes_[current] = n;
+          continue;
+        }
+
+        index_type middle = first + count / 2;
+        std::nth_element(cell_order_.begin() + first, cell_order_.begin() + middle, cell_order_.begin() + first + count,
+                         centroid_less(centroids, axis));
+
+        n.first = static_cast<index_type>(nodes_.size());
+        n.count = 0;
+        nodes_[current] = n;
+        nodes_.resize(nodes_.size() + 2);
+
+        tasks.push_back(std::make_pair(n.first + 1, std::make_pair(middle, first + count - middle)));
+        tasks.push_back(std::make_pair(n.first,     std::make_pair(first, middle - first)));
+      }
+    }
+
+    size_type                 leaf_size_;
+    coord_type                tolerance_;
+    std::vector<coord_type>   coordinates_;     // geometric_dimension coordinates per vertex
+    std::vector<index_type>   cell_vertices_;   // vertices_per_cell vertex indices per cell
+    std::vector<index_type>   cell_order_;      // the cells in the order of the leaves
+    std::vector<node>         nodes_;
+  };
+
+}
+
+#endif
@@ -580,6 +580,10 @@ namespace viennagrid
      *          total_interface_volume = sum_over_cells(interface_volume_per_cell).
      *        As a consequence, the same holds true for volume contributions.
      *
+     *  The cells, facets and edges are numbered, the intermediate data is held in flat arrays indexed by these numbers.
+     *  The contributions of an edge are accumulated in slots owned by the pair (cell, local edge of the cell), hence the edges
+     *  are processed in parallel if OpenMP is enabled. The accessors are only written in a final serial pass.
+     *  The results are the same as of write_voronoi_info_reference(), except for the order of the cell contributions.
      */
     template <typename CellTag,
               typename MeshT,
@@ -601,6 +605,307 @@ namespace viennagrid
       typedef typename viennagrid::result_of::element<MeshT, CellTag>::type CellType;
       typedef typename viennagrid::result_of::const_handle<MeshT, CellTag>::type ConstCellHandleType;
 
+      typedef typename viennagrid::result_of::point<MeshT>::type                           PointType;
+      typedef typename viennagrid::result_of::element<MeshT, vertex_tag>::type             VertexType;
+      typedef typename viennagrid::result_of::element<MeshT, line_tag>::type               EdgeType;
+      typedef typename viennagrid::result_of::element<MeshT, triangle_tag>::type           FacetType;
+
+      typedef typename viennagrid::result_of::const_element_range<MeshT, CellTag>::type    CellRange;
+      typedef typename viennagrid::result_of::iterator<CellRange>::type                       CellIterator;
+
+      typedef typename viennagrid::result_of::const_element_range<MeshT, typename CellTag::facet_tag>::type  FacetRange;
+      typedef typename viennagrid::result_of::iterator<FacetRange>::type                                        FacetIterator;
+
+      typedef typename viennagrid::result_of::const_element_range<MeshT, line_tag>::type                   EdgeRange;
+      typedef typename viennagrid::result_of::iterator<EdgeRange>::type                                       EdgeIterator;
+
+      typedef typename viennagrid::result_of::const_element_range<CellType, typename CellTag::facet_tag>::type  FacetOnCellRange;
+      typedef typename viennagrid::result_of::iterator<FacetOnCellRange>::type                                  FacetOnCellIterator;
+
+      typedef typename viennagrid::result_of::const_element_range<CellType, line_tag>::type                     EdgeOnCellRange;
+      typedef typename viennagrid::result_of::iterator<EdgeOnCellRange>::type                                   EdgeOnCellIterator;
+
+      typedef typename viennagrid::result_of::const_element_range<FacetType, line_tag>::type                    EdgeOnFacetRange;
+      typedef typename viennagrid::result_of::iterator<EdgeOnFacetRange>::type                                  EdgeOnFacetIterator;
+
+      typedef typename viennagrid::result_of::const_element_range<EdgeType, vertex_tag>::type                   VertexOnEdgeRange;
+      typedef typename viennagrid::result_of::iterator<VertexOnEdgeRange>::type                                 VertexOnEdgeIterator;
+
+      typedef std::size_t                                           IndexType;
+      typedef std::pair<std::pair<PointType, PointType>, IndexType> InterfaceSegment;   // end points and cell index
+
+      static const IndexType facets_per_cell = 4;
+      static const IndexType edges_per_cell  = 6;
+      static const IndexType edges_per_facet = 3;
+      IndexType const unset = std::numeric_limits<IndexType>::max();
+
+      //
+      // Step one: Number the cells, facets and edges by their ids
+      //
+      std::vector<CellType const *>     cell_ptrs;
+      std::vector<ConstCellHandleType>  cell_handles;
+      CellRange cells = viennagrid::elements<CellType>(mesh_obj);
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+      {
+        cell_ptrs.push_back(&(*cit));
+        cell_handles.push_back(cit.handle());
+      }
+
+      std::vector<FacetType const *>  facet_ptrs;
+      std::vector<IndexType>          facet_of_id;
+      FacetRange facets = viennagrid::elements<FacetType>(mesh_obj);
+      for (FacetIterator fit = facets.begin(); fit != facets.end(); ++fit)
+      {
+        IndexType id = static_cast<IndexType>((*fit).id().get());
+        if (id >= facet_of_id.size()) facet_of_id.resize(id + 1, unset);
+        facet_of_id[id] = facet_ptrs.size();
+        facet_ptrs.push_back(&(*fit));
+      }
+
+      std::vector<EdgeType const *>   edge_ptrs;
+      std::vector<VertexType const *> edge_vertices;
+      std::vector<IndexType>          edge_of_id;
+      EdgeRange edges = viennagrid::elements<EdgeType>(mesh_obj);
+      for (EdgeIterator eit = edges.begin(); eit != edges.end(); ++eit)
+      {
+        IndexType id = static_cast<IndexType>((*eit).id().get());
+        if (id >= edge_of_id.size()) edge_of_id.resize(id + 1, unset);
+        edge_of_id[id] = edge_ptrs.size();
+        edge_ptrs.push_back(&(*eit));
+
+        VertexOnEdgeRange vertices_on_edge = viennagrid::elements<VertexType>(*eit);
+        VertexOnEdgeIterator voeit = vertices_on_edge.begin();
+        edge_vertices.push_back(&(*voeit));
+        ++voeit;
+        edge_vertices.push_back(&(*voeit));
+      }
+
+      long const cell_count  = static_cast<long>(cell_ptrs.size());
+      long const facet_count = static_cast<long>(facet_ptrs.size());
+      long const edge_count  = static_cast<long>(edge_ptrs.size());
+
+      //
+      // Step two: Circumcenters of the cells and facets, the local facets and edges of the cells
+      //
+      std::vector<PointType>  cell_circumcenters(cell_ptrs.size());
+      std::vector<IndexType>  cell_facets(facets_per_cell * cell_ptrs.size());
+      std::vector<IndexType>  cell_edges(edges_per_cell * cell_ptrs.size());
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long c = 0; c < cell_count; ++c)
+      {
+        CellType const & cell = *cell_ptrs[c];
+        cell_circumcenters[c] = circumcenter(cell);
+
+        IndexType k = 0;
+        FacetOnCellRange facets_on_cell = viennagrid::elements<FacetType>(cell);
+        for (FacetOnCellIterator focit = facets_on_cell.begin(); focit != facets_on_cell.end(); ++focit)
+          cell_facets[facets_per_cell * c + k++] = facet_of_id[static_cast<IndexType>((*focit).id().get())];
+
+        k = 0;
+        EdgeOnCellRange edges_on_cell = viennagrid::elements<EdgeType>(cell);
+        for (EdgeOnCellIterator eocit = edges_on_cell.begin(); eocit != edges_on_cell.end(); ++eocit)
+          cell_edges[edges_per_cell * c + k++] = edge_of_id[static_cast<IndexType>((*eocit).id().get())];
+      }
+
+      std::vector<PointType>  facet_circumcenters(facet_ptrs.size());
+      std::vector<IndexType>  facet_edges(edges_per_facet * facet_ptrs.size());
+#ifdef _OPENMP
+      #pragma omp parallel for
+#endif
+      for (long f = 0; f < facet_count; ++f)
+      {
+        FacetType const & facet = *facet_ptrs[f];
+        facet_circumcenters[f] = circumcenter(facet);
+
+        IndexType k = 0;
+        EdgeOnFacetRange edges_on_facet = viennagrid::elements<EdgeType>(facet);
+        for (EdgeOnFacetIterator eofit = edges_on_facet.begin(); eofit != edges_on_facet.end(); ++eofit)
+          facet_edges[edges_per_facet * f + k++] = edge_of_id[static_cast<IndexType>((*eofit).id().get())];
+      }
+
+      //
+      // Step three: The cells on each facet, the facets on each edge (compressed rows)
+      //
+      std::vector<IndexType>  facet_cells(2 * facet_ptrs.size());
+      std::vector<IndexType>  facet_cell_count(facet_ptrs.size(), 0);
+      for (IndexType c = 0; c < cell_ptrs.size(); ++c)
+      {
+        for (IndexType k = 0; k < facets_per_cell; ++k)
+        {
+          IndexType f = cell_facets[facets_per_cell * c + k];
+          if (facet_cell_count[f] == 2)
+          {
+            std::cerr << "*fit: " << *facet_ptrs[f] << std::endl;
+            throw "More than two circumcenters for a facet in three dimensions!";
+          }
+          facet_cells[2 * f + facet_cell_count[f]++] = c;
+        }
+      }
+
+      std::vector<IndexType>  edge_facet_offsets(edge_ptrs.size() + 1, 0);
+      for (IndexType i = 0; i < facet_edges.size(); ++i)
+        ++edge_facet_offsets[facet_edges[i] + 1];
+      for (IndexType e = 0; e < edge_ptrs.size(); ++e)
+        edge_facet_offsets[e + 1] += edge_facet_offsets[e];
+
+      std::vector<IndexType>  edge_facets(facet_edges.size());
+      std::vector<IndexType>  fill(edge_facet_offsets.begin(), edge_facet_offsets.end() - 1);
+      for (IndexType f = 0; f < facet_ptrs.size(); ++f)
+        for (IndexType k = 0; k < edges_per_facet; ++k)
+          edge_facets[fill[facet_edges[edges_per_facet * f + k]]++] = f;
+
+      //
+      // Step four: Compute Voronoi information of each edge from the lines connecting the circumcenters:
+      //
+      std::vector<double>  edge_lengths(edge_ptrs.size());
+      std::vector<double>  edge_interface_areas(edge_ptrs.size(), 0.0);
+      std::vector<double>  cell_edge_interface_areas(edges_per_cell * cell_ptrs.size(), 0.0);
+      std::vector<double>  cell_edge_box_volumes(edges_per_cell * cell_ptrs.size(), 0.0);
+
+#ifdef _OPENMP
+      #pragma omp parallel
+#endif
+      {
+        std::vector<InterfaceSegment> interface_segments;  // reused for all edges of a thread
+
+#ifdef _OPENMP
+        #pragma omp for
+#endif
+        for (long e = 0; e < edge_count; ++e)
+        {
+          EdgeType const & edge = *edge_ptrs[e];
+          double edge_length = spanned_volume( viennagrid::point(mesh_obj, *edge_vertices[2 * e]),
+                                               viennagrid::point(mesh_obj, *edge_vertices[2 * e + 1]) );
+          edge_lengths[e] = edge_length;
+
+          interface_segments.clear();
+          for (IndexType i = edge_facet_offsets[e]; i < edge_facet_offsets[e + 1]; ++i)
+          {
+            IndexType f = edge_facets[i];
+            IndexType const * facet_cell = &facet_cells[2 * f];
+
+            if (facet_cell_count[f] == 1)
+            {
+              interface_segments.push_back(InterfaceSegment(std::make_pair(cell_circumcenters[facet_cell[0]], facet_circumcenters[f]), facet_cell[0]));
+              interface_segments.push_back(InterfaceSegment(std::make_pair(circumcenter(edge), facet_circumcenters[f]), facet_cell[0]));
+            }
+            else
+            {
+              PointType edge_mid = cell_circumcenters[facet_cell[0]] + cell_circumcenters[facet_cell[1]];
+              edge_mid /= 2.0;
+
+              interface_segments.push_back(InterfaceSegment(std::make_pair(cell_circumcenters[facet_cell[0]], edge_mid), facet_cell[0]));
+              interface_segments.push_back(InterfaceSegment(std::make_pair(edge_mid, cell_circumcenters[facet_cell[1]]), facet_cell[1]));
+            }
+          }
+
+          //
+          // determine inner point of convex interface polygon:
+          //
+          PointType inner_point = (interface_segments[0].first.first + interface_segments[0].first.second) / 2.0;
+          for (IndexType i=1; i<interface_segments.size(); ++i)
+          {
+            inner_point += (interface_segments[i].first.first + interface_segments[i].first.second) / 2.0;
+          }
+          inner_point /= interface_segments.size();
+
+          //
+          // compute interface area, the contributions go to the slot of this edge in the cell
+          //
+          double interface_area = 0.0;
+          for (IndexType i=0; i<interface_segments.size(); ++i)
+          {
+            double interface_contribution = spanned_volume(interface_segments[i].first.first, interface_segments[i].first.second, inner_point);
+            if (interface_contribution > 0)
+            {
+              interface_area += interface_contribution;
+
+              IndexType c = interface_segments[i].second;
+              IndexType slot = edges_per_cell * c;
+              while (cell_edges[slot] != static_cast<IndexType>(e)) ++slot;
+
+              cell_edge_interface_areas[slot] += interface_contribution;
+              cell_edge_box_volumes[slot]     += 2.0 * interface_contribution * edge_length / 6.0; //volume contribution of both box volumes associated with the edge
+            }
+          }
+          edge_interface_areas[e] = interface_area;
+        }
+      }
+
+      //
+      // Write Voronoi info:
+      //
+      for (IndexType e = 0; e < edge_ptrs.size(); ++e)
+      {
+        EdgeType const & edge = *edge_ptrs[e];
+
+        interface_area_accessor( edge ) = edge_interface_areas[e];
+        double volume_contribution = edge_interface_areas[e] * edge_lengths[e] / 6.0;
+        edge_box_volume_accessor(edge) = 2.0 * volume_contribution; //volume contribution of both box volumes associated with the edge
+        vertex_box_volume_accessor(*edge_vertices[2 * e])     += volume_contribution;
+        vertex_box_volume_accessor(*edge_vertices[2 * e + 1]) += volume_contribution;
+      }
+
+      // Note: Each pair of cell and edge (vertex) is visited exactly once, hence there is no need to use voronoi_unique_quantity_update() here
+      for (IndexType c = 0; c < cell_ptrs.size(); ++c)
+      {
+        VertexType const * vertices[4] = { NULL, NULL, NULL, NULL };
+        double             vertex_volumes[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+        for (IndexType k = 0; k < edges_per_cell; ++k)
+        {
+          IndexType slot = edges_per_cell * c + k;
+          if (cell_edge_interface_areas[slot] <= 0) continue;
+
+          IndexType e = cell_edges[slot];
+          EdgeType const & edge = *edge_ptrs[e];
+          interface_area_cell_contribution_accessor(edge).push_back( std::make_pair(cell_handles[c], cell_edge_interface_areas[slot]) );
+          edge_box_volume_cell_contribution_accessor(edge).push_back( std::make_pair(cell_handles[c], cell_edge_box_volumes[slot]) );
+
+          // each end point of the edge receives half of the edge's box volume
+          for (IndexType j = 0; j < 2; ++j)
+          {
+            VertexType const * vertex = edge_vertices[2 * e + j];
+            IndexType v = 0;
+            while (vertices[v] && vertices[v] != vertex) ++v;
+            vertices[v] = vertex;
+            vertex_volumes[v] += cell_edge_box_volumes[slot] / 2.0;
+          }
+        }
+
+        for (IndexType v = 0; v < 4 && vertices[v]; ++v)
+          vertex_box_volume_cell_contribution_accessor(*vertices[v]).push_back( std::make_pair(cell_handles[c], vertex_volumes[v]) );
+      }
+
+    } //write_voronoi_info(tetrahedron_tag)
+
+
+    /** @brief Reference implementation of the computation of Voronoi quantities for a tetrahedral mesh, which collects the circumcenters in maps keyed by handles.
+     *
+     *  Kept to verify and benchmark the array-based write_voronoi_info(), see the note there.
+     */
+    template <typename CellTag,
+              typename MeshT,
+              typename InterfaceAreaAccessorT,
+              typename InterfaceAreaCellContributionAccessorT,
+              typename VertexBoxVolumeAccessorT,
+              typename VertexBoxVolumeCellContributionAccessorT,
+              typename EdgeBoxVolumeAccessorT,
+              typename EdgeBoxVolumeCellContributionAccessorT>
+    void write_voronoi_info_reference(MeshT const & mesh_obj,
+                                      InterfaceAreaAccessorT                    interface_area_accessor,
+                                      InterfaceAreaCellContributionAccessorT    interface_area_cell_contribution_accessor,
+                                      VertexBoxVolumeAccessorT                  vertex_box_volume_accessor,
+                                      VertexBoxVolumeCellContributionAccessorT  vertex_box_volume_cell_contribution_accessor,
+                                      EdgeBoxVolumeAccessorT                    edge_box_volume_accessor,
+                                      EdgeBoxVolumeCellContributionAccessorT    edge_box_volume_cell_contribution_accessor,
+                                      viennagrid::tetrahedron_tag)
+    {
+      typedef typename viennagrid::result_of::element<MeshT, CellTag>::type CellType;
+      typedef typename viennagrid::result_of::const_handle<MeshT, CellTag>::type ConstCellHandleType;
+
       typedef typename viennagrid::result_of::point<MeshT>::type                           PointType;
       typedef typename viennagrid::result_of::element<MeshT, vertex_tag>::type             VertexType;
       typedef typename viennagrid::result_of::element<MeshT, line_tag>::type               EdgeType;
@@ -787,7 +1092,7 @@ namespace viennagrid
 
       } //for edges
 
-    } //write_voronoi_info(tetrahedron_tag)
+    } //write_voronoi_info_reference(tetrahedron_tag)
 
 
 
@@ -315,6 +315,14 @@ namespace viennagrid
       typedef result_of::full_mesh_config< viennagrid::tetrahedron_tag, point_type_3d, viennagrid::pointer_handle_tag >::type  type;
     };
 
+    /** @brief A config for tetrahedrons in 3d, pointer handles are used. Triangles and lines are stored in hashed key maps, which speeds up the construction of large meshes */
+    struct tetrahedral_3d_hashed
+    {
+      typedef result_of::full_mesh_config< viennagrid::tetrahedron_tag, point_type_3d, viennagrid::pointer_handle_tag,
+                                           viennagrid::std_deque_tag, viennagrid::std_deque_tag,
+                                           viennagrid::hashed_key_map_tag< viennagrid::element_key_tag > >::type  type;
+    };
+
     /** @brief A default config for hexahedrons in 3d, pointer handles are used */
     struct hexahedral_3d
     {
@@ -334,6 +342,12 @@ namespace viennagrid
   typedef viennagrid::result_of::cell<tetrahedral_3d_mesh>::type                           tetrahedral_3d_cell;
 
 
+  /** @brief A mesh for tetrahedrons in 3d, the boundary elements are stored in hashed key maps */
+  typedef viennagrid::mesh< config::tetrahedral_3d_hashed >                                tetrahedral_3d_hashed_mesh;
+  /** @brief A segmentation for tetrahedrons in 3d, the boundary elements of the mesh are stored in hashed key maps */
+  typedef viennagrid::result_of::segmentation< tetrahedral_3d_hashed_mesh >::type          tetrahedral_3d_hashed_segmentation;
+
+
   /** @brief A default mesh for hexahedrons in 3d, default config is used */
   typedef viennagrid::mesh< config::hexahedral_3d >                                         hexahedral_3d_mesh;
   /** @brief A default segmentation for hexahedrons in 3d, default config is used */
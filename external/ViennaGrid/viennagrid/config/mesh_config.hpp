@@ -19,6 +19,7 @@
 
 #include "viennagrid/topology/simplex.hpp"
 #include "viennagrid/storage/hidden_key_map.hpp"
+#include "viennagrid/storage/hashed_key_map.hpp"
 #include "viennagrid/element/element_key.hpp"
 #include "viennagrid/config/element_config.hpp"
 
@@ -65,37 +66,39 @@ namespace viennagrid
       };
 
 
-      /** @brief Defines the default container tag for all elements in a domain. For vertices and cells specific given containers are used, for all others, hidden key maps are used to ensure the uniqueness of elements (taking orientation into account) */
-      template<typename ElementTagT, typename boundary_cell_tag, typename VertexContainerT, typename CellContainerT>
+      /** @brief Defines the default container tag for all elements in a domain. For vertices and cells specific given containers are used, for all others, key maps (hidden key maps by default) are used to ensure the uniqueness of elements (taking orientation into account) */
+      template<typename ElementTagT, typename boundary_cell_tag, typename VertexContainerT, typename CellContainerT,
+               typename BoundaryContainerT = viennagrid::hidden_key_map_tag< viennagrid::element_key_tag > >
       struct default_container_tag
       {
-        typedef viennagrid::hidden_key_map_tag< viennagrid::element_key_tag > type;
+        typedef BoundaryContainerT type;
       };
 
-      template<typename ElementTagT, typename VertexContainerT, typename CellContainerT>
-      struct default_container_tag<ElementTagT, ElementTagT, VertexContainerT, CellContainerT>
+      template<typename ElementTagT, typename VertexContainerT, typename CellContainerT, typename BoundaryContainerT>
+      struct default_container_tag<ElementTagT, ElementTagT, VertexContainerT, CellContainerT, BoundaryContainerT>
       {
         typedef CellContainerT type;
       };
 
-      template<typename ElementTagT, typename VertexContainerT, typename CellContainerT>
-      struct default_container_tag<ElementTagT, viennagrid::vertex_tag, VertexContainerT, CellContainerT>
+      template<typename ElementTagT, typename VertexContainerT, typename CellContainerT, typename BoundaryContainerT>
+      struct default_container_tag<ElementTagT, viennagrid::vertex_tag, VertexContainerT, CellContainerT, BoundaryContainerT>
       {
         typedef VertexContainerT type;
       };
 
-      template<typename VertexContainerT, typename CellContainerT>
-      struct default_container_tag<viennagrid::vertex_tag, viennagrid::vertex_tag, VertexContainerT, CellContainerT>
+      template<typename VertexContainerT, typename CellContainerT, typename BoundaryContainerT>
+      struct default_container_tag<viennagrid::vertex_tag, viennagrid::vertex_tag, VertexContainerT, CellContainerT, BoundaryContainerT>
       {
         typedef VertexContainerT type;
       };
 
 
       /** @brief Creates the complete configuration for one element. ID tag is smart_id_tag<int>, element_container_tag is defined based default_container_tag meta function, boundary_storage_layout is defined based on storage_layout_config, no appendix type. For vertex no boundary storage layout is defined. */
-      template<typename CellTagT, typename ElementTagT, typename HandleTagT, typename VertexContainerT, typename CellContainerT>
+      template<typename CellTagT, typename ElementTagT, typename HandleTagT, typename VertexContainerT, typename CellContainerT,
+               typename BoundaryContainerT = viennagrid::hidden_key_map_tag< viennagrid::element_key_tag > >
       struct full_element_config
       {
-        typedef typename viennagrid::result_of::handled_container<typename default_container_tag<CellTagT, ElementTagT, VertexContainerT, CellContainerT>::type,
+        typedef typename viennagrid::result_of::handled_container<typename default_container_tag<CellTagT, ElementTagT, VertexContainerT, CellContainerT, BoundaryContainerT>::type,
                                                                             HandleTagT>::tag                     container_tag;
 
         typedef typename storage_layout_config<CellTagT,
@@ -116,8 +119,8 @@ namespace viennagrid
         >::type type;
       };
 
-      template<typename CellTagT, typename HandleTagT, typename VertexContainerT, typename CellContainerT>
-      struct full_element_config<CellTagT, viennagrid::vertex_tag, HandleTagT, VertexContainerT, CellContainerT>
+      template<typename CellTagT, typename HandleTagT, typename VertexContainerT, typename CellContainerT, typename BoundaryContainerT>
+      struct full_element_config<CellTagT, viennagrid::vertex_tag, HandleTagT, VertexContainerT, CellContainerT, BoundaryContainerT>
       {
         typedef typename viennagrid::result_of::handled_container<typename default_container_tag<CellTagT, viennagrid::vertex_tag, VertexContainerT, CellContainerT>::type,
                                                                             HandleTagT>::tag                     container_tag;
@@ -139,24 +142,24 @@ namespace viennagrid
 
 
       /** @brief Helper meta function for creating topologic configuration using full_element_config for each element. Terminates at vertex level. */
-      template<typename CellTagT, typename ElementTagT, typename HandleTagT, typename VertexContainerTagT, typename CellContainerTagT>
+      template<typename CellTagT, typename ElementTagT, typename HandleTagT, typename VertexContainerTagT, typename CellContainerTagT, typename BoundaryContainerTagT>
       struct full_topology_config_helper
       {
         typedef typename viennagrid::detail::result_of::insert<
-            typename full_topology_config_helper<CellTagT, typename ElementTagT::facet_tag, HandleTagT, VertexContainerTagT, CellContainerTagT>::type,
+            typename full_topology_config_helper<CellTagT, typename ElementTagT::facet_tag, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>::type,
             viennagrid::static_pair<
                 ElementTagT,
-                typename full_element_config<CellTagT, ElementTagT, HandleTagT, VertexContainerTagT, CellContainerTagT>::type
+                typename full_element_config<CellTagT, ElementTagT, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>::type
             >
         >::type type;
       };
 
-      template<typename CellTagT, typename HandleTagT, typename VertexContainerTagT, typename CellContainerTagT>
-      struct full_topology_config_helper<CellTagT, viennagrid::vertex_tag, HandleTagT, VertexContainerTagT, CellContainerTagT>
+      template<typename CellTagT, typename HandleTagT, typename VertexContainerTagT, typename CellContainerTagT, typename BoundaryContainerTagT>
+      struct full_topology_config_helper<CellTagT, viennagrid::vertex_tag, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>
       {
         typedef typename viennagrid::make_typemap<
             viennagrid::vertex_tag,
-            typename full_element_config<CellTagT, viennagrid::vertex_tag, HandleTagT, VertexContainerTagT, CellContainerTagT>::type
+            typename full_element_config<CellTagT, viennagrid::vertex_tag, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>::type
         >::type type;
       };
 
@@ -166,14 +169,16 @@ namespace viennagrid
        *  @tparam HandleTagT            Defines, which handle type should be used for all elements. Default is pointer handle
        *  @tparam VertexContainerTagT   Defines, which container type should be used for vertices. Default is std::deque
        *  @tparam CellContainerTagT     Defines, which container type should be used for cells. Default is std::deque
+       *  @tparam BoundaryContainerTagT Defines, which container type should be used for all other elements, e.g. facets and edges. Default is a hidden key map, viennagrid::hashed_key_map_tag selects a hash table
        */
       template<typename CellTagT,
                typename HandleTagT  = viennagrid::pointer_handle_tag,
                typename VertexContainerTagT = viennagrid::std_deque_tag,
-               typename CellContainerTagT = viennagrid::std_deque_tag>
+               typename CellContainerTagT = viennagrid::std_deque_tag,
+               typename BoundaryContainerTagT = viennagrid::hidden_key_map_tag< viennagrid::element_key_tag > >
       struct full_topology_config
       {
-        typedef typename full_topology_config_helper<CellTagT, CellTagT, HandleTagT, VertexContainerTagT, CellContainerTagT>::type type;
+        typedef typename full_topology_config_helper<CellTagT, CellTagT, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>::type type;
       };
 
 
@@ -183,15 +188,17 @@ namespace viennagrid
        *  @tparam HandleTagT            Defines, which handle type should be used for all elements. Default is pointer handle
        *  @tparam VertexContainerTagT   Defines, which container type should be used for vertices. Default is std::deque
        *  @tparam CellContainerTagT     Defines, which container type should be used for cells. Default is std::deque
+       *  @tparam BoundaryContainerTagT Defines, which container type should be used for all other elements, e.g. facets and edges. Default is a hidden key map, viennagrid::hashed_key_map_tag selects a hash table
        */
       template<typename CellTagT,
                 typename PointType,
                 typename HandleTagT = viennagrid::pointer_handle_tag,
                 typename VertexContainerTagT = viennagrid::std_deque_tag,
-                typename CellContainerTagT = viennagrid::std_deque_tag>
+                typename CellContainerTagT = viennagrid::std_deque_tag,
+                typename BoundaryContainerTagT = viennagrid::hidden_key_map_tag< viennagrid::element_key_tag > >
       struct full_mesh_config
       {
-        typedef typename full_topology_config<CellTagT, HandleTagT, VertexContainerTagT, CellContainerTagT>::type MeshConfig;
+        typedef typename full_topology_config<CellTagT, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>::type MeshConfig;
         typedef typename query<MeshConfig, null_type, vertex_tag>::type VertexConfig;
 
         typedef typename viennagrid::detail::result_of::insert_or_modify<
@@ -211,10 +218,10 @@ namespace viennagrid
         >::type type;
       };
 
-      template<typename CellTagT, typename HandleTagT, typename VertexContainerTagT, typename CellContainerTagT>
-      struct full_mesh_config<CellTagT, void, HandleTagT, VertexContainerTagT, CellContainerTagT>
+      template<typename CellTagT, typename HandleTagT, typename VertexContainerTagT, typename CellContainerTagT, typename BoundaryContainerTagT>
+      struct full_mesh_config<CellTagT, void, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>
       {
-        typedef typename viennagrid::config::result_of::full_topology_config<CellTagT, HandleTagT, VertexContainerTagT, CellContainerTagT>::type type;
+        typedef typename viennagrid::config::result_of::full_topology_config<CellTagT, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>::type type;
       };
 
 
@@ -266,10 +273,11 @@ namespace viennagrid
               typename PointTypeT,
               typename HandleTagT = viennagrid::pointer_handle_tag,
               typename VertexContainerTagT = viennagrid::std_deque_tag,
-              typename CellContainerTagT = viennagrid::std_deque_tag>
+              typename CellContainerTagT = viennagrid::std_deque_tag,
+              typename BoundaryContainerTagT = viennagrid::hidden_key_map_tag< viennagrid::element_key_tag > >
     struct wrapped_mesh_config_t
     {
-      typedef typename result_of::full_mesh_config<CellTagT, PointTypeT, HandleTagT, VertexContainerTagT, CellContainerTagT>::type type;
+      typedef typename result_of::full_mesh_config<CellTagT, PointTypeT, HandleTagT, VertexContainerTagT, CellContainerTagT, BoundaryContainerTagT>::type type;
     };
   }
 
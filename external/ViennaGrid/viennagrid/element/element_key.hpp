@@ -22,6 +22,7 @@
 #include "viennagrid/element/element.hpp"
 #include "viennagrid/topology/vertex.hpp"
 
+#include "viennagrid/storage/id.hpp"
 #include "viennagrid/storage/container.hpp"
 #include "viennagrid/storage/hidden_key_map.hpp"
 
@@ -31,6 +32,21 @@
 
 namespace viennagrid
 {
+  namespace detail
+  {
+    /** @brief The container of the vertex ids of an element key: a static array if the number of vertices is fixed, a std::vector otherwise (e.g. for polygons) */
+    template<typename IDT, long NumVerticesV>
+    struct element_key_container
+    {
+      typedef viennagrid::static_array<IDT, NumVerticesV> type;
+    };
+
+    template<typename IDT>
+    struct element_key_container<IDT, -1>
+    {
+      typedef std::vector<IDT> type;
+    };
+  }
 
   /** @brief A key type that uniquely identifies an element by its vertices */
   template <typename element_type>
@@ -39,11 +55,14 @@ namespace viennagrid
     typedef typename element_type::tag            ElementTag;
     typedef typename viennagrid::result_of::element< element_type, vertex_tag >::type vertex_type;
     typedef typename vertex_type::id_type id_type;
+    typedef typename detail::element_key_container<id_type, boundary_elements<ElementTag, vertex_tag>::num>::type id_container_type;
 
   public:
 
-    explicit element_key( const element_type & el2) : vertex_ids( viennagrid::elements<vertex_tag>(el2).size() )
+    explicit element_key( const element_type & el2)
     {
+      vertex_ids.resize( viennagrid::elements<vertex_tag>(el2).size() );
+
       typedef typename viennagrid::result_of::const_element_range< element_type, vertex_tag >::type vertex_range;
       typedef typename viennagrid::result_of::const_iterator< vertex_range >::type const_iterator;
 
@@ -54,12 +73,8 @@ namespace viennagrid
            ++vit, ++i)
         vertex_ids[i] = static_cast<id_type>( (*vit).id() );
       //sort it:
-      std::sort(vertex_ids.begin(), vertex_ids.end());
-    }
-
-    element_key( const element_key & ek2) : vertex_ids(ek2.vertex_ids.size())
-    {
-      std::copy( ek2.vertex_ids.begin(), ek2.vertex_ids.end(), vertex_ids.begin() );
+      if (!vertex_ids.empty())
+        std::sort(&vertex_ids[0], &vertex_ids[0] + vertex_ids.size());
     }
 
     bool operator < (element_key const & epc2) const
@@ -77,9 +92,27 @@ namespace viennagrid
       return false;
     }
 
+    bool operator == (element_key const & epc2) const
+    {
+      return vertex_ids.size() == epc2.vertex_ids.size() && std::equal( vertex_ids.begin(), vertex_ids.end(), epc2.vertex_ids.begin() );
+    }
+
+    /** @brief Returns a hash value of the sorted vertex ids, used by viennagrid::hashed_key_map */
+    std::size_t hash() const
+    {
+      // FNV-1a over the ids, followed by a final mix such that the low bits depend on all ids
+      std::size_t h = static_cast<std::size_t>(2166136261u);
+      for (std::size_t i=0; i < vertex_ids.size(); ++i)
+        h = (h ^ id_value(vertex_ids[i])) * static_cast<std::size_t>(16777619u);
+      h ^= h >> 15;
+      h *= static_cast<std::size_t>(0x2c1b3c6du);
+      h ^= h >> 12;
+      return h;
+    }
+
     void print() const
     {
-      for (typename std::vector<id_type>::const_iterator vit = vertex_ids.begin();
+      for (typename id_container_type::const_iterator vit = vertex_ids.begin();
             vit != vertex_ids.end();
             ++vit)
         std::cout << *vit << " ";
@@ -87,8 +120,14 @@ namespace viennagrid
     }
 
   private:
-      // TODO: rather than hard-wiring std::vector, make this configurable
-    std::vector< id_type > vertex_ids;
+
+    template<typename ValueT, typename BaseIDT>
+    static std::size_t id_value( detail::smart_id<ValueT, BaseIDT> const & id ) { return static_cast<std::size_t>(id.get()); }
+
+    template<typename IDT>
+    static std::size_t id_value( IDT const & id ) { return static_cast<std::size_t>(id); }
+
+    id_container_type vertex_ids;
   };
 }
 
@@ -120,7 +120,8 @@ namespace viennagrid
         {
           std::stringstream ss;
           ss << "* ViennaGrid: Cannot open file " << filename_ << "!";
-          return ss.str().c_str();
+          what_ = ss.str();
+          return what_.c_str();
         }
 
         cannot_open_file_exception(std::string file) : filename_(file) {}
@@ -129,6 +130,7 @@ namespace viennagrid
 
       private:
         std::string filename_;
+        mutable std::string what_;   // the message must outlive what()
     };
 
     /** @brief Provides an exception for the case a parser problem occurs */
@@ -142,7 +144,8 @@ namespace viennagrid
             ss << "* ViennaGrid: Bad file format in file " << filename_ << ": " << message_;
           else
             ss << "* ViennaGrid: Bad file format: " << message_;
-          return ss.str().c_str();
+          what_ = ss.str();
+          return what_.c_str();
         }
 
         /** @brief Constructor taking the file name and a custom parser-specific message to be issued */
@@ -155,6 +158,7 @@ namespace viennagrid
       private:
         std::string filename_;
         std::string message_;
+        mutable std::string what_;   // the message must outlive what()
     };
 
 
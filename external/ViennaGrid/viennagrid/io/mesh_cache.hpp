@@ -0,0 +1,803 @@
+#ifndef VIENNAGRID_IO_MESH_CACHE_HPP
+#define VIENNAGRID_IO_MESH_CACHE_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+  #include <process.h>
+#else
+  #include <unistd.h>
+#endif
+
+#include "viennagrid/forwards.hpp"
+#include "viennagrid/io/helper.hpp"
+
+#include "viennagrid/mesh/mesh.hpp"
+#include "viennagrid/mesh/segmentation.hpp"
+#include "viennagrid/mesh/element_creation.hpp"
+
+/** @file viennagrid/io/mesh_cache.hpp
+    @brief Provides a binary cache file for meshes and segmentations, which are reloaded without parsing the original file
+
+    The cache file consists of a fixed-size header followed by flat arrays, each starting at a multiple of eight bytes:
+      - the header (see mesh_cache_header), among others holding the hash of the original file
+      - the IDs of the segments (int, segment_count entries)
+      - the vertex coordinates (double, geometric_dimension entries per vertex)
+      - the vertex indices of the cells (int, vertices_per_cell entries per cell)
+      - the segment ID of each cell (int, -1 for cells in no segment)
+    For simplex meshes, the derived topology follows, i.e. the boundary elements and their connectivity:
+      - for each boundary dimension d (edges, then triangles of tetrahedral meshes): the IDs of the elements, followed by
+        the indices of their boundary elements of dimension 0 (vertices) to d-1, in the local order of each element
+      - the indices of the boundary elements of dimension 1 to cell dimension - 1 of each cell
+    All values are stored in the byte order of the writing machine, the header allows to detect a mismatch.
+*/
+
+namespace viennagrid
+{
+  namespace io
+  {
+
+    /** @brief The header of a mesh cache file */
+    struct mesh_cache_header
+    {
+      /** @brief The version of the file layout, increased on every incompatible change */
+      static unsigned int current_version() { return 1; }
+      static unsigned int byte_order_mark() { return 0x01020304; }
+
+      mesh_cache_header() : version(current_version()), byte_order(byte_order_mark()), source_hash(0),
+                            geometric_dimension(0), vertices_per_cell(0), segment_count(0), topology_dimension(0), vertex_count(0), cell_count(0)
+      {
+        std::memcpy(magic, "VGCACHE", 8);
+        boundary_counts[0] = boundary_counts[1] = 0;
+      }
+
+      bool is_compatible() const
+      {
+        return std::memcmp(magic, "VGCACHE", 8) == 0 && version == current_version() && byte_order == byte_order_mark();
+      }
+
+      char                magic[8];
+      unsigned int        version;
+      unsigned int        byte_order;
+      unsigned long long  source_hash;
+      unsigned int        geometric_dimension;
+      unsigned int        vertices_per_cell;
+      unsigned int        segment_count;
+      unsigned int        topology_dimension;   // the cell dimension if the topology is stored, zero otherwise
+      unsigned long long  vertex_count;
+      unsigned long long  cell_count;
+      unsigned long long  boundary_counts[2];   // the number of edges and triangles if the topology is stored
+    };
+
+    namespace detail
+    {
+      /** @brief Rounds a number of bytes up to the next multiple of eight */
+      inline std::size_t mesh_cache_aligned(std::size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+      /** @brief Returns the number of boundary elements of dimension 'k' of a simplex of dimension 'n' */
+      inline std::size_t mesh_cache_simplex_boundary_size(int n, int k)
+      {
+        std::size_t result = 1;
+        for (int i = 0; i <= k; ++i)
+          result = result * static_cast<std::size_t>(n + 1 - i) / static_cast<std::size_t>(i + 1);
+        return result;
+      }
+
+      /** @brief Returns the sizes of the topology arrays in the order of the file, see the file description */
+      inline std::vector<std::size_t> mesh_cache_topology_sizes(mesh_cache_header const & header)
+      {
+        std::vector<std::size_t> sizes;
+        int const cell_dim = static_cast<int>(header.topology_dimension);
+        for (int d = 1; d < cell_dim; ++d)
+        {
+          std::size_t count = static_cast<std::size_t>(header.boundary_counts[d-1]);
+          sizes.push_back(count);
+          for (int k = 0; k < d; ++k)
+            sizes.push_back(count * mesh_cache_simplex_boundary_size(d, k));
+        }
+        for (int k = 1; k < cell_dim; ++k)
+          sizes.push_back(static_cast<std::size_t>(header.cell_count) * mesh_cache_simplex_boundary_size(cell_dim, k));
+        return sizes;
+      }
+
+      /** @brief Returns the total size of a cache file with the given header */
+      inline std::size_t mesh_cache_size(mesh_cache_header const & header)
+      {
+        std::size_t size = sizeof(mesh_cache_header)
+                         + mesh_cache_aligned(header.segment_count * sizeof(int))
+                         + mesh_cache_aligned(header.vertex_count * header.geometric_dimension * sizeof(double))
+                         + mesh_cache_aligned(header.cell_count * header.vertices_per_cell * sizeof(int))
+                         + mesh_cache_aligned(header.cell_count * sizeof(int));
+
+        std::vector<std::size_t> topology_sizes = mesh_cache_topology_sizes(header);
+        for (std::size_t i = 0; i < topology_sizes.size(); ++i)
+          size += mesh_cache_aligned(topology_sizes[i] * sizeof(int));
+        return size;
+      }
+
+      /** @brief A file name next to the cache file, which is unique among the processes and writers writing the same cache file */
+      inline std::string mesh_cache_temporary_filename(std::string const & filename, void const * writer)
+      {
+        std::ostringstream name;
+#ifdef _WIN32
+        name << filename << ".tmp." << _getpid() << "." << writer;
+#else
+        name << filename << ".tmp." << getpid() << "." << writer;
+#endif
+        return name.str();
+      }
+
+      template<typename T>
+      void mesh_cache_write_array(std::ofstream & writer, std::vector<T> const & values)
+      {
+        static const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+        std::size_t bytes = values.size() * sizeof(T);
+        if (bytes > 0)
+          writer.write(reinterpret_cast<char const *>(&values[0]), static_cast<std::streamsize>(bytes));
+        writer.write(zeros, static_cast<std::streamsize>(mesh_cache_aligned(bytes) - bytes));
+      }
+
+      template<typename T>
+      bool mesh_cache_read_array(std::ifstream & reader, std::vector<T> & values, std::size_t size)
+      {
+        values.resize(size);
+        std::size_t bytes = size * sizeof(T);
+        if (bytes > 0)
+          reader.read(reinterpret_cast<char *>(&values[0]), static_cast<std::streamsize>(bytes));
+        reader.ignore(static_cast<std::streamsize>(mesh_cache_aligned(bytes) - bytes));
+        return reader.good();
+      }
+
+
+      /** @brief Appends the indices of the boundary elements of dimension SubDimT to DimT-1 of an element to the arrays starting at 'arrays' */
+      template<int SubDimT, int DimT>
+      struct mesh_cache_boundary_indices
+      {
+        template<typename ElementT>
+        static void append(ElementT const & element, std::vector< std::vector<int> > const & index_of_id, std::vector<int> * arrays)
+        {
+          typedef typename viennagrid::result_of::const_element_range<ElementT, simplex_tag<SubDimT> >::type  BoundaryRange;
+          typedef typename viennagrid::result_of::iterator<BoundaryRange>::type                                 BoundaryIterator;
+
+          BoundaryRange boundary(element);
+          for (BoundaryIterator bit = boundary.begin(); bit != boundary.end(); ++bit)
+            arrays[0].push_back(index_of_id[SubDimT][static_cast<std::size_t>((*bit).id().get())]);
+
+          mesh_cache_boundary_indices<SubDimT+1, DimT>::append(element, index_of_id, arrays + 1);
+        }
+      };
+
+      template<int DimT>
+      struct mesh_cache_boundary_indices<DimT, DimT>
+      {
+        template<typename ElementT>
+        static void append(ElementT const &, std::vector< std::vector<int> > const &, std::vector<int> *) {}
+      };
+
+
+      /** @brief Collects the topology arrays of the boundary elements of dimension DimT to CellDimT-1, see the file description */
+      template<int DimT, int CellDimT>
+      struct mesh_cache_topology_writer
+      {
+        template<typename MeshT>
+        static void collect(MeshT const & mesh_obj, mesh_cache_header & header,
+                            std::vector< std::vector<int> > & index_of_id, std::vector< std::vector<int> > & arrays)
+        {
+          typedef typename viennagrid::result_of::const_element_range<MeshT, simplex_tag<DimT> >::type  ElementRange;
+          typedef typename viennagrid::result_of::iterator<ElementRange>::type                           ElementIterator;
+
+          ElementRange elements(mesh_obj);
+          header.boundary_counts[DimT-1] = elements.size();
+
+          std::size_t first = arrays.size();
+          arrays.resize(first + 1 + DimT);   // the IDs, then the boundary elements of dimension 0 to DimT-1
+
+          int index = 0;
+          for (ElementIterator it = elements.begin(); it != elements.end(); ++it, ++index)
+          {
+            std::size_t id = static_cast<std::size_t>((*it).id().get());
+            if (id >= index_of_id[DimT].size())
+              index_of_id[DimT].resize(id + 1, -1);
+            index_of_id[DimT][id] = index;
+            arrays[first].push_back(static_cast<int>(id));
+
+            mesh_cache_boundary_indices<0, DimT>::append(*it, index_of_id, &arrays[first + 1]);
+          }
+
+          mesh_cache_topology_writer<DimT+1, CellDimT>::collect(mesh_obj, header, index_of_id, arrays);
+        }
+      };
+
+      template<int CellDimT>
+      struct mesh_cache_topology_writer<CellDimT, CellDimT>
+      {
+        template<typename MeshT>
+        static void collect(MeshT const &, mesh_cache_header &, std::vector< std::vector<int> > &, std::vector< std::vector<int> > &) {}
+      };
+
+
+      /** @brief The handles of the elements of dimension 0 to DimT created from a cache file, ordered as in the file */
+      template<typename MeshT, int DimT>
+      struct mesh_cache_handles : public mesh_cache_handles<MeshT, DimT-1>
+      {
+        std::vector<typename viennagrid::result_of::handle<MeshT, simplex_tag<DimT> >::type> handles;
+      };
+
+      template<typename MeshT>
+      struct mesh_cache_handles<MeshT, 0>
+      {
+        std::vector<typename viennagrid::result_of::handle<MeshT, vertex_tag>::type> handles;
+      };
+
+      /** @brief Advances a combination of 'k' out of 'n' positions in lexicographic order, the order in which simplices create their boundary elements */
+      inline void mesh_cache_next_combination(int * positions, int k, int n)
+      {
+        int i = k - 1;
+        while (i > 0 && positions[i] == n - k + i)
+          --i;
+        ++positions[i];
+        for (int j = i + 1; j < k; ++j)
+          positions[j] = positions[j-1] + 1;
+      }
+
+      /** @brief Sets the boundary elements of dimension SubDimT to DimT-1 of an element, 'arrays[s]' holds the indices of the boundary elements of dimension s */
+      template<int SubDimT, int DimT>
+      struct mesh_cache_boundary_setter
+      {
+        template<typename MeshT, typename ElementT, typename HandlesT>
+        static void set(MeshT & mesh_obj, ElementT & element, std::vector<int> const * const * arrays, std::size_t index, HandlesT const & handles)
+        {
+          typedef typename viennagrid::result_of::element<MeshT, simplex_tag<SubDimT> >::type BoundaryElementType;
+          std::vector<typename viennagrid::result_of::handle<MeshT, simplex_tag<SubDimT> >::type> const & boundary_handles
+              = static_cast<mesh_cache_handles<MeshT, SubDimT> const &>(handles).handles;
+          std::vector<typename viennagrid::result_of::handle<MeshT, vertex_tag>::type> const & vertex_handles
+              = static_cast<mesh_cache_handles<MeshT, 0> const &>(handles).handles;
+
+          const int num = boundary_elements<simplex_tag<DimT>, simplex_tag<SubDimT> >::num;
+          int const * indices = &(*arrays[SubDimT])[num * index];
+          int const * vertices = &(*arrays[0])[(DimT + 1) * index];
+
+          // the boundary element with the vertices in the local order of the element, from which the orientation is determined
+          BoundaryElementType boundary_element( viennagrid::detail::inserter(mesh_obj).get_physical_container_collection() );
+          int positions[SubDimT + 1];
+          for (int j = 0; j <= SubDimT; ++j)
+            positions[j] = j;
+
+          for (int k = 0; k < num; ++k, mesh_cache_next_combination(positions, SubDimT + 1, DimT + 1))
+          {
+            for (int j = 0; j <= SubDimT; ++j)
+              boundary_element.set_vertex( vertex_handles[vertices[positions[j]]], j );
+            element.set_boundary_element( boundary_element, std::make_pair(boundary_handles[indices[k]], false), k );
+          }
+
+          mesh_cache_boundary_setter<SubDimT+1, DimT>::set(mesh_obj, element, arrays, index, handles);
+        }
+      };
+
+      template<int DimT>
+      struct mesh_cache_boundary_setter<DimT, DimT>
+      {
+        template<typename MeshT, typename ElementT, typename HandlesT>
+        static void set(MeshT &, ElementT &, std::vector<int> const * const *, std::size_t, HandlesT const &) {}
+      };
+
+      /** @brief Creates an element of dimension DimT with the given vertices and boundary elements without searching its boundary elements in the mesh */
+      template<int DimT, typename MeshT, typename HandlesT>
+      typename viennagrid::result_of::handle<MeshT, simplex_tag<DimT> >::type
+      mesh_cache_make_element(MeshT & mesh_obj, int id, std::vector<int> const * const * arrays, std::size_t index, HandlesT const & handles)
+      {
+        typedef typename viennagrid::result_of::element<MeshT, simplex_tag<DimT> >::type ElementType;
+        std::vector<typename viennagrid::result_of::handle<MeshT, vertex_tag>::type> const & vertex_handles
+            = static_cast<mesh_cache_handles<MeshT, 0> const &>(handles).handles;
+
+        ElementType element( viennagrid::detail::inserter(mesh_obj).get_physical_container_collection() );
+        element.id( typename ElementType::id_type(id) );
+
+        int const * vertices = &(*arrays[0])[(DimT + 1) * index];
+        for (int j = 0; j <= DimT; ++j)
+          element.set_vertex( vertex_handles[vertices[j]], j );
+        mesh_cache_boundary_setter<1, DimT>::set(mesh_obj, element, arrays, index, handles);
+
+        return viennagrid::detail::push_element<false, false>(mesh_obj, element).first;
+      }
+
+      /** @brief Creates the boundary elements of dimension DimT to CellDimT-1 from the topology arrays starting at 'arrays' */
+      template<int DimT, int CellDimT>
+      struct mesh_cache_topology_reader
+      {
+        template<typename MeshT, typename HandlesT>
+        static void create(MeshT & mesh_obj, mesh_cache_header const & header, std::vector<int> const * arrays, HandlesT & handles)
+        {
+          std::size_t const count = static_cast<std::size_t>(header.boundary_counts[DimT-1]);
+          std::vector<int> const & ids = arrays[0];
+
+          std::vector<int> const * boundary_arrays[DimT];
+          for (int k = 0; k < DimT; ++k)
+            boundary_arrays[k] = &arrays[1 + k];
+
+          std::vector<typename viennagrid::result_of::handle<MeshT, simplex_tag<DimT> >::type> & element_handles
+              = static_cast<mesh_cache_handles<MeshT, DimT> &>(handles).handles;
+          element_handles.resize(count);
+          for (std::size_t i = 0; i < count; ++i)
+            element_handles[i] = mesh_cache_make_element<DimT>(mesh_obj, ids[i], boundary_arrays, i, handles);
+
+          mesh_cache_topology_reader<DimT+1, CellDimT>::create(mesh_obj, header, arrays + 1 + DimT, handles);
+        }
+      };
+
+      template<int CellDimT>
+      struct mesh_cache_topology_reader<CellDimT, CellDimT>
+      {
+        template<typename MeshT, typename HandlesT>
+        static void create(MeshT &, mesh_cache_header const &, std::vector<int> const *, HandlesT &) {}
+      };
+
+      /** @brief Returns whether the topology of a cell type can be stored, which holds for simplices */
+      template<typename CellTagT>
+      struct mesh_cache_has_topology { static const bool value = false; };
+
+      template<int DimT>
+      struct mesh_cache_has_topology< simplex_tag<DimT> > { static const bool value = (DimT >= 2 && DimT <= 3); };
+
+      /** @brief Returns true if all indices are in the range [0, count) */
+      inline bool mesh_cache_valid_indices(std::vector<int> const & indices, std::size_t count)
+      {
+        for (std::size_t i = 0; i < indices.size(); ++i)
+          if (indices[i] < 0 || static_cast<std::size_t>(indices[i]) >= count)
+            return false;
+        return true;
+      }
+
+      /** @brief Returns true if all boundary element indices of the topology arrays refer to existing elements */
+      inline bool mesh_cache_valid_topology(mesh_cache_header const & header, std::vector< std::vector<int> > const & topology)
+      {
+        int const cell_dim = static_cast<int>(header.topology_dimension);
+        std::vector<std::size_t> counts(1, static_cast<std::size_t>(header.vertex_count));
+        std::size_t array = 0;
+        for (int d = 1; d < cell_dim; ++d)
+        {
+          ++array;   // the IDs
+          for (int k = 0; k < d; ++k, ++array)
+            if (!mesh_cache_valid_indices(topology[array], counts[k]))
+              return false;
+          counts.push_back(static_cast<std::size_t>(header.boundary_counts[d-1]));
+        }
+        for (int k = 1; k < cell_dim; ++k, ++array)
+          if (!mesh_cache_valid_indices(topology[array], counts[k]))
+            return false;
+        return true;
+      }
+
+      /** @brief Collects and creates the topology arrays of simplex meshes, the topology of other meshes is not stored */
+      template<bool HasTopologyV>
+      struct mesh_cache_topology
+      {
+        /** @brief Collects the topology arrays in the order of the file, 'vertex_of_id' maps the vertex IDs to the vertex indices and is consumed */
+        template<typename MeshT>
+        static void collect(MeshT const & mesh_obj, mesh_cache_header & header, std::vector<int> & vertex_of_id, std::vector< std::vector<int> > & topology)
+        {
+          typedef typename viennagrid::result_of::cell_tag<MeshT>::type                                 CellTag;
+          typedef typename viennagrid::result_of::const_element_range<MeshT, CellTag>::type             CellRange;
+          typedef typename viennagrid::result_of::iterator<CellRange>::type                             CellIterator;
+
+          header.topology_dimension = CellTag::dim;
+
+          std::vector< std::vector<int> > index_of_id(CellTag::dim);
+          index_of_id[0].swap(vertex_of_id);
+          mesh_cache_topology_writer<1, CellTag::dim>::collect(mesh_obj, header, index_of_id, topology);
+
+          CellRange cells(mesh_obj);
+          std::size_t first = topology.size();
+          topology.resize(first + CellTag::dim - 1);
+          for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit)
+            mesh_cache_boundary_indices<1, CellTag::dim>::append(*cit, index_of_id, &topology[first]);
+        }
+
+        /** @brief Creates the boundary elements and the cells from the topology arrays.
+         *
+         * The elements are inserted with their stored boundary elements, hence no boundary element is searched in the mesh,
+         * which dominates the construction of a mesh from its cell vertices.
+         */
+        template<typename MeshT, typename SegmentationT, typename VertexHandleContainerT>
+        static void create(MeshT & mesh_obj, SegmentationT & segmentation, mesh_cache_header const & header,
+                           std::vector<int> const & cell_vertices, std::vector<int> const & cell_segments,
+                           std::vector< std::vector<int> > const & topology, VertexHandleContainerT const & vertex_handles)
+        {
+          typedef typename viennagrid::result_of::cell_tag<MeshT>::type                                 CellTag;
+          typedef typename viennagrid::result_of::handle<MeshT, CellTag>::type                          CellHandleType;
+          const int cell_dim = CellTag::dim;
+
+          mesh_cache_handles<MeshT, cell_dim-1> handles;
+          static_cast<mesh_cache_handles<MeshT, 0> &>(handles).handles = vertex_handles;
+          mesh_cache_topology_reader<1, cell_dim>::create(mesh_obj, header, &topology[0], handles);
+
+          std::vector<int> const * cell_arrays[cell_dim];
+          cell_arrays[0] = &cell_vertices;
+          for (int k = 1; k < cell_dim; ++k)
+            cell_arrays[k] = &topology[topology.size() - cell_dim + k];
+
+          std::size_t const cell_count = static_cast<std::size_t>(header.cell_count);
+          for (std::size_t i = 0; i < cell_count; ++i)
+          {
+            CellHandleType cell_handle = mesh_cache_make_element<cell_dim>(mesh_obj, static_cast<int>(i), cell_arrays, i, handles);
+            if (cell_segments[i] >= 0)
+              viennagrid::add( segmentation[cell_segments[i]], viennagrid::dereference_handle(mesh_obj, cell_handle) );
+          }
+        }
+      };
+
+      template<>
+      struct mesh_cache_topology<false>
+      {
+        template<typename MeshT>
+        static void collect(MeshT const &, mesh_cache_header &, std::vector<int> &, std::vector< std::vector<int> > &) {}
+
+        template<typename MeshT, typename SegmentationT, typename VertexHandleContainerT>
+        static void create(MeshT &, SegmentationT &, mesh_cache_header const &, std::vector<int> const &, std::vector<int> const &,
+                           std::vector< std::vector<int> > const &, VertexHandleContainerT const &) {}
+      };
+    }
+
+    /** @brief Computes a 64-bit hash of the content of a file, which identifies the original file of a cache. Throws cannot_open_file_exception if the file cannot be read. */
+    inline unsigned long long file_hash(std::string const & filename)
+    {
+      std::ifstream reader(filename.c_str(), std::ios::binary);
+      if (!reader)
+        throw cannot_open_file_exception(filename);
+
+      unsigned long long const prime = 1099511628211ULL;
+      unsigned long long hash = 14695981039346656037ULL;
+      unsigned long long size = 0;
+
+      std::vector<char> buffer(1 << 20);
+      while (reader)
+      {
+        reader.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+        std::size_t count = static_cast<std::size_t>(reader.gcount());
+        size += count;
+
+        // eight bytes at a time, the remainder byte by byte
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+          unsigned long long word;
+          std::memcpy(&word, &buffer[i], 8);
+          hash = (hash ^ word) * prime;
+          hash ^= hash >> 29;
+        }
+        for (; i < count; ++i)
+          hash = (hash ^ static_cast<unsigned char>(buffer[i])) * prime;
+      }
+      return (hash ^ size) * prime;
+    }
+
+
+    /** @brief Writes a mesh and a segmentation to a binary cache file, see mesh_cache_reader. An existing cache file is replaced at once,
+     * hence concurrent readers and writers never see a partially written one */
+    struct mesh_cache_writer
+    {
+      /** @brief The functor interface triggering the write operation.
+       *
+       * @param mesh_obj      The mesh to be written
+       * @param segmentation  The segmentation to be written, each cell is recorded with one segment
+       * @param filename      Name of the cache file
+       * @param source_hash   The hash of the original file, see file_hash()
+       */
+      template <typename MeshType, typename SegmentationType>
+      void operator()(MeshType const & mesh_obj, SegmentationType const & segmentation, std::string const & filename, unsigned long long source_hash) const
+      {
+        typedef typename viennagrid::result_of::point<MeshType>::type                                 PointType;
+        typedef typename result_of::cell_tag<MeshType>::type                                          CellTag;
+
+        typedef typename viennagrid::result_of::const_element_range<MeshType, vertex_tag>::type       VertexRange;
+        typedef typename viennagrid::result_of::iterator<VertexRange>::type                           VertexIterator;
+        typedef typename viennagrid::result_of::const_element_range<MeshType, CellTag>::type          CellRange;
+        typedef typename viennagrid::result_of::iterator<CellRange>::type                             CellIterator;
+        typedef typename viennagrid::result_of::const_element_range<typename result_of::element<MeshType, CellTag>::type, vertex_tag>::type  VertexOnCellRange;
+        typedef typename viennagrid::result_of::iterator<VertexOnCellRange>::type                     VertexOnCellIterator;
+
+        typedef typename SegmentationType::const_iterator                                             SegmentIterator;
+        typedef typename viennagrid::result_of::segment_handle<SegmentationType>::type                SegmentHandleType;
+        typedef typename viennagrid::result_of::const_element_range<SegmentHandleType, CellTag>::type CellOnSegmentRange;
+        typedef typename viennagrid::result_of::iterator<CellOnSegmentRange>::type                    CellOnSegmentIterator;
+
+        const int point_dim = viennagrid::result_of::static_size<PointType>::value;
+        const int cell_size = boundary_elements<CellTag, vertex_tag>::num;
+
+        VertexRange vertices(mesh_obj);
+        CellRange   cells(mesh_obj);
+
+        mesh_cache_header header;
+        header.source_hash         = source_hash;
+        header.geometric_dimension = point_dim;
+        header.vertices_per_cell   = cell_size;
+        header.segment_count       = static_cast<unsigned int>(segmentation.size());
+        header.vertex_count        = vertices.size();
+        header.cell_count          = cells.size();
+
+        // the vertices and cells are numbered in the order of their ranges
+        std::vector<int>    vertex_of_id;
+        std::vector<double> coordinates;
+        coordinates.reserve(point_dim * vertices.size());
+        int index = 0;
+        for (VertexIterator vit = vertices.begin(); vit != vertices.end(); ++vit, ++index)
+        {
+          std::size_t id = static_cast<std::size_t>((*vit).id().get());
+          if (id >= vertex_of_id.size())
+            vertex_of_id.resize(id + 1, -1);
+          vertex_of_id[id] = index;
+
+          PointType const & p = viennagrid::point(mesh_obj, *vit);
+          for (int j = 0; j < point_dim; ++j)
+            coordinates.push_back(p[j]);
+        }
+
+        std::vector<int> cell_of_id;
+        std::vector<int> cell_vertices;
+        cell_vertices.reserve(cell_size * cells.size());
+        index = 0;
+        for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit, ++index)
+        {
+          std::size_t id = static_cast<std::size_t>((*cit).id().get());
+          if (id >= cell_of_id.size())
+            cell_of_id.resize(id + 1, -1);
+          cell_of_id[id] = index;
+
+          VertexOnCellRange vertices_on_cell(*cit);
+          for (VertexOnCellIterator vocit = vertices_on_cell.begin(); vocit != vertices_on_cell.end(); ++vocit)
+            cell_vertices.push_back(vertex_of_id[static_cast<std::size_t>((*vocit).id().get())]);
+        }
+
+        std::vector<int> segment_ids;
+        std::vector<int> cell_segments(cells.size(), -1);
+        for (SegmentIterator sit = segmentation.begin(); sit != segmentation.end(); ++sit)
+        {
+          segment_ids.push_back(static_cast<int>((*sit).id()));
+
+          CellOnSegmentRange cells_on_segment(*sit);
+          for (CellOnSegmentIterator cit = cells_on_segment.begin(); cit != cells_on_segment.end(); ++cit)
+          {
+            int & segment = cell_segments[cell_of_id[static_cast<std::size_t>((*cit).id().get())]];
+            if (segment == -1)
+              segment = segment_ids.back();
+          }
+        }
+
+        // the topology of simplex meshes: the boundary elements with their IDs and the cells with their boundary elements
+        std::vector< std::vector<int> > topology;
+        detail::mesh_cache_topology<detail::mesh_cache_has_topology<CellTag>::value>::collect(mesh_obj, header, vertex_of_id, topology);
+
+        // concurrent runs may cache the same file, hence the cache file is written to a file of its own and renamed into place
+        std::string temporary = detail::mesh_cache_temporary_filename(filename, this);
+        std::ofstream writer(temporary.c_str(), std::ios::binary);
+        if (!writer)
+          throw cannot_open_file_exception(temporary);
+
+        writer.write(reinterpret_cast<char const *>(&header), sizeof(header));
+        detail::mesh_cache_write_array(writer, segment_ids);
+        detail::mesh_cache_write_array(writer, coordinates);
+        detail::mesh_cache_write_array(writer, cell_vertices);
+        detail::mesh_cache_write_array(writer, cell_segments);
+        for (std::size_t i = 0; i < topology.size(); ++i)
+          detail::mesh_cache_write_array(writer, topology[i]);
+        writer.close();
+
+        if (!writer)
+        {
+          std::remove(temporary.c_str());
+          throw bad_file_format_exception(filename, "Write error.");
+        }
+
+#ifdef _WIN32
+        std::remove(filename.c_str());   // rename does not replace existing files on Windows
+#endif
+        if (std::rename(temporary.c_str(), filename.c_str()) != 0)
+        {
+          std::remove(temporary.c_str());
+          throw cannot_open_file_exception(filename);
+        }
+      }
+    };
+
+
+    /** @brief Reads a mesh and a segmentation from a binary cache file written by mesh_cache_writer.
+     *
+     * The vertices and cells get the same IDs as by netgen_reader, the boundary elements are created with the cells.
+     */
+    struct mesh_cache_reader
+    {
+      /** @brief The functor interface triggering the read operation. The mesh is only modified if the cache is valid.
+       *
+       * @param mesh_obj      The mesh where the file content is written to
+       * @param segmentation  The segmentation where the file content is written to
+       * @param filename      Name of the cache file
+       * @param source_hash   The hash of the original file, see file_hash()
+       * @return              False if the cache file does not exist, belongs to another original file or mesh type, or is incomplete
+       */
+      template <typename MeshType, typename SegmentationType>
+      bool operator()(MeshType & mesh_obj, SegmentationType & segmentation, std::string const & filename, unsigned long long source_hash) const
+      {
+        typedef typename viennagrid::result_of::point<MeshType>::type                   PointType;
+        typedef typename result_of::cell_tag<MeshType>::type                            CellTag;
+        typedef typename result_of::element<MeshType, CellTag>::type                    CellType;
+        typedef typename result_of::element<MeshType, vertex_tag>::type                 VertexType;
+        typedef typename result_of::handle<MeshType, vertex_tag>::type                  VertexHandleType;
+
+        const int point_dim = viennagrid::result_of::static_size<PointType>::value;
+        const int cell_size = boundary_elements<CellTag, vertex_tag>::num;
+
+        std::ifstream reader(filename.c_str(), std::ios::binary);
+        if (!reader)
+          return false;
+
+        mesh_cache_header header;
+        reader.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!reader || !header.is_compatible() || header.source_hash != source_hash
+            || header.geometric_dimension != static_cast<unsigned int>(point_dim)
+            || header.vertices_per_cell != static_cast<unsigned int>(cell_size)
+            || header.topology_dimension != static_cast<unsigned int>(detail::mesh_cache_has_topology<CellTag>::value ? CellTag::dim : 0))
+          return false;
+
+        reader.seekg(0, std::ios::end);
+        if (static_cast<std::size_t>(reader.tellg()) != detail::mesh_cache_size(header))
+          return false;
+        reader.seekg(sizeof(header), std::ios::beg);
+
+        std::vector<int>    segment_ids;
+        std::vector<double> coordinates;
+        std::vector<int>    cell_vertices;
+        std::vector<int>    cell_segments;
+        std::size_t const   vertex_count = static_cast<std::size_t>(header.vertex_count);
+        std::size_t const   cell_count   = static_cast<std::size_t>(header.cell_count);
+        if (!detail::mesh_cache_read_array(reader, segment_ids, header.segment_count)
+            || !detail::mesh_cache_read_array(reader, coordinates, point_dim * vertex_count)
+            || !detail::mesh_cache_read_array(reader, cell_vertices, cell_size * cell_count)
+            || !detail::mesh_cache_read_array(reader, cell_segments, cell_count))
+          return false;
+
+        std::vector<std::size_t> topology_sizes = detail::mesh_cache_topology_sizes(header);
+        std::vector< std::vector<int> > topology(topology_sizes.size());
+        for (std::size_t i = 0; i < topology_sizes.size(); ++i)
+          if (!detail::mesh_cache_read_array(reader, topology[i], topology_sizes[i]))
+            return false;
+
+        if (!detail::mesh_cache_valid_indices(cell_vertices, vertex_count)
+            || !detail::mesh_cache_valid_topology(header, topology))
+          return false;
+
+        //
+        // Create the mesh:
+        //
+        for (std::size_t i = 0; i < segment_ids.size(); ++i)
+          segmentation.get_make_segment(segment_ids[i]);
+
+        std::vector<VertexHandleType> vertex_handles(vertex_count);
+        for (std::size_t i = 0; i < vertex_count; ++i)
+        {
+          PointType p;
+          for (int j = 0; j < point_dim; ++j)
+            p[j] = coordinates[point_dim * i + j];
+
+          vertex_handles[i] = viennagrid::make_vertex_with_id( mesh_obj, typename VertexType::id_type(i), p );
+        }
+
+        if (!topology.empty())
+        {
+          detail::mesh_cache_topology<detail::mesh_cache_has_topology<CellTag>::value>::create(mesh_obj, segmentation, header, cell_vertices, cell_segments, topology, vertex_handles);
+          return true;
+        }
+
+        if (cell_count > 0)
+          viennagrid::reserve_boundary_elements( mesh_obj, cell_count );
+
+        for (std::size_t i = 0; i < cell_count; ++i)
+        {
+          viennagrid::static_array<VertexHandleType, boundary_elements<CellTag, vertex_tag>::num> cell_vertex_handles;
+          for (int j = 0; j < cell_size; ++j)
+            cell_vertex_handles[j] = vertex_handles[cell_vertices[cell_size * i + j]];
+
+          if (cell_segments[i] < 0)
+            viennagrid::make_element_with_id<CellType>(mesh_obj, cell_vertex_handles.begin(), cell_vertex_handles.end(), typename CellType::id_type(i));
+          else
+            viennagrid::make_element_with_id<CellType>(segmentation[cell_segments[i]], cell_vertex_handles.begin(), cell_vertex_handles.end(), typename CellType::id_type(i));
+        }
+
+        return true;
+      }
+    };
+
+
+    /** @brief Wraps a reader such that the result of the first read of a file is stored in a binary cache file next to it, from which later reads are served.
+     *
+     * The cache file is named after the original file with the suffix '.vgcache' appended. If a cache directory is given, the cache files
+     * are stored there instead, see cache_filename(). A cache file is only used if it was written for the same
+     * content of the original file (see file_hash()) and the same mesh type, otherwise the original file is read and the cache file is rewritten.
+     * If the cache file cannot be written, e.g. in a read-only directory, the file is read without caching.
+     *
+     * @tparam ReaderT   The reader of the original file format, e.g. netgen_reader
+     */
+    template <typename ReaderT>
+    struct cached_reader
+    {
+      /** @brief An empty cache directory stores the cache files next to the original files, otherwise the directory has to exist */
+      cached_reader(ReaderT const & reader = ReaderT(), std::string const & cache_directory = std::string())
+        : reader_(reader), cache_directory_(cache_directory), from_cache_(false) {}
+
+      /** @brief Returns the name of the cache file of a file */
+      static std::string cache_filename(std::string const & filename) { return filename + ".vgcache"; }
+
+      /** @brief Returns the name of the cache file of a file in a cache directory. The name contains a hash of the path of the file,
+       * hence files of the same name in different directories do not share a cache file */
+      static std::string cache_filename(std::string const & filename, std::string const & cache_directory)
+      {
+        if (cache_directory.empty())
+          return cache_filename(filename);
+
+        unsigned long long hash = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < filename.size(); ++i)
+          hash = (hash ^ static_cast<unsigned char>(filename[i])) * 1099511628211ULL;
+
+        std::ostringstream name;
+        name << cache_directory << '/' << filename.substr(filename.find_last_of("/\\") + 1) << '.' << std::hex << hash << ".vgcache";
+        return name.str();
+      }
+
+      /** @brief Returns true if the last read was served from the cache file */
+      bool from_cache() const { return from_cache_; }
+
+      /** @brief The functor interface triggering the read operation.
+       *
+       * @param mesh_obj      The mesh where the file content is written to
+       * @param segmentation  The segmentation where the file content is written to
+       * @param filename      Name of the original file
+       */
+      template <typename MeshType, typename SegmentationType>
+      int operator()(MeshType & mesh_obj, SegmentationType & segmentation, std::string const & filename)
+      {
+        unsigned long long source_hash = file_hash(filename);
+        std::string cache_file = cache_filename(filename, cache_directory_);
+
+        from_cache_ = mesh_cache_reader()(mesh_obj, segmentation, cache_file, source_hash);
+        if (from_cache_)
+          return EXIT_SUCCESS;
+
+        int result = reader_(mesh_obj, segmentation, filename);
+        try
+        {
+          mesh_cache_writer()(mesh_obj, segmentation, cache_file, source_hash);
+        }
+        catch (std::exception const &)
+        {
+          // reading does not depend on the cache, a failed write leaves the cache file untouched
+        }
+        return result;
+      }
+
+    private:
+      ReaderT     reader_;
+      std::string cache_directory_;
+      bool        from_cache_;
+    };
+
+  } //namespace io
+} //namespace viennagrid
+
+#endif
@@ -113,6 +113,9 @@ namespace viennagrid
         std::cout << "* netgen_reader::operator(): Reading " << cell_num << " cells... " << std::endl;
         #endif
 
+        if (cell_num > 0)
+          viennagrid::reserve_boundary_elements( mesh_obj, static_cast<std::size_t>(cell_num) );
+
         for (int i=0; i<cell_num; ++i)
         {
           long vertex_num;
@@ -16,6 +16,9 @@
 
 /** @file viennagrid/io/vtk_reader.hpp
  *  @brief    This is a simple vtk-reader implementation. Refer to the vtk-standard (cf. http://www.vtk.org/pdf/file-formats.pdf) and make sure the same order of XML tags is preserved.
+ *
+ *  Data arrays are read in the ascii, binary (base64) and appended (raw or base64) formats. Compressed binary data requires zlib,
+ *  which is enabled by defining VIENNAGRID_WITH_ZLIB and linking against zlib.
  */
 
 #include <fstream>
@@ -25,6 +28,15 @@
 #include <deque>
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <limits>
+
+#ifdef VIENNAGRID_WITH_ZLIB
+#include <zlib.h>
+#endif
 
 #include "viennagrid/forwards.hpp"
 #include "viennagrid/point.hpp"
@@ -38,7 +50,391 @@ namespace viennagrid
   namespace io
   {
 
+    namespace detail
+    {
+      /** @brief Merges points which coincide up to a tolerance using a spatial hash, replaces a std::map of the points.
+       *
+       * For a positive tolerance, space is divided into cubes with the tolerance as edge length. A point is compared to the points in its own
+       * and the neighboring cubes, two points are merged if all their coordinates differ by at most the tolerance.
+       * For tolerance zero only identical points are merged.
+       * The hash table uses open addressing with linear probing, a point is found between the slot of its cube and the next empty slot.
+       */
+      template<typename PointT>
+      class vtk_point_merger
+      {
+        static const int dim = viennagrid::result_of::static_size<PointT>::value;
+
+      public:
+
+        vtk_point_merger() : tolerance_(0.0) {}
+
+        /** @brief Removes all points and sets the tolerance up to which points are merged */
+        void clear(double tolerance)
+        {
+          tolerance_ = tolerance;
+          points_.clear();
+          table_.clear();
+        }
+
+        /** @brief Returns the distinct points in the order of their insertion */
+        std::vector<PointT> const & points() const { return points_; }
+
+        /** @brief Returns the index of the point merged with p, p is added as a new point if there is none */
+        std::size_t insert(PointT const & p)
+        {
+          if (2 * (points_.size() + 1) > table_.size())
+            rehash( std::max<std::size_t>(64, 2 * table_.size()) );
+
+          long long cube[dim];
+          for (int j = 0; j < dim; ++j)
+            cube[j] = cube_index(p[j]);
+
+          // all 3^dim neighboring cubes for a positive tolerance, only the own cube otherwise
+          int neighbors = 1;
+          if (tolerance_ > 0)
+            for (int j = 0; j < dim; ++j)
+              neighbors *= 3;
+
+          for (int n = 0; n < neighbors; ++n)
+          {
+            long long neighbor[dim];
+            int digits = n;
+            for (int j = 0; j < dim; ++j, digits /= 3)
+              neighbor[j] = (tolerance_ > 0) ? cube[j] + digits % 3 - 1 : cube[j];
+
+            for (std::size_t slot = hash(neighbor) & mask(); table_[slot] != invalid(); slot = (slot + 1) & mask())
+              if (coincide(points_[table_[slot]], p))
+                return table_[slot];
+          }
+
+          std::size_t slot = hash(cube) & mask();
+          while (table_[slot] != invalid())
+            slot = (slot + 1) & mask();
+          table_[slot] = points_.size();
+          points_.push_back(p);
+          return points_.size() - 1;
+        }
+
+      private:
+
+        static std::size_t invalid() { return static_cast<std::size_t>(-1); }
+        std::size_t mask() const { return table_.size() - 1; }
+
+        /** @brief Returns the cube of a coordinate, for tolerance zero the bit pattern of the coordinate */
+        long long cube_index(double x) const
+        {
+          if (tolerance_ > 0)
+          {
+            double cube = std::floor(x / tolerance_);
+            const double limit = 4.0e18;
+            return static_cast<long long>( std::max(-limit, std::min(limit, cube)) );
+          }
+
+          x += 0.0;   // -0.0 and 0.0 coincide
+          long long bits;
+          std::memcpy(&bits, &x, sizeof(bits));
+          return bits;
+        }
+
+        static std::size_t hash(long long const * cube)
+        {
+          unsigned long long h = 14695981039346656037ULL;
+          for (int j = 0; j < dim; ++j)
+            h = (h ^ static_cast<unsigned long long>(cube[j])) * 1099511628211ULL;
+          return static_cast<std::size_t>(h ^ (h >> 32));
+        }
+
+        bool coincide(PointT const & p1, PointT const & p2) const
+        {
+          for (int j = 0; j < dim; ++j)
+            if (std::fabs(p1[j] - p2[j]) > tolerance_)
+              return false;
+          return true;
+        }
+
+        void rehash(std::size_t size)
+        {
+          table_.assign(size, invalid());
+          for (std::size_t i = 0; i < points_.size(); ++i)
+          {
+            long long cube[dim];
+            for (int j = 0; j < dim; ++j)
+              cube[j] = cube_index(points_[i][j]);
+
+            std::size_t slot = hash(cube) & mask();
+            while (table_[slot] != invalid())
+              slot = (slot + 1) & mask();
+            table_[slot] = i;
+          }
+        }
+
+        double                    tolerance_;
+        std::vector<PointT>       points_;
+        std::vector<std::size_t>  table_;
+      };
+
+
+      /** @brief Reads the bytes of a binary data array, either raw or base64-encoded.
+       *
+       * Base64 text is decoded in groups of four characters, whitespace is skipped. VTK encodes the header and the data of an array separately,
+       * each padded to a full group, which is decoded to the concatenation of both.
+       */
+      class vtk_byte_reader
+      {
+      public:
+        vtk_byte_reader(std::istream & stream, bool base64) : stream_(stream), base64_(base64), position_(0), size_(0) {}
+
+        /** @brief Reads n bytes, returns false if the input ends before */
+        bool read(char * bytes, std::size_t n)
+        {
+          if (!base64_)
+          {
+            stream_.read(bytes, static_cast<std::streamsize>(n));
+            return static_cast<std::size_t>(stream_.gcount()) == n;
+          }
+
+          while (n > 0)
+          {
+            if (position_ == size_ && !decode_group())
+              return false;
+
+            std::size_t count = std::min(n, size_ - position_);
+            std::memcpy(bytes, buffer_ + position_, count);
+            bytes += count;
+            position_ += count;
+            n -= count;
+          }
+          return true;
+        }
+
+      private:
+
+        static int decode(int c)
+        {
+          if (c >= 'A' && c <= 'Z') return c - 'A';
+          if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+          if (c >= '0' && c <= '9') return c - '0' + 52;
+          if (c == '+') return 62;
+          if (c == '/') return 63;
+          return -1;
+        }
+
+        bool decode_group()
+        {
+          std::streambuf * buffer = stream_.rdbuf();
+          int values[4];
+          int padding = 0;
+          for (int i = 0; i < 4; )
+          {
+            int c = buffer->sbumpc();
+            if (c == std::char_traits<char>::eof() || c == '<')
+              return false;
+            if (c == '=')
+            {
+              values[i++] = 0;
+              ++padding;
+            }
+            else if (decode(c) >= 0)
+              values[i++] = decode(c);
+          }
+
+          buffer_[0] = static_cast<char>( (values[0] << 2) | (values[1] >> 4) );
+          buffer_[1] = static_cast<char>( ((values[1] & 0xF) << 4) | (values[2] >> 2) );
+          buffer_[2] = static_cast<char>( ((values[2] & 0x3) << 6) | values[3] );
+          position_ = 0;
+          size_ = 3 - std::min(padding, 2);
+          return true;
+        }
+
+        std::istream & stream_;
+        bool           base64_;
+        char           buffer_[3];
+        std::size_t    position_;
+        std::size_t    size_;
+      };
+
+
+      /** @brief Appends 'count' values of type SourceT stored in 'bytes' to 'values', swapping the byte order if requested */
+      template<typename SourceT, typename ValueT>
+      void vtk_append_values(char const * bytes, std::size_t count, bool swap, std::vector<ValueT> & values)
+      {
+        values.reserve(values.size() + count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+          char tmp[sizeof(SourceT)];
+          std::memcpy(tmp, bytes + i * sizeof(SourceT), sizeof(SourceT));
+          if (swap)
+            std::reverse(tmp, tmp + sizeof(SourceT));
+
+          SourceT value;
+          std::memcpy(&value, tmp, sizeof(SourceT));
+          values.push_back( static_cast<ValueT>(value) );
+        }
+      }
+
+      /** @brief Returns the size in bytes of a VTK data type, e.g. 'Float64', or zero for an unknown type */
+      inline std::size_t vtk_type_size(std::string const & type)
+      {
+        std::string t = string_to_lower(type);
+        if (t == "int8" || t == "uint8")                          return 1;
+        if (t == "int16" || t == "uint16")                        return 2;
+        if (t == "int32" || t == "uint32" || t == "float32")      return 4;
+        if (t == "int64" || t == "uint64" || t == "float64")      return 8;
+        return 0;
+      }
+
+      /** @brief Converts binary values of a VTK data type and appends them to 'values' */
+      template<typename ValueT>
+      void vtk_append_values(std::string const & type, char const * bytes, std::size_t size, bool swap, std::vector<ValueT> & values)
+      {
+        std::string t = string_to_lower(type);
+        std::size_t count = size / vtk_type_size(type);
+        if      (t == "int8")     vtk_append_values<signed char>(bytes, count, swap, values);
+        else if (t == "uint8")    vtk_append_values<unsigned char>(bytes, count, swap, values);
+        else if (t == "int16")    vtk_append_values<short>(bytes, count, swap, values);
+        else if (t == "uint16")   vtk_append_values<unsigned short>(bytes, count, swap, values);
+        else if (t == "int32")    vtk_append_values<int>(bytes, count, swap, values);
+        else if (t == "uint32")   vtk_append_values<unsigned int>(bytes, count, swap, values);
+        else if (t == "int64")    vtk_append_values<long long>(bytes, count, swap, values);
+        else if (t == "uint64")   vtk_append_values<unsigned long long>(bytes, count, swap, values);
+        else if (t == "float32")  vtk_append_values<float>(bytes, count, swap, values);
+        else                      vtk_append_values<double>(bytes, count, swap, values);
+      }
+
+      /** @brief Returns true if the machine stores integers with the least significant byte first */
+      inline bool vtk_host_is_little_endian()
+      {
+        unsigned int one = 1;
+        char first;
+        std::memcpy(&first, &one, 1);
+        return first == 1;
+      }
+
+      /** @brief The encoding of binary data arrays, given by the attributes of the VTKFile tag */
+      struct vtk_binary_format
+      {
+        vtk_binary_format() : header_size(4), swap(false), compressed(false) {}
+
+        std::size_t header_size;   // 4 for header_type="UInt32" (the default), 8 for "UInt64"
+        bool        swap;          // true if the byte order of the file differs from the machine
+        bool        compressed;    // true for compressor="vtkZLibDataCompressor"
+      };
+
+      /** @brief Reads an unsigned integer of the binary header of a data array */
+      inline bool vtk_read_header_value(vtk_byte_reader & bytes, vtk_binary_format const & format, unsigned long long & value)
+      {
+        char tmp[8];
+        if (!bytes.read(tmp, format.header_size))
+          return false;
+
+        std::vector<unsigned long long> values;
+        if (format.header_size == 8)
+          vtk_append_values<unsigned long long>(tmp, 1, format.swap, values);
+        else
+          vtk_append_values<unsigned int>(tmp, 1, format.swap, values);
+        value = values[0];
+        return true;
+      }
+
+      /** @brief Reads a binary data array, i.e. its header followed by the data, which is decompressed if necessary. Throws a bad_file_format_exception on errors. */
+      template<typename ValueT>
+      void vtk_read_binary_values(vtk_byte_reader & bytes, vtk_binary_format const & format, std::string const & type, std::vector<ValueT> & values)
+      {
+        if (vtk_type_size(type) == 0)
+          throw bad_file_format_exception("", "Unsupported type of binary <DataArray>: " + type);
+
+        std::vector<char> data;
+        if (!format.compressed)
+        {
+          unsigned long long size;
+          if (!vtk_read_header_value(bytes, format, size))
+            throw bad_file_format_exception("", "Binary <DataArray> ended unexpectedly!");
+          data.resize(static_cast<std::size_t>(size));
+          if (size > 0 && !bytes.read(&data[0], data.size()))
+            throw bad_file_format_exception("", "Binary <DataArray> ended unexpectedly!");
+        }
+        else
+        {
+#ifdef VIENNAGRID_WITH_ZLIB
+          // header: number of blocks, uncompressed block size, uncompressed size of the last block, compressed size of each block
+          unsigned long long block_count, block_size, last_block_size;
+          if (!vtk_read_header_value(bytes, format, block_count) || !vtk_read_header_value(bytes, format, block_size)
+              || !vtk_read_header_value(bytes, format, last_block_size))
+            throw bad_file_format_exception("", "Compressed <DataArray> ended unexpectedly!");
+
+          std::vector<unsigned long long> compressed_sizes(static_cast<std::size_t>(block_count));
+          for (std::size_t i = 0; i < compressed_sizes.size(); ++i)
+            if (!vtk_read_header_value(bytes, format, compressed_sizes[i]))
+              throw bad_file_format_exception("", "Compressed <DataArray> ended unexpectedly!");
+
+          std::vector<char> compressed;
+          for (std::size_t i = 0; i < compressed_sizes.size(); ++i)
+          {
+            uLongf size = static_cast<uLongf>( (i + 1 == compressed_sizes.size() && last_block_size > 0) ? last_block_size : block_size );
+            std::size_t offset = data.size();
+            data.resize(offset + size);
+            compressed.resize(static_cast<std::size_t>(compressed_sizes[i]));
+            if ( (compressed.size() > 0 && !bytes.read(&compressed[0], compressed.size()))
+                 || (size > 0 && uncompress(reinterpret_cast<Bytef *>(&data[offset]), &size,
+                                            reinterpret_cast<Bytef const *>(&compressed[0]), static_cast<uLong>(compressed.size())) != Z_OK) )
+              throw bad_file_format_exception("", "Compressed <DataArray> is corrupt!");
+            data.resize(offset + size);
+          }
+#else
+          throw bad_file_format_exception("", "Compressed <DataArray> found, define VIENNAGRID_WITH_ZLIB and link against zlib to read it!");
+#endif
+        }
+
+        if (!data.empty())
+          vtk_append_values(type, &data[0], data.size(), format.swap, values);
+      }
+
+      /** @brief Parses whitespace-separated ascii values and appends them to 'values' */
+      template<typename ValueT>
+      void vtk_parse_ascii_values(std::string const & text, std::vector<ValueT> & values)
+      {
+        char const * position = text.c_str();
+        while (true)
+        {
+          char * end;
+          double value = std::strtod(position, &end);
+          if (end == position)
+            break;
+          values.push_back( static_cast<ValueT>(value) );
+          position = end;
+        }
+      }
+
+      /** @brief Reads whitespace-separated ascii values up to the next '<', which is not extracted. The text is parsed in chunks, such that it is never held in memory as a whole. */
+      template<typename ValueT>
+      void vtk_read_ascii_values(std::istream & stream, std::vector<ValueT> & values)
+      {
+        std::streambuf * buffer = stream.rdbuf();
+        std::string text;
+        text.reserve(65536);
+        while (true)
+        {
+          int c = buffer->sgetc();
+          if (c == std::char_traits<char>::eof() || c == '<')
+            break;
+          buffer->sbumpc();
+          text.push_back(static_cast<char>(c));
+
+          // a chunk ends at whitespace, hence values are not split
+          if (text.size() >= 65536 && std::isspace(c))
+          {
+            vtk_parse_ascii_values(text, values);
+            text.clear();
+          }
+        }
+        vtk_parse_ascii_values(text, values);
+      }
+    }
+
+
     /** @brief A VTK reader class that allows to read meshes from XML-based VTK files as defined in http://www.vtk.org/pdf/file-formats.pdf
+     *
+     * Points of different pieces or segments which coincide up to the merge tolerance (see set_merge_tolerance()) are merged to a single vertex.
      *
      * @tparam MeshType         The type of the mesh to be read. Must not be a segment type!
      * @tparam SegmentationType   The type of the segmentation to be read, default is the default segmentation of MeshType
@@ -85,24 +481,31 @@ namespace viennagrid
       typedef std::map< std::string, base_dynamic_field<double, CellType> * >               CellScalarOutputFieldContainer;
       typedef std::map< std::string, base_dynamic_field<vector_data_type, CellType> * >     CellVectorOutputFieldContainer;
 
+      typedef std::vector<std::pair<std::string, std::vector<double> > >                   DataContainer;
 
+      static const std::size_t vertices_per_cell = boundary_elements<CellTag, vertex_tag>::num;
 
 
 
       std::ifstream                                        reader;
-      std::map<PointType, std::size_t, point_less>         global_points;
-      std::map<std::size_t, PointType>                     global_points_2;
-      std::map<int, std::deque<std::size_t> >              local_to_global_map;
-      std::map<int, std::deque<std::size_t> >              local_cell_vertices;
-      std::map<int, std::deque<std::size_t> >              local_cell_offsets;
+      detail::vtk_binary_format                            binary_format;
+      std::streampos                                       appended_data_start;   // position after the '_' of <AppendedData>, -1 if not searched yet
+      bool                                                 appended_data_base64;
+
+      double                                               merge_tolerance;
+      detail::vtk_point_merger<PointType>                  global_points;
+
+      // the staging buffers of each segment, the pieces of a segment are appended:
+      std::map<int, std::vector<std::size_t> >             local_to_global_map;   // the global vertex of each point
+      std::map<int, std::vector<std::size_t> >             local_cell_vertices;   // the global vertices of each cell in VTK order, vertices_per_cell per cell
       std::map<int, std::size_t>                           local_cell_num;
-      std::map<int, std::deque<CellHandleType> >           local_cell_handle;
+      std::map<int, std::vector<CellHandleType> >          local_cell_handle;
 
       //data containers:
-      std::map<int, std::deque<std::pair<std::string, std::deque<double> > > >  local_scalar_vertex_data;
-      std::map<int, std::deque<std::pair<std::string, std::deque<double> > > >  local_vector_vertex_data;
-      std::map<int, std::deque<std::pair<std::string, std::deque<double> > > >  local_scalar_cell_data;
-      std::map<int, std::deque<std::pair<std::string, std::deque<double> > > >  local_vector_cell_data;
+      std::map<int, DataContainer>  local_scalar_vertex_data;
+      std::map<int, DataContainer>  local_vector_vertex_data;
+      std::map<int, DataContainer>  local_scalar_cell_data;
+      std::map<int, DataContainer>  local_vector_cell_data;
 
 
       template<typename map_type>
@@ -144,6 +547,26 @@ namespace viennagrid
         registered_segment_cell_vector_data.clear();
       }
 
+      /** @brief Clears the points, cells and data read by a previous read operation */
+      void clear_staging()
+      {
+        global_points.clear(merge_tolerance);
+
+        local_to_global_map.clear();
+        local_cell_vertices.clear();
+        local_cell_num.clear();
+        local_cell_handle.clear();
+
+        local_scalar_vertex_data.clear();
+        local_vector_vertex_data.clear();
+        local_scalar_cell_data.clear();
+        local_vector_cell_data.clear();
+
+        vertex_data_scalar_read.clear();
+        vertex_data_vector_read.clear();
+        cell_data_scalar_read.clear();
+        cell_data_vector_read.clear();
+      }
 
 
 
@@ -151,11 +574,14 @@ namespace viennagrid
       /** @brief Opens a file */
       void openFile(std::string const & filename)
       {
-        reader.open(filename.c_str());
+        reader.clear();
+        reader.open(filename.c_str(), std::ios::binary);
         if(!reader)
         {
           throw cannot_open_file_exception(filename);
         }
+        binary_format = detail::vtk_binary_format();
+        appended_data_start = std::streampos(-1);
       }
 
       /** @brief Closes a file */
@@ -191,124 +617,189 @@ namespace viennagrid
         }
       }
 
-      /** @brief Reads the coordinates of the points/vertices in the mesh */
-      void readNodeCoordinates(long nodeNum, long numberOfComponents, segment_id_type seg_id)
+      /** @brief Reads the encoding of binary data from the attributes of the VTKFile tag */
+      void readBinaryFormat(xml_tag<> const & tag)
       {
-        double nodeCoord;
-        local_to_global_map[seg_id].resize(nodeNum);
+        binary_format = detail::vtk_binary_format();
+        if (tag.has_attribute("header_type"))
+          binary_format.header_size = detail::vtk_type_size(tag.get_value("header_type"));
+        if (binary_format.header_size != 4 && binary_format.header_size != 8)
+          throw bad_file_format_exception("", "Unsupported header_type " + tag.get_value("header_type"));
+
+        bool big_endian = tag.has_attribute("byte_order") && string_to_lower(tag.get_value("byte_order")) == "bigendian";
+        binary_format.swap = (big_endian == detail::vtk_host_is_little_endian());
 
-        for(long i = 0; i < nodeNum; i++)
+        if (tag.has_attribute("compressor") && !tag.get_value("compressor").empty())
         {
-          PointType p;
+          if (string_to_lower(tag.get_value("compressor")) != "vtkzlibdatacompressor")
+            throw bad_file_format_exception("", "Unsupported compressor " + tag.get_value("compressor"));
+          binary_format.compressed = true;
+        }
+      }
 
-          for(long j = 0; j < numberOfComponents; j++)
-          {
-            reader >> nodeCoord;
-            if (j < geometric_dim)
-              p[j] = nodeCoord;
-          }
+      /** @brief Finds the start of the appended data, i.e. the position after the '_' following the <AppendedData> tag */
+      void findAppendedData()
+      {
+        std::streampos position = reader.tellg();
+        reader.seekg(0, std::ios::beg);
 
-          //add point to global list if not already there
-          if (global_points.find(p) == global_points.end())
-          {
-            std::size_t new_global_id = global_points.size();
-            global_points.insert( std::make_pair(p, new_global_id) );
-            global_points_2.insert( std::make_pair(new_global_id, p) );
-            local_to_global_map[seg_id][i] = new_global_id;
-          }
-          else
+        std::string skipped;
+        xml_tag<> tag;
+        while (std::getline(reader, skipped, '<'))
+        {
+          reader.unget();
+          tag.parse(reader);
+          if (tag.name() == "appendeddata")
           {
-            local_to_global_map[seg_id][i] = global_points[p];
+            appended_data_base64 = (string_to_lower(tag.get_value("encoding")) == "base64");
+            char c = ' ';
+            while (reader.get(c) && c != '_') {}
+            appended_data_start = reader.tellg();
+            break;
           }
         }
+
+        if (appended_data_start == std::streampos(-1))
+          throw bad_file_format_exception("", "Parse error: <DataArray> refers to appended data, but no <AppendedData> found!");
+
+        reader.clear();
+        reader.seekg(position);
       }
 
-      /** @brief Reads the vertex indices of the cells inside the mesh */
-      void readCellIndices(std::size_t seg_id)
+      /** @brief Reads the values of the data array opened by 'tag' in any of the formats ascii, binary or appended, including the closing tag */
+      template<typename ValueT>
+      void readDataArray(xml_tag<> const & tag, std::vector<ValueT> & values)
       {
-        long cellNode = 0;
-        std::string token;
-        reader >> token;
+        std::string format = string_to_lower(tag.get_value("format"));
+        if (tag.is_self_closing() && format != "appended")
+          return;
 
-        while (token != "</DataArray>")
+        if (format == "appended")
         {
-          assert( strChecker::myIsNumber(token) && "Cell vertex index is not a number!" );
+          if (appended_data_start == std::streampos(-1))
+            findAppendedData();
 
-          cellNode = atoi(token.c_str());
-          local_cell_vertices[seg_id].push_back(cellNode);
+          std::streampos position = reader.tellg();
+          reader.seekg( appended_data_start + std::streamoff(atol(tag.get_value("offset").c_str())) );
 
-          reader >> token;
+          detail::vtk_byte_reader bytes(reader, appended_data_base64);
+          detail::vtk_read_binary_values(bytes, binary_format, tag.get_value("type"), values);
+
+          reader.clear();
+          reader.seekg(position);
+          if (tag.is_self_closing())
+            return;
+        }
+        else if (format == "binary")
+        {
+          detail::vtk_byte_reader bytes(reader, true);
+          detail::vtk_read_binary_values(bytes, binary_format, tag.get_value("type"), values);
+        }
+
+        if (format != "appended" && format != "binary")
+          detail::vtk_read_ascii_values(reader, values);
+        else
+        {
+          // the remainder up to the closing tag
+          reader.ignore(std::numeric_limits<std::streamsize>::max(), '<');
+          reader.unget();
         }
+
+        xml_tag<> closing_tag;
+        closing_tag.parse_and_check_name(reader, "/dataarray");
       }
 
-      /** @brief Read the cell offsets for the vertex indices */
-      void readOffsets(std::size_t seg_id)
+      /** @brief Reads the coordinates of the points/vertices in the mesh, merges them with the points read before */
+      void readNodeCoordinates(xml_tag<> const & tag, std::size_t nodeNum, segment_id_type seg_id)
       {
-          //****************************************************************************
-          // read in the offsets: describe the affiliation of the nodes to the cells
-          // (see: http://www.vtk.org/pdf/file-formats.pdf , page 9)
-          //****************************************************************************
+        tag.check_attribute("numberofcomponents", "");
+        std::size_t numberOfComponents = atoi(tag.get_value("numberofcomponents").c_str());
+
+        std::vector<double> coordinates;
+        coordinates.reserve(nodeNum * numberOfComponents);
+        readDataArray(tag, coordinates);
+        if (coordinates.size() != nodeNum * numberOfComponents)
+          throw bad_file_format_exception("", "Number of point coordinates does not match NumberOfPoints!");
+
+        std::vector<std::size_t> & local_to_global = local_to_global_map[seg_id];
+        local_to_global.reserve(local_to_global.size() + nodeNum);
+        for (std::size_t i = 0; i < nodeNum; ++i)
+        {
+          PointType p;
+          for (std::size_t j = 0; j < numberOfComponents && j < static_cast<std::size_t>(geometric_dim); ++j)
+            p[j] = coordinates[i * numberOfComponents + j];
 
-          std::string token;
-          long offset = 0;
-          reader >> token;
+          //add point to global list if not already there
+          local_to_global.push_back( global_points.insert(p) );
+        }
+      }
 
-          while(token != "</DataArray>")
-          {
-            assert( strChecker::myIsNumber(token) && "Cell offset is not a number!" );
+      /** @brief Reads the cells of a piece from its connectivity and offsets, 'point_offset' is the number of points of the segment before the piece.
+       *
+       * The connectivity is converted to global vertex indices in place and appended to the cell vertices of the segment.
+       */
+      void readCells(std::vector<std::size_t> & connectivity, std::vector<long> const & offsets, std::size_t cellNum,
+                     std::size_t point_offset, segment_id_type seg_id)
+      {
+        //****************************************************************************
+        // the offsets describe the affiliation of the nodes to the cells
+        // (see: http://www.vtk.org/pdf/file-formats.pdf , page 9)
+        //****************************************************************************
+        if (offsets.size() != cellNum || connectivity.size() != vertices_per_cell * cellNum)
+          throw bad_file_format_exception("", "Number of cells does not match NumberOfCells!");
+
+        for (std::size_t i = 0; i < cellNum; ++i)
+          if (offsets[i] != static_cast<long>(vertices_per_cell * (i + 1)))
+            throw bad_file_format_exception("", "Number of cell vertices does not match the cell type!");
+
+        std::vector<std::size_t> const & local_to_global = local_to_global_map[seg_id];
+        for (std::size_t i = 0; i < connectivity.size(); ++i)
+        {
+          std::size_t local_index = point_offset + connectivity[i];
+          if (local_index >= local_to_global.size())
+            throw bad_file_format_exception("", "Cell vertex index out of range!");
+          connectivity[i] = local_to_global[local_index];
+        }
 
-            offset = atoi(token.c_str());
-            local_cell_offsets[seg_id].push_back(offset);
+        std::vector<std::size_t> & cell_vertices = local_cell_vertices[seg_id];
+        if (cell_vertices.empty())
+          cell_vertices.swap(connectivity);
+        else
+          cell_vertices.insert(cell_vertices.end(), connectivity.begin(), connectivity.end());
 
-            //std::cout << "Vertex#: " << offset << std::endl;
-            reader >> token;
-          }
+        local_cell_num[seg_id] += cellNum;
       }
 
-      /** @brief Read the types of each cell. */
-      void readTypes()
+      /** @brief Checks the types of the cells */
+      void checkTypes(std::vector<long> const & types)
       {
-          //****************************************************************************
-          // read in the offsets: describe the affiliation of the nodes to the cells
-          // (see: http://www.vtk.org/pdf/file-formats.pdf , page 9)
-          //****************************************************************************
-
-          std::string token;
-#ifndef NDEBUG
-          long type = 0;
-#endif
-          reader >> token;
-
-          while(token != "</DataArray>")
-          {
-            assert( strChecker::myIsNumber(token) && "Cell type is not a number!" );
 #ifndef NDEBUG
-            type = atoi(token.c_str());
-            assert(type == ELEMENT_TAG_TO_VTK_TYPE<CellTag>::value && "Error in VTK reader: Type mismatch!");
+        for (std::size_t i = 0; i < types.size(); ++i)
+          assert(types[i] == ELEMENT_TAG_TO_VTK_TYPE<CellTag>::value && "Error in VTK reader: Type mismatch!");
+#else
+        (void)types;
 #endif
-            //std::cout << "Vertex#: " << offset << std::endl;
-            reader >> token;
-          }
       }
 
-      /** @brief Read data and push it to a container. Helper function. */
-      void readData(std::deque<double> & container)
+      /** @brief Returns the data array with the given name, which is created if it does not exist */
+      std::vector<double> & findOrCreateData(DataContainer & data, std::string const & name, bool & created)
       {
-        std::string token;
-        reader >> token;
-
-        while (string_to_lower(token) != "</dataarray>")
-        {
-          container.push_back( atof(token.c_str()) );
-          reader >> token;
-        }
+        created = false;
+        for (std::size_t i = 0; i < data.size(); ++i)
+          if (data[i].first == name)
+            return data[i].second;
+
+        created = true;
+        data.push_back( std::make_pair(name, std::vector<double>()) );
+        return data.back().second;
       }
 
-      /** @brief Read point or cell data and fill the respective data containers */
-      template <typename ContainerType, typename NameContainerType>
+      /** @brief Read point or cell data and fill the respective data containers. The values of a piece are appended at 'offset', the number of points or cells of the segment before the piece. */
+      template <typename NameContainerType>
       void readPointCellData(segment_id_type seg_id,
-                             ContainerType & scalar_data,
-                             ContainerType & vector_data,
+                             std::size_t offset,
+                             std::map<int, DataContainer> & scalar_data,
+                             std::map<int, DataContainer> & vector_data,
                              NameContainerType & data_names_scalar,
                              NameContainerType & data_names_vector)
       {
@@ -324,25 +815,22 @@ namespace viennagrid
           tag.check_attribute("name", "");
           name = tag.get_value("name");
 
+          components = 1;
           if (tag.has_attribute("numberofcomponents"))
             components = atoi(tag.get_value("numberofcomponents").c_str());
 
-          //now read data:
-          if (components == 1)
-          {
-            data_names_scalar.push_back(std::make_pair(seg_id, name));
-            scalar_data[seg_id].push_back( std::make_pair(name, std::deque<double>()) );
-            readData(scalar_data[seg_id].back().second);
-          }
-          else if (components == 3)
-          {
-            data_names_vector.push_back(std::make_pair(seg_id, name));
-            vector_data[seg_id].push_back( std::make_pair(name, std::deque<double>()) );
-            readData(vector_data[seg_id].back().second);
-          }
-          else
+          if (components != 1 && components != 3)
             throw bad_file_format_exception("", "Number of components for data invalid!");
 
+          //now read data:
+          bool created;
+          std::vector<double> & values = findOrCreateData( (components == 1 ? scalar_data : vector_data)[seg_id], name, created );
+          if (created)
+            (components == 1 ? data_names_scalar : data_names_vector).push_back(std::make_pair(seg_id, name));
+
+          values.resize(components * offset);
+          readDataArray(tag, values);
+
           tag.parse(reader);
         }
 
@@ -352,166 +840,171 @@ namespace viennagrid
 
       }
 
+      /** @brief Resizes the data arrays to 'count' points or cells, such that the data of the next piece is appended at the right position */
+      void resizeData(DataContainer & data, std::size_t count, std::size_t components)
+      {
+        for (std::size_t i = 0; i < data.size(); ++i)
+          data[i].second.resize(components * count);
+      }
+
+      /** @brief Skips a <FieldData> section */
+      void skipFieldData()
+      {
+        xml_tag<> tag;
+        tag.parse(reader);
+        while (tag.name() == "dataarray")
+        {
+          std::vector<double> values;
+          if (string_to_lower(tag.get_value("type")) != "string")
+            readDataArray(tag, values);
+          else if (!tag.is_self_closing())
+          {
+            std::string text;
+            std::getline(reader, text, '<');
+            reader.unget();
+            tag.parse_and_check_name(reader, "/dataarray");
+          }
+          tag.parse(reader);
+        }
+        tag.check_name("/fielddata");
+      }
+
       /////////////////////////// Routines for pushing everything to mesh ///////////////
 
       /** @brief Pushes the vertices read to the mesh */
       void setupVertices(MeshType & mesh_obj)
       {
-        for (std::size_t i=0; i<global_points_2.size(); ++i)
-          viennagrid::make_vertex_with_id( mesh_obj, typename VertexType::id_type(i), global_points_2[i] );
+        std::vector<PointType> const & points = global_points.points();
+        for (std::size_t i=0; i<points.size(); ++i)
+          viennagrid::make_vertex_with_id( mesh_obj, typename VertexType::id_type(i), points[i] );
       }
 
       /** @brief Pushes the cells read to the mesh. Preserves segment information. */
       void setupCells(MeshType & mesh_obj, SegmentationType & segmentation, segment_id_type seg_id)
       {
         //***************************************************
-        // building up the cells in ViennaGrid
-        // -------------------------------------------------
-        // "cells"   ... contain the indices of the nodes
-        // "offsets" ... contain the information about
-        //               the affiliation of the nodes
-        //               to the cells
+        // building up the cells in ViennaGrid, the vertices
+        // of each cell are stored contiguously
         //***************************************************
-        //CellType cell;
-        long numVertices = 0;
-        long offsetIdx = 0;
+        std::vector<std::size_t> const & cell_vertices = local_cell_vertices[seg_id];
+        std::vector<CellHandleType> & cell_handles = local_cell_handle[seg_id];
+        std::size_t const cell_num = local_cell_num[seg_id];
 
-        std::deque<std::size_t> const & offsets = local_cell_offsets[seg_id];
+        SegmentHandleType & segment = segmentation[seg_id];
+        VertexRange vertices(mesh_obj);
+        cell_handles.reserve(cell_num);
 
-        for (std::size_t i = 0; i < local_cell_num[seg_id]; i++)
+        vtk_to_viennagrid_orientations<CellTag> reorderer;
+        for (std::size_t i = 0; i < cell_num; i++)
         {
-          //*************************************************
-          // choose the offset index for the i-th cell
-          // in the "cells"-vector and calculate the
-          // number of vertices belonging to the i-th cell
-          //*************************************************
-          if(i == 0)
-          {
-            offsetIdx = 0;
-            numVertices = offsets[i];
-          }
-          else
-          {
-            offsetIdx = offsets[i-1];
-            numVertices = offsets[i]-offsets[i-1];
-          }
-
-
-          //****************************************************
-          // read out the node indices form the "cells"-vector
-          // and add the cells to the "vertices"-array
-          //****************************************************
-
           viennagrid::static_array<VertexHandleType, boundary_elements<CellTag, vertex_tag>::num> cell_vertex_handles;
 
-          vtk_to_viennagrid_orientations<CellTag> reorderer;
-          for (long j = 0; j < numVertices; j++)
+          for (std::size_t j = 0; j < vertices_per_cell; j++)
           {
-            long reordered_j = reorderer(j);
-            std::size_t local_index = local_cell_vertices[seg_id][reordered_j + offsetIdx];
-            std::size_t global_vertex_index = local_to_global_map[seg_id][local_index];
+            std::size_t global_vertex_index = cell_vertices[i * vertices_per_cell + reorderer(static_cast<long>(j))];
 
-            cell_vertex_handles[j] = viennagrid::elements<viennagrid::vertex_tag>(mesh_obj).handle_at(global_vertex_index);
-            viennagrid::add( segmentation[seg_id], viennagrid::dereference_handle(segmentation, cell_vertex_handles[j]) );
+            cell_vertex_handles[j] = vertices.handle_at(global_vertex_index);
+            viennagrid::add( segment, viennagrid::dereference_handle(segmentation, cell_vertex_handles[j]) );
           }
 
-          local_cell_handle[seg_id].push_back(
-            viennagrid::make_element<CellType>(segmentation[seg_id], cell_vertex_handles.begin(), cell_vertex_handles.end())//, typename CellType::id_type(i));//, );
-                                    );
+          cell_handles.push_back( viennagrid::make_element<CellType>(segment, cell_vertex_handles.begin(), cell_vertex_handles.end()) );
         }
       }
 
+      /** @brief Assigns scalar data of each point or cell of a segment to an output field, 'element' returns the vertex or cell of an index */
+      template <typename ElementT, typename ElementFunctorT>
+      void assignData(base_dynamic_field<double, ElementT> & field, std::vector<double> const & values, std::size_t count, ElementFunctorT const & element)
+      {
+        for (std::size_t i=0; i<count; ++i)
+          field(element(i)) = values[i];
+      }
+
+      /** @brief Assigns vector data of each point or cell of a segment to an output field, 'element' returns the vertex or cell of an index */
+      template <typename ElementT, typename ElementFunctorT>
+      void assignData(base_dynamic_field<vector_data_type, ElementT> & field, std::vector<double> const & values, std::size_t count, ElementFunctorT const & element)
+      {
+        for (std::size_t i=0; i<count; ++i)
+          field(element(i)).assign(values.begin() + 3*i, values.begin() + 3*i + 3);
+      }
+
+      /** @brief Returns the vertex of a point of a segment */
+      struct vertex_of_point
+      {
+        vertex_of_point(VertexRange const & vertices, std::vector<std::size_t> const & local_to_global) : vertices_(vertices), local_to_global_(local_to_global) {}
+
+        VertexType const & operator()(std::size_t i) const { return vertices_[local_to_global_[i]]; }
+
+        VertexRange const & vertices_;
+        std::vector<std::size_t> const & local_to_global_;
+      };
+
+      /** @brief Returns the cell of a segment with a given index */
+      struct cell_of_index
+      {
+        cell_of_index(SegmentHandleType const & segment, std::vector<CellHandleType> const & cell_handles) : segment_(segment), cell_handles_(cell_handles) {}
+
+        CellType const & operator()(std::size_t i) const { return viennagrid::dereference_handle(segment_, cell_handles_[i]); }
+
+        SegmentHandleType const & segment_;
+        std::vector<CellHandleType> const & cell_handles_;
+      };
+
       /** @brief Writes data for vertices to the ViennaGrid mesh using ViennaData */
       template <typename ContainerType>
-      void setupDataVertex(MeshType & mesh_obj, SegmentHandleType & segment, segment_id_type seg_id, ContainerType const & container, std::size_t num_components)
+      void setupDataVertex(MeshType & mesh_obj, SegmentHandleType &, segment_id_type seg_id, ContainerType const & container, std::size_t num_components)
       {
         std::string const & name = container.first;
+        std::vector<std::size_t> const & local_to_global = local_to_global_map[seg_id];
+        std::size_t const count = container.second.size() / num_components;
+
+        VertexRange vertices(mesh_obj);
+        vertex_of_point element(vertices, local_to_global);
 
         if (num_components == 1)
         {
           VertexScalarOutputFieldContainer & current_registered_segment_vertex_scalar_data = registered_segment_vertex_scalar_data[seg_id];
-          if (registered_vertex_scalar_data.find(name) != registered_vertex_scalar_data.end())
-          {
-            for (std::size_t i=0; i<container.second.size(); ++i)
-            {
-              std::size_t global_vertex_id = local_to_global_map[seg_id][i];
-              VertexType const & vertex = viennagrid::elements<viennagrid::vertex_tag>(mesh_obj)[global_vertex_id];
-
-              (*registered_vertex_scalar_data[name])(vertex) = (container.second)[i];
-            }
-          }
-          else if (current_registered_segment_vertex_scalar_data.find(name) != current_registered_segment_vertex_scalar_data.end())
-          {
-            for (std::size_t i=0; i<container.second.size(); ++i)
-            {
-              std::size_t global_vertex_id = local_to_global_map[seg_id][i];
-              VertexType const & vertex = viennagrid::elements<viennagrid::vertex_tag>(mesh_obj)[global_vertex_id];
-
-              (*current_registered_segment_vertex_scalar_data[name])(vertex) = (container.second)[i];
-            }
-          }
+          typename VertexScalarOutputFieldContainer::iterator it = registered_vertex_scalar_data.find(name);
+          typename VertexScalarOutputFieldContainer::iterator jt = current_registered_segment_vertex_scalar_data.find(name);
+          if (it != registered_vertex_scalar_data.end())
+            assignData(*it->second, container.second, count, element);
+          else if (jt != current_registered_segment_vertex_scalar_data.end())
+            assignData(*jt->second, container.second, count, element);
           else
           {
             #if defined VIENNAGRID_DEBUG_ALL || defined VIENNAGRID_DEBUG_IO
             std::cout << "* vtk_reader::operator(): Reading scalar quantity "
                       << container.first << " to vertices." << std::endl;
             #endif
-            for (std::size_t i=0; i<container.second.size(); ++i)
+            std::deque<double> & data = vertex_scalar_data[container.first][seg_id];
+            for (std::size_t i=0; i<count; ++i)
             {
-              std::size_t global_vertex_id = local_to_global_map[seg_id][i];
-              VertexType const & vertex = viennagrid::elements<viennagrid::vertex_tag>(mesh_obj)[global_vertex_id];
-
-              if ( static_cast<typename VertexType::id_type::base_id_type>(vertex_scalar_data[container.first][seg_id].size()) <= vertex.id().get()) vertex_scalar_data[container.first][seg_id].resize(vertex.id().get()+1);
-              vertex_scalar_data[container.first][seg_id][vertex.id().get()] = (container.second)[i];
+              VertexType const & vertex = element(i);
+              if ( static_cast<typename VertexType::id_type::base_id_type>(data.size()) <= vertex.id().get()) data.resize(vertex.id().get()+1);
+              data[vertex.id().get()] = (container.second)[i];
             }
           }
         }
         else
         {
           VertexVectorOutputFieldContainer & current_registered_segment_vertex_vector_data = registered_segment_vertex_vector_data[seg_id];
-          if (registered_vertex_vector_data.find(name) != registered_vertex_vector_data.end())
-          {
-            for (std::size_t i=0; i<container.second.size()/3; ++i)
-            {
-              std::size_t global_vertex_id = local_to_global_map[seg_id][i];
-              VertexType const & vertex = viennagrid::elements<viennagrid::vertex_tag>(mesh_obj)[global_vertex_id];
-
-              (*registered_vertex_vector_data[name])(vertex).resize(3);
-              (*registered_vertex_vector_data[name])(vertex)[0] = (container.second)[3*i+0];
-              (*registered_vertex_vector_data[name])(vertex)[1] = (container.second)[3*i+1];
-              (*registered_vertex_vector_data[name])(vertex)[2] = (container.second)[3*i+2];
-            }
-          }
-          else if (current_registered_segment_vertex_vector_data.find(name) != current_registered_segment_vertex_vector_data.end())
-          {
-            for (std::size_t i=0; i<container.second.size(); ++i)
-            {
-              std::size_t global_vertex_id = local_to_global_map[seg_id][i];
-              VertexType const & vertex = viennagrid::elements<viennagrid::vertex_tag>(mesh_obj)[global_vertex_id];
-
-              (*current_registered_segment_vertex_vector_data[name])(vertex).resize(3);
-              (*current_registered_segment_vertex_vector_data[name])(vertex)[0] = (container.second)[3*i+0];
-              (*current_registered_segment_vertex_vector_data[name])(vertex)[1] = (container.second)[3*i+1];
-              (*current_registered_segment_vertex_vector_data[name])(vertex)[2] = (container.second)[3*i+2];
-            }
-          }
+          typename VertexVectorOutputFieldContainer::iterator it = registered_vertex_vector_data.find(name);
+          typename VertexVectorOutputFieldContainer::iterator jt = current_registered_segment_vertex_vector_data.find(name);
+          if (it != registered_vertex_vector_data.end())
+            assignData(*it->second, container.second, count, element);
+          else if (jt != current_registered_segment_vertex_vector_data.end())
+            assignData(*jt->second, container.second, count, element);
           else
           {
             #if defined VIENNAGRID_DEBUG_ALL || defined VIENNAGRID_DEBUG_IO
             std::cout << "* vtk_reader::operator(): Reading vector quantity "
                       << container.first << " to vertices." << std::endl;
             #endif
-            assert( 3 * viennagrid::elements<viennagrid::vertex_tag>(segment).size() == container.second.size());
-            for (std::size_t i=0; i<container.second.size() / 3; ++i)
+            std::deque<vector_data_type> & data = vertex_vector_data[container.first][seg_id];
+            for (std::size_t i=0; i<count; ++i)
             {
-              std::size_t global_vertex_id = local_to_global_map[seg_id][i];
-              VertexType const & vertex = viennagrid::elements<viennagrid::vertex_tag>(mesh_obj)[global_vertex_id];
-
-              if ( static_cast<typename VertexType::id_type::base_id_type>(vertex_vector_data[container.first][seg_id].size()) <= vertex.id().get()) vertex_vector_data[container.first][seg_id].resize(vertex.id().get()+1);
-              vertex_vector_data[container.first][seg_id][vertex.id().get()].resize(3);
-              vertex_vector_data[container.first][seg_id][vertex.id().get()][0] = (container.second)[3*i+0];
-              vertex_vector_data[container.first][seg_id][vertex.id().get()][1] = (container.second)[3*i+1];
-              vertex_vector_data[container.first][seg_id][vertex.id().get()][2] = (container.second)[3*i+2];
+              VertexType const & vertex = element(i);
+              if ( static_cast<typename VertexType::id_type::base_id_type>(data.size()) <= vertex.id().get()) data.resize(vertex.id().get()+1);
+              data[vertex.id().get()].assign(container.second.begin() + 3*i, container.second.begin() + 3*i + 3);
             }
           }
         }
@@ -522,86 +1015,55 @@ namespace viennagrid
       void setupDataCell(MeshType &, SegmentHandleType & segment, segment_id_type seg_id, ContainerType const & container, std::size_t num_components)
       {
         std::string const & name = container.first;
+        std::size_t const count = container.second.size() / num_components;
+
+        cell_of_index element(segment, local_cell_handle[seg_id]);
 
         if (num_components == 1)
         {
           CellScalarOutputFieldContainer & current_registered_segment_cell_scalar_data = registered_segment_cell_scalar_data[seg_id];
-          if (registered_cell_scalar_data.find(name) != registered_cell_scalar_data.end())
-          {
-            for (std::size_t i=0; i<container.second.size(); ++i)
-            {
-              CellType const & cell = viennagrid::dereference_handle( segment, local_cell_handle[seg_id][i] );
-
-              (*registered_cell_scalar_data[name])(cell) = (container.second)[i];
-            }
-          }
-          else if (current_registered_segment_cell_scalar_data.find(name) != current_registered_segment_cell_scalar_data.end())
-          {
-            for (std::size_t i=0; i<container.second.size(); ++i)
-            {
-              CellType const & cell = viennagrid::dereference_handle( segment, local_cell_handle[seg_id][i] );
-
-              (*current_registered_segment_cell_scalar_data[name])(cell) = (container.second)[i];
-            }
-          }
+          typename CellScalarOutputFieldContainer::iterator it = registered_cell_scalar_data.find(name);
+          typename CellScalarOutputFieldContainer::iterator jt = current_registered_segment_cell_scalar_data.find(name);
+          if (it != registered_cell_scalar_data.end())
+            assignData(*it->second, container.second, count, element);
+          else if (jt != current_registered_segment_cell_scalar_data.end())
+            assignData(*jt->second, container.second, count, element);
           else
           {
             #if defined VIENNAGRID_DEBUG_ALL || defined VIENNAGRID_DEBUG_IO
             std::cout << "* vtk_reader::operator(): Reading scalar quantity "
-                      << container.first << " to vertices." << std::endl;
+                      << container.first << " to cells." << std::endl;
             #endif
-            for (std::size_t i=0; i<container.second.size(); ++i)
+            std::deque<double> & data = cell_scalar_data[container.first][seg_id];
+            for (std::size_t i=0; i<count; ++i)
             {
-              CellType const & cell = viennagrid::dereference_handle( segment, local_cell_handle[seg_id][i] );
-
-              if ( static_cast<typename CellType::id_type::base_id_type>(cell_scalar_data[container.first][seg_id].size()) <= cell.id().get()) cell_scalar_data[container.first][seg_id].resize(cell.id().get()+1);
-              cell_scalar_data[container.first][seg_id][cell.id().get()] = (container.second)[i];
+              CellType const & cell = element(i);
+              if ( static_cast<typename CellType::id_type::base_id_type>(data.size()) <= cell.id().get()) data.resize(cell.id().get()+1);
+              data[cell.id().get()] = (container.second)[i];
             }
           }
         }
         else
         {
           CellVectorOutputFieldContainer & current_registered_segment_cell_vector_data = registered_segment_cell_vector_data[seg_id];
-          if (registered_cell_vector_data.find(name) != registered_cell_vector_data.end())
-          {
-            for (std::size_t i=0; i<container.second.size()/3; ++i)
-            {
-              CellType const & cell = viennagrid::dereference_handle( segment, local_cell_handle[seg_id][i] );
-
-              (*registered_cell_vector_data[name])(cell).resize(3);
-              (*registered_cell_vector_data[name])(cell)[0] = (container.second)[3*i+0];
-              (*registered_cell_vector_data[name])(cell)[1] = (container.second)[3*i+1];
-              (*registered_cell_vector_data[name])(cell)[2] = (container.second)[3*i+2];
-            }
-          }
-          else if (current_registered_segment_cell_vector_data.find(name) != current_registered_segment_cell_vector_data.end())
-          {
-            for (std::size_t i=0; i<container.second.size(); ++i)
-            {
-              CellType const & cell = viennagrid::dereference_handle( segment, local_cell_handle[seg_id][i] );
-
-              (*current_registered_segment_cell_vector_data[name])(cell).resize(3);
-              (*current_registered_segment_cell_vector_data[name])(cell)[0] = (container.second)[3*i+0];
-              (*current_registered_segment_cell_vector_data[name])(cell)[1] = (container.second)[3*i+1];
-              (*current_registered_segment_cell_vector_data[name])(cell)[2] = (container.second)[3*i+2];
-            }
-          }
+          typename CellVectorOutputFieldContainer::iterator it = registered_cell_vector_data.find(name);
+          typename CellVectorOutputFieldContainer::iterator jt = current_registered_segment_cell_vector_data.find(name);
+          if (it != registered_cell_vector_data.end())
+            assignData(*it->second, container.second, count, element);
+          else if (jt != current_registered_segment_cell_vector_data.end())
+            assignData(*jt->second, container.second, count, element);
           else
           {
             #if defined VIENNAGRID_DEBUG_ALL || defined VIENNAGRID_DEBUG_IO
             std::cout << "* vtk_reader::operator(): Reading vector quantity "
-                      << container.first << " to vertices." << std::endl;
+                      << container.first << " to cells." << std::endl;
             #endif
-            assert( 3 * viennagrid::elements<CellTag>(segment).size() == container.second.size());
-            for (std::size_t i=0; i<container.second.size() / 3; ++i)
+            std::deque<vector_data_type> & data = cell_vector_data[container.first][seg_id];
+            for (std::size_t i=0; i<count; ++i)
             {
-              CellType const & cell = viennagrid::dereference_handle( segment, local_cell_handle[seg_id][i] );
-
-              if ( static_cast<typename CellType::id_type::base_id_type>(cell_vector_data[container.first][seg_id].size()) <= cell.id().get()) cell_vector_data[container.first][seg_id].resize(cell.id().get()+1);
-              cell_vector_data[container.first][seg_id][cell.id().get()].resize(3);
-              cell_vector_data[container.first][seg_id][cell.id().get()][0] = (container.second)[3*i+0];
-              cell_vector_data[container.first][seg_id][cell.id().get()][1] = (container.second)[3*i+1];
-              cell_vector_data[container.first][seg_id][cell.id().get()][2] = (container.second)[3*i+2];
+              CellType const & cell = element(i);
+              if ( static_cast<typename CellType::id_type::base_id_type>(data.size()) <= cell.id().get()) data.resize(cell.id().get()+1);
+              data[cell.id().get()].assign(container.second.begin() + 3*i, container.second.begin() + 3*i + 3);
             }
           }
         }
@@ -633,7 +1095,92 @@ namespace viennagrid
 
       }
 
-      /** @brief Parses a .vtu file referring to a segment of the mesh */
+      /** @brief Parses a <Piece> of an unstructured grid, its points, cells and data are appended to the segment */
+      void parse_piece(xml_tag<> const & piece_tag, segment_id_type seg_id, std::string const & filename)
+      {
+        piece_tag.check_attribute("numberofpoints", filename);
+        std::size_t nodeNum = atoi(piece_tag.get_value("numberofpoints").c_str());
+        #ifdef VIENNAGRID_DEBUG_IO
+        std::cout << "#Nodes: " << nodeNum << std::endl;
+        #endif
+
+        piece_tag.check_attribute("numberofcells", filename);
+        std::size_t cellNum = atoi(piece_tag.get_value("numberofcells").c_str());
+        #ifdef VIENNAGRID_DEBUG_IO
+        std::cout << "#Cells: " << cellNum << std::endl;
+        #endif
+
+        std::size_t point_offset = local_to_global_map[seg_id].size();
+        std::size_t cell_offset  = local_cell_num[seg_id];
+
+        std::vector<std::size_t> connectivity;
+        std::vector<long> offsets;
+        std::vector<long> types;
+        bool has_points = false;
+
+        // the sections of a piece may appear in any order, e.g. ParaView writes the data first
+        xml_tag<> tag;
+        tag.parse(reader);
+        while (tag.name() != "/piece")
+        {
+          if (tag.name() == "points")
+          {
+            tag.parse_and_check_name(reader, "dataarray", filename);
+            readNodeCoordinates(tag, nodeNum, seg_id);
+            tag.parse_and_check_name(reader, "/points", filename);
+            has_points = true;
+          }
+          else if (tag.name() == "cells")
+          {
+            tag.parse(reader);
+            while (tag.name() == "dataarray")
+            {
+              tag.check_attribute("name", filename);
+
+              if (tag.get_value("name") == "connectivity")
+                readDataArray(tag, connectivity);
+              else if (tag.get_value("name") == "offsets")
+                readDataArray(tag, offsets);
+              else if (tag.get_value("name") == "types")
+                readDataArray(tag, types);
+              else
+                throw bad_file_format_exception(filename, "Parse error: <DataArray> is not named 'connectivity', 'offsets' or 'types'!");
+
+              tag.parse(reader);
+            }
+            tag.check_name("/cells", filename);
+          }
+          else if (tag.name() == "pointdata")
+          {
+            if (!tag.is_self_closing())
+              readPointCellData(seg_id, point_offset, local_scalar_vertex_data, local_vector_vertex_data,
+                                vertex_data_scalar_read, vertex_data_vector_read);
+          }
+          else if (tag.name() == "celldata")
+          {
+            if (!tag.is_self_closing())
+              readPointCellData(seg_id, cell_offset, local_scalar_cell_data, local_vector_cell_data,
+                                cell_data_scalar_read, cell_data_vector_read);
+          }
+          else
+            throw bad_file_format_exception(filename, "Parse error: Expected <Points>, <Cells>, <PointData>, <CellData> or </Piece> tag!");
+
+          tag.parse(reader);
+        }
+
+        if (!has_points)
+          throw bad_file_format_exception(filename, "Parse error: <Piece> without <Points>!");
+
+        checkTypes(types);
+        readCells(connectivity, offsets, cellNum, point_offset, seg_id);
+
+        resizeData(local_scalar_vertex_data[seg_id], point_offset + nodeNum, 1);
+        resizeData(local_vector_vertex_data[seg_id], point_offset + nodeNum, 3);
+        resizeData(local_scalar_cell_data[seg_id], cell_offset + cellNum, 1);
+        resizeData(local_vector_cell_data[seg_id], cell_offset + cellNum, 3);
+      }
+
+      /** @brief Parses a .vtu file referring to a segment of the mesh, all pieces of the file are added to the segment */
       void parse_vtu_segment(std::string filename, segment_id_type seg_id)
       {
 
@@ -641,9 +1188,6 @@ namespace viennagrid
         {
           openFile(filename);
 
-          long nodeNum = 0;
-          long numberOfComponents = 0;
-
           xml_tag<> tag;
 
           tag.parse(reader);
@@ -651,87 +1195,39 @@ namespace viennagrid
             throw bad_file_format_exception(filename, "Parse error: No opening ?xml tag!");
 
           tag.parse_and_check_name(reader, "vtkfile", filename);
-          tag.parse_and_check_name(reader, "unstructuredgrid", filename);
-
-          tag.parse_and_check_name(reader, "piece", filename);
-
-          tag.check_attribute("numberofpoints", filename);
+          readBinaryFormat(tag);
 
-          nodeNum = atoi(tag.get_value("numberofpoints").c_str());
-          #ifdef VIENNAGRID_DEBUG_IO
-          std::cout << "#Nodes: " << nodeNum << std::endl;
-          #endif
-
-          tag.check_attribute("numberofcells", filename);
-
-          local_cell_num[seg_id] = atoi(tag.get_value("numberofcells").c_str());
-          #ifdef VIENNAGRID_DEBUG_IO
-          std::cout << "#Cells: " << local_cell_num[seg_id] << std::endl;
-          #endif
-
-          tag.parse_and_check_name(reader, "points", filename);
-
-          tag.parse_and_check_name(reader, "dataarray", filename);
-          tag.check_attribute("numberofcomponents", filename);
-
-          numberOfComponents = atoi(tag.get_value("numberofcomponents").c_str());
-          readNodeCoordinates(nodeNum, numberOfComponents, seg_id);
-
-          tag.parse_and_check_name(reader, "/dataarray", filename);
-          tag.parse_and_check_name(reader, "/points", filename);
+          tag.parse_and_check_name(reader, "unstructuredgrid", filename);
 
           tag.parse(reader);
-          if (tag.name() == "pointdata")
-          {
-             readPointCellData(seg_id, local_scalar_vertex_data, local_vector_vertex_data,
-                                      vertex_data_scalar_read, vertex_data_vector_read);
-            tag.parse(reader);
-          }
-
-          if (tag.name() != "cells")
-            throw bad_file_format_exception(filename, "Parse error: Expected Cells tag!");
-
-          for (std::size_t i=0; i<3; ++i)
+          while (tag.name() != "/unstructuredgrid")
           {
-            tag.parse_and_check_name(reader, "dataarray", filename);
-            tag.check_attribute("name", filename);
-
-            if (tag.get_value("name") == "connectivity")
-              readCellIndices(seg_id);
-            else if (tag.get_value("name") == "offsets")
-              readOffsets(seg_id);
-            else if (tag.get_value("name") == "types")
-              readTypes();
+            if (tag.name() == "piece")
+              parse_piece(tag, seg_id, filename);
+            else if (tag.name() == "fielddata")
+              skipFieldData();
             else
-              throw bad_file_format_exception(filename, "Parse error: <DataArray> is not named 'connectivity', 'offsets' or 'types'!");
-          }
-
-          tag.parse_and_check_name(reader, "/cells", filename);
+              throw bad_file_format_exception(filename, "Parse error: Expected <Piece> tag!");
 
-          tag.parse(reader);
-          if (tag.name() == "celldata")
-          {
-            readPointCellData(seg_id, local_scalar_cell_data, local_vector_cell_data,
-                                      cell_data_scalar_read, cell_data_vector_read);
             tag.parse(reader);
           }
 
-
-          if (tag.name() != "/piece")
-            throw bad_file_format_exception(filename, "Parse error: Expected </Piece> tag!");
-
-          tag.parse_and_check_name(reader, "/unstructuredgrid", filename);
-          tag.parse_and_check_name(reader, "/vtkfile", filename);
+          // the appended data follows the grid, it is read with the data arrays referring to it
+          tag.parse(reader);
+          if (tag.name() != "/vtkfile" && tag.name() != "appendeddata")
+            throw bad_file_format_exception(filename, "Parse error: Expected </VTKFile> tag!");
 
           closeFile();
         }
         catch (std::exception const & ex) {
           std::cerr << "Problems while reading file " << filename << std::endl;
           std::cerr << "what(): " << ex.what() << std::endl;
+          closeFile();
         }
 
       }
 
+
       /** @brief Processes a .vtu file that represents a full mesh */
       void process_vtu(std::string const & filename)
       {
@@ -819,8 +1315,16 @@ namespace viennagrid
     public:
 
 
+      vtk_reader() : appended_data_start(-1), appended_data_base64(false), merge_tolerance(0.0) {}
+
       ~vtk_reader() { clear(); }
 
+      /** @brief Sets the tolerance up to which the coordinates of points are considered equal, such that the points are merged to a single vertex. The default is zero, i.e. only identical points are merged. */
+      void set_merge_tolerance(double tolerance) { merge_tolerance = tolerance; }
+
+      /** @brief Returns the tolerance up to which the coordinates of points are considered equal */
+      double get_merge_tolerance() const { return merge_tolerance; }
+
 
       /** @brief Triggers the read process.
        *
@@ -833,6 +1337,8 @@ namespace viennagrid
         std::string::size_type pos  = filename.rfind(".")+1;
         std::string extension = filename.substr(pos, filename.size());
 
+        clear_staging();
+
         if(extension == "vtu")
         {
           process_vtu(filename);
@@ -854,6 +1360,12 @@ namespace viennagrid
         // push everything to the ViennaGrid mesh:
         //
         setupVertices(mesh_obj);
+
+        std::size_t cell_count = 0;
+        for (std::map<int, std::size_t>::iterator it = local_cell_num.begin(); it != local_cell_num.end(); ++it)
+          cell_count += it->second;
+        if (cell_count > 0)
+          viennagrid::reserve_boundary_elements( mesh_obj, cell_count );
 //         for (size_t seg_id = 0; seg_id < local_cell_num.size(); ++seg_id)
         for (std::map<int, std::size_t>::iterator it = local_cell_num.begin(); it != local_cell_num.end(); ++it)
         {
@@ -892,7 +1404,7 @@ namespace viennagrid
       {
         std::vector<std::string> ret;
 
-        std::map<int, std::deque<std::pair<std::string, std::deque<double> > > >::const_iterator it = local_scalar_vertex_data.find(segment_id);
+        typename std::map<int, DataContainer>::const_iterator it = local_scalar_vertex_data.find(segment_id);
         if (it == local_scalar_vertex_data.end())
           return ret;
 
@@ -907,7 +1419,7 @@ namespace viennagrid
       {
         std::vector<std::string> ret;
 
-        std::map<int, std::deque<std::pair<std::string, std::deque<double> > > >::const_iterator it = local_vector_vertex_data.find(segment_id);
+        typename std::map<int, DataContainer>::const_iterator it = local_vector_vertex_data.find(segment_id);
         if (it == local_vector_vertex_data.end())
           return ret;
 
@@ -922,7 +1434,7 @@ namespace viennagrid
       {
         std::vector<std::string> ret;
 
-        std::map<int, std::deque<std::pair<std::string, std::deque<double> > > >::const_iterator it = local_scalar_cell_data.find(segment_id);
+        typename std::map<int, DataContainer>::const_iterator it = local_scalar_cell_data.find(segment_id);
         if (it == local_scalar_cell_data.end())
           return ret;
 
@@ -937,7 +1449,7 @@ namespace viennagrid
       {
         std::vector<std::string> ret;
 
-        std::map<int, std::deque<std::pair<std::string, std::deque<double> > > >::const_iterator it = local_vector_cell_data.find(segment_id);
+        typename std::map<int, DataContainer>::const_iterator it = local_vector_cell_data.find(segment_id);
         if (it == local_vector_cell_data.end())
           return ret;
 
@@ -76,6 +76,8 @@ namespace viennagrid
 
     public:
 
+      xml_tag() : self_closing_(false) {}
+
       /** @brief Triggers the parsing of a XML tag */
       template <typename InputStream>
       void parse(InputStream & reader)
@@ -99,6 +101,13 @@ namespace viennagrid
         //strip whitespace or closing tag at the end
         name_.resize(name_.size()-1);
 
+        //an empty-element tag without attributes, e.g. <PointData/>
+        if (c == '>' && name_.size() > 0 && name_[name_.size()-1] == '/')
+        {
+          name_.resize(name_.size()-1);
+          self_closing_ = true;
+        }
+
         #ifdef VIENNAGRID_DEBUG_IO
         std::cout << name_ << std::endl;
         #endif
@@ -128,6 +137,10 @@ namespace viennagrid
           else if (c != ' ')
             token.append(1, make_lower(c));
 
+          //an empty-element tag with attributes, e.g. <DataArray ... />
+          if (!inside_string && c == '>')
+            self_closing_ = (token == "/>");
+
 
           if (end_of_attribute)
           {
@@ -189,6 +202,9 @@ namespace viennagrid
       /** @brief Returns the XML tag name */
       std::string name() const { return name_; }
 
+      /** @brief Returns true if the XML tag is an empty-element tag such as <DataArray ... />, which has no content and no closing tag */
+      bool is_self_closing() const { return self_closing_; }
+
       /** @brief Returns true if the XML tag has a certain attribute */
       bool has_attribute(std::string const & attrib_name) const
       {
@@ -232,6 +248,7 @@ namespace viennagrid
       {
         name_ = std::string();
         attributes_.clear();
+        self_closing_ = false;
       }
     private:
 
@@ -245,6 +262,7 @@ namespace viennagrid
 
       std::string name_;
       AttributeContainer attributes_;
+      bool self_closing_;
     };
 
 
@@ -0,0 +1,303 @@
+#ifndef VIENNAGRID_MESH_COMPACT_MESH_HPP
+#define VIENNAGRID_MESH_COMPACT_MESH_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#include <vector>
+#include "viennagrid/forwards.hpp"
+#include "viennagrid/mesh/mesh.hpp"
+#include "viennagrid/mesh/segmentation.hpp"
+#include "viennagrid/algorithm/spanned_volume.hpp"
+
+/** @file viennagrid/mesh/compact_mesh.hpp
+    @brief Provides an immutable, array-based snapshot of a mesh for read-only traversals, e.g. by a simulator
+*/
+
+namespace viennagrid
+{
+
+  /** @brief An immutable snapshot of the vertices, cells, facets and edges of a mesh, stored in flat arrays.
+    *
+    * The coordinates are stored as one array per geometric dimension (structure of arrays), the connectivity as arrays of 32-bit indices
+    * with a fixed number of entries per element. The vertices and cells are numbered in the order of the element ranges of the mesh,
+    * facets and edges in the order of their ranges as well. There are no handles, no IDs and no appendices per element.
+    *
+    * The snapshot does not reference the mesh after construction, later modifications of the mesh are not reflected.
+    * The point type is the one of the mesh, hence all ViennaGrid algorithms on points (e.g. spanned_volume(), norm(), inner_prod()) apply to point().
+    *
+    * @tparam MeshT   The mesh type from which the snapshot is taken. Its cells must provide facets and lines, e.g. triangles or tetrahedra.
+    * @tparam IndexT  The signed integer type of the indices
+    */
+  template<typename MeshT, typename IndexT = int>
+  class compact_mesh
+  {
+  public:
+    typedef MeshT                                                                     mesh_type;
+    typedef IndexT                                                                    index_type;
+    typedef std::size_t                                                               size_type;
+
+    typedef typename viennagrid::result_of::point<MeshT>::type                        point_type;
+    typedef typename viennagrid::result_of::coord<point_type>::type                   coord_type;
+    typedef typename viennagrid::result_of::cell_tag<MeshT>::type                     cell_tag;
+    typedef typename cell_tag::facet_tag                                              facet_tag;
+
+    static const int geometric_dimension = viennagrid::result_of::static_size<point_type>::value;
+    static const int vertices_per_cell   = boundary_elements<cell_tag, vertex_tag>::num;
+    static const int facets_per_cell     = boundary_elements<cell_tag, facet_tag>::num;
+    static const int edges_per_cell      = boundary_elements<cell_tag, line_tag>::num;
+    static const int vertices_per_facet  = boundary_elements<facet_tag, vertex_tag>::num;
+
+    /** @brief Returned by facet_cells() for the missing second cell of a boundary facet and by cell_segment() for cells without segment */
+    static index_type invalid_index() { return -1; }
+
+    /** @brief Takes the snapshot of a mesh */
+    explicit compact_mesh(MeshT const & mesh_obj) { assign(mesh_obj); }
+
+    /** @brief Takes the snapshot of a mesh and records the segment of each cell, see cell_segment() */
+    template<typename SegmentationT>
+    compact_mesh(MeshT const & mesh_obj, SegmentationT const & segmentation)
+    {
+      assign(mesh_obj);
+      assign_segments(segmentation);
+    }
+
+    size_type vertex_count() const { return coordinates_[0].size(); }
+    size_type cell_count()   const { return cell_vertices_.size() / vertices_per_cell; }
+    size_type facet_count()  const { return facet_cells_.size() / 2; }
+    size_type edge_count()   const { return edge_vertices_.size() / 2; }
+
+    /** @brief Returns the array of the coordinates of all vertices in the given dimension, NULL for a mesh without vertices */
+    coord_type const * coordinates(int dimension) const { return coordinates_[dimension].empty() ? NULL : &coordinates_[dimension][0]; }
+
+    /** @brief Assembles the point of a vertex from the coordinate arrays */
+    point_type point(index_type vertex) const
+    {
+      point_type p;
+      for (int d = 0; d < geometric_dimension; ++d)
+        p[d] = coordinates_[d][vertex];
+      return p;
+    }
+
+    /** @brief Returns the 'vertices_per_cell' vertex indices of a cell, in the order of the cell's vertex range */
+    index_type const * cell_vertices(index_type cell) const { return &cell_vertices_[vertices_per_cell * cell]; }
+
+    /** @brief Returns the 'facets_per_cell' facet indices of a cell */
+    index_type const * cell_facets(index_type cell) const { return &cell_facets_[facets_per_cell * cell]; }
+
+    /** @brief Returns the 'edges_per_cell' edge indices of a cell */
+    index_type const * cell_edges(index_type cell) const { return &cell_edges_[edges_per_cell * cell]; }
+
+    /** @brief Returns the 'vertices_per_facet' vertex indices of a facet */
+    index_type const * facet_vertices(index_type facet) const { return &facet_vertices_[vertices_per_facet * facet]; }
+
+    /** @brief Returns the two cells sharing a facet. The second one is invalid_index() for facets on the boundary of the mesh. */
+    index_type const * facet_cells(index_type facet) const { return &facet_cells_[2 * facet]; }
+
+    /** @brief Returns the two vertex indices of an edge */
+    index_type const * edge_vertices(index_type edge) const { return &edge_vertices_[2 * edge]; }
+
+    bool is_boundary_facet(index_type facet) const { return facet_cells_[2 * facet + 1] == invalid_index(); }
+
+    /** @brief Returns the ID of the first segment containing the cell, invalid_index() if segments were not recorded or the cell is in no segment */
+    index_type cell_segment(index_type cell) const { return cell_segments_.empty() ? invalid_index() : cell_segments_[cell]; }
+
+    /** @brief Returns the number of bytes allocated by the snapshot */
+    size_type memory_size() const
+    {
+      size_type bytes = sizeof(*this);
+      for (int d = 0; d < geometric_dimension; ++d)
+        bytes += coordinates_[d].capacity() * sizeof(coord_type);
+      bytes += ( cell_vertices_.capacity() + cell_facets_.capacity() + cell_edges_.capacity()
+               + facet_vertices_.capacity() + facet_cells_.capacity() + edge_vertices_.capacity()
+               + cell_segments_.capacity() ) * sizeof(index_type);
+      return bytes;
+    }
+
+  private:
+
+    /** @brief Maps the (dense) IDs of the elements in a range to their position in the range */
+    template<typename RangeT>
+    static void number_elements(RangeT const & range, std::vector<index_type> & index_of_id)
+    {
+      typedef typename viennagrid::result_of::iterator<RangeT>::type IteratorType;
+
+      index_type index = 0;
+      for (IteratorType it = range.begin(); it != range.end(); ++it, ++index)
+      {
+        size_type id = static_cast<size_type>((*it).id().get());
+        if (id >= index_of_id.size())
+          index_of_id.resize(id + 1, invalid_index());
+        index_of_id[id] = index;
+      }
+    }
+
+    /** @brief Writes the indices of the boundary elements of an element to 'indices' */
+    template<typename BoundaryTagT, typename ElementT>
+    static void write_boundary_indices(ElementT const & element, std::vector<index_type> const & index_of_id, index_type * indices)
+    {
+      typedef typename viennagrid::result_of::const_element_range<ElementT, BoundaryTagT>::type  BoundaryRange;
+      typedef typename viennagrid::result_of::iterator<BoundaryRange>::type                         BoundaryIterator;
+
+      BoundaryRange boundary = viennagrid::elements<BoundaryTagT>(element);
+      for (BoundaryIterator bit = boundary.begin(); bit != boundary.end(); ++bit)
+        *indices++ = index_of_id[static_cast<size_type>((*bit).id().get())];
+    }
+
+    void assign(MeshT const & mesh_obj)
+    {
+      typedef typename viennagrid::result_of::const_element_range<MeshT, vertex_tag>::type   VertexRange;
+      typedef typename viennagrid::result_of::iterator<VertexRange>::type                   VertexIterator;
+      typedef typename viennagrid::result_of::const_element_range<MeshT, cell_tag>::type     CellRange;
+      typedef typename viennagrid::result_of::iterator<CellRange>::type                     CellIterator;
+      typedef typename viennagrid::result_of::const_element_range<MeshT, facet_tag>::type    FacetRange;
+      typedef typename viennagrid::result_of::iterator<FacetRange>::type                    FacetIterator;
+      typedef typename viennagrid::result_of::const_element_range<MeshT, line_tag>::type     EdgeRange;
+      typedef typename viennagrid::result_of::iterator<EdgeRange>::type                     EdgeIterator;
+
+      VertexRange vertices(mesh_obj);
+      CellRange   cells(mesh_obj);
+      FacetRange  facets(mesh_obj);
+      EdgeRange   edges(mesh_obj);
+
+      std::vector<index_type> vertex_of_id, facet_of_id, edge_of_id;
+      number_elements(vertices, vertex_of_id);
+      number_elements(facets, facet_of_id);
+      number_elements(edges, edge_of_id);
+
+      for (int d = 0; d < geometric_dimension; ++d)
+        coordinates_[d].resize(vertices.size());
+      index_type v = 0;
+      for (VertexIterator vit = vertices.begin(); vit != vertices.end(); ++vit, ++v)
+      {
+        point_type const & p = viennagrid::point(mesh_obj, *vit);
+        for (int d = 0; d < geometric_dimension; ++d)
+          coordinates_[d][v] = p[d];
+      }
+
+      cell_vertices_.resize(vertices_per_cell * cells.size());
+      cell_facets_.resize(facets_per_cell * cells.size());
+      cell_edges_.resize(edges_per_cell * cells.size());
+      facet_cells_.resize(2 * facets.size(), invalid_index());
+      index_type c = 0;
+      for (CellIterator cit = cells.begin(); cit != cells.end(); ++cit, ++c)
+      {
+        write_boundary_indices<vertex_tag>(*cit, vertex_of_id, &cell_vertices_[vertices_per_cell * c]);
+        write_boundary_indices<facet_tag>(*cit, facet_of_id, &cell_facets_[facets_per_cell * c]);
+        write_boundary_indices<line_tag>(*cit, edge_of_id, &cell_edges_[edges_per_cell * c]);
+
+        for (int k = 0; k < facets_per_cell; ++k)
+        {
+          index_type * facet_cells = &facet_cells_[2 * cell_facets_[facets_per_cell * c + k]];
+          facet_cells[facet_cells[0] == invalid_index() ? 0 : 1] = c;
+        }
+      }
+
+      facet_vertices_.resize(vertices_per_facet * facets.size());
+      index_type f = 0;
+      for (FacetIterator fit = facets.begin(); fit != facets.end(); ++fit, ++f)
+        write_boundary_indices<vertex_tag>(*fit, vertex_of_id, &facet_vertices_[vertices_per_facet * f]);
+
+      edge_vertices_.resize(2 * edges.size());
+      index_type e = 0;
+      for (EdgeIterator eit = edges.begin(); eit != edges.end(); ++eit, ++e)
+        write_boundary_indices<vertex_tag>(*eit, vertex_of_id, &edge_vertices_[2 * e]);
+    }
+
+    template<typename SegmentationT>
+    void assign_segments(SegmentationT const & segmentation)
+    {
+      typedef typename SegmentationT::const_iterator                                                  SegmentIterator;
+      typedef typename viennagrid::result_of::segment_handle<SegmentationT>::type                     SegmentHandleType;
+      typedef typename viennagrid::result_of::const_element_range<SegmentHandleType, cell_tag>::type  CellOnSegmentRange;
+      typedef typename viennagrid::result_of::iterator<CellOnSegmentRange>::type                      CellOnSegmentIterator;
+      typedef typename viennagrid::result_of::const_element_range<MeshT, cell_tag>::type              CellRange;
+
+      std::vector<index_type> cell_of_id;
+      number_elements(CellRange(segmentation.mesh()), cell_of_id);
+
+      cell_segments_.assign(cell_count(), invalid_index());
+      for (SegmentIterator sit = segmentation.begin(); sit != segmentation.end(); ++sit)
+      {
+        CellOnSegmentRange cells(*sit);
+        for (CellOnSegmentIterator cit = cells.begin(); cit != cells.end(); ++cit)
+        {
+          index_type & segment = cell_segments_[cell_of_id[static_cast<size_type>((*cit).id().get())]];
+          if (segment == invalid_index())
+            segment = static_cast<index_type>((*sit).id());
+        }
+      }
+    }
+
+    std::vector<coord_type>  coordinates_[geometric_dimension];
+    std::vector<index_type>  cell_vertices_;
+    std::vector<index_type>  cell_facets_;
+    std::vector<index_type>  cell_edges_;
+    std::vector<index_type>  facet_vertices_;
+    std::vector<index_type>  facet_cells_;
+    std::vector<index_type>  edge_vertices_;
+    std::vector<index_type>  cell_segments_;
+  };
+
+
+  namespace detail
+  {
+    /** @brief For internal use only */
+    template<typename CompactMeshT, typename IndexT>
+    typename CompactMeshT::coord_type compact_mesh_volume(CompactMeshT const & mesh_obj, IndexT const * vertices, simplex_tag<1>)
+    {
+      return spanned_volume(mesh_obj.point(vertices[0]), mesh_obj.point(vertices[1]));
+    }
+
+    template<typename CompactMeshT, typename IndexT>
+    typename CompactMeshT::coord_type compact_mesh_volume(CompactMeshT const & mesh_obj, IndexT const * vertices, simplex_tag<2>)
+    {
+      return spanned_volume(mesh_obj.point(vertices[0]), mesh_obj.point(vertices[1]), mesh_obj.point(vertices[2]));
+    }
+
+    template<typename CompactMeshT, typename IndexT>
+    typename CompactMeshT::coord_type compact_mesh_volume(CompactMeshT const & mesh_obj, IndexT const * vertices, simplex_tag<3>)
+    {
+      return spanned_volume(mesh_obj.point(vertices[0]), mesh_obj.point(vertices[1]), mesh_obj.point(vertices[2]), mesh_obj.point(vertices[3]));
+    }
+  }
+
+  /** @brief Returns the volume of a simplex cell of a compact mesh, same as viennagrid::volume() of the cell in the original mesh */
+  template<typename MeshT, typename IndexT>
+  typename compact_mesh<MeshT, IndexT>::coord_type volume(compact_mesh<MeshT, IndexT> const & mesh_obj, IndexT cell)
+  {
+    return detail::compact_mesh_volume(mesh_obj, mesh_obj.cell_vertices(cell), typename compact_mesh<MeshT, IndexT>::cell_tag());
+  }
+
+  /** @brief Returns the volume of a facet of a compact mesh with simplex cells, same as viennagrid::volume() of the facet in the original mesh */
+  template<typename MeshT, typename IndexT>
+  typename compact_mesh<MeshT, IndexT>::coord_type facet_volume(compact_mesh<MeshT, IndexT> const & mesh_obj, IndexT facet)
+  {
+    return detail::compact_mesh_volume(mesh_obj, mesh_obj.facet_vertices(facet), typename compact_mesh<MeshT, IndexT>::facet_tag());
+  }
+
+  /** @brief Returns the centroid of a cell of a compact mesh, same as viennagrid::centroid() of the cell in the original mesh */
+  template<typename MeshT, typename IndexT>
+  typename compact_mesh<MeshT, IndexT>::point_type centroid(compact_mesh<MeshT, IndexT> const & mesh_obj, IndexT cell)
+  {
+    typedef compact_mesh<MeshT, IndexT> CompactMeshType;
+
+    typename CompactMeshType::point_type p = mesh_obj.point(mesh_obj.cell_vertices(cell)[0]);
+    for (int k = 1; k < CompactMeshType::vertices_per_cell; ++k)
+      p += mesh_obj.point(mesh_obj.cell_vertices(cell)[k]);
+    p /= CompactMeshType::vertices_per_cell;
+    return p;
+  }
+
+}
+
+#endif
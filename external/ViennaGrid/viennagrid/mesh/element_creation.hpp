@@ -320,6 +320,49 @@ namespace viennagrid
     return make_element<ElementTag>( domain_segment, vertex_handles.begin(), vertex_handles.end() );
   }
 
+
+  namespace detail
+  {
+    /** @brief For internal use only */
+    template<typename MeshT, typename CellTagT>
+    struct reserve_boundary_elements_functor
+    {
+      reserve_boundary_elements_functor(MeshT & mesh_obj, std::size_t cell_count) : mesh_obj_(mesh_obj), cell_count_(cell_count) {}
+
+      template<typename ElementTagT>
+      void operator() ( viennagrid::detail::tag<ElementTagT> )
+      {
+        typedef typename viennagrid::result_of::element<MeshT, ElementTagT>::type ElementType;
+
+        // most boundary elements are shared by (at least) two cells
+        long num = boundary_elements<CellTagT, ElementTagT>::num;
+        if (num > 0)
+          detail::reserve_container( viennagrid::get<ElementType>(detail::element_collection(mesh_obj_)), cell_count_ * num / 2 );
+      }
+
+      MeshT & mesh_obj_;
+      std::size_t cell_count_;
+    };
+  }
+
+  /** @brief Reserves the containers of the boundary elements (e.g. facets and edges) of a mesh for a given number of cells.
+    *
+    * Only has an effect for boundary elements stored in a viennagrid::hashed_key_map, which then need not be rehashed while the cells are created.
+    *
+    * @param  mesh_obj     The host mesh object
+    * @param  cell_count   The number of cells, which are about to be created
+    */
+  template<typename WrappedConfigT>
+  void reserve_boundary_elements( viennagrid::mesh<WrappedConfigT> & mesh_obj, std::size_t cell_count )
+  {
+    typedef viennagrid::mesh<WrappedConfigT> MeshType;
+    typedef typename viennagrid::result_of::cell_tag<MeshType>::type CellTag;
+    typedef typename viennagrid::result_of::element<MeshType, CellTag>::type CellType;
+
+    detail::reserve_boundary_elements_functor<MeshType, CellTag> functor( mesh_obj, cell_count );
+    viennagrid::detail::for_each< typename viennagrid::result_of::boundary_element_taglist<CellType>::type >(functor);
+  }
+
 }
 
 
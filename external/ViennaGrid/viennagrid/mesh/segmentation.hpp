@@ -887,8 +887,8 @@ namespace viennagrid
     };
 
 
-    /** @brief Information container providing iteration over segments of a segmentation */
-    template<typename element_segment_mapping_type, typename container_tag = viennagrid::std_deque_tag>
+    /** @brief Information container providing iteration over segments of a segmentation. One is stored per element, most elements are in one or two segments only. */
+    template<typename element_segment_mapping_type, typename container_tag = viennagrid::std_vector_tag>
     struct segment_info_t
     {
       typedef typename element_segment_mapping_type::segment_id_type segment_id_type;
@@ -1141,15 +1141,31 @@ namespace viennagrid
   namespace result_of
   {
 
+    /** @brief Metafunction for obtaining the default view type of the segments of a mesh. The handles are held in sorted vectors (see viennagrid::sorted_vector) instead of std::set, which saves memory and provides contiguous iteration.
+     *
+     * @tparam MeshT          The base mesh type to which the segmentation is associated
+     */
+    template<typename MeshT>
+    struct segment_view
+    {
+      typedef typename mesh_view_from_typelist<
+          MeshT,
+          typename viennagrid::detail::result_of::key_typelist<
+              typename element_collection<MeshT>::type::typemap
+          >::type,
+          default_segment_view_container_config
+      >::type type;
+    };
+
     /** @brief Metafunction for obtaining a segmentation type for a mesh type and with settings. Segment element information is not present (see segment_element_info for more information)
      *
      * @tparam MeshT          The base mesh type to which the segmentation is associated
-     * @tparam ViewT            The mesh view type representing the referenced elements, default ist default mesh view from MeshT
+     * @tparam ViewT            The mesh view type representing the referenced elements, default is a mesh view from MeshT holding the handles in sorted vectors
      * @tparam SegmentIDType    The ID type for segments, default is int
      * @tparam AppendixType     The appendix type, for internal use only, don't change default type unless you know what you are doing :)
      */
     template<typename MeshT,
-             typename ViewT = typename viennagrid::result_of::mesh_view<MeshT>::type,
+             typename ViewT = typename viennagrid::result_of::segment_view<MeshT>::type,
              typename SegmentIDType = int,
              typename AppendixType =
                 viennagrid::collection<
@@ -1188,12 +1204,12 @@ namespace viennagrid
     /** @brief Metafunction for obtaining a segmentation type for a 3D hull mesh type and with settings. Segment element information is a bool (see segment_element_info for more information)
      *
      * @tparam MeshT          The base mesh type to which the segmentation is associated
-     * @tparam ViewT            The mesh view type representing the referenced elements, default ist default mesh view from MeshT
+     * @tparam ViewT            The mesh view type representing the referenced elements, default is a mesh view from MeshT holding the handles in sorted vectors
      * @tparam SegmentIDType    The ID type for segments, default is int
      * @tparam AppendixType     The appendix type, for internal use only, don't change default type unless you know what you are doing :)
      */
     template<typename MeshT,
-             typename ViewT = typename viennagrid::result_of::mesh_view<MeshT>::type,
+             typename ViewT = typename viennagrid::result_of::segment_view<MeshT>::type,
              typename SegmentIDType = int,
              typename AppendixType =
               viennagrid::collection<
@@ -1558,7 +1574,7 @@ namespace viennagrid
     viennagrid::elements<element_type>( segment.parent().all_elements() ).insert_unique_handle( viennagrid::handle( segment.parent().mesh(), element ) );
     detail::add( segment, viennagrid::make_accessor<element_type>( detail::element_segment_mapping_collection(segment) ), element );
 
-    // recursively adding facet elements; view containers has to be std::set
+    // recursively adding facet elements; the view containers have to ignore duplicates (e.g. std::set or viennagrid::sorted_vector)
     typedef typename viennagrid::result_of::facet_range< element_type >::type FacetRangeType;
     typedef typename viennagrid::result_of::iterator< FacetRangeType >::type FacetRangeIterator;
 
@@ -46,6 +46,24 @@ namespace viennagrid
     }
 
 
+    /** @brief Inserts a value if it is not yet present in the container, linear in the size of the container */
+    template<typename container_type>
+    void insert_unique(container_type & container, const typename container_type::value_type & value)
+    {
+      if (std::find(container.begin(), container.end(), value) == container.end())
+        insert(container, value);
+    }
+
+    /** @brief Erases the first occurrence of a value from the container, linear in the size of the container */
+    template<typename container_type>
+    void erase_value(container_type & container, const typename container_type::value_type & value)
+    {
+      typename container_type::iterator it = std::find(container.begin(), container.end(), value);
+      if (it != container.end())
+        container.erase(it);
+    }
+
+
 
 
 
@@ -72,6 +72,10 @@ namespace viennagrid
   /** @brief A tag indicating that std::map is used as a container */
   struct std_map_tag;
 
+  /** @brief A tag indicating that viennagrid::sorted_vector is used as a container */
+  template<typename compare_tag = default_tag>
+  struct sorted_vector_tag;
+
   /** @brief A tag indicating that storage::static_array should be used
     *
     * @tparam SizeV       The static size of the array
@@ -96,6 +100,12 @@ namespace viennagrid
       std_set_tag<id_compare_tag>
   >::type default_view_container_config;
 
+  /** @brief A typemap defining the default container configuration for the views of a segmentation, which are filled mostly in the order of the element IDs */
+  typedef viennagrid::make_typemap<
+      default_tag,
+      sorted_vector_tag<id_compare_tag>
+  >::type default_segment_view_container_config;
+
 
   /** @brief A tag indicating that a handled container is used
     *
@@ -0,0 +1,319 @@
+#ifndef VIENNAGRID_STORAGE_HASHED_KEY_MAP_HPP
+#define VIENNAGRID_STORAGE_HASHED_KEY_MAP_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#include <deque>
+#include <vector>
+#include <limits>
+#include "viennagrid/storage/container.hpp"
+#include "viennagrid/storage/hidden_key_map.hpp"
+
+/** @file viennagrid/storage/hashed_key_map.hpp
+    @brief Provides a hash-based alternative to the hidden key map
+*/
+
+namespace viennagrid
+{
+
+  /** @brief A hash-based container with the interface of hidden_key_map: the key is deduced from the value object.
+    *
+    * The values are stored in a std::deque in the order of insertion, hence their addresses are stable as long as they are not erased.
+    * The values are found through an open-addressing table with linear probing, which holds the hash and the index of each value.
+    * Compared to the std::map of hidden_key_map, an insertion neither allocates a tree node nor rebalances a tree, and the table
+    * can be reserved up front, e.g. from the number of cells of a mesh, see reserve().
+    *
+    * Erasing a value other than the last one moves the last value to its position, which invalidates handles to the last value.
+    *
+    * @tparam  KeyT    The key functor type which extracts the key from the value object. Must provide a member function hash() and operator==.
+    * @tparam  ValueT  The value type, i.e. the element stored inside the map.
+    */
+  template<typename KeyT, typename ValueT>
+  class hashed_key_map
+  {
+  public:
+
+    typedef std::deque< ValueT >               container_type;
+    typedef KeyT                               key_type;
+    typedef ValueT                             value_type;
+    typedef typename container_type::size_type size_type;
+    typedef value_type &                       reference;
+    typedef const value_type &                 const_reference;
+    typedef value_type *                       pointer;
+    typedef const value_type *                 const_pointer;
+
+    typedef typename container_type::iterator                             iterator;
+    typedef typename container_type::const_iterator                 const_iterator;
+
+    typedef typename container_type::reverse_iterator             reverse_iterator;
+    typedef typename container_type::const_reverse_iterator const_reverse_iterator;
+
+
+    iterator begin() { return values.begin(); }
+    iterator end()   { return values.end(); }
+
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end()   const { return values.end(); }
+
+    reverse_iterator rbegin() { return values.rbegin(); }
+    reverse_iterator rend()   { return values.rend(); }
+
+    const_reverse_iterator rbegin() const { return values.rbegin(); }
+    const_reverse_iterator rend()   const { return values.rend(); }
+
+    iterator find( const value_type & element)
+    {
+      size_type index = lookup( key_type(element) );
+      return (index == npos()) ? end() : begin() + index;
+    }
+
+    const_iterator find( const value_type & element) const
+    {
+      size_type index = lookup( key_type(element) );
+      return (index == npos()) ? end() : begin() + index;
+    }
+
+    std::pair<iterator, bool> insert( const value_type & element )
+    {
+      key_type key(element);
+      std::size_t hash = key.hash();
+
+      if (2 * (values.size() + 1) > table.size())
+        rehash( 2 * (values.size() + 1) );
+
+      std::size_t mask = table.size() - 1;
+      for (std::size_t pos = hash & mask; ; pos = (pos + 1) & mask)
+      {
+        if (table[pos].index == npos())
+        {
+          table[pos].hash  = hash;
+          table[pos].index = values.size();
+          keys.push_back(key);
+          values.push_back(element);
+          return std::make_pair( begin() + (values.size() - 1), true );
+        }
+        if (table[pos].hash == hash && keys[table[pos].index] == key)
+          return std::make_pair( begin() + table[pos].index, false );
+      }
+    }
+
+    iterator erase( iterator to_erase )
+    {
+      size_type index = static_cast<size_type>(to_erase - begin());
+      size_type last  = values.size() - 1;
+
+      remove_slot( index );
+      if (index != last)
+      {
+        // the last value takes the place of the erased one
+        table[slot_of(last)].index = index;
+        values[index] = values[last];
+        keys[index]   = keys[last];
+      }
+      values.pop_back();
+      keys.pop_back();
+
+      return begin() + index;
+    }
+
+    void clear()
+    {
+      values.clear();
+      keys.clear();
+      table.clear();
+    }
+
+    /** @brief Reserves the table for 'n' values, such that no rehashing takes place until then */
+    void reserve( size_type n )
+    {
+      if (2 * n > table.size())
+        rehash( 2 * n );
+    }
+
+    size_type size() const { return values.size(); }
+    bool empty()     const { return values.empty(); }
+
+  private:
+
+    struct slot
+    {
+      slot() : hash(0), index(npos()) {}
+
+      std::size_t hash;
+      size_type   index;
+    };
+
+    static size_type npos() { return std::numeric_limits<size_type>::max(); }
+
+    size_type lookup( key_type const & key ) const
+    {
+      if (table.empty())
+        return npos();
+
+      std::size_t hash = key.hash();
+      std::size_t mask = table.size() - 1;
+      for (std::size_t pos = hash & mask; table[pos].index != npos(); pos = (pos + 1) & mask)
+        if (table[pos].hash == hash && keys[table[pos].index] == key)
+          return table[pos].index;
+      return npos();
+    }
+
+    /** @brief Returns the position in the table of the value with the given index */
+    std::size_t slot_of( size_type index ) const
+    {
+      std::size_t mask = table.size() - 1;
+      std::size_t pos = keys[index].hash() & mask;
+      while (table[pos].index != index)
+        pos = (pos + 1) & mask;
+      return pos;
+    }
+
+    /** @brief Removes the table entry of the value with the given index, the following entries of the cluster are shifted back */
+    void remove_slot( size_type index )
+    {
+      std::size_t mask = table.size() - 1;
+      std::size_t hole = slot_of(index);
+      for (std::size_t pos = (hole + 1) & mask; table[pos].index != npos(); pos = (pos + 1) & mask)
+      {
+        std::size_t home = table[pos].hash & mask;
+        // the entry may fill the hole if its home position is not within (hole, pos]
+        if ( (pos > hole) ? (home <= hole || home > pos) : (home <= hole && home > pos) )
+        {
+          table[hole] = table[pos];
+          hole = pos;
+        }
+      }
+      table[hole] = slot();
+    }
+
+    void rehash( size_type min_size )
+    {
+      std::size_t new_size = 16;
+      while (new_size < min_size)
+        new_size *= 2;
+
+      std::vector<slot> new_table(new_size);
+      std::size_t mask = new_size - 1;
+      for (std::size_t i = 0; i < table.size(); ++i)
+      {
+        if (table[i].index == npos())
+          continue;
+        std::size_t pos = table[i].hash & mask;
+        while (new_table[pos].index != npos())
+          pos = (pos + 1) & mask;
+        new_table[pos] = table[i];
+      }
+      table.swap(new_table);
+    }
+
+    container_type         values;
+    std::vector<key_type>  keys;
+    std::vector<slot>      table;
+  };
+
+
+
+  namespace detail
+  {
+    template<typename KeyT, typename ElementT, typename handle_tag>
+    class container_base<hashed_key_map<KeyT, ElementT>, handle_tag> : public handled_container<hashed_key_map<KeyT, ElementT>, handle_tag>
+    {
+    public:
+
+      typedef handled_container<hashed_key_map<KeyT, ElementT>, handle_tag> handled_container_type;
+      typedef typename handled_container_type::container_type container_type;
+
+      typedef typename handled_container_type::value_type value_type;
+
+      typedef typename handled_container_type::pointer pointer;
+      typedef typename handled_container_type::const_pointer const_pointer;
+
+      typedef typename handled_container_type::reference reference;
+      typedef typename handled_container_type::const_reference const_reference;
+
+      typedef typename handled_container_type::iterator iterator;
+      typedef typename handled_container_type::const_iterator const_iterator;
+
+      typedef typename handled_container_type::handle_type handle_type;
+      typedef typename handled_container_type::const_handle_type const_handle_type;
+
+      typedef std::pair<handle_type, bool> return_type;
+
+      bool is_present( const value_type & element ) const
+      {
+        return container_type::find(element) != container_type::end();
+      }
+
+      typename container_type::const_iterator find( const value_type & element ) const
+      {
+        return container_type::find(element);
+      }
+
+      return_type insert( const value_type & element )
+      {
+        std::pair<typename container_type::iterator, bool> tmp = container_type::insert( element );
+        return std::make_pair( handled_container_type::handle(*tmp.first), tmp.second);
+      }
+    };
+  }
+
+
+  /** @brief A tag for selecting a hashed key map as a storage type, e.g. for the boundary elements in viennagrid::config::result_of::full_mesh_config
+    *
+    * @tparam  KeyTypeTagT      A tag identifying the key deduction mechanism to be used in the hashed key map.
+    */
+  template<typename KeyTypeTagT>
+  struct hashed_key_map_tag {};
+
+  namespace result_of
+  {
+    /** \cond */
+    template<typename element_type, typename key_type_tag>
+    struct container<element_type, hashed_key_map_tag<key_type_tag> >
+    {
+      typedef hashed_key_map< typename hidden_key_map_key_type_from_tag<element_type, key_type_tag>::type, element_type > type;
+    };
+    /** \endcond */
+  }
+
+  namespace detail
+  {
+    template<typename KeyT, typename ValueT>
+    std::pair<typename hashed_key_map<KeyT, ValueT>::iterator, bool>
+        insert( hashed_key_map<KeyT, ValueT> & container, const ValueT & element )
+    {
+      return container.insert( element );
+    }
+
+    /** @brief Reserves an element container for 'n' elements, only hashed key maps are reserved */
+    template<typename ContainerT>
+    struct reserve_container_helper
+    {
+      static void reserve( ContainerT &, std::size_t ) {}
+    };
+
+    template<typename KeyT, typename ValueT, typename HandleTagT>
+    struct reserve_container_helper< container<hashed_key_map<KeyT, ValueT>, HandleTagT> >
+    {
+      static void reserve( container<hashed_key_map<KeyT, ValueT>, HandleTagT> & c, std::size_t n ) { c.reserve(n); }
+    };
+
+    template<typename ContainerT>
+    void reserve_container( ContainerT & c, std::size_t n )
+    {
+      reserve_container_helper<ContainerT>::reserve(c, n);
+    }
+  }
+}
+
+#endif
@@ -117,7 +117,8 @@ namespace viennagrid
       using base::set_max_id;
       void set_max_id( id_type last_id_ )
       {
-        if (last_id_ > last_id)
+        // last_id is the next free ID
+        if (last_id_ >= last_id)
         {
           last_id = last_id_;
           ++last_id;
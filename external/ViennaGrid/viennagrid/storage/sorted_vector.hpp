@@ -0,0 +1,168 @@
+#ifndef VIENNAGRID_STORAGE_SORTED_VECTOR_HPP
+#define VIENNAGRID_STORAGE_SORTED_VECTOR_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics,
+                            Institute for Analysis and Scientific Computing,
+                            TU Wien.
+
+                            -----------------
+                     ViennaGrid - The Vienna Grid Library
+                            -----------------
+
+   License:      MIT (X11), see file LICENSE in the base directory
+======================================================================= */
+
+#include <vector>
+#include <algorithm>
+#include "viennagrid/storage/forwards.hpp"
+#include "viennagrid/storage/container.hpp"
+
+/** @file viennagrid/storage/sorted_vector.hpp
+    @brief Provides a set of unique values, which are stored contiguously in a sorted std::vector
+*/
+
+namespace viennagrid
+{
+
+  /** @brief A set of unique values stored in a sorted std::vector, a compact alternative to std::set.
+    *
+    * Each value occupies sizeof(ValueT) bytes instead of a tree node, iteration is contiguous and lookups are binary searches.
+    * Appending values in increasing order is amortized constant, inserting a value in between moves all greater values.
+    * Hence, this container is suited for sets which are filled mostly in order, e.g. handles of elements which are added in the order of their IDs.
+    *
+    * @tparam  ValueT    The value type
+    * @tparam  CompareT  A functor defining a strict weak ordering of the values
+    */
+  template<typename ValueT, typename CompareT = std::less<ValueT> >
+  class sorted_vector
+  {
+    typedef std::vector<ValueT> container_type;
+
+  public:
+
+    typedef typename container_type::value_type             value_type;
+    typedef typename container_type::size_type              size_type;
+    typedef typename container_type::difference_type        difference_type;
+    typedef typename container_type::reference              reference;
+    typedef typename container_type::const_reference        const_reference;
+
+    typedef typename container_type::iterator               iterator;
+    typedef typename container_type::const_iterator         const_iterator;
+    typedef typename container_type::reverse_iterator       reverse_iterator;
+    typedef typename container_type::const_reverse_iterator const_reverse_iterator;
+
+    iterator begin() { return values.begin(); }
+    iterator end()   { return values.end(); }
+
+    const_iterator begin() const { return values.begin(); }
+    const_iterator end()   const { return values.end(); }
+
+    reverse_iterator rbegin() { return values.rbegin(); }
+    reverse_iterator rend()   { return values.rend(); }
+
+    const_reverse_iterator rbegin() const { return values.rbegin(); }
+    const_reverse_iterator rend()   const { return values.rend(); }
+
+    reference front() { return values.front(); }
+    const_reference front() const { return values.front(); }
+
+    reference back() { return values.back(); }
+    const_reference back() const { return values.back(); }
+
+    reference operator[]( size_type index ) { return values[index]; }
+    const_reference operator[]( size_type index ) const { return values[index]; }
+
+    size_type size() const { return values.size(); }
+    bool empty() const { return values.empty(); }
+    void clear() { values.clear(); }
+    void reserve( size_type n ) { values.reserve(n); }
+    void resize( size_type n ) { values.resize(n); }
+
+    /** @brief Inserts a value if no equivalent value is present, returns the position of the value and whether it was inserted */
+    std::pair<iterator, bool> insert( const_reference value )
+    {
+      CompareT compare;
+      if (values.empty() || compare(values.back(), value))
+      {
+        values.push_back(value);
+        return std::make_pair( values.end() - 1, true );
+      }
+
+      iterator it = std::lower_bound( values.begin(), values.end(), value, compare );
+      if (!compare(value, *it))
+        return std::make_pair( it, false );
+      return std::make_pair( values.insert(it, value), true );
+    }
+
+    iterator find( const_reference value )
+    {
+      iterator it = std::lower_bound( values.begin(), values.end(), value, CompareT() );
+      return (it != values.end() && !CompareT()(value, *it)) ? it : values.end();
+    }
+
+    const_iterator find( const_reference value ) const
+    {
+      const_iterator it = std::lower_bound( values.begin(), values.end(), value, CompareT() );
+      return (it != values.end() && !CompareT()(value, *it)) ? it : values.end();
+    }
+
+    iterator erase( iterator it ) { return values.erase(it); }
+
+    /** @brief Erases the value equivalent to the given one, returns the number of erased values */
+    size_type erase( const_reference value )
+    {
+      iterator it = find(value);
+      if (it == values.end())
+        return 0;
+      values.erase(it);
+      return 1;
+    }
+
+  private:
+    container_type values;
+  };
+
+
+  namespace detail
+  {
+    template<typename ValueT, typename CompareT>
+    void insert(sorted_vector<ValueT, CompareT> & container, const typename sorted_vector<ValueT, CompareT>::value_type & value)
+    {
+      container.insert(value);
+    }
+
+    template<typename ValueT, typename CompareT>
+    void insert_unique(sorted_vector<ValueT, CompareT> & container, const typename sorted_vector<ValueT, CompareT>::value_type & value)
+    {
+      container.insert(value);
+    }
+
+    template<typename ValueT, typename CompareT>
+    void erase_value(sorted_vector<ValueT, CompareT> & container, const typename sorted_vector<ValueT, CompareT>::value_type & value)
+    {
+      container.erase(value);
+    }
+  }
+
+
+  namespace result_of
+  {
+    /** \cond */
+    template<typename ValueT>
+    struct container<ValueT, sorted_vector_tag<default_tag> >
+    {
+      typedef sorted_vector<ValueT> type;
+    };
+
+    template<typename ValueT>
+    struct container<ValueT, sorted_vector_tag<id_compare_tag> >
+    {
+      typedef sorted_vector<ValueT, viennagrid::detail::IDCompare<ValueT> > type;
+    };
+    /** \endcond */
+  }
+
+}
+
+#endif
@@ -19,6 +19,7 @@
 #include "viennagrid/meta/typemap.hpp"
 
 #include "viennagrid/storage/container.hpp"
+#include "viennagrid/storage/sorted_vector.hpp"
 #include "viennagrid/storage/container_collection.hpp"
 #include "viennagrid/storage/handle.hpp"
 #include "viennagrid/storage/id.hpp"
@@ -223,13 +224,7 @@ namespace viennagrid
     void clear() { handle_container.clear(); }
 
 
-    void insert_unique_handle(handle_type handle)
-    {
-      for (iterator it = begin(); it != end(); ++it)
-        if (handle == it.handle()) return;
-
-      insert_handle(handle);
-    }
+    void insert_unique_handle(handle_type handle) { viennagrid::detail::insert_unique(handle_container, handle); }
 
     void insert_handle(handle_type handle) { viennagrid::detail::insert(handle_container, handle); }
     void set_handle( handle_type element, size_type pos )
@@ -237,15 +232,7 @@ namespace viennagrid
       if (size() <= pos+1) resize(pos+1);
       handle_container[pos] = element;
     }
-    void erase_handle(handle_type handle)
-    {
-      for (iterator it = begin(); it != end(); ++it)
-        if (it.handle() == handle)
-        {
-          handle_container.erase( it );
-          return;
-        }
-    }
+    void erase_handle(handle_type handle) { viennagrid::detail::erase_value(handle_container, handle); }
 
     handle_type handle_at(std::size_t pos) { return viennagrid::advance(begin(), pos).handle(); }
     const_handle_type handle_at(std::size_t pos) const { return viennagrid::advance(begin(), pos).handle(); }
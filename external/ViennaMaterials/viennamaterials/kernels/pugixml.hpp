@@ -120,6 +120,12 @@ struct PugiXML
     mdb.read(stream);
     return true;
   }
+
+  bool load(const char* buffer, std::size_t size)
+  {
+    mdb.read(buffer, size);
+    return true;
+  }
   
   void dump(std::ostream& stream = std::cout)
   {
@@ -53,6 +53,11 @@ public:
     return matlib.load(stream);
   }
 
+  virtual bool load(const char* buffer, std::size_t size)
+  {
+    return matlib.load(buffer, size);
+  }
+
   virtual void dump(std::ostream& stream = std::cout)
   {
     matlib.dump(stream);
@@ -49,6 +49,11 @@ public:
   */
   virtual bool load(std::stringstream & stream) = 0;
 
+  /** 
+      @brief Loads the material database from a memory buffer, e.g., a mapped file
+  */
+  virtual bool load(const char* buffer, std::size_t size) = 0;
+
   /** 
       @brief Writes the content of the database to the stream
   */
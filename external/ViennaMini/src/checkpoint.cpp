@@ -0,0 +1,294 @@
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMini - The Vienna Device Simulator
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+  #include <io.h>
+  #include <fcntl.h>
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+#include "viennamini/checkpoint.hpp"
+#include "viennautils/log.hpp"
+
+
+namespace viennamini {
+
+namespace {
+
+  // file layout: magic, version, sizeof(long) and the data, followed by the magic again,
+  // such that a truncated file is detected
+  const char         checkpoint_magic[4] = { 'V', 'M', 'C', 'K' };
+  const unsigned int checkpoint_version  = 2;
+
+  template<typename T>
+  void write_vector(std::ostream& stream, std::vector<T> const& values)
+  {
+    detail::write_binary(stream, static_cast<unsigned long long>(values.size()));
+    if(!values.empty())
+      stream.write(reinterpret_cast<char const*>(&values[0]), static_cast<std::streamsize>(values.size() * sizeof(T)));
+  }
+
+  template<typename T>
+  bool read_vector(std::istream& stream, std::vector<T>& values, unsigned long long max_size)
+  {
+    unsigned long long size;
+    if(!detail::read_binary(stream, size) || size > max_size) return false;
+    values.resize(static_cast<std::size_t>(size));
+    return values.empty() || static_cast<bool>(stream.read(reinterpret_cast<char*>(&values[0]),
+                                                           static_cast<std::streamsize>(values.size() * sizeof(T))));
+  }
+
+  bool read_magic(std::istream& stream)
+  {
+    char magic[sizeof(checkpoint_magic)];
+    return stream.read(magic, sizeof(magic)) && std::memcmp(magic, checkpoint_magic, sizeof(magic)) == 0;
+  }
+
+  // flushes the file to the disk, otherwise a crash shortly after the rename
+  // may leave an empty or partial checkpoint behind
+  bool sync_file(std::string const& filename)
+  {
+#ifdef _WIN32
+    int fd = _open(filename.c_str(), _O_WRONLY | _O_BINARY);
+    if(fd < 0) return false;
+    bool synced = (_commit(fd) == 0);
+    _close(fd);
+#else
+    int fd = ::open(filename.c_str(), O_WRONLY);
+    if(fd < 0) return false;
+    bool synced = (::fsync(fd) == 0);
+    ::close(fd);
+#endif
+    return synced;
+  }
+
+  bool write_checkpoint_data(std::string const& filename, checkpoint const& state)
+  {
+    std::ofstream stream(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if(!stream) return false;
+
+    stream.write(checkpoint_magic, sizeof(checkpoint_magic));
+    detail::write_binary(stream, checkpoint_version);
+    detail::write_binary(stream, static_cast<unsigned int>(sizeof(long)));
+
+    detail::write_binary(stream, state.dimension);
+    detail::write_binary(stream, static_cast<unsigned long long>(state.cells));
+    state.settings.save(stream);
+    detail::write_binary(stream, state.bias_fraction);
+    detail::write_binary(stream, static_cast<unsigned long long>(state.nonlinear_iterations));
+    write_vector(stream, state.damping);
+
+    detail::write_binary(stream, static_cast<unsigned long long>(state.iterates.size()));
+    for(std::size_t i = 0; i < state.iterates.size(); i++)
+    {
+      write_vector(stream, state.iterates[i]);
+      write_vector(stream, i < state.mappings.size() ? state.mappings[i] : std::vector<long>());
+    }
+
+    stream.write(checkpoint_magic, sizeof(checkpoint_magic));
+    stream.close();
+    return !stream.fail();
+  }
+
+} // anonymous namespace
+
+
+bool write_checkpoint(std::string const& filename, checkpoint const& state)
+{
+  // the previous checkpoint is only replaced by a complete one
+  std::string temporary = filename + ".tmp";
+  if(!write_checkpoint_data(temporary, state) || !sync_file(temporary))
+  {
+    std::remove(temporary.c_str());
+    return false;
+  }
+
+#ifdef _WIN32
+  std::remove(filename.c_str());   // rename does not replace existing files on Windows
+#endif
+  if(std::rename(temporary.c_str(), filename.c_str()) != 0)
+  {
+    std::remove(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool read_checkpoint(std::string const& filename, checkpoint& state)
+{
+  std::ifstream stream(filename.c_str(), std::ios::binary);
+  if(!stream || !read_magic(stream)) return false;
+
+  unsigned int version, long_size;
+  if(!detail::read_binary(stream, version)   || version   != checkpoint_version) return false;
+  if(!detail::read_binary(stream, long_size) || long_size != sizeof(long))       return false;
+
+  unsigned long long cells, iterations, quantities;
+  if(!detail::read_binary(stream, state.dimension)) return false;
+  if(!detail::read_binary(stream, cells))           return false;
+  if(!state.settings.load(stream))                  return false;
+  if(!detail::read_binary(stream, state.bias_fraction)) return false;
+  if(!detail::read_binary(stream, iterations))      return false;
+  if(!read_vector(stream, state.damping, 64))       return false;
+  if(!detail::read_binary(stream, quantities) || quantities > 64) return false;
+
+  state.cells                = static_cast<std::size_t>(cells);
+  state.nonlinear_iterations = static_cast<std::size_t>(iterations);
+  state.iterates.resize(static_cast<std::size_t>(quantities));
+  state.mappings.resize(static_cast<std::size_t>(quantities));
+  for(std::size_t i = 0; i < state.iterates.size(); i++)
+  {
+    if(!read_vector(stream, state.iterates[i], cells)) return false;
+    if(!read_vector(stream, state.mappings[i], cells)) return false;
+  }
+
+  return read_magic(stream);
+}
+
+
+#ifndef _WIN32
+
+checkpoint_writer::checkpoint_writer() :
+  started_(false), pending_(false), busy_(false), stop_(false), written_(0)
+{
+  pthread_mutex_init(&mutex_, NULL);
+  pthread_cond_init(&condition_, NULL);
+}
+
+checkpoint_writer::~checkpoint_writer()
+{
+  if(started_)
+  {
+    pthread_mutex_lock(&mutex_);
+    stop_ = true;
+    pthread_cond_broadcast(&condition_);
+    pthread_mutex_unlock(&mutex_);
+    pthread_join(thread_, NULL);
+  }
+  pthread_cond_destroy(&condition_);
+  pthread_mutex_destroy(&mutex_);
+}
+
+void checkpoint_writer::submit(std::string const& filename, checkpoint& state)
+{
+  pthread_mutex_lock(&mutex_);
+  if(!started_)
+  {
+    if(pthread_create(&thread_, NULL, &checkpoint_writer::run, this) != 0)
+    {
+      // no thread available, write synchronously
+      if(write(filename, state)) ++written_;
+      pthread_mutex_unlock(&mutex_);
+      return;
+    }
+    started_ = true;
+  }
+
+  // a pending checkpoint, which has not been picked up yet, is replaced
+  filename_ = filename;
+  state_.swap(state);
+  pending_ = true;
+  pthread_cond_broadcast(&condition_);
+  pthread_mutex_unlock(&mutex_);
+}
+
+void checkpoint_writer::wait()
+{
+  pthread_mutex_lock(&mutex_);
+  while(pending_ || busy_)
+    pthread_cond_wait(&condition_, &mutex_);
+  pthread_mutex_unlock(&mutex_);
+}
+
+std::size_t checkpoint_writer::written() const
+{
+  pthread_mutex_lock(&mutex_);
+  std::size_t written = written_;
+  pthread_mutex_unlock(&mutex_);
+  return written;
+}
+
+void* checkpoint_writer::run(void* self)
+{
+  static_cast<checkpoint_writer*>(self)->loop();
+  return NULL;
+}
+
+void checkpoint_writer::loop()
+{
+  checkpoint  state;
+  std::string filename;
+
+  pthread_mutex_lock(&mutex_);
+  while(true)
+  {
+    while(!pending_ && !stop_)
+      pthread_cond_wait(&condition_, &mutex_);
+    if(!pending_)
+      break;
+
+    // the buffers of the written checkpoint are handed back with the next submit()
+    state.swap(state_);
+    filename = filename_;
+    pending_ = false;
+    busy_    = true;
+    pthread_mutex_unlock(&mutex_);
+
+    bool success = write(filename, state);
+
+    pthread_mutex_lock(&mutex_);
+    if(success) ++written_;
+    busy_ = false;
+    pthread_cond_broadcast(&condition_);
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+#else
+
+checkpoint_writer::checkpoint_writer() : written_(0) {}
+
+checkpoint_writer::~checkpoint_writer() {}
+
+void checkpoint_writer::submit(std::string const& filename, checkpoint& state)
+{
+  if(write(filename, state)) ++written_;
+}
+
+void checkpoint_writer::wait() {}
+
+std::size_t checkpoint_writer::written() const
+{
+  return written_;
+}
+
+#endif
+
+bool checkpoint_writer::write(std::string const& filename, checkpoint const& state)
+{
+  if(write_checkpoint(filename, state))
+    return true;
+
+  viennautils::log::err() << "[Warning] ViennaMini: cannot write the checkpoint " << filename << std::endl;
+  return false;
+}
+
+} // viennamini
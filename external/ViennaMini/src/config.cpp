@@ -13,7 +13,13 @@
 ======================================================================= */
 
 
+#include <cstdlib>
+#include <iostream>
+
 #include "viennamini/config.hpp"
+#include "viennamini/checkpoint.hpp"
+#include "viennautils/xml.hpp"
+#include "viennautils/log.hpp"
 
 
 namespace viennamini {
@@ -26,8 +32,26 @@ config::config()
   linear_breaktol_                     = 1.E-14;
   linear_iterations_                   = 1000;
   damping_                             = 1.0;
+  adaptive_damping_                    = false;
+  minimal_damping_                     = 1.E-3;
+  bias_ramping_                        = false;
+  bias_step_                           = 0.1;
+  minimal_bias_step_                   = 1.E-3;
   initial_guess_smoothing_iterations_  = 0;
   model_drift_diffusion_state_         = true;
+  checkpoint_interval_                 = 0;
+  refinement_tolerance_                = 1.0;
+  refinement_levels_                   = 5;
+  refinement_max_cells_                = 1000000;
+
+  if(const char* jit_cache = std::getenv("VIENNAMINI_JIT_CACHE"))
+    jit_cache_ = jit_cache;
+
+  if(const char* recommendation = std::getenv("VIENNAMINI_SOLVER_RECOMMENDATION"))
+  {
+    if(!load_solver_recommendation(recommendation))
+      viennautils::log::err() << "[Warning] ViennaMini: cannot load the solver recommendation " << recommendation << std::endl;
+  }
 }
 
 
@@ -61,6 +85,31 @@ config::NumericType&  config::damping()
   return damping_;
 }
 
+bool& config::adaptive_damping()
+{
+  return adaptive_damping_;
+}
+
+config::NumericType&  config::minimal_damping()
+{
+  return minimal_damping_;
+}
+
+bool& config::bias_ramping()
+{
+  return bias_ramping_;
+}
+
+config::NumericType&  config::bias_step()
+{
+  return bias_step_;
+}
+
+config::NumericType&  config::minimal_bias_step()
+{
+  return minimal_bias_step_;
+}
+
 config::IndexType&    config::initial_guess_smoothing_iterations()
 {
   return initial_guess_smoothing_iterations_;
@@ -82,10 +131,202 @@ config::NumericType& config::workfunction(std::size_t segment_index)
     return segment_contact_workfunctions_[segment_index];
 }
 
+void config::assign_linear_solver(std::size_t quantity_index, std::string const& solver, std::string const& preconditioner)
+{
+  // dimension 0 applies to all dimensions
+  linear_solvers_[std::make_pair(0, quantity_index)] = LinearSolverType(solver, preconditioner);
+}
+
+bool config::linear_solver(int dimension, std::size_t quantity_index, std::string& solver, std::string& preconditioner) const
+{
+  LinearSolversType::const_iterator iter = linear_solvers_.find(std::make_pair(0, quantity_index));
+  if(iter == linear_solvers_.end())
+  {
+    iter = recommended_linear_solvers_.find(std::make_pair(dimension, quantity_index));
+    if(iter == recommended_linear_solvers_.end())
+      return false;
+  }
+  solver         = iter->second.first;
+  preconditioner = iter->second.second;
+  return true;
+}
+
+bool config::load_solver_recommendation(std::string const& filename)
+{
+  pugi::xml_document document;
+  if(!document.load_file(filename.c_str()))
+    return false;
+
+  pugi::xml_node root = document.child("solver_recommendation");
+  if(!root)
+    return false;
+
+  for(pugi::xml_node problem = root.child("problem"); problem; problem = problem.next_sibling("problem"))
+  {
+    int         dimension      = problem.child("dimension").text().as_int();
+    std::size_t quantity_index = problem.child("pde").text().as_uint();
+    std::string solver         = problem.child_value("solver");
+    std::string preconditioner = problem.child_value("preconditioner");
+    if(dimension > 0 && !solver.empty() && !preconditioner.empty())
+      recommended_linear_solvers_[std::make_pair(dimension, quantity_index)] = LinearSolverType(solver, preconditioner);
+  }
+  return true;
+}
+
+std::string& config::capture_prefix()
+{
+  return capture_prefix_;
+}
+
+std::string& config::jit_cache()
+{
+  return jit_cache_;
+}
+
 bool& config::drift_diffusion_state()
 {
   return model_drift_diffusion_state_;
 }
 
+std::string& config::checkpoint_file()
+{
+  return checkpoint_file_;
+}
+
+config::IndexType& config::checkpoint_interval()
+{
+  return checkpoint_interval_;
+}
+
+config::NumericType& config::refinement_tolerance()
+{
+  return refinement_tolerance_;
+}
+
+config::IndexType& config::refinement_levels()
+{
+  return refinement_levels_;
+}
+
+config::IndexType& config::refinement_max_cells()
+{
+  return refinement_max_cells_;
+}
+
+namespace {
+
+  // the strings of the settings are file names, prefixes and solver names
+  const unsigned long long max_name_size = 4096;
+
+  void save_segment_values(std::ostream& stream, config::SegmentValuesType const& values)
+  {
+    detail::write_binary(stream, static_cast<unsigned long long>(values.size()));
+    for(config::SegmentValuesType::const_iterator iter = values.begin(); iter != values.end(); iter++)
+    {
+      detail::write_binary(stream, static_cast<unsigned long long>(iter->first));
+      detail::write_binary(stream, iter->second);
+    }
+  }
+
+  bool load_segment_values(std::istream& stream, config::SegmentValuesType& values)
+  {
+    unsigned long long size, segment_index;
+    if(!detail::read_binary(stream, size)) return false;
+    values.clear();
+    for(unsigned long long i = 0; i < size; i++)
+    {
+      config::NumericType value;
+      if(!detail::read_binary(stream, segment_index) || !detail::read_binary(stream, value)) return false;
+      values[static_cast<std::size_t>(segment_index)] = value;
+    }
+    return true;
+  }
+
+  void save_linear_solvers(std::ostream& stream, config::LinearSolversType const& solvers)
+  {
+    detail::write_binary(stream, static_cast<unsigned long long>(solvers.size()));
+    for(config::LinearSolversType::const_iterator iter = solvers.begin(); iter != solvers.end(); iter++)
+    {
+      detail::write_binary(stream, iter->first.first);
+      detail::write_binary(stream, static_cast<unsigned long long>(iter->first.second));
+      detail::write_binary(stream, iter->second.first);
+      detail::write_binary(stream, iter->second.second);
+    }
+  }
+
+  bool load_linear_solvers(std::istream& stream, config::LinearSolversType& solvers)
+  {
+    unsigned long long size, quantity_index;
+    if(!detail::read_binary(stream, size)) return false;
+    solvers.clear();
+    for(unsigned long long i = 0; i < size; i++)
+    {
+      int dimension;
+      config::LinearSolverType solver;
+      if(!detail::read_binary(stream, dimension) || !detail::read_binary(stream, quantity_index) ||
+         !detail::read_binary(stream, solver.first, max_name_size) || !detail::read_binary(stream, solver.second, max_name_size)) return false;
+      solvers[std::make_pair(dimension, static_cast<std::size_t>(quantity_index))] = solver;
+    }
+    return true;
+  }
+
+} // anonymous namespace
+
+void config::save(std::ostream& stream) const
+{
+  detail::write_binary(stream, nonlinear_iterations_);
+  detail::write_binary(stream, linear_iterations_);
+  detail::write_binary(stream, initial_guess_smoothing_iterations_);
+  detail::write_binary(stream, temperature_);
+  detail::write_binary(stream, nonlinear_breaktol_);
+  detail::write_binary(stream, linear_breaktol_);
+  detail::write_binary(stream, damping_);
+  detail::write_binary(stream, adaptive_damping_);
+  detail::write_binary(stream, minimal_damping_);
+  detail::write_binary(stream, bias_ramping_);
+  detail::write_binary(stream, bias_step_);
+  detail::write_binary(stream, minimal_bias_step_);
+  save_segment_values(stream, segment_contact_values_);
+  save_segment_values(stream, segment_contact_workfunctions_);
+  detail::write_binary(stream, model_drift_diffusion_state_);
+  save_linear_solvers(stream, linear_solvers_);
+  save_linear_solvers(stream, recommended_linear_solvers_);
+  detail::write_binary(stream, capture_prefix_);
+  detail::write_binary(stream, jit_cache_);
+  detail::write_binary(stream, checkpoint_file_);
+  detail::write_binary(stream, checkpoint_interval_);
+  detail::write_binary(stream, refinement_tolerance_);
+  detail::write_binary(stream, refinement_levels_);
+  detail::write_binary(stream, refinement_max_cells_);
+}
+
+bool config::load(std::istream& stream)
+{
+  return detail::read_binary(stream, nonlinear_iterations_)
+      && detail::read_binary(stream, linear_iterations_)
+      && detail::read_binary(stream, initial_guess_smoothing_iterations_)
+      && detail::read_binary(stream, temperature_)
+      && detail::read_binary(stream, nonlinear_breaktol_)
+      && detail::read_binary(stream, linear_breaktol_)
+      && detail::read_binary(stream, damping_)
+      && detail::read_binary(stream, adaptive_damping_)
+      && detail::read_binary(stream, minimal_damping_)
+      && detail::read_binary(stream, bias_ramping_)
+      && detail::read_binary(stream, bias_step_)
+      && detail::read_binary(stream, minimal_bias_step_)
+      && load_segment_values(stream, segment_contact_values_)
+      && load_segment_values(stream, segment_contact_workfunctions_)
+      && detail::read_binary(stream, model_drift_diffusion_state_)
+      && load_linear_solvers(stream, linear_solvers_)
+      && load_linear_solvers(stream, recommended_linear_solvers_)
+      && detail::read_binary(stream, capture_prefix_, max_name_size)
+      && detail::read_binary(stream, jit_cache_, max_name_size)
+      && detail::read_binary(stream, checkpoint_file_, max_name_size)
+      && detail::read_binary(stream, checkpoint_interval_)
+      && detail::read_binary(stream, refinement_tolerance_)
+      && detail::read_binary(stream, refinement_levels_)
+      && detail::read_binary(stream, refinement_max_cells_);
+}
+
 } // viennamini
 
@@ -14,6 +14,7 @@
 ======================================================================= */
 
 #include "viennamini/device.hpp"
+#include "viennautils/log.hpp"
 
 namespace viennamini {
 
@@ -39,7 +40,7 @@ template<typename MeshT, typename SegmentationT, typename StorageT>
 void device<MeshT,SegmentationT,StorageT>::assign_contact(std::size_t segment_index)
 {
 #ifdef VIENNAMINI_DEBUG
-  std::cout << "* assign_contact(): segment " << segment_index << std::endl;
+  viennautils::log::out() << "* assign_contact(): segment " << segment_index << std::endl;
 #endif
   contact_segments_.push_back(segment_index);
 }
@@ -48,7 +49,7 @@ template<typename MeshT, typename SegmentationT, typename StorageT>
 void device<MeshT,SegmentationT,StorageT>::assign_oxide(std::size_t segment_index)
 {
 #ifdef VIENNAMINI_DEBUG
-  std::cout << "* assign_oxide(): segment " << segment_index << std::endl;
+  viennautils::log::out() << "* assign_oxide(): segment " << segment_index << std::endl;
 #endif
   oxide_segments_.push_back(segment_index);
 }
@@ -57,7 +58,7 @@ template<typename MeshT, typename SegmentationT, typename StorageT>
 void device<MeshT,SegmentationT,StorageT>::assign_semiconductor(std::size_t segment_index, NumericType const& ND, NumericType const& NA)
 {
 #ifdef VIENNAMINI_DEBUG
-  std::cout << "* assign_semiconductor(): segment " << segment_index << std::endl;
+  viennautils::log::out() << "* assign_semiconductor(): segment " << segment_index << std::endl;
 #endif
   semiconductor_segments_.push_back(segment_index);
 
@@ -13,7 +13,13 @@
 ======================================================================= */
 
 
+#include <cmath>
+#include <algorithm>
+#include <sstream>
+
 #include "viennamini/simulator.hpp"
+#include "viennafvm/profiler.hpp"
+#include "viennautils/log.hpp"
 
 
 namespace viennamini
@@ -21,7 +27,8 @@ namespace viennamini
 
 template <typename DeviceT, typename MatlibT>
 simulator<DeviceT, MatlibT>::simulator(DeviceT& device, MatlibT& matlib, viennamini::config& config) :
-          device_(device), matlib_(matlib), config_(config), notfound_(-1)
+          device_(device), matlib_(matlib), config_(config), notfound_(-1),
+          cancelled_(false), cancelled_bias_fraction_(1.0), bias_fraction_(1.0), initial_guess_(NULL)
 {
   eps_.wrap_constant ( device_.storage(), eps_key_  );
   mu_n_.wrap_constant( device_.storage(), mu_n_key_ );
@@ -33,6 +40,8 @@ simulator<DeviceT, MatlibT>::simulator(DeviceT& device, MatlibT& matlib, viennam
 template <typename DeviceT, typename MatlibT>
 void simulator<DeviceT, MatlibT>::operator()()
 {
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::simulator");
+
   // detect contact-semiconductor and contact-oxide interfaces
   //
   this->detect_interfaces();
@@ -52,9 +61,93 @@ void simulator<DeviceT, MatlibT>::operator()()
   this->run();
 }
 
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::resume(NumericType bias_fraction)
+{
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::simulator");
+
+  // the boundary conditions and the material parameters are set up as usual,
+  // but the iterates in the storage are kept
+  //
+  this->detect_interfaces();
+  this->prepare(false);
+
+  this->run(bias_fraction);
+}
+
+template <typename DeviceT, typename MatlibT>
+bool simulator<DeviceT, MatlibT>::resume_from_checkpoint(std::string const& filename)
+{
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::simulator");
+
+  viennamini::checkpoint state;
+  if(!viennamini::read_checkpoint(filename, state))
+  {
+    viennautils::log::err() << "[Error] ViennaMini: " << filename << " is not a valid checkpoint" << std::endl;
+    return false;
+  }
+
+  const std::size_t cell_count = viennagrid::cells(device_.mesh()).size();
+  if(state.dimension != viennagrid::result_of::geometric_dimension<MeshType>::value || state.cells != cell_count)
+  {
+    viennautils::log::err() << "[Error] ViennaMini: the checkpoint " << filename << " does not belong to this device" << std::endl;
+    return false;
+  }
+
+  // the settings of the checkpointed run, but checkpoints are written as configured now
+  std::string checkpoint_file     = config_.checkpoint_file();
+  int         checkpoint_interval = config_.checkpoint_interval();
+  config_ = state.settings;
+  config_.checkpoint_file()     = checkpoint_file;
+  config_.checkpoint_interval() = checkpoint_interval;
+
+  // the boundary conditions and the material parameters are set up as usual,
+  // the iterates are taken from the checkpoint
+  //
+  this->detect_interfaces();
+  this->prepare(false);
+
+  if(config_.drift_diffusion_state() && pde_system_.size() == 0)
+    add_drift_diffusion();
+
+  if(state.iterates.size() != pde_system_.size())
+  {
+    viennautils::log::err() << "[Error] ViennaMini: the checkpoint " << filename << " holds " << state.iterates.size()
+                            << " quantities, the simulation " << pde_system_.size() << std::endl;
+    return false;
+  }
+
+  // the DOF mapping follows from the boundary conditions and the disabled quantities,
+  // a different one indicates a different device setup
+  viennafvm::create_mapping(pde_system_, device_.mesh(), device_.storage());
+  std::vector<long> mapping;
+  for(std::size_t pde_index = 0; pde_index < pde_system_.size(); pde_index++)
+  {
+    viennafvm::backup_mapping(pde_system_, pde_index, device_.mesh(), device_.storage(), mapping);
+    if(state.iterates[pde_index].size() != cell_count || mapping != state.mappings[pde_index])
+    {
+      viennautils::log::err() << "[Error] ViennaMini: the DOF mapping of quantity " << pde_index
+                              << " does not match the checkpoint " << filename << std::endl;
+      return false;
+    }
+  }
+
+  for(std::size_t pde_index = 0; pde_index < pde_system_.size(); pde_index++)
+    viennafvm::restore_iterate(pde_system_, pde_index, device_.mesh(), device_.storage(), state.iterates[pde_index]);
+
+  viennautils::log::out() << "* Resuming from checkpoint " << filename << " at " << state.bias_fraction * 100.0
+                          << " % of the contact potentials after " << state.nonlinear_iterations << " nonlinear iterations" << std::endl;
+
+  pde_solver_.continue_from(state.nonlinear_iterations, state.damping);
+  this->run(state.bias_fraction);
+  return true;
+}
+
 template <typename DeviceT, typename MatlibT>
 void simulator<DeviceT, MatlibT>::write_device_doping()
 {
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::write_device_doping");
+
   typedef typename viennadata::result_of::accessor<StorageType, viennamini::donator_doping_key, NumericType, CellType>::type DonatorAccessorType;
   typedef typename viennadata::result_of::accessor<StorageType, viennamini::acceptor_doping_key, NumericType, CellType>::type AcceptorAccessorType;
 
@@ -70,6 +163,8 @@ void simulator<DeviceT, MatlibT>::write_device_doping()
 template <typename DeviceT, typename MatlibT>
 void simulator<DeviceT, MatlibT>::write_device_initial_guesses()
 {
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::write_device_initial_guesses");
+
   typedef typename viennadata::result_of::accessor<StorageType, BoundaryKeyType, NumericType, CellType>::type  BoundaryAccessorType;
   typedef typename viennadata::result_of::accessor<StorageType, IterateKeyType, NumericType, CellType>::type   InitGuessAccessorType;
 
@@ -98,6 +193,8 @@ void simulator<DeviceT, MatlibT>::write_device_initial_guesses()
 template <typename DeviceT, typename MatlibT>
 void simulator<DeviceT, MatlibT>::write_result(std::string filename)
 {
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::write_result");
+
   // Writing all solution variables back to domain.
   //
   std::vector<long> result_ids(3); //TODO: Better way to make potential, electron_density and hole_density accessible
@@ -108,9 +205,169 @@ void simulator<DeviceT, MatlibT>::write_result(std::string filename)
   viennafvm::io::write_solution_to_VTK_file(result(), filename, device_.mesh(), device_.segments(), device_.storage(), result_ids);
 }
 
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::store_solution(SolutionTransferType& transfer)
+{
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::store_solution");
+
+  typedef typename viennadata::result_of::accessor<StorageType, viennafvm::disable_quantity_key, bool, CellType>::type   DisabledAccessorType;
+  typedef typename viennadata::result_of::accessor<StorageType, BoundaryKeyType, bool, CellType>::type                  BoundaryAccessorType;
+  typedef typename viennadata::result_of::accessor<StorageType, BoundaryKeyType, NumericType, CellType>::type           BoundaryValueAccessorType;
+  typedef typename viennadata::result_of::accessor<StorageType, IterateKeyType, NumericType, CellType>::type            IterateAccessorType;
+
+  FunctionSymbolType quantities[3] = { quantity_potential(), quantity_electron_density(), quantity_hole_density() };
+
+  CellRangeType cells(device_.mesh());
+  std::vector<NumericType> values(cells.size());
+  std::vector<bool>        defined(cells.size());
+  for(int i = 0; i < 3; i++)
+  {
+    std::size_t id = quantities[i].id();
+    DisabledAccessorType      disabled_acc  = viennadata::make_accessor(device_.storage(), viennafvm::disable_quantity_key(id));
+    BoundaryAccessorType      boundary_acc  = viennadata::make_accessor<BoundaryKeyType, bool, CellType>(device_.storage(), BoundaryKeyType(id));
+    BoundaryValueAccessorType bnd_value_acc = viennadata::make_accessor<BoundaryKeyType, NumericType, CellType>(device_.storage(), BoundaryKeyType(id));
+    IterateAccessorType       iterate_acc   = viennadata::make_accessor(device_.storage(), IterateKeyType(id));
+
+    // Dirichlet cells hold the boundary values, as written by write_result()
+    std::size_t c = 0;
+    for(CellIteratorType cit = cells.begin(); cit != cells.end(); ++cit, ++c)
+    {
+      defined[c] = !disabled_acc(*cit);
+      values[c]  = boundary_acc(*cit) ? bnd_value_acc(*cit) : iterate_acc(*cit);
+    }
+    transfer.add_quantity(id, values, defined, i > 0);   // the carrier densities in log space
+  }
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::use_initial_guess(SolutionTransferType const* previous)
+{
+  initial_guess_ = previous;
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::transfer_initial_guess()
+{
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::transfer_initial_guess");
+
+  typedef typename SolutionTransferType::PointType                                                                    PointType;
+  typedef typename viennadata::result_of::accessor<StorageType, viennafvm::disable_quantity_key, bool, CellType>::type   DisabledAccessorType;
+  typedef typename viennadata::result_of::accessor<StorageType, IterateKeyType, NumericType, CellType>::type            IterateAccessorType;
+
+  CellRangeType cells(device_.mesh());
+  std::vector<PointType> centroids(cells.size());
+  std::size_t c = 0;
+  for(CellIteratorType cit = cells.begin(); cit != cells.end(); ++cit, ++c)
+    centroids[c] = viennagrid::centroid(*cit);
+
+  FunctionSymbolType quantities[3] = { quantity_potential(), quantity_electron_density(), quantity_hole_density() };
+  std::vector<NumericType> values;
+  for(int i = 0; i < 3; i++)
+  {
+    std::size_t id = quantities[i].id();
+    if(!initial_guess_->interpolate(id, centroids, values))
+    {
+      viennautils::log::err() << "[Warning] ViennaMini: the previous solution does not contain quantity " << id
+                              << ", the doping based initial guess is used" << std::endl;
+      continue;
+    }
+
+    DisabledAccessorType disabled_acc = viennadata::make_accessor(device_.storage(), viennafvm::disable_quantity_key(id));
+    IterateAccessorType  iterate_acc  = viennadata::make_accessor(device_.storage(), IterateKeyType(id));
+
+    c = 0;
+    for(CellIteratorType cit = cells.begin(); cit != cells.end(); ++cit, ++c)
+      if(!disabled_acc(*cit))
+        iterate_acc(*cit) = values[c];
+  }
+
+#ifdef VIENNAMINI_DEBUG
+  viennautils::log::out() << "* initial guesses interpolated from a previous solution on " << initial_guess_->cell_count() << " cells" << std::endl;
+#endif
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::compute_error_indicator(std::vector<NumericType>& indicator)
+{
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::compute_error_indicator");
+
+  typedef typename viennagrid::result_of::const_facet_range<CellType>::type                                             FacetOnCellRangeType;
+  typedef typename viennagrid::result_of::iterator<FacetOnCellRangeType>::type                                          FacetOnCellIteratorType;
+  typedef typename viennagrid::result_of::cell_range<SegmentType>::type                                                 SegmentCellRangeType;
+  typedef typename viennagrid::result_of::iterator<SegmentCellRangeType>::type                                          SegmentCellIteratorType;
+  typedef typename viennadata::result_of::accessor<StorageType, viennafvm::disable_quantity_key, bool, CellType>::type   DisabledAccessorType;
+  typedef typename viennadata::result_of::accessor<StorageType, BoundaryKeyType, bool, CellType>::type                  BoundaryAccessorType;
+  typedef typename viennadata::result_of::accessor<StorageType, BoundaryKeyType, NumericType, CellType>::type           BoundaryValueAccessorType;
+  typedef typename viennadata::result_of::accessor<StorageType, IterateKeyType, NumericType, CellType>::type            IterateAccessorType;
+  typedef typename viennadata::result_of::accessor<StorageType, viennafvm::facet_distance_key, NumericType, FacetType>::type  DistanceAccessorType;
+
+  const int          dimension = viennagrid::result_of::geometric_dimension<MeshType>::value;
+  const NumericType  thermal_potential = viennamini::get_thermal_potential(config_.temperature());
+
+  CellRangeType cells(device_.mesh());
+  std::size_t max_id = 0;
+  for(CellIteratorType cit = cells.begin(); cit != cells.end(); ++cit)
+    max_id = std::max<std::size_t>(max_id, (*cit).id().get());
+  indicator.assign(cells.empty() ? 0 : max_id+1, 0.0);
+
+  // the cell size, by which a facet gradient is turned into the variation across the cell
+  std::vector<NumericType> cell_size(indicator.size());
+  for(CellIteratorType cit = cells.begin(); cit != cells.end(); ++cit)
+    cell_size[(*cit).id().get()] = std::pow(viennagrid::volume(*cit), 1.0 / dimension);
+
+  DistanceAccessorType distance_acc = viennadata::make_accessor(device_.storage(), viennafvm::facet_distance_key());
+
+  FunctionSymbolType quantities[3] = { quantity_potential(), quantity_electron_density(), quantity_hole_density() };
+  std::vector<NumericType> values(indicator.size());
+  std::vector<char>        defined(indicator.size());
+  std::vector<NumericType> gradients;
+  typename viennagrid::result_of::field<std::vector<NumericType>, FacetType>::type gradient_field(gradients);
+  for(int i = 0; i < 3; i++)
+  {
+    std::size_t id = quantities[i].id();
+    DisabledAccessorType      disabled_acc  = viennadata::make_accessor(device_.storage(), viennafvm::disable_quantity_key(id));
+    BoundaryAccessorType      boundary_acc  = viennadata::make_accessor<BoundaryKeyType, bool, CellType>(device_.storage(), BoundaryKeyType(id));
+    BoundaryValueAccessorType bnd_value_acc = viennadata::make_accessor<BoundaryKeyType, NumericType, CellType>(device_.storage(), BoundaryKeyType(id));
+    IterateAccessorType       iterate_acc   = viennadata::make_accessor(device_.storage(), IterateKeyType(id));
+
+    // the potential is scaled by the thermal voltage, the carrier densities are compared in log space
+    for(CellIteratorType cit = cells.begin(); cit != cells.end(); ++cit)
+    {
+      std::size_t c     = (*cit).id().get();
+      NumericType value = boundary_acc(*cit) ? bnd_value_acc(*cit) : iterate_acc(*cit);
+      defined[c] = !disabled_acc(*cit) && (i == 0 || value > 0.0);
+      values[c]  = !defined[c] ? 0.0 : (i == 0 ? value / thermal_potential : std::log(value));
+    }
+
+    for(typename SegmentationType::iterator sit = device_.segments().begin(); sit != device_.segments().end(); ++sit)
+    {
+      SegmentType& segment = *sit;
+      SegmentCellRangeType segment_cells(segment);
+      for(SegmentCellIteratorType cit = segment_cells.begin(); cit != segment_cells.end(); ++cit)
+      {
+        std::size_t c = (*cit).id().get();
+        if(!defined[c]) continue;
+
+        FacetOnCellRangeType facets(*cit);
+        for(FacetOnCellIteratorType fit = facets.begin(); fit != facets.end(); ++fit)
+        {
+          CellType const* other = viennafvm::util::other_cell_of_facet(*fit, *cit, segment);
+          if(!other || !defined[other->id().get()]) continue;
+
+          viennafvm::compute_gradients_for_cell(*cit, *fit, *other, viennagrid::make_accessor<CellType>(values),
+                                                gradient_field, distance_acc);
+          indicator[c] = std::max(indicator[c], std::fabs(gradient_field(*fit)) * cell_size[c]);
+        }
+      }
+    }
+  }
+}
+
 template <typename DeviceT, typename MatlibT>
 void simulator<DeviceT, MatlibT>::detect_interfaces()
 {
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::detect_interfaces");
+
   IndicesType& contact_segments       = device_.contact_segments();
   IndicesType& oxide_segments         = device_.oxide_segments();
   IndicesType& semiconductor_segments = device_.semiconductor_segments();
@@ -167,10 +424,12 @@ int simulator<DeviceT, MatlibT>::find_adjacent_segment(SegmentType & current_con
 }
 
 template <typename DeviceT, typename MatlibT>
-void simulator<DeviceT, MatlibT>::prepare()
+void simulator<DeviceT, MatlibT>::prepare(bool initial_guesses)
 {
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::prepare");
+
 #ifdef VIENNAMINI_DEBUG
-  std::cout << "* finalizing device segments:" << std::endl;
+  viennautils::log::out() << "* finalizing device segments:" << std::endl;
 #endif
 
   StorageType & storage = device_.storage();
@@ -191,7 +450,7 @@ void simulator<DeviceT, MatlibT>::prepare()
     if(isContactInsulatorInterface(*iter))
     {
     #ifdef VIENNAMINI_DEBUG
-      std::cout << "  * segment " << *iter << " : contact-to-insulator interface" << std::endl;
+      viennautils::log::out() << "  * segment " << *iter << " : contact-to-insulator interface" << std::endl;
     #endif
       // According to [MB] for a Contact-Insulator interface, it doesn't make sense to use
       // a builtin-pot, as there is no adjacent semiconductor segment. adding 'workfunction' instead,
@@ -203,7 +462,7 @@ void simulator<DeviceT, MatlibT>::prepare()
           device_.segment(*iter),
           storage,
           quantity_potential(),
-          config_.contact_value(*iter) + config_.workfunction(*iter)
+          contact_potential(*iter, 1.0)
           );
 
       std::size_t adjacent_oxide_segment = contactOxideInterfaces_[*iter];
@@ -231,7 +490,7 @@ void simulator<DeviceT, MatlibT>::prepare()
     else if(isContactSemiconductorInterface(*iter))
     {
     #ifdef VIENNAMINI_DEBUG
-      std::cout << "  * segment " << *iter << " : contact-to-semiconductor interface" << std::endl;
+      viennautils::log::out() << "  * segment " << *iter << " : contact-to-semiconductor interface" << std::endl;
     #endif
 
       // retrieve the doping values of the adjacent semiconductor segment and
@@ -239,7 +498,6 @@ void simulator<DeviceT, MatlibT>::prepare()
       std::size_t adjacent_semiconductor_segment = contactSemiconductorInterfaces_[*iter];
       NumericType ND_value = device_.donator(adjacent_semiconductor_segment);
       NumericType NA_value = device_.acceptor(adjacent_semiconductor_segment);
-      NumericType builtin_pot = viennamini::built_in_potential(config_.temperature(), ND_value, NA_value);
 
       // a contact segment needs the permittivity as well. we use the
       // permittivity from the adjacent segment
@@ -261,7 +519,7 @@ void simulator<DeviceT, MatlibT>::prepare()
               device_.segment(*iter),  // segment
               storage,
               quantity_potential(),
-              config_.contact_value(*iter) + config_.workfunction(*iter) + builtin_pot // BC value
+              contact_potential(*iter, 1.0) // BC value
               );
 
       // as this contact is a contact-semiconductor interface, we have to
@@ -296,7 +554,7 @@ void simulator<DeviceT, MatlibT>::prepare()
       iter != oxide_segments.end(); iter++)
   {
   #ifdef VIENNAMINI_DEBUG
-         std::cout << "  * segment " << *iter << " : oxide" << std::endl;
+         viennautils::log::out() << "  * segment " << *iter << " : oxide" << std::endl;
   #endif
 
     viennafvm::set_quantity_region(device_.segment(*iter), storage, eps_key_, true);
@@ -322,7 +580,7 @@ void simulator<DeviceT, MatlibT>::prepare()
       iter != semiconductor_segments.end(); iter++)
   {
   #ifdef VIENNAMINI_DEBUG
-         std::cout << "  * segment " << *iter << " : semiconductor" << std::endl;
+         viennautils::log::out() << "  * segment " << *iter << " : semiconductor" << std::endl;
   #endif
 
     viennafvm::set_quantity_region(device_.segment(*iter), storage, eps_key_, true);
@@ -354,8 +612,10 @@ void simulator<DeviceT, MatlibT>::prepare()
     viennafvm::set_quantity_value(device_.segment(*iter), storage, builtin_key_, builtin_potential_value);
   }
 
+  if(!initial_guesses) return;
+
 #ifdef VIENNAMINI_DEBUG
-  std::cout << "* setting initial conditions .." << std::endl;
+  viennautils::log::out() << "* setting initial conditions .." << std::endl;
 #endif
   //
   // Initial conditions (required for nonlinear problems)
@@ -366,7 +626,7 @@ void simulator<DeviceT, MatlibT>::prepare()
   viennafvm::set_initial_guess(device_.mesh(), storage, quantity_hole_density(),     viennamini::acceptor_doping_key());
 
 #ifdef VIENNAMINI_DEBUG
-  std::cout << "* smoothing initial conditions " << config_.initial_guess_smoothing_iterations() << " times " << std::endl;
+  viennautils::log::out() << "* smoothing initial conditions " << config_.initial_guess_smoothing_iterations() << " times " << std::endl;
 #endif
   //
   // smooth the initial guesses
@@ -383,6 +643,11 @@ void simulator<DeviceT, MatlibT>::prepare()
     viennafvm::smooth_initial_guess(device_.mesh(), storage,
                                     viennafvm::geometric_mean_smoother(), quantity_hole_density());
   }
+
+  // a previous solution replaces the doping based guesses where it is available
+  //
+  if(initial_guess_)
+    transfer_initial_guess();
 }
 
 template <typename DeviceT, typename MatlibT>
@@ -430,29 +695,268 @@ void simulator<DeviceT, MatlibT>::add_drift_diffusion()
 }
 
 template <typename DeviceT, typename MatlibT>
-void simulator<DeviceT, MatlibT>::run()
+void simulator<DeviceT, MatlibT>::run(NumericType start_fraction)
 {
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::run");
+
   // check the config object, which model is active. add each active
-  // model to the linear pde system ...
+  // model to the linear pde system ... unless this simulator has been run already
   //
-  if(config_.drift_diffusion_state())
+  if(config_.drift_diffusion_state() && pde_system_.size() == 0)
     add_drift_diffusion();
 
   linear_solver_.max_iterations()  = config_.linear_iterations();
   linear_solver_.break_tolerance() = config_.linear_breaktol();
+  this->configure_linear_solvers();
 
   // configure the DD solver
   pde_solver_.set_damping(config_.damping());
+  pde_solver_.set_adaptive_damping(config_.adaptive_damping());
+  pde_solver_.set_min_damping(config_.minimal_damping());
   pde_solver_.set_nonlinear_iterations(config_.nonlinear_iterations());
   pde_solver_.set_nonlinear_breaktol(config_.nonlinear_breaktol());
 
+  if(config_.jit_cache().empty())
+    pde_solver_.set_jit_compiler(NULL);
+  else
+  {
+    jit_.cache_directory(config_.jit_cache());
+    pde_solver_.set_jit_compiler(&jit_);
+  }
+
+  pde_solver_.set_checkpoint_handler(this->checkpoints_enabled() ? this : NULL);
+
 //            std::cout << "starting simulatoin " << std::endl;
 
 #ifdef VIENNAMINI_DEBUG
-  std::cout << "* starting simulation .. " << std::endl;
+  viennautils::log::out() << "* starting simulation .. " << std::endl;
 #endif
+  bias_steps_.clear();
+  cancelled_ = false;
+
   // run the simulation
+  if(config_.bias_ramping())
+    this->run_bias_ramping(start_fraction);
+  else
+    this->solve_bias_step(1.0);
+
+  // the checkpoint of the last iteration has to be complete when the simulation returns
+  checkpoint_writer_.wait();
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::configure_linear_solvers()
+{
+  const int dimension = viennagrid::result_of::geometric_dimension<MeshType>::value;
+
+  linear_solver_.clear_pde_settings();
+  for(std::size_t pde_index = 0; pde_index < pde_system_.size(); pde_index++)
+  {
+    std::string solver, preconditioner;
+    if(!config_.linear_solver(dimension, pde_index, solver, preconditioner))
+      continue;
+
+    long solver_id = LinerSolverType::solver_id(solver);
+    long pc_id     = LinerSolverType::preconditioner_id(preconditioner);
+    if(solver_id < 0 || pc_id < 0)
+    {
+      viennautils::log::err() << "[Warning] ViennaMini: unknown linear solver " << solver << " / " << preconditioner
+                << " for quantity " << pde_index << ", using the default" << std::endl;
+      continue;
+    }
+    linear_solver_.set_pde_settings(pde_index, solver_id, pc_id);
+  }
+
+  if(config_.capture_prefix().empty())
+    linear_solver_.set_capture("");
+  else
+  {
+    std::stringstream prefix;
+    prefix << config_.capture_prefix() << "_" << dimension << "d";
+    linear_solver_.set_capture(prefix.str());
+  }
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::run_bias_ramping(NumericType start_fraction)
+{
+  IndicesType& contact_segments = device_.contact_segments();
+
+  NumericType max_bias = 0.0;
+  for(typename IndicesType::iterator iter = contact_segments.begin();
+      iter != contact_segments.end(); iter++)
+  {
+    max_bias = std::max(max_bias, std::abs(config_.contact_value(*iter)));
+  }
+
+  // a single step suffices ..
+  if(max_bias <= config_.bias_step())
+  {
+    this->solve_bias_step(1.0);
+    return;
+  }
+
+  // the step sizes are configured in Volt, the ramping works on the fraction of the contact potentials
+  const NumericType max_step = config_.bias_step()         / max_bias;
+  const NumericType min_step = config_.minimal_bias_step() / max_bias;
+
+  // start from the equilibrium solution, or from the bias step a cancelled simulation was solving for
+  this->apply_contact_potentials(start_fraction);
+  this->solve_bias_step(start_fraction);
+  if(cancelled_) return;
+
+  std::vector< std::vector<NumericType> > previous_iterates(pde_system_.size());
+
+  NumericType fraction = start_fraction;
+  NumericType step     = max_step;
+  while(fraction < 1.0)
+  {
+    NumericType next_fraction = std::min(NumericType(1.0), fraction + step);
+
+    for(std::size_t pde_index = 0; pde_index < pde_system_.size(); pde_index++)
+      viennafvm::backup_iterate(pde_system_, pde_index, device_.mesh(), device_.storage(), previous_iterates[pde_index]);
+
+    this->apply_contact_potentials(next_fraction);
+
+    bool converged = this->solve_bias_step(next_fraction);
+
+    // the iterates of the cancelled step are kept, the step is repeated by resume()
+    if(cancelled_) return;
+
+    if(converged)
+    {
+      fraction = next_fraction;
+      step     = std::min(max_step, 2.0 * step);
+    }
+    else if(step <= min_step)
+    {
+      // the step can not be subdivided any further, continue with the unconverged solution
+      viennautils::log::err() << "[Warning] ViennaMini: bias step to " << next_fraction * max_bias
+                << " V did not converge with the minimal step size" << std::endl;
+      fraction = next_fraction;
+    }
+    else
+    {
+      for(std::size_t pde_index = 0; pde_index < pde_system_.size(); pde_index++)
+        viennafvm::restore_iterate(pde_system_, pde_index, device_.mesh(), device_.storage(), previous_iterates[pde_index]);
+
+      step = std::max(min_step, 0.5 * step);
+    }
+  }
+}
+
+template <typename DeviceT, typename MatlibT>
+bool simulator<DeviceT, MatlibT>::solve_bias_step(NumericType bias_fraction)
+{
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::bias_step");
+
+  bias_fraction_ = bias_fraction;
   pde_solver_(pde_system_, device_.mesh(), device_.storage(), linear_solver_);
+
+  if(pde_solver_.cancelled())
+  {
+    // the iterates are consistent, but the cancelled iteration has to be repeated
+    if(this->checkpoints_enabled())
+    {
+      std::size_t iterations = pde_solver_.get_required_nonlinear_iterations();
+      this->save_checkpoint(iterations > 0 ? iterations - 1 : 0);
+    }
+
+    cancelled_               = true;
+    cancelled_bias_fraction_ = bias_fraction;
+    viennautils::log::out() << "* Simulation cancelled at " << bias_fraction * 100.0 << " % of the contact potentials" << std::endl;
+    return false;
+  }
+
+  bias_step_info info;
+  info.bias_fraction        = bias_fraction;
+  info.nonlinear_iterations = pde_solver_.get_required_nonlinear_iterations();
+  info.converged            = pde_solver_.converged();
+  for(std::size_t pde_index = 0; pde_index < pde_system_.size(); pde_index++)
+    info.damping.push_back(pde_solver_.get_last_damping(pde_index));
+  bias_steps_.push_back(info);
+
+#ifdef VIENNAFVM_VERBOSE
+  viennautils::log::out() << "* Bias step " << bias_steps_.size()-1 << " : " << bias_fraction * 100.0 << " % of the contact potentials, "
+            << info.nonlinear_iterations << " nonlinear iterations, damping";
+  for(std::size_t pde_index = 0; pde_index < info.damping.size(); pde_index++)
+    viennautils::log::out() << " " << info.damping[pde_index];
+  if(!info.converged) viennautils::log::out() << " ( not converged )";
+  viennautils::log::out() << std::endl;
+#endif
+
+  return info.converged;
+}
+
+template <typename DeviceT, typename MatlibT>
+bool simulator<DeviceT, MatlibT>::checkpoints_enabled()
+{
+  return !config_.checkpoint_file().empty() && config_.checkpoint_interval() > 0;
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::on_checkpoint(std::size_t iterations)
+{
+  if(iterations % config_.checkpoint_interval() == 0)
+    this->save_checkpoint(iterations);
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::save_checkpoint(std::size_t iterations)
+{
+  VIENNAUTILS_PROFILE_SCOPE("viennamini::checkpoint");
+
+  // only the copy of the state is done here, the file is written by the checkpoint writer
+  checkpoint_.dimension            = viennagrid::result_of::geometric_dimension<MeshType>::value;
+  checkpoint_.cells                = viennagrid::cells(device_.mesh()).size();
+  checkpoint_.settings             = config_;
+  checkpoint_.bias_fraction        = bias_fraction_;
+  checkpoint_.nonlinear_iterations = iterations;
+  checkpoint_.damping              = pde_solver_.get_current_damping();
+
+  // a cancellation may have happened before the first assembly has set up the mapping
+  viennafvm::create_mapping(pde_system_, device_.mesh(), device_.storage());
+
+  checkpoint_.iterates.resize(pde_system_.size());
+  checkpoint_.mappings.resize(pde_system_.size());
+  for(std::size_t pde_index = 0; pde_index < pde_system_.size(); pde_index++)
+  {
+    viennafvm::backup_iterate(pde_system_, pde_index, device_.mesh(), device_.storage(), checkpoint_.iterates[pde_index]);
+    viennafvm::backup_mapping(pde_system_, pde_index, device_.mesh(), device_.storage(), checkpoint_.mappings[pde_index]);
+  }
+
+  checkpoint_writer_.submit(config_.checkpoint_file(), checkpoint_);
+}
+
+template <typename DeviceT, typename MatlibT>
+typename simulator<DeviceT, MatlibT>::NumericType simulator<DeviceT, MatlibT>::contact_potential(std::size_t contact_segment_index, NumericType bias_fraction)
+{
+  NumericType value = bias_fraction * config_.contact_value(contact_segment_index) + config_.workfunction(contact_segment_index);
+
+  // a contact-semiconductor interface additionally requires the builtin-pot of the adjacent semiconductor
+  if(!isContactInsulatorInterface(contact_segment_index) && isContactSemiconductorInterface(contact_segment_index))
+  {
+    std::size_t adjacent_semiconductor_segment = contactSemiconductorInterfaces_[contact_segment_index];
+    value += viennamini::built_in_potential(config_.temperature(),
+                                            device_.donator(adjacent_semiconductor_segment),
+                                            device_.acceptor(adjacent_semiconductor_segment));
+  }
+  return value;
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::apply_contact_potentials(NumericType bias_fraction)
+{
+  IndicesType& contact_segments = device_.contact_segments();
+  for(typename IndicesType::iterator iter = contact_segments.begin();
+      iter != contact_segments.end(); iter++)
+  {
+    if(isContactInsulatorInterface(*iter) || isContactSemiconductorInterface(*iter))
+    {
+      viennafvm::set_dirichlet_boundary(device_.segment(*iter), device_.storage(), quantity_potential(),
+                                        contact_potential(*iter, bias_fraction));
+    }
+  }
 }
 
 template <typename DeviceT, typename MatlibT>
@@ -479,5 +983,37 @@ typename simulator<DeviceT, MatlibT>::VectorType const& simulator<DeviceT, Matli
   return pde_solver_.result();
 }
 
+template <typename DeviceT, typename MatlibT>
+typename simulator<DeviceT, MatlibT>::BiasStepsType const& simulator<DeviceT, MatlibT>::bias_steps() const
+{
+  return bias_steps_;
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::set_observer(viennafvm::solver_observer* observer)
+{
+  pde_solver_.set_observer(observer);
+  linear_solver_.set_observer(observer);
+}
+
+template <typename DeviceT, typename MatlibT>
+void simulator<DeviceT, MatlibT>::set_cancellation_token(viennafvm::cancellation_token const* token)
+{
+  pde_solver_.set_cancellation_token(token);
+  linear_solver_.set_cancellation_token(token);
+}
+
+template <typename DeviceT, typename MatlibT>
+bool simulator<DeviceT, MatlibT>::cancelled() const
+{
+  return cancelled_;
+}
+
+template <typename DeviceT, typename MatlibT>
+typename simulator<DeviceT, MatlibT>::NumericType simulator<DeviceT, MatlibT>::cancelled_bias_fraction() const
+{
+  return cancelled_bias_fraction_;
+}
+
 } // viennamini
 
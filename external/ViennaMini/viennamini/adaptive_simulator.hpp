@@ -0,0 +1,223 @@
+#ifndef VIENNAMINI_ADAPTIVE_SIMULATOR_HPP
+#define VIENNAMINI_ADAPTIVE_SIMULATOR_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMini - The Vienna Device Simulator
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+#include "viennagrid/algorithm/refine.hpp"
+
+#include "viennamini/simulator.hpp"
+#include "viennamini/solution_transfer.hpp"
+#include "viennautils/log.hpp"
+
+namespace viennamini {
+
+/**
+    @brief Runs a simulation in a solve-estimate-mark-refine loop: after each simulation the cells
+    whose error indicator (see simulator::compute_error_indicator()) exceeds config::refinement_tolerance()
+    are refined, the segment membership is carried over to the refined mesh, and the next simulation
+    starts from the previous solution interpolated onto the refined mesh. Hence the junctions are
+    resolved without refining the whole device up front.
+
+    The device of each level is set up by a functor, which is called with the device and has to assign
+    the materials, doping and contacts of the segments, as for a device with a fixed mesh.
+*/
+template<typename DeviceT, typename MatlibT>
+class adaptive_simulator
+{
+public:
+  typedef viennamini::simulator<DeviceT, MatlibT>                             SimulatorType;
+  typedef typename DeviceT::mesh_type                                         MeshType;
+  typedef typename DeviceT::segmentation_type                                 SegmentationType;
+  typedef typename DeviceT::storage_type                                      StorageType;
+  typedef typename DeviceT::numeric_type                                      NumericType;
+  typedef typename viennagrid::result_of::cell<MeshType>::type                CellType;
+  typedef viennamini::solution_transfer<MeshType>                             SolutionTransferType;
+
+  /**
+      @brief Convergence and refinement report of a refinement level
+  */
+  struct level_info
+  {
+    level_info() : cells(0), nonlinear_iterations(0), converged(false), max_indicator(0), refined_cells(0) {}
+
+    std::size_t   cells;
+    std::size_t   nonlinear_iterations;
+    bool          converged;
+    NumericType   max_indicator;
+    std::size_t   refined_cells;        // cells marked for the next level
+  };
+
+  /**
+      @brief The mesh, the segmentation, the matlib and the config are referenced, the mesh and
+      the segmentation are copied for the first level by operator()
+  */
+  adaptive_simulator(MeshType const& mesh, SegmentationType const& segmentation, MatlibT& matlib, viennamini::config& config) :
+    initial_mesh_(mesh), initial_segmentation_(segmentation), matlib_(matlib), config_(config), current_(NULL) {}
+
+  ~adaptive_simulator() { delete current_; }
+
+  /**
+      @brief Runs the refinement loop, 'setup' is called with the device of each level. Returns true
+      if the error indicator has reached the tolerance and the last simulation has converged
+  */
+  template<typename SetupT>
+  bool operator()(SetupT setup)
+  {
+    levels_.clear();
+
+    // the first level is a copy of the initial mesh, i.e. a refinement without marked cells
+    std::vector<bool> flags;
+    std::auto_ptr<level> next(new level);
+    viennagrid::cell_refine(initial_mesh_, initial_segmentation_, next->mesh, next->segmentation, make_flags(flags));
+
+    std::auto_ptr<SolutionTransferType> previous;
+    std::vector<NumericType> indicator;
+    for(int level_index = 0; ; level_index++)
+    {
+      delete current_;
+      current_ = next.release();
+
+      current_->device = new DeviceT(current_->mesh, current_->segmentation, current_->storage);
+      setup(*current_->device);
+      current_->simulator = new SimulatorType(*current_->device, matlib_, config_);
+      current_->simulator->use_initial_guess(previous.get());
+      (*current_->simulator)();
+      previous.reset();
+
+      level_info info;
+      info.cells = viennagrid::cells(current_->mesh).size();
+      typename SimulatorType::BiasStepsType const& steps = current_->simulator->bias_steps();
+      for(std::size_t i = 0; i < steps.size(); i++)
+        info.nonlinear_iterations += steps[i].nonlinear_iterations;
+      info.converged = !steps.empty() && steps.back().converged;
+
+      current_->simulator->compute_error_indicator(indicator);
+      info.max_indicator = indicator.empty() ? 0 : *std::max_element(indicator.begin(), indicator.end());
+      info.refined_cells = mark(indicator, info.cells, flags);
+
+      bool refine = info.converged && info.refined_cells > 0 && level_index < config_.refinement_levels();
+      if(!refine) info.refined_cells = 0;
+      levels_.push_back(info);
+
+      viennautils::log::out() << "* refinement level " << level_index << ": " << info.cells << " cells, "
+                              << info.nonlinear_iterations << " nonlinear iterations, max. error indicator "
+                              << info.max_indicator << ", refining " << info.refined_cells << " cells" << std::endl;
+
+      if(!refine)
+      {
+        bool resolved = info.max_indicator <= config_.refinement_tolerance();
+        if(info.converged && !resolved)
+          viennautils::log::err() << "* adaptive_simulator: the error indicator exceeds the tolerance after "
+                                  << level_index << " refinements" << std::endl;
+        return info.converged && resolved;
+      }
+
+      previous.reset(new SolutionTransferType(current_->mesh));
+      current_->simulator->store_solution(*previous);
+
+      next.reset(new level);
+      viennagrid::cell_refine(current_->mesh, current_->segmentation, next->mesh, next->segmentation, make_flags(flags));
+    }
+  }
+
+  /**
+      @brief The device, the simulator and the mesh of the last level, valid after operator()
+  */
+  DeviceT&          device()    { return *current_->device; }
+  SimulatorType&    simulator() { return *current_->simulator; }
+  MeshType&         mesh()      { return current_->mesh; }
+
+  std::vector<level_info> const& levels() const { return levels_; }
+
+private:
+  adaptive_simulator(adaptive_simulator const&);
+  adaptive_simulator& operator=(adaptive_simulator const&);
+
+  typedef typename viennagrid::result_of::field<std::vector<bool>, CellType>::type  FlagFieldType;
+
+  /**
+      @brief A refinement level owns its mesh and everything set up on it
+  */
+  struct level
+  {
+    level() : segmentation(mesh), device(NULL), simulator(NULL) {}
+    ~level() { delete simulator; delete device; }
+
+    MeshType          mesh;
+    SegmentationType  segmentation;
+    StorageType       storage;
+    DeviceT*          device;
+    SimulatorType*    simulator;
+  };
+
+  static FlagFieldType make_flags(std::vector<bool>& flags) { return FlagFieldType(flags); }
+
+  /**
+      @brief Marks the cells above the tolerance. If refining all of them would exceed the maximum
+      number of cells, only the ones with the largest indicators are marked. Returns the number of marked cells
+  */
+  std::size_t mark(std::vector<NumericType> const& indicator, std::size_t cells, std::vector<bool>& flags) const
+  {
+    // a refined cell is split into 2^dimension cells, the conforming closure adds a few more
+    const std::size_t growth = (1 << viennagrid::result_of::geometric_dimension<MeshType>::value) - 1;
+    const std::size_t max_cells = static_cast<std::size_t>(std::max(config_.refinement_max_cells(), 0));
+    std::size_t budget = (max_cells > cells) ? (max_cells - cells) / (growth + 1) : 0;
+
+    std::vector<NumericType> above;
+    for(std::size_t c = 0; c < indicator.size(); c++)
+      if(indicator[c] > config_.refinement_tolerance())
+        above.push_back(indicator[c]);
+
+    NumericType threshold = config_.refinement_tolerance();
+    if(above.size() > budget)
+    {
+      if(budget == 0) above.clear();
+      else
+      {
+        std::nth_element(above.begin(), above.begin() + (budget-1), above.end(), std::greater<NumericType>());
+        threshold = above[budget-1];
+      }
+    }
+
+    flags.assign(indicator.size(), false);
+    std::size_t marked = 0;
+    for(std::size_t c = 0; c < indicator.size() && !above.empty(); c++)
+    {
+      if(indicator[c] > config_.refinement_tolerance() && indicator[c] >= threshold && marked < budget)
+      {
+        flags[c] = true;
+        ++marked;
+      }
+    }
+    return marked;
+  }
+
+  MeshType const&           initial_mesh_;
+  SegmentationType const&   initial_segmentation_;
+  MatlibT&                  matlib_;
+  viennamini::config&       config_;
+
+  level*                    current_;
+  std::vector<level_info>   levels_;
+};
+
+} // viennamini
+
+#endif
@@ -0,0 +1,169 @@
+#ifndef VIENNAMINI_CHECKPOINT_HPP
+#define VIENNAMINI_CHECKPOINT_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMini - The Vienna Device Simulator
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+
+#ifndef _WIN32
+  #include <pthread.h>
+#endif
+
+#include "viennamini/config.hpp"
+
+namespace viennamini {
+
+/**
+    @brief The state of a running simulation, from which it can be continued by
+    simulator::resume_from_checkpoint(). The iterates and the DOF mapping are stored
+    per quantity in cell iteration order, hence a checkpoint only fits the mesh it
+    has been written for
+*/
+struct checkpoint
+{
+  checkpoint() : dimension(0), cells(0), bias_fraction(1.0), nonlinear_iterations(0) {}
+
+  /**
+      @brief Exchanges the contents without copying the iterates
+  */
+  void swap(checkpoint& other)
+  {
+    std::swap(dimension, other.dimension);
+    std::swap(cells, other.cells);
+    std::swap(settings, other.settings);
+    std::swap(bias_fraction, other.bias_fraction);
+    std::swap(nonlinear_iterations, other.nonlinear_iterations);
+    damping.swap(other.damping);
+    iterates.swap(other.iterates);
+    mappings.swap(other.mappings);
+  }
+
+  int                                 dimension;
+  std::size_t                         cells;
+  viennamini::config                  settings;
+  double                              bias_fraction;          // fraction of the contact potentials being solved for
+  std::size_t                         nonlinear_iterations;   // completed nonlinear iterations of the bias step
+  std::vector<double>                 damping;                // damping of each quantity in the next nonlinear iteration
+  std::vector< std::vector<double> >  iterates;
+  std::vector< std::vector<long> >    mappings;
+};
+
+/**
+    @brief Writes a checkpoint in a compact binary format. The file is written under
+    a temporary name and renamed afterwards, so an existing checkpoint is only replaced
+    by a complete one. Returns false if the file could not be written
+*/
+bool write_checkpoint(std::string const& filename, checkpoint const& state);
+
+/**
+    @brief Reads a checkpoint written by write_checkpoint(), returns false if the file
+    can not be opened or is not a valid checkpoint
+*/
+bool read_checkpoint(std::string const& filename, checkpoint& state);
+
+namespace detail {
+
+  template<typename T>
+  void write_binary(std::ostream& stream, T const& value)
+  {
+    stream.write(reinterpret_cast<char const*>(&value), sizeof(T));
+  }
+
+  template<typename T>
+  bool read_binary(std::istream& stream, T& value)
+  {
+    return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+  }
+
+  inline void write_binary(std::ostream& stream, std::string const& value)
+  {
+    write_binary(stream, static_cast<unsigned long long>(value.size()));
+    stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+  }
+
+  // the length is checked against max_size before the string is allocated, such that a
+  // corrupted length can not request an arbitrary amount of memory
+  inline bool read_binary(std::istream& stream, std::string& value, unsigned long long max_size)
+  {
+    unsigned long long size;
+    if(!read_binary(stream, size) || size > max_size) return false;
+    value.resize(static_cast<std::size_t>(size));
+    return size == 0 || static_cast<bool>(stream.read(&value[0], static_cast<std::streamsize>(size)));
+  }
+
+} // detail
+
+/**
+    @brief Writes checkpoints from a background thread, such that the simulation only
+    pays for copying the iterates. If the thread is still busy with a checkpoint, a newer
+    one replaces the pending one, hence the file always receives the latest state.
+    The thread is started with the first checkpoint. Without pthreads (Windows), the
+    checkpoints are written synchronously
+*/
+class checkpoint_writer
+{
+public:
+  checkpoint_writer();
+
+  /**
+      @brief Waits for the pending checkpoint and stops the thread
+  */
+  ~checkpoint_writer();
+
+  /**
+      @brief Queues 'state' to be written to 'filename'. The contents of 'state' are taken
+      over, 'state' receives the buffers of an older checkpoint for reuse
+  */
+  void submit(std::string const& filename, checkpoint& state);
+
+  /**
+      @brief Blocks until all submitted checkpoints have been written
+  */
+  void wait();
+
+  /**
+      @brief The number of checkpoints written so far
+  */
+  std::size_t written() const;
+
+private:
+  checkpoint_writer(checkpoint_writer const&);
+  checkpoint_writer& operator=(checkpoint_writer const&);
+
+  bool write(std::string const& filename, checkpoint const& state);
+
+#ifndef _WIN32
+  static void* run(void* self);
+  void         loop();
+
+  pthread_t       thread_;
+  mutable pthread_mutex_t mutex_;
+  pthread_cond_t  condition_;
+  bool            started_;
+  bool            pending_;
+  bool            busy_;
+  bool            stop_;
+  std::string     filename_;
+  checkpoint      state_;
+#endif
+  std::size_t     written_;
+};
+
+} // viennamini
+
+#endif
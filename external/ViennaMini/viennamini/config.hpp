@@ -17,6 +17,8 @@
 
 #include <map>
 #include <vector>
+#include <string>
+#include <iosfwd>
 
 namespace viennamini {
 
@@ -26,6 +28,8 @@ struct config
   typedef int                                 IndexType;
   typedef std::vector<NumericType>            ValuesType;
   typedef std::map<std::size_t, NumericType>  SegmentValuesType;
+  typedef std::pair<std::string, std::string> LinearSolverType;     // solver and preconditioner name
+  typedef std::map<std::pair<int, std::size_t>, LinearSolverType>  LinearSolversType;  // (dimension, quantity) -> solver
 
   typedef NumericType       numeric_type;
   typedef IndexType         index_type;
@@ -40,10 +44,80 @@ struct config
   IndexType&    linear_iterations();
   NumericType&  linear_breaktol();
   NumericType&  damping();
+  bool&         adaptive_damping();
+  NumericType&  minimal_damping();
   IndexType&    initial_guess_smoothing_iterations();
 
+  /**
+      @brief If enabled, the contact potentials are ramped up from equilibrium in steps of
+      at most 'bias_step' Volt. Steps which do not converge are subdivided down to 'minimal_bias_step'
+  */
+  bool&         bias_ramping();
+  NumericType&  bias_step();
+  NumericType&  minimal_bias_step();
+
   void assign_contact(std::size_t segment_index, NumericType value, NumericType workfunction);
 
+  /**
+      @brief Uses the given linear solver and preconditioner (e.g. "bicgstab", "ilu0") for the
+      systems of a quantity (0: potential, 1: electron density, 2: hole density) in all dimensions.
+      Explicit assignments take precedence over a loaded solver recommendation
+  */
+  void assign_linear_solver(std::size_t quantity_index, std::string const& solver, std::string const& preconditioner);
+
+  /**
+      @brief Looks up the linear solver of a quantity for a device of the given dimension,
+      returns false if the default solver setup shall be used
+  */
+  bool linear_solver(int dimension, std::size_t quantity_index, std::string& solver, std::string& preconditioner) const;
+
+  /**
+      @brief Loads a solver recommendation written by viennamos_autotune. The recommendation
+      file given by the environment variable VIENNAMINI_SOLVER_RECOMMENDATION is loaded on construction
+  */
+  bool load_solver_recommendation(std::string const& filename);
+
+  /**
+      @brief If not empty, the first assembled systems of each quantity are written to
+      '<prefix>_<dimension>d_pde<quantity>_<number>.mtx', which serve as input for viennamos_autotune
+  */
+  std::string&  capture_prefix();
+
+  /**
+      @brief If not empty, the integrands of the equations are compiled to native code by the system compiler
+      and the kernels are cached in this directory, so repeated runs of the same model do not compile again.
+      Initialized from the environment variable VIENNAMINI_JIT_CACHE
+  */
+  std::string&  jit_cache();
+
+  /**
+      @brief If not empty and the interval is positive, the state of the simulation is written to this
+      file every 'checkpoint_interval' nonlinear iterations and when the simulation is cancelled.
+      The simulation can be continued from the file by simulator::resume_from_checkpoint()
+  */
+  std::string&  checkpoint_file();
+  IndexType&    checkpoint_interval();
+
+  /**
+      @brief Target of the adaptive refinement by adaptive_simulator: cells are refined until the
+      error indicator, the potential and log carrier density differences across a cell in units of
+      the thermal voltage, stays below the tolerance. At most 'refinement_levels' refinements are
+      performed and the refinement stops at 'refinement_max_cells' cells
+  */
+  NumericType&  refinement_tolerance();
+  IndexType&    refinement_levels();
+  IndexType&    refinement_max_cells();
+
+  /**
+      @brief Writes all settings in a binary format, as part of a checkpoint
+  */
+  void save(std::ostream& stream) const;
+
+  /**
+      @brief Reads the settings written by save(), returns false if the stream does not hold valid settings
+  */
+  bool load(std::istream& stream);
+
   NumericType& contact_value(std::size_t segment_index);
 
   NumericType& workfunction(std::size_t segment_index);
@@ -58,9 +132,23 @@ private:
   NumericType       nonlinear_breaktol_;
   NumericType       linear_breaktol_;
   NumericType       damping_;
+  bool              adaptive_damping_;
+  NumericType       minimal_damping_;
+  bool              bias_ramping_;
+  NumericType       bias_step_;
+  NumericType       minimal_bias_step_;
   SegmentValuesType segment_contact_values_;
   SegmentValuesType segment_contact_workfunctions_;
   bool              model_drift_diffusion_state_;
+  LinearSolversType linear_solvers_;
+  LinearSolversType recommended_linear_solvers_;
+  std::string       capture_prefix_;
+  std::string       jit_cache_;
+  std::string       checkpoint_file_;
+  IndexType         checkpoint_interval_;
+  NumericType       refinement_tolerance_;
+  IndexType         refinement_levels_;
+  IndexType         refinement_max_cells_;
 };
 
 
@@ -0,0 +1,73 @@
+#ifndef VIENNAMINI_DEVICE_SETUP_HPP
+#define VIENNAMINI_DEVICE_SETUP_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMini - The Vienna Device Simulator
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+#include <string>
+#include <vector>
+
+#include "viennamini/config.hpp"
+
+namespace viennamini {
+
+/**
+    @brief The name, material and role of a segment of a device, as set up in the ViennaMini
+    module of ViennaMOS and stored in its state files
+*/
+struct segment_setup
+{
+  segment_setup() : id(0), is_contact(false), contact(0), workfunction(0), is_oxide(false),
+                    is_semiconductor(false), donors(0), acceptors(0) {}
+
+  std::size_t   id;
+  std::string   name;
+  std::string   material;
+  bool          is_contact;
+  double        contact;
+  double        workfunction;
+  bool          is_oxide;
+  bool          is_semiconductor;
+  double        donors;
+  double        acceptors;
+};
+
+/**
+    @brief Assigns the segments to the device and the contact potentials to the config. A segment
+    flagged as contact is neither an oxide nor a semiconductor
+*/
+template<typename DeviceT>
+void setup_device(DeviceT& device, config& conf, std::vector<segment_setup> const& segments)
+{
+  for(std::size_t i = 0; i < segments.size(); i++)
+  {
+    segment_setup const& seg = segments[i];
+    device.assign_name(seg.id, seg.name);
+    device.assign_material(seg.id, seg.material);
+
+    if(seg.is_contact)
+    {
+      device.assign_contact(seg.id);
+      conf.assign_contact(seg.id, seg.contact, seg.workfunction);
+    }
+    else if(seg.is_oxide)
+      device.assign_oxide(seg.id);
+    else if(seg.is_semiconductor)
+      device.assign_semiconductor(seg.id, seg.donors, seg.acceptors);
+  }
+}
+
+} // viennamini
+
+#endif
@@ -32,6 +32,8 @@
 #include "viennafvm/io/vtk_writer.hpp"
 #include "viennafvm/boundary.hpp"
 #include "viennafvm/pde_solver.hpp"
+#include "viennafvm/cancellation.hpp"
+#include "viennafvm/jit.hpp"
 #include "viennafvm/initial_guess.hpp"
 #ifdef VIENNACL_WITH_OPENCL
 #include "viennafvm/viennacl_support.hpp"
@@ -44,6 +46,7 @@
 #include "viennagrid/algorithm/interface.hpp"
 #include "viennagrid/algorithm/voronoi.hpp"
 #include "viennagrid/algorithm/scale.hpp"
+#include "viennagrid/algorithm/centroid.hpp"
 
 // ViennaMath includes:
 #include "viennamath/expression.hpp"
@@ -65,11 +68,24 @@
 #include "viennamini/config.hpp"
 #include "viennamini/device.hpp"
 #include "viennamini/result_accessor.hpp"
+#include "viennamini/checkpoint.hpp"
+#include "viennamini/solution_transfer.hpp"
 
 namespace viennamini
 {
+    /**
+        @brief Convergence report of a single bias step of the simulation
+    */
+    struct bias_step_info
+    {
+      double                bias_fraction;        // fraction of the configured contact potentials
+      std::size_t           nonlinear_iterations;
+      std::vector<double>   damping;              // damping of each quantity in the last nonlinear iteration
+      bool                  converged;
+    };
+
     template<typename DeviceT, typename MatlibT>
-    class simulator
+    class simulator : private viennafvm::checkpoint_handler
     {
       public:
         typedef DeviceT                                                                         DeviceType;
@@ -101,6 +117,8 @@ namespace viennamini
 
         typedef boost::numeric::ublas::vector<NumericType>                                      VectorType;
         typedef std::map<std::size_t, std::size_t>                                              IndexMapType;
+        typedef std::vector<bias_step_info>                                                     BiasStepsType;
+        typedef viennamini::solution_transfer<MeshType>                                         SolutionTransferType;
 
 
         /**
@@ -118,6 +136,22 @@ namespace viennamini
         */
         void operator()();
 
+        /**
+            @brief Continues a cancelled simulation from the current iterates in the storage of
+            the device, i.e., no initial guesses are assigned. 'bias_fraction' is the fraction of
+            the contact potentials the cancelled simulation was solving for, see cancelled_bias_fraction()
+        */
+        void resume(NumericType bias_fraction = 1.0);
+
+        /**
+            @brief Continues a simulation from a checkpoint written to config::checkpoint_file(),
+            e.g. by a run which has crashed or has been cancelled. The settings, the iterates and the
+            state of the nonlinear solver are taken from the checkpoint, only the checkpoint settings
+            of the current config are kept. No initial guesses are assigned. Returns false if the
+            checkpoint can not be read or does not belong to the device
+        */
+        bool resume_from_checkpoint(std::string const& filename);
+
         /**
             @brief Writes the doping phi,n,p to a vtk file
         */
@@ -130,6 +164,28 @@ namespace viennamini
 
         void write_result(std::string filename = "viennamini_result");
 
+        /**
+            @brief Adds the potential and the carrier densities of the last simulation run to
+            'transfer', which has been created for the mesh of the device
+        */
+        void store_solution(SolutionTransferType& transfer);
+
+        /**
+            @brief The next simulation run starts from the solution in 'previous', interpolated onto
+            the mesh of the device, instead of the doping based initial guesses, see solution_transfer.
+            'previous' is not owned and has to be kept until the simulation has been prepared, NULL
+            restores the doping based guesses
+        */
+        void use_initial_guess(SolutionTransferType const* previous);
+
+        /**
+            @brief Computes the error indicator of each cell after a simulation run, indexed by the cell
+            ids: the variation of the potential in units of the thermal voltage and of the logarithms of
+            the carrier densities across the cell, i.e. the largest gradient at the facets to neighbouring
+            cells of the same segment times the cell size
+        */
+        void compute_error_indicator(std::vector<NumericType>& indicator);
+
 
     private:
 
@@ -152,8 +208,9 @@ namespace viennamini
             2. disable obsolete quantities
             3. assign initial guesses
             4. smooth initial guesses
+            The initial guesses are skipped, if 'initial_guesses' is false
         */
-        void prepare();
+        void prepare(bool initial_guesses = true);
 
         /**
             @brief Test whether the contact segment under test shares an interface with an insulator
@@ -169,9 +226,59 @@ namespace viennamini
 
         /**
             @brief Perform the device simulation. The device has been assigned an initial guess
-            and boundary conditions at this point.
+            and boundary conditions at this point. The bias ramping starts at 'start_fraction'
+            of the contact potentials.
+        */
+        void run(NumericType start_fraction = 0.0);
+
+        /**
+            @brief Ramp the contact potentials from equilibrium up to the configured values.
+            A bias step which does not converge is reverted and subdivided.
+        */
+        void run_bias_ramping(NumericType start_fraction);
+
+        /**
+            @brief Run the nonlinear solver for the currently applied contact potentials
+            and record the convergence behaviour. Returns true if the solver converged.
+        */
+        bool solve_bias_step(NumericType bias_fraction);
+
+        /**
+            @brief Computes the potential boundary value of a contact segment, where only
+            the given fraction of the contact potential is applied
+        */
+        NumericType contact_potential(std::size_t contact_segment_index, NumericType bias_fraction);
+
+        /**
+            @brief Assigns the potential boundary conditions of all contacts for the given fraction
+            of the contact potentials
+        */
+        void apply_contact_potentials(NumericType bias_fraction);
+
+        /**
+            @brief Applies the per-quantity linear solvers of the config, e.g. from a solver
+            recommendation, and the capture mode of the assembled systems
+        */
+        void configure_linear_solvers();
+
+        /**
+            @brief Called by the pde_solver after each completed nonlinear iteration, writes a
+            checkpoint every config::checkpoint_interval() iterations
+        */
+        void on_checkpoint(std::size_t iterations);
+
+        /**
+            @brief Copies the current state of the simulation and passes it to the checkpoint writer
         */
-        void run();
+        void save_checkpoint(std::size_t iterations);
+
+        bool checkpoints_enabled();
+
+        /**
+            @brief Overwrites the current iterates of the potential and the carrier densities with
+            the ones interpolated from the previous solution, see use_initial_guess()
+        */
+        void transfer_initial_guess();
 
     public:
         FunctionSymbolType quantity_potential()        const;
@@ -180,6 +287,34 @@ namespace viennamini
 
         VectorType const& result();
 
+        /**
+            @brief Convergence reports of all bias steps performed by the last simulation run
+        */
+        BiasStepsType const& bias_steps() const;
+
+        /**
+            @brief Registers an observer with the nonlinear and the linear solver, which is
+            notified about the progress of the simulation. The observer is not owned.
+        */
+        void set_observer(viennafvm::solver_observer* observer);
+
+        /**
+            @brief Registers a token with the nonlinear and the linear solver, by which another
+            thread can stop the simulation. The token is not owned.
+        */
+        void set_cancellation_token(viennafvm::cancellation_token const* token);
+
+        /**
+            @brief Returns whether the last simulation run has been cancelled
+        */
+        bool cancelled() const;
+
+        /**
+            @brief The fraction of the contact potentials the cancelled simulation was solving for,
+            to be passed to resume()
+        */
+        NumericType cancelled_bias_fraction() const;
+
     private:
         DeviceType            & device_;
         MatlibType            & matlib_;
@@ -188,10 +323,13 @@ namespace viennamini
         PDESystemType           pde_system_;
         PDESolverType           pde_solver_;
         LinerSolverType         linear_solver_;
+        viennafvm::jit_compiler jit_;
 
         IndexMapType contactSemiconductorInterfaces_;
         IndexMapType contactOxideInterfaces_;
 
+        BiasStepsType bias_steps_;
+
         viennamini::permittivity_key       eps_key_;
         viennamini::builtin_potential_key  builtin_key_;
         viennamini::donator_doping_key     ND_key_;
@@ -206,6 +344,15 @@ namespace viennamini
         QuantityType  mu_p_;
 
         int notfound_;
+
+        bool        cancelled_;
+        NumericType cancelled_bias_fraction_;
+
+        NumericType                   bias_fraction_;       // the bias step being solved for
+        viennamini::checkpoint        checkpoint_;
+        viennamini::checkpoint_writer checkpoint_writer_;
+
+        SolutionTransferType const*   initial_guess_;
     };
 }
 
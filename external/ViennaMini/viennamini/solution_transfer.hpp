@@ -0,0 +1,194 @@
+#ifndef VIENNAMINI_SOLUTION_TRANSFER_HPP
+#define VIENNAMINI_SOLUTION_TRANSFER_HPP
+
+/* =======================================================================
+   Copyright (c) 2011-2013, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                 ViennaMini - The Vienna Device Simulator
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                   weinbub@iue.tuwien.ac.at
+               (add your name here)
+
+   license:    see file LICENSE in the ViennaFVM base directory
+======================================================================= */
+
+#include <map>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "viennagrid/mesh/mesh.hpp"
+#include "viennagrid/algorithm/volume.hpp"
+#include "viennagrid/algorithm/spatial_index.hpp"
+
+namespace viennamini {
+
+/**
+    @brief Transfers the solution of a simulation to another mesh of the same device, e.g. a
+    refined one or one with a different oxide thickness, where it serves as initial guess.
+
+    The cell values of each quantity are averaged onto the vertices of the source mesh, weighted
+    by the cell volumes and only over the cells where the quantity is defined. At a point, the
+    vertex values of the source cell containing it are interpolated linearly. Carrier densities
+    are interpolated in log space, which keeps them positive and follows their exponential
+    variation across junctions. Points in source cells without the quantity, e.g. in an oxide
+    which has become thinner, or outside of the source mesh take the value of the nearest cell
+    with the quantity.
+*/
+template<typename MeshT>
+class solution_transfer
+{
+public:
+  typedef viennagrid::spatial_index<MeshT>        IndexType;
+  typedef typename IndexType::point_type          PointType;
+  typedef typename IndexType::index_type          CellIndexType;
+  typedef double                                  NumericType;
+
+  /**
+      @brief Copies the geometry of the source mesh, the mesh is not referenced afterwards
+  */
+  explicit solution_transfer(MeshT const& mesh) : index_(mesh)
+  {
+    typedef typename viennagrid::result_of::const_cell_range<MeshT>::type   CellRangeType;
+    typedef typename viennagrid::result_of::iterator<CellRangeType>::type   CellIteratorType;
+
+    CellRangeType cells(mesh);
+    volumes_.reserve(cells.size());
+    for(CellIteratorType cit = cells.begin(); cit != cells.end(); ++cit)
+      volumes_.push_back(viennagrid::volume(*cit));
+  }
+
+  std::size_t cell_count() const { return volumes_.size(); }
+
+  /**
+      @brief Adds the cell values of the quantity 'id' in cell iteration order. Only the cells
+      marked in 'defined' hold values of the quantity. If 'logarithmic' is set, the values are
+      interpolated in log space, then values not greater than zero are treated as undefined.
+      Returns false if the number of values does not match the source mesh
+  */
+  bool add_quantity(std::size_t id, std::vector<NumericType> const& values, std::vector<bool> const& defined, bool logarithmic)
+  {
+    if(values.size() != cell_count() || defined.size() != cell_count())
+      return false;
+
+    quantity& q   = quantities_[id];
+    q.logarithmic = logarithmic;
+    q.cell_values = values;
+    q.defined.assign(defined.begin(), defined.end());
+
+    std::vector<NumericType> weights(index_.vertex_count(), 0.0);
+    q.vertex_values.assign(index_.vertex_count(), 0.0);
+    for(std::size_t c = 0; c < cell_count(); c++)
+    {
+      if(logarithmic)
+      {
+        if(q.defined[c] && values[c] > 0.0)
+          q.cell_values[c] = std::log(values[c]);
+        else
+          q.defined[c] = false;
+      }
+      if(!q.defined[c]) continue;
+
+      CellIndexType const* vertices = index_.cell_vertices(static_cast<CellIndexType>(c));
+      for(int k = 0; k < IndexType::vertices_per_cell; k++)
+      {
+        q.vertex_values[vertices[k]] += volumes_[c] * q.cell_values[c];
+        weights[vertices[k]]         += volumes_[c];
+      }
+    }
+    for(std::size_t v = 0; v < weights.size(); v++)
+      if(weights[v] > 0.0) q.vertex_values[v] /= weights[v];
+
+    q.any_defined = std::find(q.defined.begin(), q.defined.end(), char(true)) != q.defined.end();
+    return true;
+  }
+
+  bool has_quantity(std::size_t id) const
+  {
+    return quantities_.find(id) != quantities_.end();
+  }
+
+  /**
+      @brief Interpolates the quantity 'id' at the given points. Returns false if the quantity
+      has not been added or is not defined in any source cell
+  */
+  bool interpolate(std::size_t id, std::vector<PointType> const& points, std::vector<NumericType>& values) const
+  {
+    typename std::map<std::size_t, quantity>::const_iterator it = quantities_.find(id);
+    if(it == quantities_.end() || !it->second.any_defined)
+      return false;
+    quantity const& q = it->second;
+
+    values.resize(points.size());
+    long count = static_cast<long>(points.size());
+#ifdef _OPENMP
+    #pragma omp parallel for
+#endif
+    for(long i = 0; i < count; i++)
+    {
+      NumericType value = interpolate(q, points[i]);
+      values[i] = q.logarithmic ? std::exp(value) : value;
+    }
+    return true;
+  }
+
+  std::size_t memory_size() const
+  {
+    std::size_t size = index_.memory_size() + volumes_.capacity() * sizeof(NumericType);
+    for(typename std::map<std::size_t, quantity>::const_iterator it = quantities_.begin(); it != quantities_.end(); ++it)
+      size += (it->second.cell_values.capacity() + it->second.vertex_values.capacity()) * sizeof(NumericType) + it->second.defined.capacity();
+    return size;
+  }
+
+private:
+  struct quantity
+  {
+    quantity() : logarithmic(false), any_defined(false) {}
+
+    bool                      logarithmic;
+    bool                      any_defined;
+    std::vector<char>         defined;          // per cell
+    std::vector<NumericType>  cell_values;      // per cell, logarithms for logarithmic quantities
+    std::vector<NumericType>  vertex_values;    // per vertex, averaged from the defined cells
+  };
+
+  NumericType interpolate(quantity const& q, PointType const& p) const
+  {
+    CellIndexType cell = index_.locate(p);
+    if(cell != IndexType::invalid_index() && q.defined[cell])
+    {
+      NumericType lambda[IndexType::vertices_per_cell];
+      index_.barycentric_coordinates(cell, p, lambda);
+
+      CellIndexType const* vertices = index_.cell_vertices(cell);
+      NumericType value = 0.0;
+      for(int k = 0; k < IndexType::vertices_per_cell; k++)
+        value += lambda[k] * q.vertex_values[vertices[k]];
+      return value;
+    }
+
+    // the nearest cell holding the quantity, the search is widened until one is found
+    std::vector<CellIndexType> nearest;
+    for(std::size_t k = 8; ; k *= 4)
+    {
+      index_.nearest(p, k, nearest);
+      for(std::size_t i = 0; i < nearest.size(); i++)
+        if(q.defined[nearest[i]])
+          return q.cell_values[nearest[i]];
+      if(k >= cell_count())
+        break;
+    }
+    return 0.0;   // not reached, as the quantity is defined in some cell
+  }
+
+  IndexType                           index_;
+  std::vector<NumericType>            volumes_;
+  std::map<std::size_t, quantity>     quantities_;
+};
+
+} // viennamini
+
+#endif
@@ -0,0 +1,251 @@
+/* =============================================================================
+   Copyright (c) 2010, 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                ViennaUtils - The Vienna Utilities Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                      weinbub@iue.tuwien.ac.at
+
+   license:    see file LICENSE in the base directory
+============================================================================= */
+
+
+#ifndef VIENNAUTILS_LOG_HPP
+#define VIENNAUTILS_LOG_HPP
+
+/** @file log.hpp
+    @brief Injectable log output of the solver libraries.
+
+    The libraries write their messages to viennautils::log::out() and viennautils::log::err().
+    By default these are std::cout and std::cerr. A viennautils::log::scoped_sink redirects
+    both streams of the calling thread to a sink, other threads are not affected. Hence
+    several simulations can run concurrently without redirecting the process-wide streams.
+
+    The ring_buffer_sink is a lock-free single-producer/single-consumer channel: the thread
+    which runs the simulation writes complete lines into it, another thread, e.g., the GUI,
+    drains it in batches. The producer never waits; if the consumer falls behind and the buffer
+    is full, lines are dropped and reported with the next drain.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "viennautils/platform.hpp"
+
+namespace viennautils {
+
+namespace log {
+
+//! receives the log output of a thread
+class sink
+{
+public:
+  virtual ~sink() {}
+  virtual void write(const char* data, std::size_t size) = 0;
+};
+
+//! a lock-free single-producer/single-consumer ring buffer of characters
+class ring_buffer_sink : public sink
+{
+public:
+  //! the capacity is rounded up to a power of two
+  explicit ring_buffer_sink(std::size_t capacity = 1 << 20)
+    : head_(0), tail_(0), dropped_(0), reported_(0), closed_(false)
+  {
+    std::size_t size = 1;
+    while(size < capacity) size <<= 1;
+    buffer_.resize(size);
+    mask_ = size - 1;
+  }
+
+  //! producer side: stores the data completely or drops it, never blocks
+  void write(const char* data, std::size_t size)
+  {
+    std::size_t head = head_;
+    std::size_t tail = tail_;
+    VIENNAUTILS_MEMORY_BARRIER(); // the consumer is done with everything before the tail
+    if(size > buffer_.size() - (head - tail))
+    {
+      dropped_ = dropped_ + size;
+      return;
+    }
+
+    std::size_t begin = head & mask_;
+    std::size_t first = std::min(size, buffer_.size() - begin);
+    std::memcpy(&buffer_[begin], data, first);
+    if(first < size)
+      std::memcpy(&buffer_[0], data + first, size - first);
+
+    VIENNAUTILS_MEMORY_BARRIER(); // publish the data before the new head
+    head_ = head + size;
+  }
+
+  //! consumer side: appends all available data to 'text', returns the number of appended characters
+  std::size_t drain(std::string& text)
+  {
+    std::size_t head = head_;
+    VIENNAUTILS_MEMORY_BARRIER(); // read the data after the head
+    std::size_t tail = tail_;
+    std::size_t size = head - tail;
+    std::size_t initial_size = text.size();
+
+    if(size > 0)
+    {
+      std::size_t begin = tail & mask_;
+      std::size_t first = std::min(size, buffer_.size() - begin);
+      text.append(&buffer_[begin], first);
+      if(first < size)
+        text.append(&buffer_[0], size - first);
+
+      VIENNAUTILS_MEMORY_BARRIER(); // release the space after the data has been read
+      tail_ = head;
+    }
+
+    std::size_t dropped = dropped_;
+    if(dropped != reported_)
+    {
+      std::ostringstream note;
+      note << "[" << dropped - reported_ << " characters of log output dropped]" << std::endl;
+      text += note.str();
+      reported_ = dropped;
+    }
+    return text.size() - initial_size;
+  }
+
+  //! producer side: signals that nothing is going to be written anymore
+  void close()
+  {
+    VIENNAUTILS_MEMORY_BARRIER();
+    closed_ = true;
+  }
+
+  //! consumer side: true if the producer is done, check before the final drain
+  bool closed() const
+  {
+    bool closed = closed_;
+    VIENNAUTILS_MEMORY_BARRIER();
+    return closed;
+  }
+
+private:
+  ring_buffer_sink(ring_buffer_sink const&);
+  ring_buffer_sink& operator=(ring_buffer_sink const&);
+
+  std::vector<char>       buffer_;
+  std::size_t             mask_;
+  volatile std::size_t    head_;      // written by the producer
+  volatile std::size_t    tail_;      // written by the consumer
+  volatile std::size_t    dropped_;   // written by the producer
+  std::size_t             reported_;  // consumer only
+  volatile bool           closed_;
+};
+
+//! a stream buffer which hands complete lines over to a sink
+class sink_buffer : public std::streambuf
+{
+public:
+  explicit sink_buffer(sink& target) : target_(target) {}
+  ~sink_buffer()
+  {
+    sync();
+    if(!line_.empty()) target_.write(line_.data(), line_.size());
+  }
+
+protected:
+  int_type overflow(int_type c)
+  {
+    if(c != traits_type::eof())
+    {
+      line_ += traits_type::to_char_type(c);
+      if(c == '\n') sync();
+    }
+    return traits_type::not_eof(c);
+  }
+
+  std::streamsize xsputn(const char* p, std::streamsize n)
+  {
+    line_.append(p, static_cast<std::size_t>(n));
+    if(std::memchr(p, '\n', static_cast<std::size_t>(n))) sync();
+    return n;
+  }
+
+  int sync()
+  {
+    // only complete lines are handed over, a trailing partial line waits for its end
+    std::string::size_type end = line_.rfind('\n');
+    if(end != std::string::npos)
+    {
+      target_.write(line_.data(), end + 1);
+      line_.erase(0, end + 1);
+    }
+    return 0;
+  }
+
+private:
+  sink&         target_;
+  std::string   line_;
+};
+
+namespace detail {
+
+//! the log stream of the calling thread, NULL if the thread writes to the standard streams
+inline std::ostream*& current()
+{
+  static VIENNAUTILS_THREAD_LOCAL std::ostream* stream = NULL;
+  return stream;
+}
+
+} // detail
+
+//! the stream for regular messages of the calling thread
+inline std::ostream& out()
+{
+  std::ostream* stream = detail::current();
+  return stream ? *stream : std::cout;
+}
+
+//! the stream for error messages of the calling thread
+inline std::ostream& err()
+{
+  std::ostream* stream = detail::current();
+  return stream ? *stream : std::cerr;
+}
+
+//! redirects out() and err() of the calling thread to a sink for the lifetime of the object
+class scoped_sink
+{
+public:
+  explicit scoped_sink(sink& target)
+    : buffer_(target), stream_(&buffer_), previous_(detail::current())
+  {
+    detail::current() = &stream_;
+  }
+
+  ~scoped_sink()
+  {
+    stream_.flush();
+    detail::current() = previous_;
+  }
+
+private:
+  scoped_sink(scoped_sink const&);
+  scoped_sink& operator=(scoped_sink const&);
+
+  sink_buffer     buffer_;
+  std::ostream    stream_;
+  std::ostream*   previous_;
+};
+
+} // log
+
+} // viennautils
+
+#endif
@@ -0,0 +1,36 @@
+/* =============================================================================
+   Copyright (c) 2010, 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                ViennaUtils - The Vienna Utilities Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                      weinbub@iue.tuwien.ac.at
+
+   license:    see file LICENSE in the base directory
+============================================================================= */
+
+
+#ifndef VIENNAUTILS_PLATFORM_HPP
+#define VIENNAUTILS_PLATFORM_HPP
+
+/** @file platform.hpp
+    @brief Thread-local storage and memory barriers of the supported compilers, shared by the log and the profiler.
+*/
+
+#ifdef _WIN32
+  #ifndef WIN32_LEAN_AND_MEAN
+    #define WIN32_LEAN_AND_MEAN
+  #endif
+  #include <windows.h>
+  #undef min
+  #undef max
+  #define VIENNAUTILS_THREAD_LOCAL __declspec(thread)
+  #define VIENNAUTILS_MEMORY_BARRIER() MemoryBarrier()
+#else
+  #define VIENNAUTILS_THREAD_LOCAL __thread
+  #define VIENNAUTILS_MEMORY_BARRIER() __sync_synchronize()
+#endif
+
+#endif
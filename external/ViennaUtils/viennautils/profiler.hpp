@@ -0,0 +1,378 @@
+/* =============================================================================
+   Copyright (c) 2010, 2011, Institute for Microelectronics, TU Wien
+   http://www.iue.tuwien.ac.at
+                             -----------------
+                ViennaUtils - The Vienna Utilities Library
+                             -----------------
+
+   authors:    Karl Rupp                          rupp@iue.tuwien.ac.at
+               Josef Weinbub                      weinbub@iue.tuwien.ac.at
+               Markus Bina                        bina@iue.tuwien.ac.at
+
+   license:    see file LICENSE in the base directory
+============================================================================= */
+
+
+#ifndef VIENNAUTILS_PROFILER_HPP
+#define VIENNAUTILS_PROFILER_HPP
+
+/** @file profiler.hpp
+    @brief A hierarchical scoped profiler.
+
+    Instrument a scope with VIENNAUTILS_PROFILE_SCOPE("name"). A named scope, created
+    by VIENNAUTILS_PROFILE_SCOPE_NAMED(var, "name"), can be closed before the end of the
+    enclosing block with VIENNAUTILS_PROFILE_STOP(var). The instrumentation
+    is only compiled in if VIENNAUTILS_WITH_PROFILER is defined, otherwise the macro
+    expands to nothing. Each thread records into its own event log, hence recording
+    does not require any locking. The reports have to be generated while no
+    instrumented code is running.
+*/
+
+#ifdef VIENNAUTILS_WITH_PROFILER
+
+#include <cstddef>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "viennautils/platform.hpp"
+
+#ifndef _WIN32
+  #include <sys/time.h>
+  #include <pthread.h>
+#endif
+
+namespace viennautils {
+
+namespace profiler {
+
+//! returns a wall clock time stamp in microseconds
+inline double now()
+{
+#ifdef _WIN32
+  LARGE_INTEGER freq, time;
+  QueryPerformanceFrequency(&freq);
+  QueryPerformanceCounter(&time);
+  return static_cast<double>(time.QuadPart) * 1.0e6 / static_cast<double>(freq.QuadPart);
+#else
+  struct timeval tval;
+  gettimeofday(&tval, NULL);
+  return static_cast<double>(tval.tv_sec) * 1.0e6 + static_cast<double>(tval.tv_usec);
+#endif
+}
+
+//! a minimal mutex, only used for registering threads and for the reports
+class mutex
+{
+public:
+#ifdef _WIN32
+  mutex()       { InitializeCriticalSection(&cs_); }
+  ~mutex()      { DeleteCriticalSection(&cs_); }
+  void lock()   { EnterCriticalSection(&cs_); }
+  void unlock() { LeaveCriticalSection(&cs_); }
+private:
+  CRITICAL_SECTION cs_;
+#else
+  mutex()       { pthread_mutex_init(&mutex_, NULL); }
+  ~mutex()      { pthread_mutex_destroy(&mutex_); }
+  void lock()   { pthread_mutex_lock(&mutex_); }
+  void unlock() { pthread_mutex_unlock(&mutex_); }
+private:
+  pthread_mutex_t mutex_;
+#endif
+};
+
+class scoped_lock
+{
+public:
+  scoped_lock(mutex& m) : m_(m) { m_.lock(); }
+  ~scoped_lock()                { m_.unlock(); }
+private:
+  mutex& m_;
+};
+
+//! a completed scope
+struct event
+{
+  const char*  name;
+  double       begin;     // [us]
+  double       end;       // [us]
+  std::size_t  depth;
+  std::size_t  sequence;  // order in which the scopes have been entered
+};
+
+//! the events recorded by a single thread
+struct thread_log
+{
+  thread_log(std::size_t id) : id(id), depth(0), sequence(0) {}
+
+  std::size_t         id;
+  std::size_t         depth;
+  std::size_t         sequence;
+  std::vector<event>  events;
+};
+
+//! aggregated timings of all scopes sharing the same call path
+struct node_statistics
+{
+  node_statistics() : calls(0), total(0) {}
+
+  std::size_t calls;
+  double      total;   // [us]
+};
+
+//! holds the event logs of all threads
+class registry
+{
+public:
+  typedef std::vector<std::string>                      PathType;
+  typedef std::map<PathType, node_statistics>           StatisticsType;
+
+  static registry& instance()
+  {
+    static registry r;
+    return r;
+  }
+
+  //! returns the event log of the calling thread, a new one after the logs have been released
+  thread_log& local()
+  {
+    static VIENNAUTILS_THREAD_LOCAL thread_log* log        = NULL;
+    static VIENNAUTILS_THREAD_LOCAL std::size_t generation = 0;
+
+    // release() publishes the new generation with a barrier, the check needs no lock
+    std::size_t current = generation_;
+    VIENNAUTILS_MEMORY_BARRIER();
+    if(!log || generation != current)
+    {
+      scoped_lock lock(mutex_);
+      log = new thread_log(logs_.size());
+      logs_.push_back(log);
+      generation = generation_;
+    }
+    return *log;
+  }
+
+  //! discards all recorded events
+  void clear()
+  {
+    scoped_lock lock(mutex_);
+    for(std::size_t i = 0; i < logs_.size(); i++)
+    {
+      logs_[i]->events.clear();
+      logs_[i]->sequence = 0;
+    }
+    origin_ = now();
+  }
+
+  //! discards all recorded events and frees the event logs of all threads, including
+  //! the ones of threads which have terminated. No scope may be open in any thread
+  void release()
+  {
+    scoped_lock lock(mutex_);
+    for(std::size_t i = 0; i < logs_.size(); i++)
+      delete logs_[i];
+    logs_.clear();
+    generation_ = generation_ + 1;
+    VIENNAUTILS_MEMORY_BARRIER();
+    origin_ = now();
+  }
+
+  //! aggregates the events of all threads along their call paths
+  StatisticsType statistics()
+  {
+    scoped_lock lock(mutex_);
+    StatisticsType stats;
+    for(std::size_t i = 0; i < logs_.size(); i++)
+    {
+      // the events are stored when a scope is left, restore the order in which they were entered
+      std::vector<event> events(logs_[i]->events);
+      std::sort(events.begin(), events.end(), event_order());
+
+      PathType path;
+      for(std::size_t ei = 0; ei < events.size(); ei++)
+      {
+        path.resize(events[ei].depth);
+        path.push_back(events[ei].name);
+
+        node_statistics& node = stats[path];
+        node.calls++;
+        node.total += events[ei].end - events[ei].begin;
+      }
+    }
+    return stats;
+  }
+
+  //! aggregates all scopes with the given name independent of their call path,
+  //! recursively nested scopes of the same name are only accounted once
+  node_statistics statistics(std::string const& name)
+  {
+    StatisticsType stats = statistics();
+    node_statistics result;
+    for(StatisticsType::const_iterator iter = stats.begin(); iter != stats.end(); iter++)
+    {
+      PathType const& path = iter->first;
+      if((path.back() == name) && (std::find(path.begin(), path.end()-1, name) == path.end()-1))
+      {
+        result.calls += iter->second.calls;
+        result.total += iter->second.total;
+      }
+    }
+    return result;
+  }
+
+  //! writes the hierarchical report, call paths of all threads are merged
+  void write_report(std::ostream& stream)
+  {
+    StatisticsType stats = statistics();
+
+    std::ios_base::fmtflags flags = stream.flags();
+    std::streamsize precision     = stream.precision();
+
+    stream << std::left << std::setw(48) << "scope" << std::right
+           << std::setw(10) << "calls" << std::setw(14) << "total [s]"
+           << std::setw(14) << "mean [s]" << std::setw(10) << "parent" << std::endl;
+
+    for(StatisticsType::const_iterator iter = stats.begin(); iter != stats.end(); iter++)
+    {
+      PathType const&        path = iter->first;
+      node_statistics const& node = iter->second;
+
+      std::string label(2*(path.size()-1), ' ');
+      label += path.back();
+
+      stream << std::left << std::setw(48) << label << std::right << std::fixed
+             << std::setw(10) << node.calls
+             << std::setw(14) << std::setprecision(6) << node.total * 1.0e-6
+             << std::setw(14) << std::setprecision(6) << node.total * 1.0e-6 / node.calls;
+
+      if(path.size() > 1)
+      {
+        StatisticsType::const_iterator parent = stats.find(PathType(path.begin(), path.end()-1));
+        if((parent != stats.end()) && (parent->second.total > 0))
+          stream << std::setw(9) << std::setprecision(1) << 100.0 * node.total / parent->second.total << "%";
+      }
+      stream << std::endl;
+    }
+
+    stream.flags(flags);
+    stream.precision(precision);
+  }
+
+  //! writes all events in the Chrome trace event format (chrome://tracing, Perfetto)
+  void write_chrome_trace(std::ostream& stream)
+  {
+    scoped_lock lock(mutex_);
+
+    std::ios_base::fmtflags flags = stream.flags();
+    std::streamsize precision     = stream.precision();
+    stream << std::fixed << std::setprecision(3);
+
+    stream << "{\"traceEvents\":[";
+    bool first = true;
+    for(std::size_t i = 0; i < logs_.size(); i++)
+    {
+      for(std::size_t ei = 0; ei < logs_[i]->events.size(); ei++)
+      {
+        event const& e = logs_[i]->events[ei];
+        if(!first) stream << ",";
+        first = false;
+        stream << "\n{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << logs_[i]->id
+               << ",\"ts\":" << e.begin - origin_ << ",\"dur\":" << e.end - e.begin << "}";
+      }
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+    stream.flags(flags);
+    stream.precision(precision);
+  }
+
+  bool write_chrome_trace(std::string const& filename)
+  {
+    std::ofstream stream(filename.c_str());
+    if(!stream) return false;
+    write_chrome_trace(stream);
+    return true;
+  }
+
+private:
+  struct event_order
+  {
+    bool operator()(event const& a, event const& b) const { return a.sequence < b.sequence; }
+  };
+
+  registry() : origin_(now()), generation_(1) {}
+  ~registry()
+  {
+    for(std::size_t i = 0; i < logs_.size(); i++)
+      delete logs_[i];
+  }
+
+  mutex                     mutex_;
+  std::vector<thread_log*>  logs_;
+  double                    origin_;
+  volatile std::size_t      generation_;   // incremented by release()
+};
+
+//! records the lifetime of the enclosing scope
+class scope
+{
+public:
+  //! the name has to outlive the profiler, i.e., typically a string literal
+  scope(const char* name) : log_(registry::instance().local()), stopped_(false)
+  {
+    event_.name     = name;
+    event_.depth    = log_.depth++;
+    event_.sequence = log_.sequence++;
+    event_.begin    = now();
+  }
+
+  ~scope() { stop(); }
+
+  //! closes the scope before it is destroyed, nested scopes have to be closed already
+  void stop()
+  {
+    if(stopped_) return;
+    stopped_   = true;
+    event_.end = now();
+    log_.depth--;
+    log_.events.push_back(event_);
+  }
+
+private:
+  thread_log& log_;
+  event       event_;
+  bool        stopped_;
+};
+
+inline void clear()                                       { registry::instance().clear(); }
+inline void release()                                     { registry::instance().release(); }
+inline void write_report(std::ostream& stream)            { registry::instance().write_report(stream); }
+inline void write_chrome_trace(std::ostream& stream)      { registry::instance().write_chrome_trace(stream); }
+inline bool write_chrome_trace(std::string const& file)   { return registry::instance().write_chrome_trace(file); }
+inline node_statistics statistics(std::string const& name){ return registry::instance().statistics(name); }
+
+} // end namespace profiler
+
+} // end namespace viennautils
+
+#define VIENNAUTILS_PROFILE_CONCAT_IMPL(a, b) a##b
+#define VIENNAUTILS_PROFILE_CONCAT(a, b)      VIENNAUTILS_PROFILE_CONCAT_IMPL(a, b)
+#define VIENNAUTILS_PROFILE_SCOPE(name) \
+  viennautils::profiler::scope VIENNAUTILS_PROFILE_CONCAT(viennautils_profile_scope_, __LINE__)(name)
+#define VIENNAUTILS_PROFILE_SCOPE_NAMED(var, name)  viennautils::profiler::scope var(name)
+#define VIENNAUTILS_PROFILE_STOP(var)               var.stop()
+
+#else
+
+#define VIENNAUTILS_PROFILE_SCOPE(name)
+#define VIENNAUTILS_PROFILE_SCOPE_NAMED(var, name)
+#define VIENNAUTILS_PROFILE_STOP(var)
+
+#endif
+
+#endif
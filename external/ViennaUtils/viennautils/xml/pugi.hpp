@@ -84,6 +84,16 @@ struct pugixml
       }            
    }
 
+   //! read a memory buffer, e.g., a mapped file; the buffer is copied once and can be released afterwards
+   void read(const void* buffer, std::size_t size)
+   {
+      pugi::xml_parse_result result = xml.load_buffer(buffer, size);
+      if(!result)
+      {
+         throw InvalidXmlFileException("Exception in XmlReader::read -> " + std::string(result.description()) );
+      }
+   }
+
    //! write an input file
    void write(std::ofstream& ostream)
    {
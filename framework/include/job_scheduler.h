@@ -0,0 +1,154 @@
+#ifndef JOB_SCHEDULER_H
+#define JOB_SCHEDULER_H
+
+/*
+ *
+ * Copyright (c) 2013, Institute for Microelectronics, TU Wien.
+ *
+ * This file is part of ViennaMOS     http://viennamos.sourceforge.net/
+ *
+ * Contact: Josef Weinbub             weinbub@iue.tuwien.ac.at
+ *
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+
+#include <QObject>
+#include <QThread>
+#include <QPointer>
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QElapsedTimer>
+
+namespace viennamos {
+
+/**
+ * @brief Resource hints of a job, evaluated by the JobScheduler
+ */
+struct JobHints
+{
+    JobHints(QString const& name = QString(), int threads = 0, void const* resource = NULL, int priority = 0)
+        : name(name), threads(threads), resource(resource), priority(priority) {}
+
+    QString      name;
+    int          threads;   // number of cores the job uses, 0 requests the default share of the budget
+    void const*  resource;  // jobs on the same resource, e.g., a device, run one after another
+    int          priority;  // jobs with a higher priority are started first
+};
+
+} // viennamos
+
+/**
+ * @brief Runs the jobs of the modules on a fixed pool of threads.
+ *
+ * The number of cores which are used by all running jobs never exceeds the core budget,
+ * further jobs are queued. A job is a worker object with a 'process()' slot, which emits
+ * a finished signal once the work is done. Before the processing starts, the worker's
+ * 'setThreadBudget(int)' slot, if available, is called with the number of cores the job
+ * may use. A job without a thread hint gets the default share, so that several of them
+ * run side by side. Running jobs can only be cancelled if the worker offers a thread-safe
+ * 'cancel()' slot.
+ */
+class JobScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Status { QUEUED, RUNNING, CANCELLING, FINISHED, CANCELLED };
+
+    struct Job
+    {
+        Job() : id(-1), status(QUEUED), threads(0), thread(NULL), runtime(0) {}
+
+        int                     id;
+        viennamos::JobHints     hints;
+        Status                  status;
+        int                     threads;      // the thread budget of the job
+        QPointer<QObject>       worker;
+        QPointer<QObject>       receiver;
+        QByteArray              slot_oncancel;
+        QThread*                thread;
+        QElapsedTimer           timer;
+        qint64                  runtime;      // [ms], of finished jobs
+    };
+
+    typedef std::map<int, Job>  Jobs;
+
+    /**
+     * @brief A zero core budget uses all cores of the machine
+     */
+    explicit JobScheduler(int core_budget = 0, QObject* parent = 0);
+    ~JobScheduler();
+
+    /**
+     * @brief Queues the worker, the scheduler takes ownership of it. The finished signal
+     * of the worker is connected to 'slot_onfinish' of 'receiver'. If the job is cancelled
+     * before it has been started, 'slot_oncancel' of 'receiver' is called instead.
+     * Returns the id of the job.
+     */
+    int submit(QObject* worker, const char* signal_finished,
+               QObject* receiver, const char* slot_onfinish, const char* slot_oncancel,
+               viennamos::JobHints const& hints);
+
+    /**
+     * @brief Cancels a queued or running job, returns false if the job
+     * is running and the worker does not support cancellation
+     */
+    bool cancel(int id);
+
+    /**
+     * @brief Returns true if a queued, running or cancelling job uses the resource
+     */
+    bool hasJobs(void const* resource) const;
+
+    /**
+     * @brief Removes the finished and cancelled jobs from the list
+     */
+    void clearFinished();
+
+    int           coreBudget() const { return budget; }
+    int           usedCores()  const { return used; }
+    Jobs const&   jobs()       const { return job_list; }
+    qint64        runtime(int id) const;
+
+    static QString statusName(Status status);
+
+signals:
+    void jobChanged(int id);
+    void jobsRemoved();
+
+private slots:
+    void jobFinished();
+
+private:
+    void schedule();
+    void start(Job& job);
+    bool resourceBusy(void const* resource) const;
+
+    Jobs                    job_list;
+    std::map<QObject*, int> job_of_worker;
+    QList<QThread*>         pool;
+    QList<QThread*>         idle;
+    int                     budget;
+    int                     used;
+    int                     default_share;  // the cores of a job without a thread hint
+    int                     next_id;
+};
+
+#endif // JOB_SCHEDULER_H
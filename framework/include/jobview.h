@@ -0,0 +1,72 @@
+#ifndef JOBVIEW_H
+#define JOBVIEW_H
+
+/*
+ *
+ * Copyright (c) 2013, Institute for Microelectronics, TU Wien.
+ *
+ * This file is part of ViennaMOS     http://viennamos.sourceforge.net/
+ *
+ * Contact: Josef Weinbub             weinbub@iue.tuwien.ac.at
+ *
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <map>
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QLabel>
+#include <QTimer>
+
+#include "job_scheduler.h"
+
+/**
+ * @brief Lists the jobs of the scheduler with their status and runtime,
+ * selected jobs can be cancelled
+ */
+class JobView : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit JobView(JobScheduler* scheduler, QWidget *parent = 0);
+
+private slots:
+    void updateJob(int id);
+    void rebuild();
+    void updateRuntimes();
+    void cancelSelected();
+    void clearFinished();
+
+private:
+    enum { COLUMN_NAME = 0, COLUMN_STATUS, COLUMN_THREADS, COLUMN_TIME, COLUMNS };
+
+    int  rowOf(int id);
+    void updateBudget();
+
+    JobScheduler*       scheduler;
+    QTableWidget*       table;
+    QLabel*             budget;
+    QPushButton*        pushButtonCancel;
+    QPushButton*        pushButtonClear;
+    QTimer*             timer;
+    std::map<int, int>  rows;   // job id -> table row
+};
+
+#endif // JOBVIEW_H
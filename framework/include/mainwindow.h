@@ -53,6 +53,8 @@
 #include "multiview.h"
 #include "screenshot.h"
 #include "license.h"
+#include "job_scheduler.h"
+#include "jobview.h"
 
 namespace Ui {
 class MainWindow;
@@ -136,6 +138,7 @@ private:
     QDockWidget*                    dockModules;
     QDockWidget*                    dockModuleConfig;
     QDockWidget*                    dockOutput;
+    QDockWidget*                    dockJobs;
     QListWidget*                    active_modules;
     QComboBox*                      comboBoxMeshRepresentations;
     QComboBox*                      comboBoxFieldViz;
@@ -143,6 +146,7 @@ private:
     QSpinBox*                       spinBoxVCRDelay;
     MultiView*                      multi_view;
     QElapsedTimer                   module_timer;
+    int                             running_modules;   // modules between module_begin and module_end(_error)
     ModuleQuanIndex                 module_quan_index;
     IndexMap                        meshrep_views;
     IndexMap                        quan_views;
@@ -150,6 +154,8 @@ private:
     Messenger*                      output;
     Screenshot*                     screenshot;
     License*                        license;
+    JobScheduler*                   scheduler;
+    JobView*                        jobs;
 
 
     QPushButton* pushButtonResetView;
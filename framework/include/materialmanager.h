@@ -5,8 +5,6 @@
 #include <QtCore>
 #include <QtGui>
 
-#include "xmlstreamio.h"
-
 #include "viennamaterials/library.hpp"
 #include "viennamaterials/kernels/pugixml.hpp"
 
@@ -28,15 +26,21 @@ public:
     void saveXMLFile(QString const& filename);
     Library& getLibrary();
 
+protected:
+    void showEvent(QShowEvent* event);
+
 private slots:
     void on_pushButtonClose_clicked();
     void on_pushButtonLoad_clicked();
     void on_pushButtonSave_clicked();
 
 private:
+    void populateTree();
+
     Ui::MaterialManager     *ui;
     QString                  material_file_str;
     Library                  library;
+    bool                     tree_populated;  // the tree is built from the library when the dialog is first shown
 };
 
 #endif // MATERIALMANAGER_H
@@ -27,6 +27,7 @@
  */
 
 #include <QPlainTextEdit>
+#include <QTimer>
 
 #include <iostream>
 #include <streambuf>
@@ -36,6 +37,7 @@
 #include "qdebugstream.h"
 
 #include "boost/shared_ptr.hpp"
+#include "viennautils/log.hpp"
 
 class Messenger : public QPlainTextEdit
 {
@@ -50,6 +52,12 @@ public:
     void releaseStreams();
     QPlainTextEdit* getPlainTextEditWidget();
 
+    typedef boost::shared_ptr<viennautils::log::ring_buffer_sink>  LogSinkPtr;
+
+    void attachLog(LogSinkPtr const& sink);
+
+private slots:
+    void drainLogs();
 
 private:
     typedef boost::shared_ptr<QDebugStream> DebugStreamsPtr;
@@ -57,6 +65,10 @@ private:
 
     DebugStreams    debug_streams;
     std::map<std::ostream*, bool>    stream_unifier;
+
+    std::vector<LogSinkPtr>   log_sinks;
+    QTimer*                   log_timer;
+    std::string               log_text;
 };
 
 #endif // MESSENGER_H
@@ -38,6 +38,7 @@
 #include "messenger.h"
 #include "materialmanager.h"
 #include "modulecontrol.h"
+#include "job_scheduler.h"
 
 class ModuleInterface : public QObject
 {
@@ -57,7 +58,8 @@ public:
     virtual void execute    () = 0;
 
     void setup(DataBase* central_db,         MultiView* central_multiview,
-               Messenger* central_messenger, MaterialManager* central_material_manager);
+               Messenger* central_messenger, MaterialManager* central_material_manager,
+               JobScheduler* central_scheduler);
     QWidget*                    get_widget();
     void                        register_module_widget(QWidget* widget);
 
@@ -135,6 +137,7 @@ public:
     MultiView*                  multiview;
     Messenger*                  messenger;
     MaterialManager*            material_manager;
+    JobScheduler*               scheduler;
 
     QuantitySet                 quantity_set;
     ModuleControl*              module_control_widget;
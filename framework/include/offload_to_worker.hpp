@@ -4,30 +4,24 @@
 #include <QThread>
 #include <QObject>
 
+#include "job_scheduler.h"
+
 namespace viennamos {
 
+/**
+ * @brief Queues the worker in the module's job scheduler. The worker's output is shown by the messenger,
+ * 'slot_onfinish' of the module is called when the worker is finished and 'slot_oncancel' if the job
+ * is cancelled before it has been started.
+ */
 template<typename Worker, typename Messenger, typename Module>
-void offload(Worker* worker, Messenger* messenger, const char* signal_finished, Module* module, const char* slot_onfinish)
+int offload(Worker* worker, Messenger* messenger, const char* signal_finished, Module* module, const char* slot_onfinish,
+            const char* slot_oncancel, JobHints const& hints)
 {
-    QThread* thread = new QThread;
-    worker->moveToThread(thread);
-
-    // signals/slot communication between threads need to use the
-    // queuedconnection mechanism! otherwise, it's unstable
+    // the worker writes its output into its own log sink, which is drained by the messenger
     //
-    QObject::connect(worker, SIGNAL(message(QString const&)),
-                     messenger->getPlainTextEditWidget(), SLOT(appendPlainText(QString const&)),
-                     Qt::QueuedConnection);
-    QObject::connect(worker, signal_finished,
-                     module, slot_onfinish,
-                     Qt::QueuedConnection);
-    QObject::connect(thread, SIGNAL(started()), worker, SLOT(process()));
-    QObject::connect(worker, signal_finished, thread, SLOT(quit()));
-    QObject::connect(worker, signal_finished, worker, SLOT(deleteLater()));
-    QObject::connect(thread, SIGNAL(finished()), thread, SLOT(deleteLater()));
-    QObject::connect(thread, SIGNAL(terminated()), thread, SLOT(deleteLater()));
-
-    thread->start();
+    messenger->attachLog(worker->logSink());
+
+    return module->scheduler->submit(worker, signal_finished, module, slot_onfinish, slot_oncancel, hints);
 }
 
 
@@ -27,6 +27,7 @@
  */
 
 #include <vector>
+#include <map>
 
 #include <QVTKWidget.h>
 #include <QObject>
@@ -34,6 +35,7 @@
 #include <QMessageBox>
 #include <QDebug>
 #include <QPaintEvent>
+#include <QTimer>
 
 
 #include <vtkPolyDataAlgorithm.h>
@@ -71,6 +73,11 @@
 #include <vtkOrientationMarkerWidget.h>
 #include <vtkMultiBlockDataSet.h>
 #include <vtkCompositeDataGeometryFilter.h>
+#include <vtkDataSetSurfaceFilter.h>
+#include <vtkPolyData.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkIntArray.h>
 
 // include ParaView's pimped VTK implementations
 #include "external/Paraview/vtkPVScalarBarActor.h"
@@ -78,6 +85,7 @@
 #include "external/Paraview/vtkPVAxesActor.h"
 
 #include "common.hpp"
+#include "snapshot_buffer.hpp"
 //#include "quantity_set.hpp"
 
 #include <boost/array.hpp>
@@ -135,9 +143,15 @@ public:
     vtkSmartPointer<ScalarBarActor>&   get_colorbar()   { return colorbar; }
     vtkSmartPointer<vtkCubeAxesActor>& get_cubeAxes()   { return cubeAxisActor; }
 
+    void  show_snapshots(viennamos::SnapshotBuffer* buffer, std::string const& key, std::string const& display_name, int fps = 5);
+    void  stop_snapshots();
+
 signals:
     void grid_updated();
 
+private slots:
+    void  poll_snapshot();
+
     // ---------------------------------------------------------------------
 private:
 
@@ -183,8 +197,37 @@ private:
       lut->Build();
     }
 
+    /**
+     * @brief The surface of a segment of the central domain, which is extracted once per mesh.
+     * The blocks of the local domain are these surfaces, the quantities of the central domain
+     * are gathered onto the surface when they are shown.
+     */
+    struct SurfaceCache
+    {
+        typedef std::map<std::string, unsigned long>              Stamps;
+        typedef std::map<std::string, std::pair<double, double> > Ranges;
+
+        vtkPointSet*                  source;         // the segment in the central domain, not owned
+        unsigned long                 points_mtime;   // detects a new mesh in the central domain
+        vtkIdType                     source_cells;
+        vtkSmartPointer<vtkIdList>    point_ids;      // surface point -> point of the source
+        vtkSmartPointer<vtkIdList>    cell_ids;       // surface cell  -> cell of the source
+        Stamps                        point_stamps;   // quantity -> modification time of the source array when gathered
+        Stamps                        cell_stamps;
+        Ranges                        point_ranges;   // quantity -> range of its values on the whole segment,
+        Ranges                        cell_ranges;    // not only on the surface
+    };
+    typedef std::vector<SurfaceCache>  SurfaceCaches;
+
+    bool surfaces_outdated();
+    void extract_surface(unsigned int si, vtkPointSet* segment);
+    void gather_quantity(unsigned int si, std::string const& key, int cell_lvl);
+    void quantity_range(unsigned int si, std::string const& key, int cell_lvl, double range[2]);
+
     void resetCameraParameters();
 
+    SurfaceCaches                                        surfaces;
+    bool                                                 surfaces_built;
     vtkSmartPointer<vtkMultiBlockDataSet>                local_domain;
     vtkSmartPointer<vtkMultiBlockDataSet>                central_domain;
     Mappers                                              mappers;
@@ -215,6 +258,11 @@ private:
 
     int state;
 
+    QTimer*                      snapshot_timer;
+    viennamos::SnapshotBuffer*   snapshot_buffer;
+    std::string                  snapshot_key;
+    std::string                  snapshot_display_name;
+
     static const int UNSET      = -1;
     static const int SOLID      = 0;
     static const int QUANTITY   = 1;
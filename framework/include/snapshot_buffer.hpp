@@ -0,0 +1,118 @@
+#ifndef SNAPSHOT_BUFFER_HPP
+#define SNAPSHOT_BUFFER_HPP
+
+/*
+ *
+ * Copyright (c) 2013, Institute for Microelectronics, TU Wien.
+ *
+ * This file is part of ViennaMOS     http://viennamos.sourceforge.net/
+ *
+ * Contact: Josef Weinbub             weinbub@iue.tuwien.ac.at
+ *
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <QMutex>
+#include <QMutexLocker>
+
+namespace viennamos {
+
+/**
+ * @brief An intermediate solution of a running simulation: per quantity and segment,
+ * the cell values in the iteration order of the segment's cells, i.e., the order
+ * of the cells of the corresponding block of the multiview's multigrid.
+ */
+struct Snapshot
+{
+    typedef std::vector<double>         Values;
+    typedef std::vector<Values>         SegmentValues;
+
+    Snapshot() : iteration(0) {}
+
+    std::size_t                 iteration;  // nonlinear iteration of the simulator
+    std::vector<std::string>    names;      // names of the cell quantities in the multigrid
+    std::vector<SegmentValues>  values;     // values[quantity][segment][cell]
+};
+
+/**
+ * @brief Hands the snapshots of a simulation running in a worker thread over to the GUI thread.
+ *
+ * The exchange is triple buffered: the worker fills the back buffer and publishes it,
+ * the GUI acquires the newest published snapshot. Both sides only swap buffer indices
+ * under the mutex, the data itself is never copied and neither side ever waits for the
+ * other one to finish reading or writing. Snapshots which are published faster than
+ * they are acquired are simply overwritten by newer ones.
+ */
+class SnapshotBuffer
+{
+public:
+    SnapshotBuffer() : back_(0), middle_(1), front_(2), fresh_(false) {}
+
+    /**
+     * @brief Returns the buffer to be filled by the worker, the buffer is
+     * exclusively owned by the worker until the next call to publish()
+     */
+    Snapshot& back() { return buffers_[back_]; }
+
+    /**
+     * @brief Makes the filled back buffer available to the reader
+     */
+    void publish()
+    {
+        QMutexLocker lock(&mutex_);
+        std::swap(back_, middle_);
+        fresh_ = true;
+    }
+
+    /**
+     * @brief Returns the newest published snapshot, or NULL if nothing has been
+     * published since the last call. The snapshot stays valid until the next call.
+     */
+    Snapshot const* acquire()
+    {
+        QMutexLocker lock(&mutex_);
+        if(!fresh_) return NULL;
+        std::swap(front_, middle_);
+        fresh_ = false;
+        return &buffers_[front_];
+    }
+
+    /**
+     * @brief Drops an unread snapshot, e.g., before a new simulation is started
+     */
+    void reset()
+    {
+        QMutexLocker lock(&mutex_);
+        fresh_ = false;
+    }
+
+private:
+    Snapshot    buffers_[3];
+    int         back_;
+    int         middle_;
+    int         front_;
+    bool        fresh_;
+    QMutex      mutex_;
+};
+
+} // viennamos
+
+#endif // SNAPSHOT_BUFFER_HPP
@@ -0,0 +1,273 @@
+/*
+ *
+ * Copyright (c) 2013, Institute for Microelectronics, TU Wien.
+ *
+ * This file is part of ViennaMOS     http://viennamos.sourceforge.net/
+ *
+ * Contact: Josef Weinbub             weinbub@iue.tuwien.ac.at
+ *
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "job_scheduler.h"
+
+#include <QMetaObject>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// extracts the method name of a SLOT() string, e.g., "1transferResult()" -> "transferResult"
+QByteArray method_name(const char* slot)
+{
+    QByteArray name(slot ? slot : "");
+    if(!name.isEmpty() && name[0] >= '0' && name[0] <= '9') name.remove(0, 1);
+    int paren = name.indexOf('(');
+    if(paren >= 0) name.truncate(paren);
+    return name;
+}
+
+bool has_method(QObject* object, const char* signature)
+{
+    return object->metaObject()->indexOfMethod(QMetaObject::normalizedSignature(signature)) >= 0;
+}
+
+// number of jobs without a thread hint which can run concurrently
+const int default_concurrency = 2;
+
+} // namespace
+
+JobScheduler::JobScheduler(int core_budget, QObject* parent) :
+    QObject(parent), used(0), next_id(0)
+{
+    budget = (core_budget > 0) ? core_budget : QThread::idealThreadCount();
+    if(budget < 1) budget = 1;
+    default_share = std::max(1, budget / default_concurrency);
+
+    // every running job occupies at least one core, hence the pool never needs more threads.
+    // the threads are started once and run an event loop, the workers are moved onto them
+    for(int i = 0; i < budget; i++)
+    {
+        QThread* thread = new QThread(this);
+        thread->start();
+        pool.push_back(thread);
+        idle.push_back(thread);
+    }
+}
+
+JobScheduler::~JobScheduler()
+{
+    // no further jobs are started while the queue is cancelled
+    budget = 0;
+    for(Jobs::iterator iter = job_list.begin(); iter != job_list.end(); iter++)
+        if(iter->second.status == QUEUED || iter->second.status == RUNNING)
+            cancel(iter->first);
+
+    // a running job, which can not be cancelled, delays the shutdown until it is finished
+    foreach(QThread* thread, pool)
+    {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+int JobScheduler::submit(QObject* worker, const char* signal_finished,
+                         QObject* receiver, const char* slot_onfinish, const char* slot_oncancel,
+                         viennamos::JobHints const& hints)
+{
+    Job job;
+    job.id            = next_id++;
+    job.hints         = hints;
+    job.status        = QUEUED;
+    job.threads       = (hints.threads > 0) ? std::min(hints.threads, budget) : default_share;
+    job.worker        = worker;
+    job.receiver      = receiver;
+    job.slot_oncancel = method_name(slot_oncancel);
+    job_list[job.id]  = job;
+    job_of_worker[worker] = job.id;
+
+    // signals/slot communication between threads need to use the
+    // queuedconnection mechanism! otherwise, it's unstable
+    //
+    QObject::connect(worker, signal_finished, receiver, slot_onfinish, Qt::QueuedConnection);
+    QObject::connect(worker, signal_finished, this, SLOT(jobFinished()), Qt::QueuedConnection);
+
+    emit jobChanged(job.id);
+    schedule();
+    return job.id;
+}
+
+bool JobScheduler::cancel(int id)
+{
+    Jobs::iterator iter = job_list.find(id);
+    if(iter == job_list.end()) return false;
+    Job& job = iter->second;
+
+    if(job.status == QUEUED)
+    {
+        job.status = CANCELLED;
+        if(job.worker)
+        {
+            job_of_worker.erase(job.worker);
+            job.worker->deleteLater(); // not yet moved to a pool thread
+        }
+        if(job.receiver && !job.slot_oncancel.isEmpty())
+            QMetaObject::invokeMethod(job.receiver, job.slot_oncancel.constData(), Qt::QueuedConnection);
+        emit jobChanged(id);
+        schedule(); // jobs waiting for the resource may start now
+        return true;
+    }
+    else if(job.status == RUNNING)
+    {
+        if(!job.worker || !has_method(job.worker, "cancel()")) return false;
+
+        // the cancel slot is called directly from this thread, the worker has to
+        // check the request within its processing loop
+        QMetaObject::invokeMethod(job.worker, "cancel", Qt::DirectConnection);
+        job.status = CANCELLING;
+        emit jobChanged(id);
+        return true;
+    }
+    return job.status == CANCELLING;
+}
+
+bool JobScheduler::hasJobs(void const* resource) const
+{
+    for(Jobs::const_iterator iter = job_list.begin(); iter != job_list.end(); iter++)
+    {
+        Status status = iter->second.status;
+        if((status == QUEUED || status == RUNNING || status == CANCELLING) && iter->second.hints.resource == resource)
+            return true;
+    }
+    return false;
+}
+
+void JobScheduler::clearFinished()
+{
+    for(Jobs::iterator iter = job_list.begin(); iter != job_list.end(); )
+    {
+        if(iter->second.status == FINISHED || iter->second.status == CANCELLED)
+            job_list.erase(iter++);
+        else
+            iter++;
+    }
+    emit jobsRemoved();
+}
+
+qint64 JobScheduler::runtime(int id) const
+{
+    Jobs::const_iterator iter = job_list.find(id);
+    if(iter == job_list.end()) return 0;
+    Job const& job = iter->second;
+    if(job.status == RUNNING || job.status == CANCELLING) return job.timer.elapsed();
+    return job.runtime;
+}
+
+QString JobScheduler::statusName(Status status)
+{
+    switch(status)
+    {
+        case QUEUED:     return "Queued";
+        case RUNNING:    return "Running";
+        case CANCELLING: return "Cancelling";
+        case FINISHED:   return "Finished";
+        case CANCELLED:  return "Cancelled";
+    }
+    return "Unknown";
+}
+
+void JobScheduler::jobFinished()
+{
+    QObject* worker = sender();
+    std::map<QObject*, int>::iterator witer = job_of_worker.find(worker);
+    if(witer == job_of_worker.end()) return;
+
+    Job& job = job_list[witer->second];
+    job_of_worker.erase(witer);
+
+    job.runtime = job.timer.elapsed();
+    job.status  = (job.status == CANCELLING) ? CANCELLED : FINISHED;
+
+    // the pool thread keeps running its event loop, so the worker can be deleted in there
+    worker->deleteLater();
+    used -= job.threads;
+    idle.push_back(job.thread);
+    job.thread = NULL;
+
+    emit jobChanged(job.id);
+    schedule();
+}
+
+bool JobScheduler::resourceBusy(void const* resource) const
+{
+    if(!resource) return false;
+    for(Jobs::const_iterator iter = job_list.begin(); iter != job_list.end(); iter++)
+    {
+        Job const& job = iter->second;
+        if((job.status == RUNNING || job.status == CANCELLING) && job.hints.resource == resource)
+            return true;
+    }
+    return false;
+}
+
+void JobScheduler::schedule()
+{
+    // the queued jobs by descending priority, jobs of the same priority in the order of submission
+    std::vector<std::pair<int, int> > queue;
+    for(Jobs::iterator iter = job_list.begin(); iter != job_list.end(); iter++)
+        if(iter->second.status == QUEUED)
+            queue.push_back(std::make_pair(-iter->second.hints.priority, iter->first));
+    std::sort(queue.begin(), queue.end());
+
+    for(std::size_t i = 0; i < queue.size(); i++)
+    {
+        Job& job = job_list[queue[i].second];
+
+        // a job waiting for its resource does not hold back the others
+        if(resourceBusy(job.hints.resource)) continue;
+
+        // .. but one waiting for cores does, otherwise large jobs would starve
+        if(job.threads > budget - used) break;
+
+        start(job);
+    }
+}
+
+void JobScheduler::start(Job& job)
+{
+    if(!job.worker)
+    {
+        job.status = CANCELLED;
+        emit jobChanged(job.id);
+        return;
+    }
+
+    job.thread = idle.front();
+    idle.pop_front();
+    used += job.threads;
+
+    job.status = RUNNING;
+    job.timer.start();
+
+    job.worker->moveToThread(job.thread);
+    if(has_method(job.worker, "setThreadBudget(int)"))
+        QMetaObject::invokeMethod(job.worker, "setThreadBudget", Qt::QueuedConnection, Q_ARG(int, job.threads));
+    QMetaObject::invokeMethod(job.worker, "process", Qt::QueuedConnection);
+
+    emit jobChanged(job.id);
+}
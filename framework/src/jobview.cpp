@@ -0,0 +1,147 @@
+/*
+ *
+ * Copyright (c) 2013, Institute for Microelectronics, TU Wien.
+ *
+ * This file is part of ViennaMOS     http://viennamos.sourceforge.net/
+ *
+ * Contact: Josef Weinbub             weinbub@iue.tuwien.ac.at
+ *
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "jobview.h"
+
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+
+JobView::JobView(JobScheduler* scheduler, QWidget *parent) :
+    QWidget(parent), scheduler(scheduler)
+{
+    table = new QTableWidget(0, COLUMNS, this);
+    table->setHorizontalHeaderLabels(QStringList() << "Job" << "Status" << "Cores" << "Time [s]");
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->verticalHeader()->setVisible(false);
+    table->horizontalHeader()->setStretchLastSection(true);
+
+    budget = new QLabel(this);
+
+    pushButtonCancel = new QPushButton("Cancel", this);
+    pushButtonCancel->setToolTip("Cancel the selected jobs");
+    pushButtonClear = new QPushButton("Clear", this);
+    pushButtonClear->setToolTip("Remove the finished and cancelled jobs from the list");
+
+    QHBoxLayout* buttons = new QHBoxLayout;
+    buttons->addWidget(budget);
+    buttons->addStretch();
+    buttons->addWidget(pushButtonCancel);
+    buttons->addWidget(pushButtonClear);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(table);
+    layout->addLayout(buttons);
+
+    // the runtime of the running jobs is refreshed once per second
+    timer = new QTimer(this);
+    timer->start(1000);
+
+    QObject::connect(scheduler,         SIGNAL(jobChanged(int)), this, SLOT(updateJob(int)));
+    QObject::connect(scheduler,         SIGNAL(jobsRemoved()),   this, SLOT(rebuild()));
+    QObject::connect(timer,             SIGNAL(timeout()),       this, SLOT(updateRuntimes()));
+    QObject::connect(pushButtonCancel,  SIGNAL(clicked()),       this, SLOT(cancelSelected()));
+    QObject::connect(pushButtonClear,   SIGNAL(clicked()),       this, SLOT(clearFinished()));
+
+    rebuild();
+}
+
+int JobView::rowOf(int id)
+{
+    std::map<int, int>::iterator iter = rows.find(id);
+    if(iter != rows.end()) return iter->second;
+
+    int row = table->rowCount();
+    table->insertRow(row);
+    for(int column = 0; column < COLUMNS; column++)
+        table->setItem(row, column, new QTableWidgetItem);
+    rows[id] = row;
+    return row;
+}
+
+void JobView::updateJob(int id)
+{
+    JobScheduler::Jobs::const_iterator iter = scheduler->jobs().find(id);
+    if(iter == scheduler->jobs().end()) return;
+    JobScheduler::Job const& job = iter->second;
+
+    int row = rowOf(id);
+    table->item(row, COLUMN_NAME)->setText(job.hints.name.isEmpty() ? QString("Job %1").arg(id) : job.hints.name);
+    table->item(row, COLUMN_NAME)->setData(Qt::UserRole, id);
+    table->item(row, COLUMN_STATUS)->setText(JobScheduler::statusName(job.status));
+    table->item(row, COLUMN_THREADS)->setText(QString::number(job.threads));
+    table->item(row, COLUMN_TIME)->setText(job.status == JobScheduler::QUEUED ? QString("") :
+                                           QString::number(scheduler->runtime(id) / 1000.0, 'f', 1));
+    updateBudget();
+}
+
+void JobView::rebuild()
+{
+    table->setRowCount(0);
+    rows.clear();
+    for(JobScheduler::Jobs::const_iterator iter = scheduler->jobs().begin(); iter != scheduler->jobs().end(); iter++)
+        updateJob(iter->first);
+    updateBudget();
+}
+
+void JobView::updateRuntimes()
+{
+    for(JobScheduler::Jobs::const_iterator iter = scheduler->jobs().begin(); iter != scheduler->jobs().end(); iter++)
+        if(iter->second.status == JobScheduler::RUNNING || iter->second.status == JobScheduler::CANCELLING)
+            updateJob(iter->first);
+}
+
+void JobView::updateBudget()
+{
+    budget->setText(QString("Cores: %1 of %2 in use").arg(scheduler->usedCores()).arg(scheduler->coreBudget()));
+}
+
+void JobView::cancelSelected()
+{
+    QStringList refused;
+    QList<QTableWidgetItem*> items = table->selectedItems();
+    foreach(QTableWidgetItem* item, items)
+    {
+        if(item->column() != COLUMN_NAME) continue;
+
+        int id = item->data(Qt::UserRole).toInt();
+        JobScheduler::Jobs::const_iterator iter = scheduler->jobs().find(id);
+        if(iter == scheduler->jobs().end() ||
+           iter->second.status == JobScheduler::FINISHED || iter->second.status == JobScheduler::CANCELLED) continue;
+
+        if(!scheduler->cancel(id))
+            refused << item->text();
+    }
+    if(!refused.isEmpty())
+        QMessageBox::warning(this, "Warning", "The following jobs can not be cancelled:\n" + refused.join("\n"));
+}
+
+void JobView::clearFinished()
+{
+    scheduler->clearFinished();
+}
@@ -32,11 +32,17 @@
 #include <QLabel>
 #include <QTime>
 #include <QMainWindow>
+#include <QDir>
+
+#include <sstream>
+
+#include "viennautils/profiler.hpp"
 
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
-    ui(new Ui::MainWindow)
+    ui(new Ui::MainWindow),
+    running_modules(0)
 {
     ui->setupUi(this);
 
@@ -95,6 +101,17 @@ void MainWindow::create_widgets()
     output = new Messenger(this);
     dockOutput->setWidget(output);
 
+    // the simulation jobs of all modules share the cores of the machine
+    scheduler = new JobScheduler(0, this);
+    jobs = new JobView(scheduler, this);
+    dockJobs = new QDockWidget(tr("Jobs"), this);
+    dockJobs->setAllowedAreas(Qt::LeftDockWidgetArea);
+    dockJobs->setWidget(jobs);
+    addDockWidget(Qt::LeftDockWidgetArea, dockJobs);
+    tabifyDockWidget(dockOutput, dockJobs);
+    dockOutput->raise();
+    ui->menuView->insertAction(ui->actionActive_Modules, dockJobs->toggleViewAction());
+
     meshreps << key::surface << key::surfaceEdges << key::points << key::wireframe;
 
     comboBoxMeshRepresentations = new QComboBox(this);
@@ -224,7 +241,7 @@ void MainWindow::loadActiveModules(QList<QString>& modules)
     foreach(QString module, modules) {
 
         if(!avail_modules.value(module)) module_manager->recreate_module(module);
-        avail_modules[module]->setup(database, multi_view, output, material_manager);
+        avail_modules[module]->setup(database, multi_view, output, material_manager, scheduler);
 
         if(avail_modules[module]->is_ready()) ready_modules.append(module);
         else                                  unready_modules.append(module);
@@ -285,6 +302,12 @@ void MainWindow::show_module_widget(QListWidgetItem * item)
 void MainWindow::apply_module_begin(const QString &module)
 {
     module_timer.start();
+#ifdef VIENNAUTILS_WITH_PROFILER
+    // the thread logs are shared by all jobs, hence they are only released if no other job is recording
+    if(running_modules == 0)
+        viennautils::profiler::release();
+#endif
+    running_modules++;
     ui->statusBar->showMessage("running .." );
     //this->setCursor(Qt::WaitCursor);
     QApplication::setOverrideCursor(Qt::WaitCursor);
@@ -313,6 +336,21 @@ void MainWindow::apply_module_end(QString const& module)
     output->append("# ------------------------------------------------------------------------------------------");
     output->append("# [END] \""+module+"\" exec-time: "+QString::number(get_current_module_timer_seconds())+" s");
     output->append("# ------------------------------------------------------------------------------------------");
+    if(running_modules > 0) running_modules--;
+#ifdef VIENNAUTILS_WITH_PROFILER
+    // other running jobs are still writing to the thread logs, the report covers all jobs since the last idle state
+    if(running_modules == 0)
+    {
+        std::ostringstream report;
+        viennautils::profiler::write_report(report);
+        output->append(QString::fromStdString(report.str()));
+
+        QString tracefile = QDir::temp().filePath("viennamos_"+module+"_trace.json");
+        if(viennautils::profiler::write_chrome_trace(tracefile.toStdString()))
+            output->append("# profiling trace written to \""+tracefile+"\"");
+    }
+    else output->append("# profiling report deferred until the running jobs have finished");
+#endif
 
 
     // update the multiview: let the views know, that the data might have changed
@@ -375,6 +413,8 @@ void MainWindow::apply_module_end_error(QString const& module)
     output->append("# ------------------------------------------------------------------------------------------");
     output->append("# [ERROR] \""+module+"\" exec-time: "+QString::number(get_current_module_timer_seconds())+" s");
     output->append("# ------------------------------------------------------------------------------------------");
+
+    if(running_modules > 0) running_modules--;
 }
 
 
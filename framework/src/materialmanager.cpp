@@ -7,7 +7,8 @@
 
 MaterialManager::MaterialManager(QWidget *parent) :
     QDialog(parent),
-    ui(new Ui::MaterialManager)
+    ui(new Ui::MaterialManager),
+    tree_populated(false)
 {
     ui->setupUi(this);
     setWindowTitle("Material Manager");
@@ -35,26 +36,63 @@ MaterialManager::~MaterialManager()
 
 void MaterialManager::readXMLFile(QString const& filename)
 {
-    // populate the user interface
+    // the file is parsed only once, directly into the viennamaterial library.
+    // mapping avoids copying the file through a string, pugixml copies the
+    // buffer into its document, hence the mapping can be released right away
     //
-    XMLStreamIO xmlstream(ui->treeWidget);
-    xmlstream.load(filename);
-    for(int i = 0; i < ui->treeWidget->columnCount(); i++)
-        ui->treeWidget->resizeColumnToContents(i);
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+    {
+        QMessageBox::critical(this, "Error", "Can not open the material file " + filename + ": " + file.errorString());
+        return;
+    }
 
-    // transfer the resource file material xml file into a stringstream
-    //
-    QString result;
-    QFile file( filename );
-    if( file.open( QFile::ReadOnly ) ) {
-       QTextStream ts( &file );
-       result = ts.readAll();
+    uchar* buffer = file.map(0, file.size());
+    if(buffer)
+    {
+        library.load(reinterpret_cast<const char*>(buffer), file.size());
+        file.unmap(buffer);
     }
+    else // e.g., a compressed resource, which can not be mapped
+    {
+        QByteArray content = file.readAll();
+        library.load(content.constData(), content.size());
+    }
+    material_file_str = filename;
 
-    // load the viennamaterial library
+    // the user interface is built from the library when it is shown the next time
     //
-    std::stringstream stream(result.toStdString());
-    library.load(stream);
+    ui->treeWidget->clear();
+    tree_populated = false;
+    if(isVisible()) populateTree();
+}
+
+void MaterialManager::populateTree()
+{
+    Library::Entries materials = library.query("/materials//material[id]");
+    for(Library::EntryIterator material = materials.begin(); material != materials.end(); material++)
+    {
+        QTreeWidgetItem* id = new QTreeWidgetItem(ui->treeWidget->invisibleRootItem());
+        id->setText(0, QString::fromUtf8(material->node().child_value("id")));
+
+        pugi::xml_node parameters = material->node().child("parameters");
+        for(pugi::xml_node parameter = parameters.child("parameter"); parameter; parameter = parameter.next_sibling("parameter"))
+        {
+            QTreeWidgetItem* item = new QTreeWidgetItem(id);
+            item->setText(1, QString::fromUtf8(parameter.child_value("name")));
+            item->setText(2, QString::fromUtf8(parameter.child_value("value")));
+            item->setText(3, QString::fromUtf8(parameter.child_value("unit")));
+        }
+    }
+    for(int i = 0; i < ui->treeWidget->columnCount(); i++)
+        ui->treeWidget->resizeColumnToContents(i);
+    tree_populated = true;
+}
+
+void MaterialManager::showEvent(QShowEvent* event)
+{
+    if(!tree_populated) populateTree();
+    QDialog::showEvent(event);
 }
 
 void MaterialManager::saveXMLFile(QString const& filename)
@@ -73,7 +111,6 @@ void MaterialManager::on_pushButtonLoad_clicked()
     //QString filename = "/home/weinbub/git/ViennaMaterials/database/materials.xml";
     if(filename.isEmpty()) return; // if the cancel button has been clicked ..
     else {
-        ui->treeWidget->clear();
         readXMLFile(filename);
     }
 }
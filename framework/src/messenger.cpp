@@ -33,6 +33,11 @@ Messenger::Messenger(QWidget *parent) :
     setReadOnly(true);
     setStyleSheet("background-color: lightgray");
     setBackgroundVisible(true);
+
+    // the logs of the workers are drained in batches at a fixed rate,
+    // so the amount of output does not affect the responsiveness of the GUI
+    log_timer = new QTimer(this);
+    QObject::connect(log_timer, SIGNAL(timeout()), this, SLOT(drainLogs()));
 }
 
 Messenger::~Messenger()
@@ -44,6 +49,39 @@ void Messenger::append(QString const& msg)
     appendPlainText(msg);
 }
 
+/**
+ * @brief Shows the output written to 'sink' by a worker thread. The sink is
+ * detached automatically after it has been closed by the worker and drained.
+ */
+void Messenger::attachLog(LogSinkPtr const& sink)
+{
+    log_sinks.push_back(sink);
+    if(!log_timer->isActive())
+        log_timer->start(100);
+}
+
+void Messenger::drainLogs()
+{
+    log_text.clear();
+    for(std::vector<LogSinkPtr>::iterator iter = log_sinks.begin(); iter != log_sinks.end(); )
+    {
+        // check for the closing before the draining, otherwise the last lines could be missed
+        bool closed = (*iter)->closed();
+        (*iter)->drain(log_text);
+        if(closed) iter = log_sinks.erase(iter);
+        else       iter++;
+    }
+    if(log_sinks.empty())
+        log_timer->stop();
+
+    if(log_text.empty()) return;
+
+    // the text is appended as a new paragraph, hence the final line break is dropped
+    if(log_text[log_text.size()-1] == '\n')
+        log_text.erase(log_text.size()-1);
+    appendPlainText(QString::fromStdString(log_text));
+}
+
 QPlainTextEdit* Messenger::getPlainTextEditWidget()
 {
     return this;
@@ -27,6 +27,7 @@ ModuleInterface::ModuleInterface(ModuleInterface* child) : child(child)
     multiview        = NULL;
     messenger        = NULL;
     material_manager = NULL;
+    scheduler        = NULL;
 }
 
 ModuleInterface::~ModuleInterface()
@@ -36,18 +37,19 @@ ModuleInterface::~ModuleInterface()
 }
 
 void ModuleInterface::setup(DataBase* central_db,         MultiView* central_multiview,
-           Messenger* central_messenger, MaterialManager* central_material_manager)
+           Messenger* central_messenger, MaterialManager* central_material_manager,
+           JobScheduler* central_scheduler)
 {
     database         = central_db;
     multiview        = central_multiview;
     messenger        = central_messenger;
     material_manager = central_material_manager;
+    scheduler        = central_scheduler;
     emit base_data_ready();
 }
 
 void ModuleInterface::pre_execute()
 {
-    module_control_widget->deactivate();
     emit module_begin(child->name());
     child->execute();
 }
@@ -55,13 +57,11 @@ void ModuleInterface::pre_execute()
 void ModuleInterface::post_execute()
 {
     emit module_end(child->name());
-    module_control_widget->activate();
 }
 
 void ModuleInterface::report_error()
 {
     emit module_end_error(this->name());
-    module_control_widget->activate();
 }
 
 QWidget* ModuleInterface::get_widget()
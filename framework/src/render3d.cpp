@@ -25,6 +25,8 @@
 
 #include "render3d.h"
 
+#include <algorithm>
+
 #include <QRegion>
 #include <QStyleOption>
 #include <QPainter>
@@ -37,6 +39,7 @@
 Render3D::Render3D(vtkSmartPointer<vtkMultiBlockDataSet> domain, QWidget *parent)
     : QVTKWidget(parent)
 {
+  surfaces_built = false;
   local_domain = vtkSmartPointer<vtkMultiBlockDataSet>::New();
   central_domain = domain;
   local_domain_geom = vtkSmartPointer<vtkCompositeDataGeometryFilter>::New();
@@ -46,6 +49,11 @@ Render3D::Render3D(vtkSmartPointer<vtkMultiBlockDataSet> domain, QWidget *parent
   use_log = false; // by default, use linear scaling
   state = SOLID; // by default, we color the mesh solid
 
+  // intermediate solutions of running simulations are polled, so the worker never waits for the GUI
+  snapshot_buffer = NULL;
+  snapshot_timer = new QTimer(this);
+  QObject::connect(snapshot_timer, SIGNAL(timeout()), this, SLOT(poll_snapshot()));
+
 //  mapper = Mapper::New();
 //  actor = vtkActor::New();
 //  actor->SetMapper(mapper);
@@ -173,46 +181,28 @@ void Render3D::reset_grid()
     reset_renderer();
     mappers.clear();
     actors.clear();
+    surfaces.clear();
+    surfaces_built = false;
     local_domain->PrepareForNewData();
 }
 
 void Render3D::update_render_domain()
 {
+    // the surfaces are only extracted once per mesh, a quantity transferred
+    // to the central domain is gathered onto them when it is shown
+    //
+    if(!this->surfaces_outdated()) return;
+
     this->reset_grid();
 
-    // make sure that we work on a local copy in this render view
-    // so we don't have some 'crosstalk'.
-    // this crosstalk manifests due to the fact that during coloring vertex/cell data,
-    // we have to set an 'active' array. this is a vtk thing. The problem is now,
-    // when we work on a 'shared' grid, that one renderer sets a different active grid
-    // as another renderer -> hence 'crosstalk'
+    // the local domain holds the surfaces of the central domain's segments. as these
+    // are owned by this render view, setting the 'active' array while coloring
+    // does not lead to 'crosstalk' between render views sharing the central domain.
+    // for 3D devices, only the outer and interface surfaces are pushed to the mappers
     //
-    local_domain->DeepCopy(central_domain);
-
-    for(unsigned int si = 0; si < local_domain->GetNumberOfBlocks(); si++)
-    {
-        vtkPointSet* segment = vtkPointSet::SafeDownCast(local_domain->GetBlock(si));
-
-        mappers.push_back(Mapper::New());
-    #if VTK_MAJOR_VERSION <= 5
-        mappers.back()->SetInputConnection(segment->GetProducerPort());
-    #else
-        mapper->SetInputData(local_domain);
-    #endif
-        actors.push_back(Actor::New());
-        actors.back()->SetMapper(mappers.back());
-        actors.back()->GetProperty()->SetColor(0.0, 0.0, 1.0); // default color blue
-        renderer->AddActor(actors.back());
-
-        // color the segments by assigning the segment ID as cell quantity
-        //
-        vtkIntArray* segment_array = vtkIntArray::New();
-        segment_array->SetName(key::segment_index.toStdString().c_str());
-        segment_array->SetNumberOfValues(segment->GetNumberOfCells());
-        for(int ci = 0; ci < segment->GetNumberOfCells(); ci++)
-            segment_array->SetValue(ci, si);
-        segment->GetCellData()->AddArray(segment_array);
-    }
+    for(unsigned int si = 0; si < central_domain->GetNumberOfBlocks(); si++)
+        this->extract_surface(si, vtkPointSet::SafeDownCast(central_domain->GetBlock(si)));
+    surfaces_built = true;
 
     local_domain->Update();
     local_domain_geom->Update();
@@ -224,6 +214,147 @@ void Render3D::update_render_domain()
     emit grid_updated();
 }
 
+bool Render3D::surfaces_outdated()
+{
+    if(!surfaces_built || (surfaces.size() != central_domain->GetNumberOfBlocks())) return true;
+
+    for(unsigned int si = 0; si < central_domain->GetNumberOfBlocks(); si++)
+    {
+        vtkPointSet* segment = vtkPointSet::SafeDownCast(central_domain->GetBlock(si));
+        SurfaceCache const& cache = surfaces[si];
+
+        // a new mesh comes with new points, whose modification time is newer
+        if((segment != cache.source) || (segment->GetNumberOfCells() != cache.source_cells) ||
+           ((segment->GetPoints() ? segment->GetPoints()->GetMTime() : 0) != cache.points_mtime))
+            return true;
+    }
+    return false;
+}
+
+void Render3D::extract_surface(unsigned int si, vtkPointSet* segment)
+{
+    SurfaceCache cache;
+    cache.source       = segment;
+    cache.points_mtime = segment->GetPoints() ? segment->GetPoints()->GetMTime() : 0;
+    cache.source_cells = segment->GetNumberOfCells();
+    cache.point_ids    = vtkSmartPointer<vtkIdList>::New();
+    cache.cell_ids     = vtkSmartPointer<vtkIdList>::New();
+
+    // only the structure is passed to the filter, the quantities are gathered when they are shown
+    //
+    vtkSmartPointer<vtkDataSet> structure;
+    structure.TakeReference(segment->NewInstance());
+    structure->CopyStructure(segment);
+
+    vtkSmartPointer<vtkDataSetSurfaceFilter> filter = vtkSmartPointer<vtkDataSetSurfaceFilter>::New();
+#if VTK_MAJOR_VERSION <= 5
+    filter->SetInput(structure);
+#else
+    filter->SetInputData(structure);
+#endif
+    filter->PassThroughPointIdsOn();
+    filter->PassThroughCellIdsOn();
+    filter->Update();
+
+    vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+    surface->ShallowCopy(filter->GetOutput());
+
+    // keep the maps to the source, the arrays themselves shall not show up as quantities
+    //
+    vtkIdTypeArray* point_ids = vtkIdTypeArray::SafeDownCast(surface->GetPointData()->GetArray("vtkOriginalPointIds"));
+    vtkIdTypeArray* cell_ids  = vtkIdTypeArray::SafeDownCast(surface->GetCellData()->GetArray("vtkOriginalCellIds"));
+    cache.point_ids->SetNumberOfIds(point_ids ? point_ids->GetNumberOfTuples() : 0);
+    for(vtkIdType i = 0; i < cache.point_ids->GetNumberOfIds(); i++)
+        cache.point_ids->SetId(i, point_ids->GetValue(i));
+    cache.cell_ids->SetNumberOfIds(cell_ids ? cell_ids->GetNumberOfTuples() : 0);
+    for(vtkIdType i = 0; i < cache.cell_ids->GetNumberOfIds(); i++)
+        cache.cell_ids->SetId(i, cell_ids->GetValue(i));
+    surface->GetPointData()->RemoveArray("vtkOriginalPointIds");
+    surface->GetCellData()->RemoveArray("vtkOriginalCellIds");
+
+    // color the segments by assigning the segment ID as cell quantity
+    //
+    vtkSmartPointer<vtkIntArray> segment_array = vtkSmartPointer<vtkIntArray>::New();
+    segment_array->SetName(key::segment_index.toStdString().c_str());
+    segment_array->SetNumberOfValues(surface->GetNumberOfCells());
+    if(surface->GetNumberOfCells() > 0)
+        segment_array->FillComponent(0, si);
+    surface->GetCellData()->AddArray(segment_array);
+
+    local_domain->SetBlock(si, surface);
+    surfaces.push_back(cache);
+
+    mappers.push_back(Mapper::New());
+#if VTK_MAJOR_VERSION <= 5
+    mappers.back()->SetInputConnection(surface->GetProducerPort());
+#else
+    mappers.back()->SetInputData(surface);
+#endif
+    actors.push_back(Actor::New());
+    actors.back()->SetMapper(mappers.back());
+    actors.back()->GetProperty()->SetColor(0.0, 0.0, 1.0); // default color blue
+    renderer->AddActor(actors.back());
+}
+
+/**
+ * @brief Copies the values of a quantity of the central domain's segment onto the cached surface,
+ * unless the quantity has not changed since it has been gathered the last time. A quantity
+ * which only exists in this view, e.g., one of a snapshot, is left as it is.
+ */
+void Render3D::gather_quantity(unsigned int si, std::string const& key, int cell_lvl)
+{
+    SurfaceCache& cache = surfaces[si];
+    bool vertex = (cell_lvl == VERTEX);
+
+    vtkDataSetAttributes* source_data = vertex ? static_cast<vtkDataSetAttributes*>(cache.source->GetPointData())
+                                               : static_cast<vtkDataSetAttributes*>(cache.source->GetCellData());
+    vtkDataArray* source = source_data->GetArray(key.c_str());
+    if(!source) return;
+
+    SurfaceCache::Stamps& stamps = vertex ? cache.point_stamps : cache.cell_stamps;
+    SurfaceCache::Stamps::iterator stamp = stamps.find(key);
+    if((stamp != stamps.end()) && (stamp->second == source->GetMTime())) return;
+
+    vtkIdList* ids = vertex ? cache.point_ids : cache.cell_ids;
+    vtkSmartPointer<vtkDataArray> target;
+    target.TakeReference(source->NewInstance());
+    target->SetName(key.c_str());
+    target->SetNumberOfComponents(source->GetNumberOfComponents());
+    target->SetNumberOfTuples(ids->GetNumberOfIds());
+    source->GetTuples(ids, target);
+
+    vtkPointSet* surface = vtkPointSet::SafeDownCast(local_domain->GetBlock(si));
+    vtkDataSetAttributes* target_data = vertex ? static_cast<vtkDataSetAttributes*>(surface->GetPointData())
+                                               : static_cast<vtkDataSetAttributes*>(surface->GetCellData());
+    target_data->RemoveArray(key.c_str());
+    target_data->AddArray(target);
+
+    stamps[key] = source->GetMTime();
+    double* range = source->GetRange();
+    (vertex ? cache.point_ranges : cache.cell_ranges)[key] = std::make_pair(range[0], range[1]);
+}
+
+/**
+ * @brief The range of a quantity on the whole segment. The surface only holds a part of the
+ * values, hence its range would change the colors whenever an extremum lies inside of a 3D device.
+ */
+void Render3D::quantity_range(unsigned int si, std::string const& key, int cell_lvl, double range[2])
+{
+    SurfaceCache::Ranges const& ranges = (cell_lvl == VERTEX) ? surfaces[si].point_ranges : surfaces[si].cell_ranges;
+    SurfaceCache::Ranges::const_iterator known = ranges.find(key);
+    if(known != ranges.end())
+    {
+        range[0] = known->second.first;
+        range[1] = known->second.second;
+        return;
+    }
+
+    vtkPointSet* surface = vtkPointSet::SafeDownCast(local_domain->GetBlock(si));
+    vtkDataSetAttributes* data = (cell_lvl == VERTEX) ? static_cast<vtkDataSetAttributes*>(surface->GetPointData())
+                                                      : static_cast<vtkDataSetAttributes*>(surface->GetCellData());
+    data->GetArray(key.c_str())->GetRange(range);
+}
+
 void Render3D::print_current_statistics()
 {
     for(unsigned int si = 0; si < local_domain->GetNumberOfBlocks(); si++)
@@ -282,13 +413,15 @@ void Render3D::color_quantity_vertex()
 
     for(unsigned int si = 0; si < local_domain->GetNumberOfBlocks(); si++)
     {
+        this->gather_quantity(si, current_quantity_key, VERTEX);
         vtkPointSet* generic_segment = vtkPointSet::SafeDownCast(local_domain->GetBlock(si));
 
         if(generic_segment->GetPointData()->HasArray(current_quantity_key.c_str()))
         {
             generic_segment->GetPointData()->SetActiveScalars(current_quantity_key.c_str());
 
-            double* range = generic_segment->GetPointData()->GetScalars()->GetRange();
+            double range[2];
+            this->quantity_range(si, current_quantity_key, VERTEX, range);
 
             if(si == 0)
             {
@@ -349,13 +482,15 @@ void Render3D::color_quantity_cell()
 
     for(unsigned int si = 0; si < local_domain->GetNumberOfBlocks(); si++)
     {
+        this->gather_quantity(si, current_quantity_key, CELL);
         vtkPointSet* generic_segment = vtkPointSet::SafeDownCast(local_domain->GetBlock(si));
 
         if(generic_segment->GetCellData()->HasArray(current_quantity_key.c_str()))
         {
             generic_segment->GetCellData()->SetActiveScalars(current_quantity_key.c_str());
 
-            double* range = generic_segment->GetCellData()->GetScalars()->GetRange();
+            double range[2];
+            this->quantity_range(si, current_quantity_key, CELL, range);
             if(si == 0)
             {
                 domain_quantity_range[0] = range[0];
@@ -568,6 +703,85 @@ void Render3D::update()
 
 }
 
+/**
+ * @brief Starts to poll 'buffer' for intermediate solutions at 'fps' frames per second.
+ * New snapshots are written into the cell arrays of the local domain and the view is
+ * re-colored if it shows one of the snapshot's quantities. If the view shows nothing of the
+ * snapshot, the quantity 'key' is shown. The buffer is not owned.
+ */
+void Render3D::show_snapshots(viennamos::SnapshotBuffer* buffer, std::string const& key, std::string const& display_name, int fps)
+{
+    snapshot_buffer       = buffer;
+    snapshot_key          = key;
+    snapshot_display_name = display_name;
+    snapshot_timer->start(1000 / std::max(fps, 1));
+}
+
+/**
+ * @brief Stops polling, a snapshot still in the buffer is dropped
+ */
+void Render3D::stop_snapshots()
+{
+    snapshot_timer->stop();
+    snapshot_buffer = NULL;
+}
+
+void Render3D::poll_snapshot()
+{
+    if(!snapshot_buffer) return;
+
+    viennamos::Snapshot const* snapshot = snapshot_buffer->acquire();
+    if(!snapshot) return;
+
+    bool shows_snapshot = false;
+    for(std::size_t qi = 0; qi < snapshot->names.size(); qi++)
+    {
+        if(snapshot->values[qi].size() != local_domain->GetNumberOfBlocks()) return; // the grid has been replaced
+
+        const char* name = snapshot->names[qi].c_str();
+        for(unsigned int si = 0; si < local_domain->GetNumberOfBlocks(); si++)
+        {
+            vtkPointSet* segment = vtkPointSet::SafeDownCast(local_domain->GetBlock(si));
+            SurfaceCache& cache = surfaces[si];
+            viennamos::Snapshot::Values const& values = snapshot->values[qi][si];
+            if(vtkIdType(values.size()) != cache.source_cells) return;
+
+            // the arrays are reused between the snapshots, only the values on the surface are overwritten
+            vtkDoubleArray* array = vtkDoubleArray::SafeDownCast(segment->GetCellData()->GetArray(name));
+            if(!array || (array->GetNumberOfTuples() != segment->GetNumberOfCells()))
+            {
+                if(array) segment->GetCellData()->RemoveArray(name);
+                vtkSmartPointer<vtkDoubleArray> new_array = vtkSmartPointer<vtkDoubleArray>::New();
+                new_array->SetName(name);
+                new_array->SetNumberOfValues(segment->GetNumberOfCells());
+                segment->GetCellData()->AddArray(new_array);
+                array = new_array;
+            }
+            double* target = array->GetPointer(0);
+            for(vtkIdType ci = 0; ci < cache.cell_ids->GetNumberOfIds(); ci++)
+                target[ci] = values[cache.cell_ids->GetId(ci)];
+            array->Modified();
+            if(!values.empty())
+                cache.cell_ranges[name] = std::make_pair(*std::min_element(values.begin(), values.end()),
+                                                         *std::max_element(values.begin(), values.end()));
+
+            // the snapshot is newer than the quantity in the central domain, until the latter is replaced
+            vtkDataArray* source = cache.source->GetCellData()->GetArray(name);
+            if(source) cache.cell_stamps[name] = source->GetMTime();
+            else       cache.cell_stamps.erase(name);
+        }
+        if(state == QUANTITY && current_quantity_key == snapshot->names[qi])
+            shows_snapshot = true;
+    }
+
+    // the snapshot only holds cell values, hence a shown vertex quantity is replaced by its cell counterpart
+    if(shows_snapshot)
+        color_quantity(current_quantity_key, colorbar->GetTitle(), CELL);
+    else
+        color_quantity(snapshot_key, snapshot_display_name, CELL);
+    this->update();
+}
+
 void Render3D::reset_view()
 {
     resetCameraParameters();
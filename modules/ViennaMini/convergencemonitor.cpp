@@ -0,0 +1,154 @@
+/*
+ *
+ * Copyright (c) 2013, Institute for Microelectronics, TU Wien.
+ *
+ * This file is part of ViennaMOS     http://viennamos.sourceforge.net/
+ *
+ * Contact: Josef Weinbub             weinbub@iue.tuwien.ac.at
+ *
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+
+#include <vtkDoubleArray.h>
+#include <vtkVariant.h>
+
+#include "multiview.h"
+#include "chart2d.h"
+#include "chartentry.h"
+
+#include "convergencemonitor.h"
+
+ConvergenceMonitor::ConvergenceMonitor(QString const& name, QStringList const& quantities, QObject *parent) :
+    QObject(parent), name(name), quantities(quantities), multiview(NULL), table_id(0), has_table(false)
+{
+    qRegisterMetaType<viennafvm::iteration_record>("viennafvm::iteration_record");
+}
+
+void ConvergenceMonitor::start(MultiView* multiview)
+{
+    if(this->multiview != multiview)
+    {
+        if(this->multiview) QObject::disconnect(this->multiview, 0, this, 0);
+        this->multiview = multiview;
+        has_table = false;
+        QObject::connect(multiview, SIGNAL(tableRemoved(std::size_t)), this, SLOT(tableRemoved(std::size_t)));
+    }
+
+    this->setupTable();
+    row.assign(table->GetNumberOfColumns(), 0.0);
+
+    // let the chart editors know about the (new) table
+    multiview->update();
+
+    this->setupChart();
+}
+
+void ConvergenceMonitor::record(viennafvm::iteration_record const& record)
+{
+    if(!has_table || (record.pde_index >= std::size_t(quantities.size()))) return;
+
+    std::size_t offset = 1 + record.pde_index * COLUMNS_PER_QUANTITY;
+    row[offset + UPDATE_NORM]       = record.update_norm;
+    row[offset + RESIDUAL_NORM]     = record.residual_norm;
+    row[offset + LINEAR_ITERATIONS] = record.linear_solve.iterations;
+    row[offset + SOLVE_TIME]        = record.assembly_time + record.linear_solve.pc_time +
+                                      record.linear_solve.solver_time + record.update_time;
+
+    // a nonlinear iteration is complete, once the last quantity has been updated
+    if(record.pde_index + 1 == std::size_t(quantities.size()))
+    {
+        // the nonlinear iteration counter restarts for each bias step, so number the rows continuously
+        vtkIdType row_index = table->InsertNextBlankRow();
+        row[0] = row_index;
+        for(std::size_t ci = 0; ci < row.size(); ci++)
+            table->SetValue(row_index, ci, vtkVariant(row[ci]));
+        table->Modified();
+
+        this->refreshChart();
+    }
+}
+
+void ConvergenceMonitor::tableRemoved(std::size_t id)
+{
+    if(has_table && (id == table_id)) has_table = false;
+}
+
+void ConvergenceMonitor::setupTable()
+{
+    if(has_table)
+    {
+        table->SetNumberOfRows(0);
+        table->Modified();
+        return;
+    }
+
+    table = vtkSmartPointer<vtkTable>::New();
+
+    QStringList columns;
+    columns << "Iteration";
+    for(int qi = 0; qi < quantities.size(); qi++)
+    {
+        columns << quantities[qi] + " Update Norm"
+                << quantities[qi] + " Residual Norm"
+                << quantities[qi] + " Linear Iterations"
+                << quantities[qi] + " Solve Time";
+    }
+
+    for(int ci = 0; ci < columns.size(); ci++)
+    {
+        vtkSmartPointer<vtkDoubleArray> column = vtkSmartPointer<vtkDoubleArray>::New();
+        column->SetName(columns[ci].toStdString().c_str());
+        table->AddColumn(column);
+    }
+
+    table_id  = multiview->addTable(name, table);
+    has_table = true;
+}
+
+void ConvergenceMonitor::setupChart()
+{
+    Chart2D* chart = multiview->getCurrentChart2D();
+    if(!chart) return;
+
+    chart->clear();
+    chart->setTitle(name);
+    chart->setXAxisLabel("Nonlinear Iteration");
+    chart->setYAxisLabel("Update Norm");
+    chart->setYAxisLogScale(true);
+    chart->showLegend(true);
+
+    for(int qi = 0; qi < quantities.size(); qi++)
+    {
+        int column = 1 + qi * COLUMNS_PER_QUANTITY + UPDATE_NORM;
+        QString key(table->GetColumnName(column));
+        ChartEntry entry(column, key, key, Qt::black, true, 2, 1, 4, 5.0, true);
+        chart->addPlot(0, entry, false, table_id);
+    }
+    chart->update();
+}
+
+void ConvergenceMonitor::refreshChart()
+{
+    Chart2D* chart = multiview->getCurrentChart2D();
+    if(!chart) return;
+
+    chart->reset_view();
+    chart->update();
+    chart->GetRenderWindow()->Render();
+}
@@ -0,0 +1,86 @@
+#ifndef CONVERGENCEMONITOR_H
+#define CONVERGENCEMONITOR_H
+
+/*
+ *
+ * Copyright (c) 2013, Institute for Microelectronics, TU Wien.
+ *
+ * This file is part of ViennaMOS     http://viennamos.sourceforge.net/
+ *
+ * Contact: Josef Weinbub             weinbub@iue.tuwien.ac.at
+ *
+ *
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include <vector>
+
+#include <QObject>
+#include <QMetaType>
+#include <QStringList>
+
+#include <vtkSmartPointer.h>
+#include <vtkTable.h>
+
+#include "viennafvm/solver_observer.hpp"
+
+class MultiView;
+
+Q_DECLARE_METATYPE(viennafvm::iteration_record)
+
+/**
+ * @brief Collects the iteration records of a running simulation in a table
+ * of the multiview and keeps the current chart view up-to-date, so the
+ * convergence behaviour can be watched while the worker is running.
+ * Each row of the table holds one nonlinear iteration.
+ */
+class ConvergenceMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    ConvergenceMonitor(QString const& name, QStringList const& quantities, QObject *parent = 0);
+
+    /**
+     * @brief Prepares the table for a new run. If the current view is a chart,
+     * the update norms are plotted there
+     */
+    void start(MultiView* multiview);
+
+public slots:
+    void record(viennafvm::iteration_record const& record);
+
+private slots:
+    void tableRemoved(std::size_t id);
+
+private:
+    void setupTable();
+    void setupChart();
+    void refreshChart();
+
+    enum { UPDATE_NORM = 0, RESIDUAL_NORM, LINEAR_ITERATIONS, SOLVE_TIME, COLUMNS_PER_QUANTITY };
+
+    QString                     name;
+    QStringList                 quantities;
+    MultiView*                  multiview;
+    vtkSmartPointer<vtkTable>   table;
+    std::size_t                 table_id;
+    bool                        has_table;
+    std::vector<double>         row;
+};
+
+#endif // CONVERGENCEMONITOR_H
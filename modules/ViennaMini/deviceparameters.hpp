@@ -2,9 +2,11 @@
 #define DEVICEPARAMETERS_HPP
 
 #include <map>
+#include <vector>
 #include "segmentparameters.hpp"
 
 #include "viennamini/config.hpp"
+#include "viennamini/device_setup.hpp"
 
 struct DeviceParameters
 {
@@ -37,6 +39,29 @@ struct DeviceParameters
 
     SimConfig& config() { return local_config; }
 
+    // the segments in the form of viennamini::setup_device(), which is shared with the batch runner
+    std::vector<viennamini::segment_setup> segments()
+    {
+        std::vector<viennamini::segment_setup> result;
+        for(iterator iter = begin(); iter != end(); iter++)
+        {
+            SegmentParameters& segpara = iter->second;
+            viennamini::segment_setup seg;
+            seg.id               = iter->first;
+            seg.name             = segpara.name.toStdString();
+            seg.material         = segpara.material.toStdString();
+            seg.is_contact       = segpara.isContact;
+            seg.contact          = segpara.contact;
+            seg.workfunction     = segpara.workfunction;
+            seg.is_oxide         = segpara.isOxide;
+            seg.is_semiconductor = segpara.isSemiconductor;
+            seg.donors           = segpara.donors;
+            seg.acceptors        = segpara.acceptors;
+            result.push_back(seg);
+        }
+        return result;
+    }
+
     DomainParameters    domain_paras;
     Numeric             temperature;
     SimConfig           local_config; // offers default parameters!
@@ -74,6 +74,7 @@ ViennaMiniForm::ViennaMiniForm(QWidget *parent) :
     ui->lineEditLinSolveTol->setValidator(double_validator);
     ui->lineEditNonLinSolveTol->setValidator(double_validator);
     ui->lineEditNonLinSolveDamping->setValidator(double_validator);
+    ui->lineEditBiasStep->setValidator(double_validator);
 
     ui->tableWidget->verticalHeader()->setVisible(false);
 
@@ -86,6 +87,10 @@ ViennaMiniForm::ViennaMiniForm(QWidget *parent) :
     ui->lineEditNonLinSolveIterations->setText(QString::number(device_parameters.config().nonlinear_iterations()));
     ui->lineEditNonLinSolveTol->setText(QString::number(device_parameters.config().nonlinear_breaktol()));
     ui->lineEditNonLinSolveDamping->setText(QString::number(device_parameters.config().damping()));
+    ui->checkBoxAdaptiveDamping->setChecked(device_parameters.config().adaptive_damping());
+    ui->checkBoxBiasRamping->setChecked(device_parameters.config().bias_ramping());
+    ui->lineEditBiasStep->setText(QString::number(device_parameters.config().bias_step()));
+    ui->lineEditBiasStep->setEnabled(device_parameters.config().bias_ramping());
 
     QObject::connect(ui->tableWidget, SIGNAL(currentCellChanged(int,int,int,int)), this, SLOT(showSegmentParameters(int, int, int, int)));
 
@@ -95,6 +100,9 @@ ViennaMiniForm::ViennaMiniForm(QWidget *parent) :
     QObject::connect(ui->lineEditNonLinSolveIterations, SIGNAL(textChanged(QString)), this, SLOT(setNonLinearIterations(QString)));
     QObject::connect(ui->lineEditNonLinSolveTol, SIGNAL(textChanged(QString)), this, SLOT(setNonLinearTolerance(QString)));
     QObject::connect(ui->lineEditNonLinSolveDamping, SIGNAL(textChanged(QString)), this, SLOT(setNonLinearDamping(QString)));
+    QObject::connect(ui->checkBoxAdaptiveDamping, SIGNAL(toggled(bool)), this, SLOT(setAdaptiveDamping(bool)));
+    QObject::connect(ui->checkBoxBiasRamping, SIGNAL(toggled(bool)), this, SLOT(setBiasRamping(bool)));
+    QObject::connect(ui->lineEditBiasStep, SIGNAL(textChanged(QString)), this, SLOT(setBiasStep(QString)));
     QObject::connect(ui->lineEditSegmentName, SIGNAL(textChanged(QString)), this, SLOT(setSegmentName(QString)));
     QObject::connect(ui->radioButtonContactSingle, SIGNAL(toggled(bool)), this, SLOT(setSegmentContactIsSingle(bool)));
     QObject::connect(ui->lineEditContactSingle, SIGNAL(textChanged(QString)), this, SLOT(setSegmentContactContactValue(QString)));
@@ -192,6 +200,11 @@ void ViennaMiniForm::on_pushButtonLoadMesh_clicked()
     }
 }
 
+void ViennaMiniForm::on_pushButtonProbe_clicked()
+{
+    emit probeRequested(ui->lineEditProbePoint->text());
+}
+
 void ViennaMiniForm::setupDevice(std::vector<int> const& segment_indices)
 {
     if(resize_device_parameters)
@@ -306,6 +319,22 @@ void ViennaMiniForm::setNonLinearDamping(QString const& value_str)
     device_parameters.config().damping() = value_str.toDouble();
 }
 
+void ViennaMiniForm::setAdaptiveDamping(bool state)
+{
+    device_parameters.config().adaptive_damping() = state;
+}
+
+void ViennaMiniForm::setBiasRamping(bool state)
+{
+    device_parameters.config().bias_ramping() = state;
+    ui->lineEditBiasStep->setEnabled(state);
+}
+
+void ViennaMiniForm::setBiasStep(QString const& value_str)
+{
+    device_parameters.config().bias_step() = value_str.toDouble();
+}
+
 void ViennaMiniForm::setSegmentName(QString const& name)
 {
     device_parameters[ui->tableWidget->item(ui->tableWidget->currentRow(), 0)->data(Qt::UserRole).toInt()].name = name;
@@ -450,6 +479,9 @@ void ViennaMiniForm::saveState(QSettings& settings)
     settings.setValue("nonlinsolve_iter", device_parameters.config().nonlinear_iterations());
     settings.setValue("nonlinsolve_tol", device_parameters.config().nonlinear_breaktol());
     settings.setValue("nonlinsolve_damping", device_parameters.config().damping());
+    settings.setValue("nonlinsolve_adaptive_damping", device_parameters.config().adaptive_damping());
+    settings.setValue("nonlinsolve_bias_ramping", device_parameters.config().bias_ramping());
+    settings.setValue("nonlinsolve_bias_step", device_parameters.config().bias_step());
     settings.endGroup();
 
     settings.beginGroup("device");
@@ -500,6 +532,10 @@ void ViennaMiniForm::loadState(QSettings& settings)
     device_parameters.config().nonlinear_iterations() = settings.value("nonlinsolve_iter").toInt();
     device_parameters.config().nonlinear_breaktol() = settings.value("nonlinsolve_tol").toDouble();
     device_parameters.config().damping() = settings.value("nonlinsolve_damping").toDouble();
+    // the following entries are missing in older state files, so keep the current values as defaults
+    device_parameters.config().adaptive_damping() = settings.value("nonlinsolve_adaptive_damping", device_parameters.config().adaptive_damping()).toBool();
+    device_parameters.config().bias_ramping() = settings.value("nonlinsolve_bias_ramping", device_parameters.config().bias_ramping()).toBool();
+    device_parameters.config().bias_step() = settings.value("nonlinsolve_bias_step", device_parameters.config().bias_step()).toDouble();
     settings.endGroup();
 
     // now, we update the UI too!
@@ -510,6 +546,10 @@ void ViennaMiniForm::loadState(QSettings& settings)
     ui->lineEditNonLinSolveIterations->setText(QString::number(device_parameters.config().nonlinear_iterations()));
     ui->lineEditNonLinSolveTol->setText(QString::number(device_parameters.config().nonlinear_breaktol()));
     ui->lineEditNonLinSolveDamping->setText(QString::number(device_parameters.config().damping()));
+    ui->checkBoxAdaptiveDamping->setChecked(device_parameters.config().adaptive_damping());
+    ui->checkBoxBiasRamping->setChecked(device_parameters.config().bias_ramping());
+    ui->lineEditBiasStep->setText(QString::number(device_parameters.config().bias_step()));
+    ui->lineEditBiasStep->setEnabled(device_parameters.config().bias_ramping());
 
     settings.beginGroup("device");
     int segment_size = settings.value("segmentsize").toInt();
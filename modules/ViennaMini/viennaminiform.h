@@ -52,6 +52,7 @@ public:
     DeviceParameters& getParameters();
 signals:
     void meshFileEntered(QString const& filename);
+    void probeRequested(QString const& point);
 
 public slots:
     void saveState(QSettings& settings);
@@ -60,12 +61,16 @@ public slots:
 
 private slots:
     void on_pushButtonLoadMesh_clicked();
+    void on_pushButtonProbe_clicked();
     void setTemperature(QString const& value_str);
     void setLinearTolerance(QString const& value_str);
     void setLinearIterations(QString const& value_str);
     void setNonLinearTolerance(QString const& value_str);
     void setNonLinearIterations(QString const& value_str);
     void setNonLinearDamping(QString const& value_str);
+    void setAdaptiveDamping(bool state);
+    void setBiasRamping(bool state);
+    void setBiasStep(QString const& value_str);
     void showSegmentParameters(int row, int col = -1, int prev_row = -1, int prev_col = -1);
     void setSegmentName(QString const& name);
     void setSegmentMaterial(QString const& name);
@@ -32,12 +32,78 @@
 #include "keys_units.hpp"
 
 #include "viennagrid/io/netgen_reader.hpp"
+#include "viennagrid/io/mesh_cache.hpp"
 #include "viennagrid/algorithm/scale.hpp"
+#include "viennagrid/algorithm/spatial_index.hpp"
+#include "viennautils/profiler.hpp"
 
 #include "viennaminimodule.h"
 
 
+#include <QDateTime>
 #include <QDebug>
+#include <QDesktopServices>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace {
+
+// the cache directory is bounded: caches which have not been written for a month are removed, as well as
+// the least recently written ones while all caches take more than 1 GB
+const qint64 meshCacheMaxBytes   = Q_INT64_C(1024) * 1024 * 1024;
+const int    meshCacheMaxAgeDays = 30;
+
+void evictMeshCaches(QString const& directory)
+{
+    QDateTime now = QDateTime::currentDateTime();
+    qint64 bytes = 0;
+
+    // newest first, a temporary file is left behind by a run that crashed while writing the cache
+    QFileInfoList caches = QDir(directory).entryInfoList(QStringList() << "*.vgcache" << "*.vgcache.tmp.*", QDir::Files, QDir::Time);
+    foreach(QFileInfo const& cache, caches)
+    {
+        bool temporary = !cache.fileName().endsWith(".vgcache");
+        bool outdated  = cache.lastModified().addDays(temporary ? 1 : meshCacheMaxAgeDays) < now;
+        if(!temporary && !outdated && bytes + cache.size() <= meshCacheMaxBytes)
+        {
+            bytes += cache.size();
+            continue;
+        }
+        if(temporary && !outdated) continue;    // may be written right now
+        QFile::remove(cache.absoluteFilePath());
+    }
+}
+
+// the binary mesh caches are kept in the user's cache location, not next to the mesh files
+QString meshCacheDirectory()
+{
+    QString location = QDesktopServices::storageLocation(QDesktopServices::CacheLocation);
+    if(location.isEmpty()) return QString();
+    QString directory = QDir(location).filePath("meshes");
+    if(!QDir().mkpath(directory)) return QString();
+    evictMeshCaches(directory);
+    return directory;
+}
+
+// reads the mesh without a cache if there is no writable cache location
+template<typename DeviceT>
+void readMesh(DeviceT& device, QString const& filename)
+{
+    QString cache_directory = meshCacheDirectory();
+    if(cache_directory.isEmpty())
+    {
+        viennagrid::io::netgen_reader reader;
+        reader(device.getCellComplex(), device.getSegmentation(), filename.toStdString());
+    }
+    else
+    {
+        viennagrid::io::cached_reader<viennagrid::io::netgen_reader> reader(viennagrid::io::netgen_reader(), cache_directory.toStdString());
+        reader(device.getCellComplex(), device.getSegmentation(), QFileInfo(filename).absoluteFilePath().toStdString());
+    }
+}
+
+} // namespace
 
 /**
  * @brief The module's c'tor registers the module's UI widget and registers
@@ -53,8 +119,17 @@ ViennaMiniModule::ViennaMiniModule() : ModuleInterface(this)
     // setup module specific mechanisms
     //
     QObject::connect(widget, SIGNAL(meshFileEntered(QString const&)), this, SLOT(loadMeshFile(QString const&)));
+    QObject::connect(widget, SIGNAL(probeRequested(QString const&)), this, SLOT(probePoint(QString const&)));
     QObject::connect(this, SIGNAL(materialsAvailable(MaterialManager::Library&)), widget, SLOT(setMaterialLibrary(MaterialManager::Library&)));
 
+    // collects the convergence data of the simulation, the order follows the quantities of the ViennaMini simulator
+    //
+    resume_fraction = -1.0;
+    has_result      = false;
+
+    convergence_monitor = new ConvergenceMonitor(this->name()+" Convergence",
+                                                 QStringList() << "Potential" << "Electrons" << "Holes", this);
+
 
     // create output quantities of this module
     //
@@ -192,25 +267,36 @@ void ViennaMiniModule::reset()
  */
 void ViennaMiniModule::execute()
 {
-    DeviceParameters& parameters = widget->getParameters();
-
     if((device_id == viennamos::Device2u::ID()) && (has<viennamos::Device2u>()))
-    {
-        viennamos::Device2u& device = access<viennamos::Device2u>();
-        ViennaMiniWorker* worker = new ViennaMiniWorker(&device, material_manager->getLibrary(), parameters,
-                                                        pot_quan_vertex, n_quan_vertex, p_quan_vertex,
-                                                        pot_quan_cell, n_quan_cell, p_quan_cell);
-        viennamos::offload(worker, messenger, SIGNAL(finished()), this, SLOT(transferResult()));
-    }
+        submit(access<viennamos::Device2u>(), viennamos::key::vdevice2u);
     else
     if((device_id == viennamos::Device3u::ID()) && (has<viennamos::Device3u>()))
+        submit(access<viennamos::Device3u>(), viennamos::key::vdevice3u);
+}
+
+/**
+ * @brief Queues a simulation of the device in the job scheduler, simulations
+ * of the same device are not run concurrently
+ */
+template<typename DeviceT>
+void ViennaMiniModule::submit(DeviceT& device, QString const& type)
+{
+    ViennaMiniWorker* worker = new ViennaMiniWorker(&device, material_manager->getLibrary(), widget->getParameters(),
+                                                    pot_quan_vertex, n_quan_vertex, p_quan_vertex,
+                                                    pot_quan_cell, n_quan_cell, p_quan_cell);
+    worker->setSnapshotBuffer(&snapshots);
+    if(resume_fraction >= 0.0)
     {
-        viennamos::Device3u& device = access<viennamos::Device3u>();
-        ViennaMiniWorker* worker = new ViennaMiniWorker(&device, material_manager->getLibrary(), parameters,
-                                                        pot_quan_vertex, n_quan_vertex, p_quan_vertex,
-                                                        pot_quan_cell, n_quan_cell, p_quan_cell);
-        viennamos::offload(worker, messenger, SIGNAL(finished()), this, SLOT(transferResult()));
+        messenger->append("# resuming the cancelled simulation from the current solution");
+        worker->setResume(resume_fraction);
+        resume_fraction = -1.0;
     }
+    QObject::connect(worker, SIGNAL(started()), this, SLOT(jobStarted()), Qt::QueuedConnection);
+    QObject::connect(worker, SIGNAL(cancelled(double)), this, SLOT(jobInterrupted(double)), Qt::QueuedConnection);
+    QObject::connect(worker, SIGNAL(iteration(viennafvm::iteration_record)),
+                     convergence_monitor, SLOT(record(viennafvm::iteration_record)), Qt::QueuedConnection);
+    viennamos::offload(worker, messenger, SIGNAL(finished()), this, SLOT(transferResult()), SLOT(jobCancelled()),
+                       viennamos::JobHints(this->name()+" ("+type+")", 0, &device));
 }
 
 /**
@@ -220,6 +306,11 @@ void ViennaMiniModule::execute()
  */
 void ViennaMiniModule::transferResult()
 {
+  // the scope has to be closed before 'finished' is emitted, as the profiler logs may be released then
+  VIENNAUTILS_PROFILE_SCOPE_NAMED(copy_scope, "viennamos::copy_to_multiview");
+
+  stopSnapshots();
+
   if((device_id == viennamos::Device2u::ID()) && (has<viennamos::Device2u>()))
   {
     viennamos::Device2u& device = access<viennamos::Device2u>();
@@ -241,17 +332,73 @@ void ViennaMiniModule::transferResult()
     viennamos::copy(device, n_quan_cell,     multiview);
     viennamos::copy(device, p_quan_cell,     multiview);
   }
+  VIENNAUTILS_PROFILE_STOP(copy_scope);
+  has_result = true;
   emit finished();
 }
 
 
+/**
+ * @brief Called once the scheduler has started the worker: the convergence monitor and the
+ * current render view follow the simulation. The view polls the snapshots on its own,
+ * hence the worker never waits for the GUI
+ */
+void ViennaMiniModule::jobStarted()
+{
+  convergence_monitor->start(multiview);
+
+  stopSnapshots();
+  snapshots.reset();
+
+  snapshot_render = multiview->getCurrentRender3D();
+  if(!snapshot_render) return;
+
+  snapshot_render->show_snapshots(&snapshots, pot_quan_cell.name,
+                                  viennamos::generateDisplayName(pot_quan_cell.name, pot_quan_cell.unit));
+}
+
+/**
+ * @brief Called if the job has been cancelled before it was started
+ */
+void ViennaMiniModule::jobCancelled()
+{
+  emit abort();
+}
+
+/**
+ * @brief Called if the running simulation has been cancelled, the device keeps the
+ * current solution and the next run continues from there
+ */
+void ViennaMiniModule::jobInterrupted(double bias_fraction)
+{
+  resume_fraction = bias_fraction;
+  messenger->append("# the simulation has been cancelled, the next run continues from the current solution");
+}
+
+void ViennaMiniModule::stopSnapshots()
+{
+  if(snapshot_render) snapshot_render->stop_snapshots();
+  snapshot_render = NULL;
+}
+
 /**
  * @brief Function reads an input mesh into the framework's central device database
  * This function is not part of the Module interface*
  */
 void ViennaMiniModule::loadMeshFile(QString const& filename)
 {
+    // the jobs hold a reference to the device, which is replaced by the new mesh
+    if((has<viennamos::Device2u>() && scheduler->hasJobs(&access<viennamos::Device2u>())) ||
+       (has<viennamos::Device3u>() && scheduler->hasJobs(&access<viennamos::Device3u>())))
+    {
+        QMessageBox::critical(0, QString("Error"), "The device is used by a queued or running simulation, "
+                                                   "cancel the job or wait until it has finished before loading a new mesh!");
+        return;
+    }
+
     meshfile = filename;
+    resume_fraction = -1.0; // a new device starts from the initial guesses
+    has_result      = false;
 
     QString suffix = QFileInfo(filename).suffix();
 
@@ -264,8 +411,9 @@ void ViennaMiniModule::loadMeshFile(QString const& filename)
             try {
                 if(has<viennamos::Device2u>()) remove<viennamos::Device2u>();
                 viennamos::Device2u& device = make<viennamos::Device2u>();
-                viennagrid::io::netgen_reader  reader;
-                reader(device.getCellComplex(), device.getSegmentation(), filename.toStdString());
+                VIENNAUTILS_PROFILE_SCOPE_NAMED(read_scope, "viennamos::read_mesh");
+                readMesh(device, filename);
+                VIENNAUTILS_PROFILE_STOP(read_scope);
                 viennagrid::scale(device.getCellComplex(), widget->getScaling());
                 viennamos::copy(device, multiview);
                 device_id = viennamos::Device2u::ID();
@@ -289,8 +437,9 @@ void ViennaMiniModule::loadMeshFile(QString const& filename)
             try {
                 if(has<viennamos::Device3u>()) remove<viennamos::Device3u>();
                 viennamos::Device3u& device = make<viennamos::Device3u>();
-                viennagrid::io::netgen_reader  reader;
-                reader(device.getCellComplex(), device.getSegmentation(), filename.toStdString());
+                VIENNAUTILS_PROFILE_SCOPE_NAMED(read_scope, "viennamos::read_mesh");
+                readMesh(device, filename);
+                VIENNAUTILS_PROFILE_STOP(read_scope);
                 viennagrid::scale(device.getCellComplex(), widget->getScaling());
                 viennamos::copy(device, multiview);
                 device_id = viennamos::Device3u::ID();
@@ -329,4 +478,98 @@ void ViennaMiniModule::loadMeshFile(QString const& filename)
     multiview->resetAllViews();
 }
 
+/**
+ * @brief Prints the result of the last simulation at a point of the device, the point is
+ * given as 'x y' or 'x y z' in the units of the mesh file
+ * This function is not part of the Module interface
+ */
+void ViennaMiniModule::probePoint(QString const& point)
+{
+    std::vector<double> coordinates;
+    foreach(QString const& field, QString(point).replace(',', ' ').split(' ', QString::SkipEmptyParts))
+    {
+        bool ok;
+        coordinates.push_back(field.toDouble(&ok));
+        if(!ok)
+        {
+            QMessageBox::critical(0, QString("Error"), "The probe point '" + point + "' is not a list of coordinates!");
+            return;
+        }
+    }
 
+    if((device_id == viennamos::Device2u::ID()) && (has<viennamos::Device2u>()))
+        probe(access<viennamos::Device2u>(), coordinates);
+    else
+    if((device_id == viennamos::Device3u::ID()) && (has<viennamos::Device3u>()))
+        probe(access<viennamos::Device3u>(), coordinates);
+    else
+        QMessageBox::critical(0, QString("Error"), "There is no device to probe, load a mesh first!");
+}
+
+/**
+ * @brief Locates the probe point in the cells of the device through a bounding volume
+ * hierarchy and prints the cell values of the potential and the carrier concentrations.
+ * The hierarchy is built per probe, which takes a fraction of a second for meshes of
+ * several hundred thousand cells
+ */
+template<typename DeviceT>
+void ViennaMiniModule::probe(DeviceT& device, std::vector<double> const& coordinates)
+{
+    typedef typename DeviceT::CellComplex                                               DomainType;
+    typedef typename DeviceT::QuantityComplex                                           QuantityComplexType;
+    typedef typename viennagrid::result_of::point<DomainType>::type                     PointType;
+    typedef typename viennagrid::result_of::cell<DomainType>::type                      CellType;
+    typedef typename viennagrid::result_of::cell_range<DomainType>::type                CellRange;
+    typedef typename viennadata::result_of::accessor<QuantityComplexType, Quantity, double, CellType>::type AccessorType;
+    typedef viennagrid::spatial_index<DomainType>                                       IndexType;
+
+    // the running simulation writes the quantities of the device
+    if(scheduler->hasJobs(&device))
+    {
+        QMessageBox::critical(0, QString("Error"), "The device is used by a queued or running simulation, "
+                                                   "wait until it has finished before probing it!");
+        return;
+    }
+    if(!has_result)
+    {
+        QMessageBox::critical(0, QString("Error"), "There is no result to probe, run a simulation first!");
+        return;
+    }
+
+    PointType point;
+    if(coordinates.size() != point.size())
+    {
+        QMessageBox::critical(0, QString("Error"), QString("The probe point needs %1 coordinates!").arg(point.size()));
+        return;
+    }
+    // the mesh has been scaled when it was loaded
+    for(std::size_t d = 0; d < point.size(); d++)
+        point[d] = coordinates[d] * widget->getScaling();
+
+    IndexType index(device.getCellComplex());
+    int cell_index = index.locate(point);
+
+    QString location;
+    for(std::size_t d = 0; d < coordinates.size(); d++)
+        location += (d == 0 ? "(" : ", ") + QString::number(coordinates[d]);
+    location += ")";
+
+    if(cell_index == IndexType::invalid_index())
+    {
+        messenger->append("# probe " + location + ": the point is outside of the device");
+        return;
+    }
+
+    CellRange cells(device.getCellComplex());
+    CellType& cell = cells[cell_index];
+
+    AccessorType potential = viennadata::make_accessor(device.getQuantityComplex(), pot_quan_cell);
+    AccessorType electrons = viennadata::make_accessor(device.getQuantityComplex(), n_quan_cell);
+    AccessorType holes     = viennadata::make_accessor(device.getQuantityComplex(), p_quan_cell);
+
+    messenger->append(QString("# probe %1: cell %2, potential %3 %4, electrons %5 %6, holes %7 %8")
+                      .arg(location).arg(cell_index)
+                      .arg(potential(cell)).arg(QString::fromStdString(pot_quan_cell.unit))
+                      .arg(electrons(cell)).arg(QString::fromStdString(n_quan_cell.unit))
+                      .arg(holes(cell)).arg(QString::fromStdString(p_quan_cell.unit)));
+}
@@ -30,11 +30,15 @@
 // ViennaMOS includes
 //
 #include "module_interface.h"
+#include "snapshot_buffer.hpp"
+
+#include <QPointer>
 
 // Local includes
 //
 #include "viennaminiform.h"
 #include "viennaminiworker.h"
+#include "convergencemonitor.h"
 
 class ViennaMiniModule : public ModuleInterface
 {
@@ -59,15 +63,28 @@ signals:
 
 private slots:
     void loadMeshFile(QString const& filename);
+    void probePoint(QString const& point);
 
 public slots:
     void transferResult();
+    void jobStarted();
+    void jobCancelled();
+    void jobInterrupted(double bias_fraction);
 
 private:
+    template<typename DeviceT>
+    void submit(DeviceT& device, QString const& type);
+    template<typename DeviceT>
+    void probe(DeviceT& device, std::vector<double> const& coordinates);
+    void stopSnapshots();
+
     ViennaMiniForm*     widget;
     QString             meshfile;
     int                 device_id;
     int                 device_segments;
+    ConvergenceMonitor* convergence_monitor;
+    double              resume_fraction;    // of the last cancelled run, negative if there is none
+    bool                has_result;         // the quantities of the device hold the result of a run
 
     Quantity pot_quan_vertex;
     Quantity n_quan_vertex;
@@ -76,6 +93,8 @@ private:
     Quantity n_quan_cell;
     Quantity p_quan_cell;
 
+    viennamos::SnapshotBuffer   snapshots;
+    QPointer<Render3D>          snapshot_render;
 };
 
 #endif // VIENNAMINIMODULE_H
@@ -2,16 +2,26 @@
 #include <vector>
 
 #include "viennaminiworker.h"
-#include "stream_emitter.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 ViennaMiniWorker::ViennaMiniWorker(viennamos::Device2u* vmos_device, MaterialManager::Library& matlib, DeviceParameters& parameters,
                                    Quantity& target_pot_quan_vertex, Quantity& target_n_quan_vertex, Quantity& target_p_quan_vertex,
                                    Quantity& target_pot_quan_cell, Quantity& target_n_quan_cell, Quantity& target_p_quan_cell)
     : vmos_device2u_(vmos_device), matlib_(matlib), parameters_(parameters),
       target_pot_quan_vertex_(target_pot_quan_vertex), target_n_quan_vertex_(target_n_quan_vertex), target_p_quan_vertex_(target_p_quan_vertex),
-      target_pot_quan_cell_(target_pot_quan_cell), target_n_quan_cell_(target_n_quan_cell), target_p_quan_cell_(target_p_quan_cell)
+      target_pot_quan_cell_(target_pot_quan_cell), target_n_quan_cell_(target_n_quan_cell), target_p_quan_cell_(target_p_quan_cell),
+      log_(new viennautils::log::ring_buffer_sink), thread_budget_(0), resume_fraction_(-1.0)
 {
     vmos_device3u_ = NULL;
+    snapshots_                 = NULL;
+    snapshot_interval_         = 0;
+    snapshot_period_           = 0.0;
+    snapshot_quantities_       = 0;
+    iterations_since_snapshot_ = 0;
+    snapshot_writer_           = NULL;
 }
 
 ViennaMiniWorker::ViennaMiniWorker(viennamos::Device3u* vmos_device, MaterialManager::Library& matlib, DeviceParameters& parameters,
@@ -19,38 +29,93 @@ ViennaMiniWorker::ViennaMiniWorker(viennamos::Device3u* vmos_device, MaterialMan
                                    Quantity& target_pot_quan_cell, Quantity& target_n_quan_cell, Quantity& target_p_quan_cell)
     : vmos_device3u_(vmos_device), matlib_(matlib), parameters_(parameters),
       target_pot_quan_vertex_(target_pot_quan_vertex), target_n_quan_vertex_(target_n_quan_vertex), target_p_quan_vertex_(target_p_quan_vertex),
-      target_pot_quan_cell_(target_pot_quan_cell), target_n_quan_cell_(target_n_quan_cell), target_p_quan_cell_(target_p_quan_cell)
+      target_pot_quan_cell_(target_pot_quan_cell), target_n_quan_cell_(target_n_quan_cell), target_p_quan_cell_(target_p_quan_cell),
+      log_(new viennautils::log::ring_buffer_sink), thread_budget_(0), resume_fraction_(-1.0)
 {
     vmos_device2u_ = NULL;
+    snapshots_                 = NULL;
+    snapshot_interval_         = 0;
+    snapshot_period_           = 0.0;
+    snapshot_quantities_       = 0;
+    iterations_since_snapshot_ = 0;
+    snapshot_writer_           = NULL;
 }
 
 ViennaMiniWorker::~ViennaMiniWorker()
 {
+    // a worker cancelled before it was started never closes its sink in process(),
+    // the messenger would keep polling it otherwise
+    log_->close();
+}
+
+void ViennaMiniWorker::setSnapshotBuffer(viennamos::SnapshotBuffer* buffer, std::size_t interval, double period)
+{
+    snapshots_         = buffer;
+    snapshot_interval_ = interval;
+    snapshot_period_   = period;
+}
+
+void ViennaMiniWorker::setResume(double bias_fraction)
+{
+    resume_fraction_ = bias_fraction;
+}
 
+void ViennaMiniWorker::cancel()
+{
+    cancel_.request();
+}
+
+void ViennaMiniWorker::setThreadBudget(int threads)
+{
+    thread_budget_ = threads;
 }
 
 void ViennaMiniWorker::process()
 {
-    //
-    // Reroute streams
-    //
-    StreamEmitter msg_cout(std::cout);
-    StreamEmitter msg_cerr(std::cerr);
-    connect(&msg_cout, SIGNAL(message(QString const&)), this, SLOT(forward_message(QString const&)));
-    connect(&msg_cerr, SIGNAL(message(QString const&)), this, SLOT(forward_message(QString const&)));
-
-    //
-    // process a 22u domain
-    //
-    if (vmos_device2u_ != NULL)
-        process_impl(*vmos_device2u_); // in viennaminiworker.h (due to the use of templates ..)
-    else if (vmos_device3u_ != NULL)
-        process_impl(*vmos_device3u_); // in viennaminiworker.h (due to the use of templates ..)
-    else std::cerr << "ViennaMiniWorker::Error: Device type is not supported!" << std::endl;
+    emit started();
+
+#ifdef _OPENMP
+    // the setting is per thread, hence other jobs keep their own budget
+    if(thread_budget_ > 0) omp_set_num_threads(thread_budget_);
+#endif
+
+    {
+        //
+        // Reroute the output of this thread, other threads keep their streams
+        //
+        viennautils::log::scoped_sink log_scope(*log_);
+
+        //
+        // process a 22u domain
+        //
+        if (vmos_device2u_ != NULL)
+            process_impl(*vmos_device2u_); // in viennaminiworker.h (due to the use of templates ..)
+        else if (vmos_device3u_ != NULL)
+            process_impl(*vmos_device3u_); // in viennaminiworker.h (due to the use of templates ..)
+        else viennautils::log::err() << "ViennaMiniWorker::Error: Device type is not supported!" << std::endl;
+    }
+    log_->close();
     emit finished();
 }
 
-void ViennaMiniWorker::forward_message(QString const& msg)
+void ViennaMiniWorker::on_iteration(viennafvm::iteration_record const& record)
 {
-    emit message(msg);
+    emit iteration(record);
+
+    // a nonlinear iteration is complete, once the last quantity has been updated
+    if(!snapshots_ || !snapshot_writer_ || snapshot_interval_ == 0 ||
+       (record.pde_index + 1 != snapshot_quantities_)) return;
+
+    iterations_since_snapshot_++;
+    if((iterations_since_snapshot_ < snapshot_interval_) &&
+       (snapshot_clock_.elapsed() < qint64(snapshot_period_ * 1000.0))) return;
+
+    // the back buffer belongs to this thread, only the publishing swaps buffers with the GUI
+    viennamos::Snapshot& snapshot = snapshots_->back();
+    snapshot.iteration = record.nonlinear_iteration;
+    snapshot_writer_->write(snapshot);
+    snapshots_->publish();
+
+    iterations_since_snapshot_ = 0;
+    snapshot_clock_.restart();
 }
@@ -2,6 +2,7 @@
 #define VIENNAMINIWORKER_H
 
 #include <QObject>
+#include <QElapsedTimer>
 
 #include "deviceparameters.hpp"
 
@@ -10,15 +11,83 @@
 #include "device.hpp"
 #include "materialmanager.h"
 #include "quantity.h"
+#include "snapshot_buffer.hpp"
 
 #include "viennamini/simulator.hpp"
 
-#include "viennagrid/algorithm/quantity_transfer.hpp"
+#include "viennagrid/algorithm/quantity_transfer_plan.hpp"
 #include "viennautils/average.hpp"
+#include "viennautils/profiler.hpp"
+#include "viennautils/log.hpp"
+
+#include "boost/shared_ptr.hpp"
 
 #include "utils.hpp"
+#include "convergencemonitor.h"
+
+/**
+ * @brief Fills a snapshot with the current iterates of the simulator, the device
+ * type is hidden so the worker can hold the writer of either device
+ */
+class SnapshotWriter
+{
+public:
+  virtual ~SnapshotWriter() {}
+  virtual void write(viennamos::Snapshot& snapshot) = 0;
+};
+
+template<typename DeviceT>
+class DeviceSnapshotWriter : public SnapshotWriter
+{
+public:
+  typedef typename DeviceT::CellComplex                                             Domain;
+  typedef typename DeviceT::Segmentation                                            Segmentation;
+  typedef typename DeviceT::QuantityComplex                                         QuanComplex;
+  typedef typename Segmentation::iterator                                           SegmentationIterator;
+  typedef typename Segmentation::segment_handle_type                                Segment;
+  typedef typename viennagrid::result_of::cell_tag<Domain>::type                    CellTag;
+  typedef typename viennagrid::result_of::element<Domain, CellTag>::type            CellType;
+  typedef typename viennagrid::result_of::element_range<Segment, CellTag>::type     CellRange;
+  typedef typename viennagrid::result_of::iterator<CellRange>::type                 CellIterator;
+  typedef typename viennadata::result_of::accessor<QuanComplex, viennafvm::current_iterate_key, double, CellType>::type IterateAccessor;
+
+  DeviceSnapshotWriter(DeviceT& device, std::vector<std::size_t> const& quantity_ids, std::vector<std::string> const& names)
+    : device_(device), quantity_ids_(quantity_ids), names_(names) {}
+
+  // the values are written in the cell order of viennamos::copy(device, quantity, multiview),
+  // the vectors of the buffer are reused, hence there are no allocations after the first snapshot
+  void write(viennamos::Snapshot& snapshot)
+  {
+    snapshot.names = names_;
+    snapshot.values.resize(quantity_ids_.size());
+    for(std::size_t qi = 0; qi < quantity_ids_.size(); qi++)
+    {
+      IterateAccessor iterate = viennadata::make_accessor(device_.getQuantityComplex(), viennafvm::current_iterate_key(quantity_ids_[qi]));
+
+      viennamos::Snapshot::SegmentValues& segment_values = snapshot.values[qi];
+      segment_values.resize(device_.getSegmentation().size());
+
+      std::size_t si = 0;
+      for(SegmentationIterator sit = device_.getSegmentation().begin(); sit != device_.getSegmentation().end(); sit++, si++)
+      {
+        CellRange cells = viennagrid::elements<CellType>(*sit);
+        viennamos::Snapshot::Values& values = segment_values[si];
+        values.resize(cells.size());
+
+        std::size_t ci = 0;
+        for(CellIterator cit = cells.begin(); cit != cells.end(); cit++)
+          values[ci++] = iterate(*cit);
+      }
+    }
+  }
 
-class ViennaMiniWorker : public QObject
+private:
+  DeviceT                   & device_;
+  std::vector<std::size_t>    quantity_ids_;
+  std::vector<std::string>    names_;
+};
+
+class ViennaMiniWorker : public QObject, public viennafvm::solver_observer
 {
   Q_OBJECT
 
@@ -34,9 +103,44 @@ public:
                    Quantity& target_pot_quan_cell, Quantity& target_n_quan_cell, Quantity& target_p_quan_cell);
   ~ViennaMiniWorker();
 
+  typedef boost::shared_ptr<viennautils::log::ring_buffer_sink>  LogSinkPtr;
+
+  /**
+   * @brief The output of the simulation, the sink is closed once the worker is finished
+   */
+  LogSinkPtr logSink() { return log_; }
+
+  /**
+   * @brief Publishes the intermediate potential and carrier concentrations to 'buffer' every
+   * 'interval' nonlinear iterations or, at the latest, after 'period' seconds. The buffer
+   * is not owned and has to outlive the worker. A zero interval disables the streaming.
+   */
+  void setSnapshotBuffer(viennamos::SnapshotBuffer* buffer, std::size_t interval = 5, double period = 2.0);
+
+  /**
+   * @brief Continues a cancelled simulation from the current solution of the device instead of
+   * starting from the initial guesses, see the 'cancelled' signal
+   */
+  void setResume(double bias_fraction);
+
+  // viennafvm::solver_observer interface, called from within the worker thread
+  void on_iteration(viennafvm::iteration_record const& record);
+
 public slots:
   void process();
 
+  /**
+   * @brief Limits the number of OpenMP threads of the simulation, called by the job scheduler
+   * before the processing starts. A zero budget keeps the OpenMP default
+   */
+  void setThreadBudget(int threads);
+
+  /**
+   * @brief Asks the simulation to stop, called by the job scheduler from the GUI thread.
+   * The simulator stops at its next check and keeps the current solution
+   */
+  void cancel();
+
 private:
   template<typename DeviceT>
   void process_impl(DeviceT& device)
@@ -47,45 +151,49 @@ private:
     typedef viennamini::device<Domain, Segmentation, QuanComplex>   VMiniDevice;
     typedef typename MaterialManager::Library                       MatLib;
 
+    VIENNAUTILS_PROFILE_SCOPE("viennamos::viennamini_worker");
+
     VMiniDevice vmini_device(device.getCellComplex(), device.getSegmentation(), device.getQuantityComplex());
     viennamini::config & config = parameters_.config();
 
-    for(typename DeviceParameters::iterator siter = parameters_.begin();
-        siter != parameters_.end(); siter++)
-    {
-        std::size_t si = siter->first;
-        SegmentParameters& segpara = siter->second;
-        vmini_device.assign_name(si, segpara.name.toStdString());
-        vmini_device.assign_material(si, segpara.material.toStdString());
-
-        if(segpara.isContact)
-        {
-            vmini_device.assign_contact(si);
-            config.assign_contact(si, segpara.contact, segpara.workfunction);
-        }
-        else
-        if(segpara.isOxide)
-        {
-            vmini_device.assign_oxide(si);
-        }
-        else
-        if(segpara.isSemiconductor)
-        {
-            vmini_device.assign_semiconductor(si, segpara.donors, segpara.acceptors);
-        }
-        else {
-        }
-    }
+    viennamini::setup_device(vmini_device, config, parameters_.segments());
 
     // create a ViennaMini simulator object
     //
     typedef viennamini::simulator<VMiniDevice, MatLib>     Simulator;
     typedef typename Simulator::VectorType                 ResultVector;
     Simulator simulator(vmini_device, matlib_, config);
+    simulator.set_observer(this);
+    simulator.set_cancellation_token(&cancel_);
+
+    // the snapshots carry the current iterates of the quantities under the names
+    // of the module's cell quantities, the order follows the simulator's quantities
+    //
+    std::vector<std::size_t> snapshot_ids;
+    snapshot_ids.push_back(simulator.quantity_potential().id());
+    snapshot_ids.push_back(simulator.quantity_electron_density().id());
+    snapshot_ids.push_back(simulator.quantity_hole_density().id());
+    std::vector<std::string> snapshot_names;
+    snapshot_names.push_back(target_pot_quan_cell_.name);
+    snapshot_names.push_back(target_n_quan_cell_.name);
+    snapshot_names.push_back(target_p_quan_cell_.name);
+    DeviceSnapshotWriter<DeviceT> snapshot_writer(device, snapshot_ids, snapshot_names);
+    snapshot_writer_     = &snapshot_writer;
+    snapshot_quantities_ = snapshot_ids.size();
+    iterations_since_snapshot_ = 0;
+    snapshot_clock_.start();
 
     // run the simulation
     //
-    simulator();
+    if(resume_fraction_ >= 0.0) simulator.resume(resume_fraction_);
+    else                        simulator();
+
+    snapshot_writer_ = NULL;
+
+    // the partial solution is transferred as well, it shows where the simulation stopped
+    //
+    if(simulator.cancelled())
+      emit cancelled(simulator.cancelled_bias_fraction());
 
     //simulator.write_result();
 
@@ -110,22 +218,22 @@ private:
     QuantityTransferSetter p_setter   (target_p_vertex_acc);
 
     // transfer the cell-based ViennaMini results to the vertex-based ViennaMOS
-    // device using the ViennaMOS quantity accessor
+    // device using the ViennaMOS quantity accessor. the vertex-to-cell table is
+    // set up once, the three quantities are averaged in a single pass
     //
-    viennagrid::quantity_transfer<CellType, VertexType>(device.getCellComplex(),
-                                        source_pot_acc, pot_setter,
-                                        viennautils::arithmetic_averaging(),
-                                        any_filter(), any_filter());
-
-    viennagrid::quantity_transfer<CellType, VertexType>(device.getCellComplex(),
-                                        source_n_acc, n_setter,
-                                        viennautils::arithmetic_averaging(),
-                                        any_filter(), any_filter());
-
-    viennagrid::quantity_transfer<CellType, VertexType>(device.getCellComplex(),
-                                        source_p_acc, p_setter,
-                                        viennautils::arithmetic_averaging(),
-                                        any_filter(), any_filter());
+    VIENNAUTILS_PROFILE_SCOPE_NAMED(vertex_transfer_scope, "viennamos::vertex_transfer");
+    viennagrid::quantity_transfer_plan<Domain, CellType, VertexType> transfer(device.getCellComplex(),
+                                        viennagrid::arithmetic_transfer_weighting_tag());
+    std::vector<double> cell_values, vertex_values;
+    transfer.gather(source_pot_acc, cell_values, 0);
+    transfer.gather(source_n_acc,   cell_values, 1);
+    transfer.gather(source_p_acc,   cell_values, 2);
+    transfer.apply(cell_values, vertex_values, 3);
+    transfer.scatter(vertex_values, pot_setter, 0);
+    transfer.scatter(vertex_values, n_setter,   1);
+    transfer.scatter(vertex_values, p_setter,   2);
+
+    VIENNAUTILS_PROFILE_STOP(vertex_transfer_scope);
 
     typedef typename viennadata::result_of::accessor<QuanComplex, Quantity, double, CellType>::type TargetCellAccessor;
     TargetCellAccessor target_pot_cell_acc = viennadata::make_accessor(device.getQuantityComplex(), target_pot_quan_cell_);
@@ -135,18 +243,18 @@ private:
     // transfer the cell-based ViennaMini results to the cell-based ViennaMOS
     // device using the ViennaMOS quantity accessor
     //
+    VIENNAUTILS_PROFILE_SCOPE("viennamos::cell_transfer");
     viennamos::copy(device, source_pot_acc, target_pot_cell_acc);
     viennamos::copy(device, source_n_acc,   target_n_cell_acc);
     viennamos::copy(device, source_p_acc,   target_p_cell_acc);
 
   }
 
-private slots:
-  void forward_message(QString const& msg);
-
 signals:
+  void started();
   void finished();
-  void message(QString const& msg);
+  void cancelled(double bias_fraction);
+  void iteration(viennafvm::iteration_record const& record);
 
 private:
   viennamos::Device2u*            vmos_device2u_;
@@ -159,7 +267,18 @@ private:
   Quantity                      & target_pot_quan_cell_;
   Quantity                      & target_n_quan_cell_;
   Quantity                      & target_p_quan_cell_;
-
+  LogSinkPtr                      log_;
+  int                             thread_budget_;
+  viennafvm::cancellation_token   cancel_;
+  double                          resume_fraction_;
+
+  viennamos::SnapshotBuffer*      snapshots_;
+  std::size_t                     snapshot_interval_;
+  double                          snapshot_period_;
+  std::size_t                     snapshot_quantities_;
+  std::size_t                     iterations_since_snapshot_;
+  QElapsedTimer                   snapshot_clock_;
+  SnapshotWriter*                 snapshot_writer_;
 };
 
 #endif // VIENNAMINIWORKER_H